@@ -0,0 +1,697 @@
+/*
+ * Copyright (c) 2021 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Dataplane benchmarks driven by the packet generator.
+ *
+ * Every scenario configures itself on a pair of packet-generator
+ * interfaces and a fib table of its own, so scenarios don't step on each
+ * other, and removes its configuration again after the run, so the next
+ * run starts from scratch. A run injects fixed size packets on the rx
+ * interface from one stream per worker, lets things settle for the warmup
+ * time, then measures node runtime stats and interface counters over the
+ * given duration. The packet generator itself is left out of the cost per
+ * packet. No NICs are involved, which keeps runs comparable between builds
+ * on one machine.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/pg/pg.h>
+#include <vnet/plugin/plugin.h>
+#include <vpp/app/version.h>
+#include <fcntl.h>
+
+#include <benchmark/benchmark.h>
+
+benchmark_main_t benchmark_main;
+
+VLIB_PLUGIN_REGISTER () = {
+  .version = VPP_BUILD_VER,
+  .description = "Dataplane benchmarks",
+  .default_disabled = 1,
+};
+
+static void
+benchmark_cli_output (uword arg, u8 *buffer, uword buffer_bytes)
+{
+  u8 **output = (u8 **) arg;
+
+  vec_add (*output, buffer, buffer_bytes);
+}
+
+/* run CLI commands, stopping at the first one which fails */
+static clib_error_t *
+benchmark_exec (vlib_main_t *vm, u8 *script, u8 **output)
+{
+  unformat_input_t input;
+  int rv;
+
+  unformat_init_string (&input, (char *) script, vec_len (script));
+  rv = vlib_cli_input (vm, &input, benchmark_cli_output, (uword) output);
+  unformat_free (&input);
+
+  if (rv)
+    return clib_error_return (0, "%v", *output);
+  return 0;
+}
+
+/* undo the setup a line at a time, carrying on past lines which fail, so
+   a setup which failed half way is cleaned up as far as it got */
+static void
+benchmark_teardown (vlib_main_t *vm, benchmark_scenario_t *s)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  unformat_input_t input;
+  u8 *line = 0, *output = 0;
+
+  unformat_init_vector (&input, format (0, "%U", s->format_teardown,
+					&s->args));
+  while (unformat (&input, "%U", unformat_line, &line))
+    {
+      clib_error_t *err;
+
+      vec_reset_length (output);
+      if ((err = benchmark_exec (vm, line, &output)))
+	clib_error_free (err);
+      vec_free (line);
+    }
+  unformat_free (&input);
+  vec_free (output);
+
+  vnet_sw_interface_set_flags (vnm, s->rx_sw_if_index, 0);
+  vnet_sw_interface_set_flags (vnm, s->tx_sw_if_index, 0);
+  s->is_setup = 0;
+}
+
+static clib_error_t *
+benchmark_setup (vlib_main_t *vm, benchmark_scenario_t *s, u32 scale)
+{
+  benchmark_main_t *bm = &benchmark_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  pg_main_t *pg = &pg_main;
+  benchmark_args_t *a = &s->args;
+  clib_error_t *err = 0;
+  u8 *script = 0;
+  u32 i;
+
+  if (s->required_node &&
+      vlib_get_node_by_name (vm, (u8 *) s->required_node) == 0)
+    return clib_error_return (0, "'%s' needs node '%s', plugin not loaded?",
+			      s->name, s->required_node);
+
+  /* pg interfaces can't be deleted, a scenario keeps the ones it got */
+  if (a->rx_if_id == 0)
+    {
+      a->rx_if_id = BENCHMARK_PG_IF_ID_BASE + 2 * bm->n_setup;
+      a->tx_if_id = a->rx_if_id + 1;
+      a->table_id = BENCHMARK_TABLE_ID_BASE + bm->n_setup;
+      bm->n_setup++;
+
+      i = pg_interface_add_or_get (pg, a->rx_if_id, 0, 0, 0,
+				   PG_MODE_ETHERNET);
+      s->rx_sw_if_index = pg->interfaces[i].sw_if_index;
+      i = pg_interface_add_or_get (pg, a->tx_if_id, 0, 0, 0,
+				   PG_MODE_ETHERNET);
+      s->tx_sw_if_index = pg->interfaces[i].sw_if_index;
+    }
+  a->scale = scale;
+  a->index = ~0;
+
+  vnet_sw_interface_set_flags (vnm, s->rx_sw_if_index,
+			       VNET_SW_INTERFACE_FLAG_ADMIN_UP);
+  vnet_sw_interface_set_flags (vnm, s->tx_sw_if_index,
+			       VNET_SW_INTERFACE_FLAG_ADMIN_UP);
+  s->is_setup = 1;
+
+  for (a->step = 0; err == 0; a->step++)
+    {
+      vec_reset_length (script);
+      script = format (script, "%U", s->format_setup, a);
+      if (vec_len (script) == 0)
+	break;
+
+      vec_reset_length (a->output);
+      if ((err = benchmark_exec (vm, script, &a->output)))
+	{
+	  clib_error_t *e = err;
+	  err = clib_error_return (0, "'%s' setup failed: %U", s->name,
+				   format_clib_error, e);
+	  clib_error_free (e);
+	}
+    }
+
+  vec_free (a->output);
+  vec_free (script);
+
+  if (err)
+    benchmark_teardown (vm, s);
+  return err;
+}
+
+/* node runtime stats summed over all threads, and interface counters */
+static void
+benchmark_snapshot (vlib_main_t *vm, benchmark_scenario_t *s,
+		    benchmark_node_stats_t **nodes, u64 *rx_packets,
+		    u64 *tx_packets)
+{
+  vnet_interface_main_t *im = &vnet_get_main ()->interface_main;
+  vlib_counter_t c;
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  vec_validate (nodes[0], vec_len (vm->node_main.nodes) - 1);
+  vec_zero (nodes[0]);
+
+  for (int i = 0; i < vlib_get_n_threads (); i++)
+    {
+      vlib_main_t *stat_vm = vlib_get_main_by_index (i);
+      vlib_node_main_t *nm = &stat_vm->node_main;
+
+      for (int j = 0; j < vec_len (nm->nodes) && j < vec_len (nodes[0]); j++)
+	{
+	  vlib_node_t *n = nm->nodes[j];
+	  benchmark_node_stats_t *ns = vec_elt_at_index (nodes[0], j);
+
+	  if (n->type != VLIB_NODE_TYPE_INTERNAL &&
+	      n->type != VLIB_NODE_TYPE_INPUT)
+	    continue;
+
+	  vlib_node_sync_stats (stat_vm, n);
+	  ns->calls += n->stats_total.calls;
+	  ns->vectors += n->stats_total.vectors;
+	  ns->clocks += n->stats_total.clocks;
+	}
+    }
+
+  vlib_get_combined_counter (im->combined_sw_if_counters +
+			       VNET_INTERFACE_COUNTER_RX,
+			     s->rx_sw_if_index, &c);
+  *rx_packets = c.packets;
+  vlib_get_combined_counter (im->combined_sw_if_counters +
+			       VNET_INTERFACE_COUNTER_TX,
+			     s->tx_sw_if_index, &c);
+  *tx_packets = c.packets;
+
+  vlib_worker_thread_barrier_release (vm);
+}
+
+static int
+benchmark_node_result_sort_cmp (void *a1, void *a2)
+{
+  benchmark_node_result_t *n1 = a1;
+  benchmark_node_result_t *n2 = a2;
+
+  if (n1->stats.clocks != n2->stats.clocks)
+    return n1->stats.clocks > n2->stats.clocks ? -1 : 1;
+  return (int) n1->node_index - (int) n2->node_index;
+}
+
+clib_error_t *
+benchmark_run (vlib_main_t *vm, benchmark_scenario_t *s, u32 scale,
+	       u32 packet_size, u32 n_streams, f64 warmup, f64 duration,
+	       benchmark_result_t *r)
+{
+  benchmark_node_stats_t *before = 0, *after = 0;
+  u64 rx_before, tx_before, rx_after, tx_after;
+  u8 *script = 0, *output = 0;
+  clib_error_t *err, *e;
+  f64 t0, t1;
+
+  if (packet_size <= s->header_bytes || packet_size > 9000)
+    return clib_error_return (0, "'%s' needs a packet size between %u and "
+				 "9000 bytes",
+			      s->name, s->header_bytes + 1);
+
+  if (n_streams == 0 || n_streams > clib_max (vlib_num_workers (), 1))
+    return clib_error_return (0, "can't run %u streams on %u workers",
+			      n_streams, vlib_num_workers ());
+
+  if ((err = benchmark_setup (vm, s, scale)))
+    return err;
+
+  /* one stream per worker, the first ones if there are more */
+  for (u32 i = 0; i < n_streams; i++)
+    {
+      script = format (script,
+		       "packet-generator new {\n"
+		       "  name benchmark-%s-%u\n"
+		       "  limit 0\n"
+		       "  rate 0\n"
+		       "  size %u-%u\n"
+		       "  interface pg%u\n"
+		       "  node ethernet-input\n"
+		       "  worker %u\n"
+		       "  data {\n"
+		       "%U"
+		       "    incrementing %u\n"
+		       "  }\n"
+		       "}\n",
+		       s->name, i, packet_size, packet_size, s->args.rx_if_id,
+		       i, s->format_stream, &s->args,
+		       packet_size - s->header_bytes);
+      script = format (script, "packet-generator enable-stream "
+			       "benchmark-%s-%u\n",
+		       s->name, i);
+    }
+
+  if ((err = benchmark_exec (vm, script, &output)))
+    goto done;
+
+  vlib_process_suspend (vm, warmup);
+
+  benchmark_snapshot (vm, s, &before, &rx_before, &tx_before);
+  t0 = vlib_time_now (vm);
+
+  vlib_process_suspend (vm, duration);
+
+  benchmark_snapshot (vm, s, &after, &rx_after, &tx_after);
+  t1 = vlib_time_now (vm);
+
+  clib_memset (r, 0, sizeof (*r));
+  r->scenario = s;
+  r->scale = s->scale_unit ? s->args.scale : 0;
+  r->packet_size = packet_size;
+  r->n_streams = n_streams;
+  r->duration = t1 - t0;
+  r->rx_packets = rx_after - rx_before;
+  r->tx_packets = tx_after - tx_before;
+
+  for (u32 i = 0; i < vec_len (after); i++)
+    {
+      benchmark_node_result_t *nr;
+
+      /* the generator is not part of what is measured */
+      if (after[i].vectors == before[i].vectors || i == pg_input_node.index)
+	continue;
+
+      vec_add2 (r->nodes, nr, 1);
+      nr->node_index = i;
+      nr->stats.calls = after[i].calls - before[i].calls;
+      nr->stats.vectors = after[i].vectors - before[i].vectors;
+      nr->stats.clocks = after[i].clocks - before[i].clocks;
+      r->clocks += nr->stats.clocks;
+    }
+  vec_sort_with_function (r->nodes, benchmark_node_result_sort_cmp);
+
+done:
+  /* the streams go, whatever happened */
+  vec_reset_length (script);
+  for (u32 i = 0; i < n_streams; i++)
+    script = format (script,
+		     "packet-generator disable-stream benchmark-%s-%u\n"
+		     "packet-generator delete benchmark-%s-%u\n",
+		     s->name, i, s->name, i);
+  vec_reset_length (output);
+  if ((e = benchmark_exec (vm, script, &output)))
+    clib_error_free (e);
+
+  benchmark_teardown (vm, s);
+
+  vec_free (before);
+  vec_free (after);
+  vec_free (script);
+  vec_free (output);
+  return err;
+}
+
+void
+benchmark_result_free (benchmark_result_t *r)
+{
+  vec_free (r->nodes);
+}
+
+static f64
+benchmark_per_packet (u64 v, u64 n_packets)
+{
+  return n_packets ? (f64) v / n_packets : 0;
+}
+
+u8 *
+format_benchmark_result (u8 *s, va_list *args)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  benchmark_result_t *r = va_arg (*args, benchmark_result_t *);
+  u32 n_nodes = va_arg (*args, u32);
+  benchmark_scenario_t *sc = r->scenario;
+  u32 indent = format_get_indent (s);
+
+  s = format (s, "%s", sc->name);
+  if (sc->scale_unit)
+    s = format (s, ", %u %s", r->scale, sc->scale_unit);
+  s = format (s, ", %u byte packets, %u stream%s, %.2f sec", r->packet_size,
+	      r->n_streams, r->n_streams > 1 ? "s" : "", r->duration);
+
+  s = format (s, "\n%Urx %.3f Mpps, tx %.3f Mpps, %.1f clocks/packet",
+	      format_white_space, indent + 2,
+	      r->rx_packets / r->duration / 1e6,
+	      r->tx_packets / r->duration / 1e6,
+	      benchmark_per_packet (r->clocks, r->tx_packets));
+
+  if (n_nodes == 0)
+    return s;
+
+  s = format (s, "\n%U%-32s%14s%14s%10s%12s", format_white_space, indent + 2,
+	      "Node", "Calls", "Vectors", "Vec/Call", "Clocks/Pkt");
+  for (u32 i = 0; i < vec_len (r->nodes) && i < n_nodes; i++)
+    {
+      benchmark_node_result_t *nr = vec_elt_at_index (r->nodes, i);
+
+      s = format (s, "\n%U%-32U%14lu%14lu%10.2f%12.2f", format_white_space,
+		  indent + 2, format_vlib_node_name, vm, nr->node_index,
+		  nr->stats.calls, nr->stats.vectors,
+		  benchmark_per_packet (nr->stats.vectors, nr->stats.calls),
+		  benchmark_per_packet (nr->stats.clocks, nr->stats.vectors));
+    }
+
+  return s;
+}
+
+u8 *
+format_benchmark_results_json (u8 *s, va_list *args)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  benchmark_result_t *results = va_arg (*args, benchmark_result_t *);
+
+  s = format (s, "{\n  \"version\": \"%s\",\n", VPP_BUILD_VER);
+  s = format (s, "  \"workers\": %u,\n", vlib_num_workers ());
+  s = format (s, "  \"results\": [\n");
+
+  for (u32 i = 0; i < vec_len (results); i++)
+    {
+      benchmark_result_t *r = vec_elt_at_index (results, i);
+
+      s = format (s, "    {\n      \"scenario\": \"%s\",\n",
+		  r->scenario->name);
+      s = format (s, "      \"scale\": %u,\n", r->scale);
+      s = format (s, "      \"packet_size\": %u,\n", r->packet_size);
+      s = format (s, "      \"streams\": %u,\n", r->n_streams);
+      s = format (s, "      \"duration\": %.3f,\n", r->duration);
+      s = format (s, "      \"rx_packets\": %lu,\n", r->rx_packets);
+      s = format (s, "      \"tx_packets\": %lu,\n", r->tx_packets);
+      s = format (s, "      \"rx_mpps\": %.3f,\n",
+		  r->rx_packets / r->duration / 1e6);
+      s = format (s, "      \"tx_mpps\": %.3f,\n",
+		  r->tx_packets / r->duration / 1e6);
+      s = format (s, "      \"clocks_per_packet\": %.2f,\n",
+		  benchmark_per_packet (r->clocks, r->tx_packets));
+      s = format (s, "      \"nodes\": [\n");
+      for (u32 j = 0; j < vec_len (r->nodes); j++)
+	{
+	  benchmark_node_result_t *nr = vec_elt_at_index (r->nodes, j);
+
+	  s = format (s,
+		      "        { \"name\": \"%U\", \"calls\": %lu, "
+		      "\"vectors\": %lu, \"clocks\": %lu, "
+		      "\"clocks_per_packet\": %.2f }%s\n",
+		      format_vlib_node_name, vm, nr->node_index,
+		      nr->stats.calls, nr->stats.vectors, nr->stats.clocks,
+		      benchmark_per_packet (nr->stats.clocks,
+					    nr->stats.vectors),
+		      j + 1 < vec_len (r->nodes) ? "," : "");
+	}
+      s = format (s, "      ]\n    }%s\n",
+		  i + 1 < vec_len (results) ? "," : "");
+    }
+
+  return format (s, "  ]\n}\n");
+}
+
+static int
+benchmark_scenario_sort_cmp (void *a1, void *a2)
+{
+  benchmark_scenario_t **s1 = a1;
+  benchmark_scenario_t **s2 = a2;
+
+  return strcmp ((*s1)->name, (*s2)->name);
+}
+
+static benchmark_scenario_t **
+benchmark_all_scenarios (void)
+{
+  benchmark_main_t *bm = &benchmark_main;
+  benchmark_scenario_t *s, **v = 0;
+
+  for (s = bm->scenarios; s; s = s->next)
+    vec_add1 (v, s);
+  vec_sort_with_function (v, benchmark_scenario_sort_cmp);
+  return v;
+}
+
+static uword
+unformat_benchmark_scenario (unformat_input_t *input, va_list *args)
+{
+  benchmark_main_t *bm = &benchmark_main;
+  benchmark_scenario_t **s = va_arg (*args, benchmark_scenario_t **);
+  u8 *name = 0;
+  uword *p;
+
+  if (!unformat (input, "%s", &name))
+    return 0;
+
+  vec_add1 (name, 0);
+  p = hash_get_mem (bm->scenario_by_name, name);
+  vec_free (name);
+
+  if (p == 0)
+    return 0;
+
+  s[0] = (benchmark_scenario_t *) p[0];
+  return 1;
+}
+
+static clib_error_t *
+benchmark_run_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			  vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  benchmark_scenario_t *s, **scenarios = 0;
+  benchmark_result_t *r, *results = 0;
+  clib_error_t *err = 0;
+  u8 *filename = 0, *json = 0;
+  u32 scale = 0, packet_size = 64, n_streams = 1, n_nodes = 10;
+  f64 warmup = 1, duration = 5;
+  int show_json = 0, run_all = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, "please specify a scenario");
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "all"))
+	{
+	  vec_free (scenarios);
+	  scenarios = benchmark_all_scenarios ();
+	  run_all = 1;
+	}
+      else if (unformat (line_input, "scale %u", &scale))
+	;
+      else if (unformat (line_input, "size %u", &packet_size))
+	;
+      else if (unformat (line_input, "workers %u", &n_streams))
+	;
+      else if (unformat (line_input, "warmup %f", &warmup))
+	;
+      else if (unformat (line_input, "duration %f", &duration))
+	;
+      else if (unformat (line_input, "nodes %u", &n_nodes))
+	;
+      else if (unformat (line_input, "json"))
+	show_json = 1;
+      else if (unformat (line_input, "file %U", unformat_vlib_tmpfile,
+			 &filename))
+	;
+      else if (unformat (line_input, "%U", unformat_benchmark_scenario, &s))
+	vec_add1 (scenarios, s);
+      else
+	{
+	  err = clib_error_return (0, "unknown input `%U'",
+				   format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (vec_len (scenarios) == 0)
+    {
+      err = clib_error_return (0, "please specify a scenario");
+      goto done;
+    }
+
+  if (duration <= 0 || warmup < 0)
+    {
+      err = clib_error_return (0, "invalid warmup or duration");
+      goto done;
+    }
+
+  for (u32 i = 0; i < vec_len (scenarios); i++)
+    {
+      benchmark_result_t result;
+      u32 sc_scale;
+
+      s = scenarios[i];
+      sc_scale = s->default_scale;
+
+      if (run_all && s->required_node &&
+	  vlib_get_node_by_name (vm, (u8 *) s->required_node) == 0)
+	{
+	  vlib_cli_output (vm, "%s: skipped, no '%s' node\n", s->name,
+			   s->required_node);
+	  continue;
+	}
+      if (s->scale_unit && scale)
+	{
+	  if (scale > s->max_scale)
+	    {
+	      err = clib_error_return (0, "'%s' takes up to %u %s", s->name,
+				       s->max_scale, s->scale_unit);
+	      break;
+	    }
+	  sc_scale = scale;
+	}
+
+      err = benchmark_run (vm, s, sc_scale, packet_size, n_streams, warmup,
+			   duration, &result);
+      if (err)
+	break;
+
+      vec_add1 (results, result);
+      if (!show_json)
+	vlib_cli_output (vm, "%U\n", format_benchmark_result, &result,
+			 n_nodes);
+    }
+
+  if (vec_len (results) && (show_json || filename))
+    {
+      json = format (0, "%U", format_benchmark_results_json, results);
+      if (show_json)
+	vlib_cli_output (vm, "%v", json);
+    }
+
+  if (vec_len (results) && filename)
+    {
+      int fd;
+
+      fd = open ((char *) filename, O_CREAT | O_TRUNC | O_WRONLY, 0664);
+      if (fd < 0 || write (fd, json, vec_len (json)) != vec_len (json))
+	{
+	  clib_error_t *e;
+	  e = clib_error_return_unix (0, "failed to write '%s'", filename);
+	  err = err ? clib_error_return (err, "%U", format_clib_error, e) : e;
+	  if (err != e)
+	    clib_error_free (e);
+	}
+      else
+	vlib_cli_output (vm, "%u results written to %s", vec_len (results),
+			 filename);
+      if (fd >= 0)
+	close (fd);
+    }
+
+done:
+  unformat_free (line_input);
+  vec_foreach (r, results)
+    benchmark_result_free (r);
+  vec_free (results);
+  vec_free (scenarios);
+  vec_free (filename);
+  vec_free (json);
+  return err;
+}
+
+/*?
+ * Run one or more benchmark scenarios, or all of them. Each scenario is
+ * configured before its run and the configuration is removed again
+ * afterwards, so every run starts from scratch. Traffic comes from one
+ * packet-generator stream on each of the first @c workers workers.
+ * Results are printed, or written as JSON for comparing builds.
+ *
+ * @cliexpar
+ * @cliexstart{benchmark run ip4-fib scale 1000000 duration 10}
+ * ip4-fib, 1000000 routes, 64 byte packets, 1 stream, 10.00 sec
+ *   rx 10.543 Mpps, tx 10.543 Mpps, 183.4 clocks/packet
+ * ...
+ * @cliexend
+?*/
+VLIB_CLI_COMMAND (benchmark_run_command, static) = {
+  .path = "benchmark run",
+  .short_help = "benchmark run <scenario>... | all [scale <n>] "
+		"[size <bytes>] [workers <n>] [warmup <sec>] "
+		"[duration <sec>] [nodes <n>] [json] [file <filename>]",
+  .function = benchmark_run_command_fn,
+  /* the workers must keep running while we wait for the results */
+  .is_mp_safe = 1,
+};
+
+static clib_error_t *
+show_benchmark_scenarios_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				     vlib_cli_command_t *cmd)
+{
+  benchmark_scenario_t **scenarios = benchmark_all_scenarios ();
+
+  vlib_cli_output (vm, "%-16s%-20s%-32s%s", "Name", "Scale", "Setup",
+		   "Description");
+
+  for (u32 i = 0; i < vec_len (scenarios); i++)
+    {
+      benchmark_scenario_t *s = scenarios[i];
+      u8 *scale = 0, *setup = 0;
+
+      if (s->scale_unit)
+	scale = format (0, "%u %s", s->default_scale, s->scale_unit);
+      if (s->args.rx_if_id)
+	setup = format (0, "pg%u -> pg%u, table %u", s->args.rx_if_id,
+			s->args.tx_if_id, s->args.table_id);
+
+      vlib_cli_output (vm, "%-16s%-20v%-32v%s", s->name, scale, setup,
+		       s->description);
+      vec_free (scale);
+      vec_free (setup);
+    }
+
+  vec_free (scenarios);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_benchmark_scenarios_command, static) = {
+  .path = "show benchmark scenarios",
+  .short_help = "show benchmark scenarios",
+  .function = show_benchmark_scenarios_command_fn,
+};
+
+static clib_error_t *
+benchmark_init (vlib_main_t *vm)
+{
+  benchmark_main_t *bm = &benchmark_main;
+  benchmark_scenario_t *s;
+
+  bm->scenario_by_name = hash_create_string (0, sizeof (uword));
+  for (s = bm->scenarios; s; s = s->next)
+    {
+      if (hash_get_mem (bm->scenario_by_name, s->name))
+	clib_panic ("duplicate scenario name '%s'", s->name);
+      hash_set_mem (bm->scenario_by_name, s->name, s);
+    }
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (benchmark_init);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
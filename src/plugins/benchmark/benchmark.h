@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __benchmark_benchmark_h__
+#define __benchmark_benchmark_h__
+
+#include <vppinfra/clib.h>
+#include <vppinfra/format.h>
+#include <vlib/vlib.h>
+
+/* packet-generator interface ids and fib table ids used by the scenarios
+   start here, to stay out of the way of any other configuration */
+#define BENCHMARK_PG_IF_ID_BASE 1000
+#define BENCHMARK_TABLE_ID_BASE 1000
+
+/* what a scenario gets to configure itself with */
+typedef struct
+{
+  u32 rx_if_id;	  /* traffic is injected on pg<rx_if_id> */
+  u32 tx_if_id;	  /* and is expected to leave on pg<tx_if_id> */
+  u32 table_id;	  /* private ip4/ip6 table, also used as instance id */
+  u32 scale;	  /* routes, rules, flows, ... */
+  u32 index;	  /* something setup created, for teardown to find */
+
+  /* setup is formatted and run in steps until a step comes out empty, each
+     step seeing the CLI output of the one before */
+  u32 step;
+  u8 *output;
+} benchmark_args_t;
+
+typedef struct benchmark_scenario
+{
+  char *name;
+  char *description;
+
+  /* what the scale means, and its default */
+  char *scale_unit;
+  u32 default_scale;
+  u32 max_scale;
+
+  /* a node the scenario can't run without, if it comes from a plugin */
+  char *required_node;
+
+  /* CLI commands configuring the scenario and undoing that again, and the
+     'data { }' headers of the packet-generator stream, all formatted with
+     a benchmark_args_t *. The payload fills the packet up after
+     header_bytes of headers. */
+  format_function_t *format_setup;
+  format_function_t *format_teardown;
+  format_function_t *format_stream;
+  u32 header_bytes;
+
+  /* do not set manually, a scenario is set up for each run and torn down
+     after it, on interfaces and a table allocated the first time */
+  u8 is_setup;
+  benchmark_args_t args;
+  u32 rx_sw_if_index;
+  u32 tx_sw_if_index;
+  struct benchmark_scenario *next;
+} benchmark_scenario_t;
+
+typedef struct
+{
+  u64 calls;
+  u64 vectors;
+  u64 clocks;
+} benchmark_node_stats_t;
+
+typedef struct
+{
+  u32 node_index;
+  benchmark_node_stats_t stats;
+} benchmark_node_result_t;
+
+typedef struct
+{
+  benchmark_scenario_t *scenario;
+  u32 scale;
+  u32 packet_size;
+  u32 n_streams;
+  f64 duration;
+  u64 rx_packets;
+  u64 tx_packets;
+  u64 clocks;
+  /* nodes which handled packets, busiest first */
+  benchmark_node_result_t *nodes;
+} benchmark_result_t;
+
+typedef struct
+{
+  benchmark_scenario_t *scenarios;
+  uword *scenario_by_name;
+  u32 n_setup;
+} benchmark_main_t;
+
+extern benchmark_main_t benchmark_main;
+
+#define BENCHMARK_REGISTER_SCENARIO(x)                                        \
+  benchmark_scenario_t __benchmark_scenario_##x;                              \
+  static void __clib_constructor __benchmark_scenario_registration_##x (     \
+    void)                                                                     \
+  {                                                                           \
+    benchmark_main_t *bm = &benchmark_main;                                   \
+    __benchmark_scenario_##x.next = bm->scenarios;                            \
+    bm->scenarios = &__benchmark_scenario_##x;                                \
+  }                                                                           \
+  benchmark_scenario_t __benchmark_scenario_##x
+
+clib_error_t *benchmark_run (vlib_main_t *vm, benchmark_scenario_t *s,
+			     u32 scale, u32 packet_size, u32 n_streams,
+			     f64 warmup, f64 duration,
+			     benchmark_result_t *result);
+void benchmark_result_free (benchmark_result_t *r);
+
+format_function_t format_benchmark_result;
+format_function_t format_benchmark_results_json;
+
+#endif /* __benchmark_benchmark_h__ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
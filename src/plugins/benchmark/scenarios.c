@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2021 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/ip/ip.h>
+#include <benchmark/benchmark.h>
+
+/*
+ * All scenarios share one addressing plan. Traffic comes in on the rx
+ * interface from 192.168.0.2 (2001:db8::2) and leaves the tx interface
+ * towards 192.168.1.2 (2001:db8:1::2). Routed destinations are taken from
+ * 16.0.0.0/8 (2001:db8:100::/48).
+ */
+
+#define BENCHMARK_DST4 0x10000000
+#define BENCHMARK_NEIGHBOR_MAC "02:00:00:00:01:02"
+
+static u8 *
+format_benchmark_dst4 (u8 *s, va_list *args)
+{
+  u32 offset = va_arg (*args, u32);
+  ip4_address_t a = { .as_u32 = clib_host_to_net_u32 (BENCHMARK_DST4 +
+						       offset) };
+
+  return format (s, "%U", format_ip4_address, &a);
+}
+
+static u8 *
+format_benchmark_dst6 (u8 *s, va_list *args)
+{
+  u32 offset = va_arg (*args, u32);
+  ip6_address_t a = {
+    .as_u64[0] = clib_host_to_net_u64 (0x20010db801000000ULL),
+    .as_u64[1] = clib_host_to_net_u64 (offset),
+  };
+
+  return format (s, "%U", format_ip6_address, &a);
+}
+
+/* private table with both interfaces addressed and the next-hop resolved */
+static u8 *
+format_benchmark_ip4_base (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "ip table add %u\n", a->table_id);
+  s = format (s, "set interface ip table pg%u %u\n", a->rx_if_id, a->table_id);
+  s = format (s, "set interface ip table pg%u %u\n", a->tx_if_id, a->table_id);
+  s = format (s, "set interface ip address pg%u 192.168.0.1/24\n",
+	      a->rx_if_id);
+  s = format (s, "set interface ip address pg%u 192.168.1.1/24\n",
+	      a->tx_if_id);
+  s = format (s, "set ip neighbor pg%u 192.168.1.2 %s\n", a->tx_if_id,
+	      BENCHMARK_NEIGHBOR_MAC);
+  return s;
+}
+
+static u8 *
+format_benchmark_ip4_base_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "set ip neighbor del pg%u 192.168.1.2 %s\n", a->tx_if_id,
+	      BENCHMARK_NEIGHBOR_MAC);
+  s = format (s, "set interface ip address del pg%u 192.168.0.1/24\n",
+	      a->rx_if_id);
+  s = format (s, "set interface ip address del pg%u 192.168.1.1/24\n",
+	      a->tx_if_id);
+  s = format (s, "set interface ip table pg%u 0\n", a->rx_if_id);
+  s = format (s, "set interface ip table pg%u 0\n", a->tx_if_id);
+  s = format (s, "ip table del %u\n", a->table_id);
+  return s;
+}
+
+/* the routes to 16.0.0.0/8 of the scenarios which don't count routes */
+static u8 *
+format_benchmark_ip4_route_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "ip route del %U/8 table %u via 192.168.1.2 pg%u\n",
+	      format_benchmark_dst4, 0, a->table_id, a->tx_if_id);
+  return format (s, "%U", format_benchmark_ip4_base_teardown, a);
+}
+
+static u8 *
+format_benchmark_ip4_udp (u8 *s, va_list *args)
+{
+  u32 n_dst = va_arg (*args, u32);
+
+  s = format (s, "IP4: 00:01:02:03:04:05 -> 02:fe:00:00:00:00\n");
+  s = format (s, "UDP: 192.168.0.2 -> %U", format_benchmark_dst4, 0);
+  if (n_dst > 1)
+    s = format (s, " - %U", format_benchmark_dst4, n_dst - 1);
+  return format (s, "\nUDP: 1234 -> 4321\n");
+}
+
+/* l2 cross connect, the shortest path through the graph */
+
+static u8 *
+format_benchmark_l2_xconnect_setup (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  if (a->step)
+    return s;
+
+  s = format (s, "set interface l2 xconnect pg%u pg%u\n", a->rx_if_id,
+	      a->tx_if_id);
+  s = format (s, "set interface l2 xconnect pg%u pg%u\n", a->tx_if_id,
+	      a->rx_if_id);
+  return s;
+}
+
+static u8 *
+format_benchmark_l2_xconnect_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "set interface l3 pg%u\n", a->rx_if_id);
+  s = format (s, "set interface l3 pg%u\n", a->tx_if_id);
+  return s;
+}
+
+static u8 *
+format_benchmark_l2_xconnect_stream (u8 *s, va_list *args)
+{
+  va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "IP4: 00:01:02:03:04:05 -> 00:02:03:04:05:06\n");
+  s = format (s, "UDP: 192.168.0.2 -> 192.168.1.2\n");
+  return format (s, "UDP: 1234 -> 4321\n");
+}
+
+BENCHMARK_REGISTER_SCENARIO (l2_xconnect) = {
+  .name = "l2-xconnect",
+  .description = "L2 cross connect between two interfaces",
+  .format_setup = format_benchmark_l2_xconnect_setup,
+  .format_teardown = format_benchmark_l2_xconnect_teardown,
+  .format_stream = format_benchmark_l2_xconnect_stream,
+  .header_bytes = 42,
+};
+
+/* ip4 forwarding over a table of /32 routes, every route gets traffic */
+
+static u8 *
+format_benchmark_ip4_fib_setup (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  if (a->step)
+    return s;
+
+  s = format (s, "%U", format_benchmark_ip4_base, a);
+  s = format (s, "ip route add count %u %U/32 table %u via 192.168.1.2 pg%u\n",
+	      a->scale, format_benchmark_dst4, 0, a->table_id, a->tx_if_id);
+  return s;
+}
+
+static u8 *
+format_benchmark_ip4_fib_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "ip route del count %u %U/32 table %u via 192.168.1.2 pg%u\n",
+	      a->scale, format_benchmark_dst4, 0, a->table_id, a->tx_if_id);
+  return format (s, "%U", format_benchmark_ip4_base_teardown, a);
+}
+
+static u8 *
+format_benchmark_ip4_fib_stream (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  return format (s, "%U", format_benchmark_ip4_udp, a->scale);
+}
+
+BENCHMARK_REGISTER_SCENARIO (ip4_fib) = {
+  .name = "ip4-fib",
+  .description = "IPv4 forwarding, destinations spread over all routes",
+  .scale_unit = "routes",
+  .default_scale = 100000,
+  .max_scale = 1 << 24,
+  .format_setup = format_benchmark_ip4_fib_setup,
+  .format_teardown = format_benchmark_ip4_fib_teardown,
+  .format_stream = format_benchmark_ip4_fib_stream,
+  .header_bytes = 42,
+};
+
+/* ip6 forwarding over a table of /128 routes. The packet generator can't
+   walk ranges of 128 bit fields, so all packets go to the route in the
+   middle of the table. */
+
+static u8 *
+format_benchmark_ip6_fib_setup (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  if (a->step)
+    return s;
+
+  s = format (s, "ip6 table add %u\n", a->table_id);
+  s = format (s, "set interface ip6 table pg%u %u\n", a->rx_if_id,
+	      a->table_id);
+  s = format (s, "set interface ip6 table pg%u %u\n", a->tx_if_id,
+	      a->table_id);
+  s = format (s, "set interface ip address pg%u 2001:db8::1/64\n",
+	      a->rx_if_id);
+  s = format (s, "set interface ip address pg%u 2001:db8:1::1/64\n",
+	      a->tx_if_id);
+  s = format (s, "set ip neighbor pg%u 2001:db8:1::2 %s\n", a->tx_if_id,
+	      BENCHMARK_NEIGHBOR_MAC);
+  s = format (s,
+	      "ip route add count %u %U/128 table %u via 2001:db8:1::2 pg%u\n",
+	      a->scale, format_benchmark_dst6, 0, a->table_id, a->tx_if_id);
+  return s;
+}
+
+static u8 *
+format_benchmark_ip6_fib_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s,
+	      "ip route del count %u %U/128 table %u via 2001:db8:1::2 pg%u\n",
+	      a->scale, format_benchmark_dst6, 0, a->table_id, a->tx_if_id);
+  s = format (s, "set ip neighbor del pg%u 2001:db8:1::2 %s\n", a->tx_if_id,
+	      BENCHMARK_NEIGHBOR_MAC);
+  s = format (s, "set interface ip address del pg%u 2001:db8::1/64\n",
+	      a->rx_if_id);
+  s = format (s, "set interface ip address del pg%u 2001:db8:1::1/64\n",
+	      a->tx_if_id);
+  s = format (s, "set interface ip6 table pg%u 0\n", a->rx_if_id);
+  s = format (s, "set interface ip6 table pg%u 0\n", a->tx_if_id);
+  s = format (s, "ip6 table del %u\n", a->table_id);
+  return s;
+}
+
+static u8 *
+format_benchmark_ip6_fib_stream (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "IP6: 00:01:02:03:04:05 -> 02:fe:00:00:00:00\n");
+  s = format (s, "UDP: 2001:db8::2 -> %U\n", format_benchmark_dst6,
+	      a->scale / 2);
+  return format (s, "UDP: 1234 -> 4321\n");
+}
+
+BENCHMARK_REGISTER_SCENARIO (ip6_fib) = {
+  .name = "ip6-fib",
+  .description = "IPv6 forwarding, one destination in a table of routes",
+  .scale_unit = "routes",
+  .default_scale = 100000,
+  .max_scale = 1 << 24,
+  .format_setup = format_benchmark_ip6_fib_setup,
+  .format_teardown = format_benchmark_ip6_fib_teardown,
+  .format_stream = format_benchmark_ip6_fib_stream,
+  .header_bytes = 62,
+};
+
+/* ip4 forwarding with an input ACL. The packets miss every deny rule and
+   hit the permit at the end. */
+
+static u8 *
+format_benchmark_acl_setup (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+  unformat_input_t input;
+  u32 acl_index;
+
+  if (a->step == 0)
+    {
+      s = format (s, "%U", format_benchmark_ip4_base, a);
+      s = format (s, "ip route add %U/8 table %u via 192.168.1.2 pg%u\n",
+		  format_benchmark_dst4, 0, a->table_id, a->tx_if_id);
+      s = format (s, "set acl-plugin acl");
+      for (u32 i = 0; i < a->scale; i++)
+	s = format (s, " deny src 10.%u.%u.0/24 dst 0.0.0.0/0,", i >> 8,
+		    i & 0xff);
+      return format (s, " permit src 0.0.0.0/0 dst 0.0.0.0/0\n");
+    }
+
+  if (a->step > 1)
+    return s;
+
+  /* apply the acl just added */
+  unformat_init_string (&input, (char *) a->output, vec_len (a->output));
+  if (unformat (&input, "ACL index:%u", &acl_index))
+    {
+      a->index = acl_index;
+      s = format (s, "set acl-plugin interface pg%u input acl %u\n",
+		  a->rx_if_id, acl_index);
+    }
+  unformat_free (&input);
+  return s;
+}
+
+/* the plugin has no CLI to delete an acl, it is only taken off the
+   interface */
+static u8 *
+format_benchmark_acl_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  if (a->index != ~0)
+    s = format (s, "set acl-plugin interface pg%u input acl %u del\n",
+		a->rx_if_id, a->index);
+  return format (s, "%U", format_benchmark_ip4_route_teardown, a);
+}
+
+static u8 *
+format_benchmark_acl_stream (u8 *s, va_list *args)
+{
+  va_arg (*args, benchmark_args_t *);
+
+  return format (s, "%U", format_benchmark_ip4_udp, 1024);
+}
+
+BENCHMARK_REGISTER_SCENARIO (acl) = {
+  .name = "acl",
+  .description = "IPv4 forwarding with a stateless input ACL",
+  .scale_unit = "rules",
+  .default_scale = 100,
+  .max_scale = 1 << 16,
+  .required_node = "acl-plugin-in-ip4-fa",
+  .format_setup = format_benchmark_acl_setup,
+  .format_teardown = format_benchmark_acl_teardown,
+  .format_stream = format_benchmark_acl_stream,
+  .header_bytes = 42,
+};
+
+/* NAT44 endpoint dependent, every destination is a session of its own */
+
+static u8 *
+format_benchmark_nat44_ed_setup (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  if (a->step)
+    return s;
+
+  s = format (s, "%U", format_benchmark_ip4_base, a);
+  s = format (s, "ip route add %U/8 table %u via 192.168.1.2 pg%u\n",
+	      format_benchmark_dst4, 0, a->table_id, a->tx_if_id);
+  s = format (s, "nat44 enable sessions %u\n", clib_max (2 * a->scale, 1024));
+  s = format (s, "nat44 add address 192.168.1.16 - 192.168.1.31 "
+		 "tenant-vrf %u\n",
+	      a->table_id);
+  s = format (s, "set interface nat44 in pg%u out pg%u\n", a->rx_if_id,
+	      a->tx_if_id);
+  return s;
+}
+
+static u8 *
+format_benchmark_nat44_ed_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "set interface nat44 in pg%u out pg%u del\n", a->rx_if_id,
+	      a->tx_if_id);
+  s = format (s, "nat44 add address 192.168.1.16 - 192.168.1.31 "
+		 "tenant-vrf %u del\n",
+	      a->table_id);
+  s = format (s, "nat44 disable\n");
+  return format (s, "%U", format_benchmark_ip4_route_teardown, a);
+}
+
+static u8 *
+format_benchmark_nat44_ed_stream (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  return format (s, "%U", format_benchmark_ip4_udp, a->scale);
+}
+
+BENCHMARK_REGISTER_SCENARIO (nat44_ed) = {
+  .name = "nat44-ed",
+  .description = "NAT44 endpoint dependent, established sessions",
+  .scale_unit = "sessions",
+  .default_scale = 10000,
+  .max_scale = 1 << 20,
+  .required_node = "nat44-ed-in2out",
+  .format_setup = format_benchmark_nat44_ed_setup,
+  .format_teardown = format_benchmark_nat44_ed_teardown,
+  .format_stream = format_benchmark_nat44_ed_stream,
+  .header_bytes = 42,
+};
+
+/* ip4 routed into an ESP protected IPIP tunnel, AES-GCM-128 */
+
+static u8 *
+format_benchmark_ipsec_setup (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+  char *key = "4a506a794f574265564551694d653768";
+
+  if (a->step)
+    return s;
+
+  s = format (s, "%U", format_benchmark_ip4_base, a);
+  s = format (s,
+	      "create ipip tunnel src 192.168.1.1 dst 192.168.1.2 "
+	      "instance %u outer-table-id %u\n",
+	      a->table_id, a->table_id);
+  s = format (s,
+	      "ipsec sa add %u spi %u esp crypto-alg aes-gcm-128 "
+	      "crypto-key %s\n",
+	      2 * a->table_id, 2 * a->table_id, key);
+  s = format (s,
+	      "ipsec sa add %u spi %u esp crypto-alg aes-gcm-128 "
+	      "crypto-key %s\n",
+	      2 * a->table_id + 1, 2 * a->table_id + 1, key);
+  s = format (s, "ipsec tunnel protect ipip%u sa-in %u sa-out %u\n",
+	      a->table_id, 2 * a->table_id + 1, 2 * a->table_id);
+  s = format (s, "set interface ip table ipip%u %u\n", a->table_id,
+	      a->table_id);
+  s = format (s, "set interface unnumbered ipip%u use pg%u\n", a->table_id,
+	      a->tx_if_id);
+  s = format (s, "set interface state ipip%u up\n", a->table_id);
+  s = format (s, "ip route add %U/8 table %u via ipip%u\n",
+	      format_benchmark_dst4, 0, a->table_id, a->table_id);
+  return s;
+}
+
+static u8 *
+format_benchmark_ipsec_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+  vnet_main_t *vnm = vnet_get_main ();
+  u8 *name = format (0, "ipip%u%c", a->table_id, 0);
+  uword *p;
+
+  s = format (s, "ip route del %U/8 table %u via ipip%u\n",
+	      format_benchmark_dst4, 0, a->table_id, a->table_id);
+  s = format (s, "ipsec tunnel protect ipip%u del\n", a->table_id);
+  s = format (s, "set interface unnumbered del ipip%u\n", a->table_id);
+  s = format (s, "set interface ip table ipip%u 0\n", a->table_id);
+
+  /* the CLI deletes ipip tunnels by sw_if_index only */
+  p = hash_get_mem (vnm->interface_main.hw_interface_by_name, name);
+  if (p)
+    s = format (s, "delete ipip tunnel sw_if_index %u\n",
+		vnet_get_hw_interface (vnm, p[0])->sw_if_index);
+  vec_free (name);
+
+  s = format (s, "ipsec sa del %u\n", 2 * a->table_id);
+  s = format (s, "ipsec sa del %u\n", 2 * a->table_id + 1);
+  return format (s, "%U", format_benchmark_ip4_base_teardown, a);
+}
+
+static u8 *
+format_benchmark_ipsec_stream (u8 *s, va_list *args)
+{
+  va_arg (*args, benchmark_args_t *);
+
+  return format (s, "%U", format_benchmark_ip4_udp, 1024);
+}
+
+BENCHMARK_REGISTER_SCENARIO (ipsec) = {
+  .name = "ipsec",
+  .description = "IPv4 into an ESP AES-GCM-128 protected tunnel",
+  .format_setup = format_benchmark_ipsec_setup,
+  .format_teardown = format_benchmark_ipsec_teardown,
+  .format_stream = format_benchmark_ipsec_stream,
+  .header_bytes = 42,
+};
+
+/* l2 cross connect into a VXLAN tunnel */
+
+static u8 *
+format_benchmark_vxlan_setup (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  if (a->step)
+    return s;
+
+  s = format (s, "ip table add %u\n", a->table_id);
+  s = format (s, "set interface ip table pg%u %u\n", a->tx_if_id, a->table_id);
+  s = format (s, "set interface ip address pg%u 192.168.1.1/24\n",
+	      a->tx_if_id);
+  s = format (s, "set ip neighbor pg%u 192.168.1.2 %s\n", a->tx_if_id,
+	      BENCHMARK_NEIGHBOR_MAC);
+  s = format (s,
+	      "create vxlan tunnel src 192.168.1.1 dst 192.168.1.2 vni %u "
+	      "instance %u encap-vrf-id %u\n",
+	      a->table_id, a->table_id, a->table_id);
+  s = format (s, "set interface state vxlan_tunnel%u up\n", a->table_id);
+  s = format (s, "set interface l2 xconnect pg%u vxlan_tunnel%u\n",
+	      a->rx_if_id, a->table_id);
+  s = format (s, "set interface l2 xconnect vxlan_tunnel%u pg%u\n",
+	      a->table_id, a->rx_if_id);
+  return s;
+}
+
+static u8 *
+format_benchmark_vxlan_teardown (u8 *s, va_list *args)
+{
+  benchmark_args_t *a = va_arg (*args, benchmark_args_t *);
+
+  s = format (s, "set interface l3 pg%u\n", a->rx_if_id);
+  s = format (s,
+	      "create vxlan tunnel src 192.168.1.1 dst 192.168.1.2 vni %u "
+	      "instance %u encap-vrf-id %u del\n",
+	      a->table_id, a->table_id, a->table_id);
+  s = format (s, "set ip neighbor del pg%u 192.168.1.2 %s\n", a->tx_if_id,
+	      BENCHMARK_NEIGHBOR_MAC);
+  s = format (s, "set interface ip address del pg%u 192.168.1.1/24\n",
+	      a->tx_if_id);
+  s = format (s, "set interface ip table pg%u 0\n", a->tx_if_id);
+  s = format (s, "ip table del %u\n", a->table_id);
+  return s;
+}
+
+BENCHMARK_REGISTER_SCENARIO (vxlan) = {
+  .name = "vxlan",
+  .description = "L2 cross connect into a VXLAN tunnel",
+  .format_setup = format_benchmark_vxlan_setup,
+  .format_teardown = format_benchmark_vxlan_teardown,
+  .format_stream = format_benchmark_l2_xconnect_stream,
+  .header_bytes = 42,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,395 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/plugin/plugin.h>
+#include <vnet/crypto/crypto.h>
+#include <crypto_native/crypto_native.h>
+#include <crypto_native/aes.h>
+#include <crypto_native/poly1305.h>
+
+#if __GNUC__ > 4  && !__clang__ && CLIB_DEBUG == 0
+#pragma GCC optimize ("O3")
+#endif
+
+/*
+ * Multi-buffer ChaCha20-Poly1305 (RFC 8439).
+ *
+ * Each vector lane runs the ChaCha20 block function for a different
+ * op, so one call of chacha20_blocks() produces the next keystream
+ * block of up to CHACHA20_N_LANES packets. Lanes are refilled with new
+ * ops as soon as they finish, so short and long packets can be mixed.
+ * Poly1305 runs per lane on the scalar side, interleaved with the
+ * vector work.
+ */
+
+#if defined(CLIB_HAVE_VEC512)
+#define CHACHA20_N_LANES 16
+typedef u32x16 chacha20_vec_t;
+typedef u32x16u chacha20_vecu_t;
+#elif defined(CLIB_HAVE_VEC256)
+#define CHACHA20_N_LANES 8
+typedef u32x8 chacha20_vec_t;
+typedef u32x8u chacha20_vecu_t;
+#else
+#define CHACHA20_N_LANES 4
+typedef u32x4 chacha20_vec_t;
+typedef u32x4u chacha20_vecu_t;
+#endif
+
+#define CHACHA20_BLOCK_SIZE 64
+
+typedef struct
+{
+  u32 key[8];
+} chacha20_poly1305_key_data_t;
+
+/* state word i of all lanes is contiguous, so it loads as one vector */
+typedef struct
+{
+  u32 key[8][CHACHA20_N_LANES];
+  u32 nonce[3][CHACHA20_N_LANES];
+  u32 counter[CHACHA20_N_LANES];
+  u32 ks[16][CHACHA20_N_LANES];
+} chacha20_lanes_t;
+
+typedef struct
+{
+  vnet_crypto_op_t *op;
+  vnet_crypto_op_chunk_t *chunk; /* next chunk to process */
+  u8 *src, *dst;
+  u32 n_left; /* bytes left in current chunk */
+  u32 n_chunks_left;
+  u32 n_bytes;
+  poly1305_ctx_t poly;
+} chacha20_poly1305_lane_t;
+
+static_always_inline chacha20_vec_t
+chacha20_rotl (chacha20_vec_t v, int n)
+{
+  return (v << n) | (v >> (32 - n));
+}
+
+#define CHACHA20_QR(a, b, c, d)                                               \
+  do                                                                          \
+    {                                                                         \
+      x[a] += x[b];                                                           \
+      x[d] = chacha20_rotl (x[d] ^ x[a], 16);                                 \
+      x[c] += x[d];                                                           \
+      x[b] = chacha20_rotl (x[b] ^ x[c], 12);                                 \
+      x[a] += x[b];                                                           \
+      x[d] = chacha20_rotl (x[d] ^ x[a], 8);                                  \
+      x[c] += x[d];                                                           \
+      x[b] = chacha20_rotl (x[b] ^ x[c], 7);                                  \
+    }                                                                         \
+  while (0)
+
+static_always_inline void
+chacha20_blocks (chacha20_lanes_t *l)
+{
+  chacha20_vec_t s[16], x[16];
+  int i;
+
+  s[0] = (chacha20_vec_t){} + 0x61707865;
+  s[1] = (chacha20_vec_t){} + 0x3320646e;
+  s[2] = (chacha20_vec_t){} + 0x79622d32;
+  s[3] = (chacha20_vec_t){} + 0x6b206574;
+  for (i = 0; i < 8; i++)
+    s[4 + i] = *(chacha20_vecu_t *) l->key[i];
+  s[12] = *(chacha20_vecu_t *) l->counter;
+  for (i = 0; i < 3; i++)
+    s[13 + i] = *(chacha20_vecu_t *) l->nonce[i];
+
+  for (i = 0; i < 16; i++)
+    x[i] = s[i];
+
+  for (i = 0; i < 10; i++)
+    {
+      CHACHA20_QR (0, 4, 8, 12);
+      CHACHA20_QR (1, 5, 9, 13);
+      CHACHA20_QR (2, 6, 10, 14);
+      CHACHA20_QR (3, 7, 11, 15);
+      CHACHA20_QR (0, 5, 10, 15);
+      CHACHA20_QR (1, 6, 11, 12);
+      CHACHA20_QR (2, 7, 8, 13);
+      CHACHA20_QR (3, 4, 9, 14);
+    }
+
+  for (i = 0; i < 16; i++)
+    *(chacha20_vecu_t *) l->ks[i] = x[i] + s[i];
+}
+
+static_always_inline void
+chacha20_xor (u8 *dst, u8 *src, u8 *ks, u32 len)
+{
+  u32 i = 0;
+
+  for (; i + 16 <= len; i += 16)
+    *(u8x16u *) (dst + i) = *(u8x16u *) (src + i) ^ *(u8x16u *) (ks + i);
+  for (; i < len; i++)
+    dst[i] = src[i] ^ ks[i];
+}
+
+static_always_inline void
+chacha20_poly1305_lane_init (chacha20_lanes_t *l,
+			     chacha20_poly1305_lane_t *ln, u32 lane,
+			     vnet_crypto_op_t *op,
+			     vnet_crypto_op_chunk_t *chunks, int is_enc,
+			     int is_chained)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+  chacha20_poly1305_key_data_t *kd = cm->key_data[op->key_index];
+  int i;
+
+  if (is_enc && (op->flags & VNET_CRYPTO_OP_FLAG_INIT_IV))
+    {
+      crypto_native_per_thread_data_t *ptd =
+	vec_elt_at_index (cm->per_thread_data, vlib_get_thread_index ());
+      u8x16 t = ptd->cbc_iv[lane];
+      clib_memcpy_fast (op->iv, &t, 8);
+      ptd->cbc_iv[lane] = aes_enc_round (t, t);
+    }
+
+  for (i = 0; i < 8; i++)
+    l->key[i][lane] = kd->key[i];
+  for (i = 0; i < 3; i++)
+    l->nonce[i][lane] = clib_mem_unaligned (op->iv + 4 * i, u32);
+  l->counter[lane] = 0;
+
+  ln->op = op;
+  if (is_chained)
+    {
+      ln->chunk = chunks + op->chunk_index;
+      ln->n_chunks_left = op->n_chunks;
+      ln->n_left = 0;
+      ln->n_bytes = 0;
+      for (i = 0; i < op->n_chunks; i++)
+	ln->n_bytes += ln->chunk[i].len;
+    }
+  else
+    {
+      ln->src = op->src;
+      ln->dst = op->dst;
+      ln->n_left = ln->n_bytes = op->len;
+      ln->n_chunks_left = 0;
+    }
+}
+
+static_always_inline int
+chacha20_poly1305_lane_is_done (chacha20_poly1305_lane_t *ln)
+{
+  return ln->n_left == 0 && ln->n_chunks_left == 0;
+}
+
+/* encrypt or decrypt up to one keystream block worth of payload */
+static_always_inline void
+chacha20_poly1305_lane_data (chacha20_poly1305_lane_t *ln, u8 *ks,
+			     int is_enc)
+{
+  u32 n = CHACHA20_BLOCK_SIZE, len;
+
+  while (n)
+    {
+      if (ln->n_left == 0)
+	{
+	  if (ln->n_chunks_left == 0)
+	    return;
+	  ln->src = ln->chunk->src;
+	  ln->dst = ln->chunk->dst;
+	  ln->n_left = ln->chunk->len;
+	  ln->chunk++;
+	  ln->n_chunks_left--;
+	  continue;
+	}
+
+      len = clib_min (n, ln->n_left);
+
+      /* authenticate ciphertext, before it is overwritten when in-place */
+      if (!is_enc)
+	poly1305_update (&ln->poly, ln->src, len);
+      chacha20_xor (ln->dst, ln->src, ks, len);
+      if (is_enc)
+	poly1305_update (&ln->poly, ln->dst, len);
+
+      ln->src += len;
+      ln->dst += len;
+      ln->n_left -= len;
+      ks += len;
+      n -= len;
+    }
+}
+
+static_always_inline int
+chacha20_poly1305_lane_final (chacha20_poly1305_lane_t *ln, int is_enc)
+{
+  vnet_crypto_op_t *op = ln->op;
+  u64 lengths[2] = { op->aad_len, ln->n_bytes };
+  u8 tag[16], diff = 0;
+  int i;
+
+  poly1305_pad16 (&ln->poly);
+  poly1305_update (&ln->poly, (u8 *) lengths, sizeof (lengths));
+  poly1305_final (&ln->poly, tag);
+
+  if (is_enc)
+    {
+      clib_memcpy_fast (op->tag, tag, clib_min (op->tag_len, 16));
+      op->status = VNET_CRYPTO_OP_STATUS_COMPLETED;
+      return 1;
+    }
+
+  for (i = 0; i < clib_min (op->tag_len, 16); i++)
+    diff |= tag[i] ^ op->tag[i];
+
+  if (diff)
+    {
+      op->status = VNET_CRYPTO_OP_STATUS_FAIL_BAD_HMAC;
+      return 0;
+    }
+
+  op->status = VNET_CRYPTO_OP_STATUS_COMPLETED;
+  return 1;
+}
+
+static_always_inline u32
+chacha20_poly1305_ops (vnet_crypto_op_t *ops[], vnet_crypto_op_chunk_t *chunks,
+		       u32 n_ops, int is_enc, int is_chained)
+{
+  chacha20_lanes_t lanes = {};
+  chacha20_poly1305_lane_t ln[CHACHA20_N_LANES];
+  u32 next = 0, n_fail = 0, i, w;
+  uword active = 0;
+
+  for (i = 0; i < CHACHA20_N_LANES && next < n_ops; i++)
+    {
+      chacha20_poly1305_lane_init (&lanes, ln + i, i, ops[next++], chunks,
+				   is_enc, is_chained);
+      active |= (uword) 1 << i;
+    }
+
+  while (active)
+    {
+      chacha20_blocks (&lanes);
+
+      foreach_set_bit_index (i, active)
+	{
+	  u32 ks[16] = {};
+
+	  for (w = 0; w < 16; w++)
+	    ks[w] = lanes.ks[w][i];
+
+	  if (lanes.counter[i]++ == 0)
+	    {
+	      /* block 0 keys the authenticator, payload starts at block 1 */
+	      poly1305_init (&ln[i].poly, (u8 *) ks);
+	      poly1305_update (&ln[i].poly, ln[i].op->aad, ln[i].op->aad_len);
+	      poly1305_pad16 (&ln[i].poly);
+	    }
+	  else
+	    chacha20_poly1305_lane_data (ln + i, (u8 *) ks, is_enc);
+
+	  if (!chacha20_poly1305_lane_is_done (ln + i))
+	    continue;
+
+	  if (!chacha20_poly1305_lane_final (ln + i, is_enc))
+	    n_fail++;
+
+	  if (next < n_ops)
+	    chacha20_poly1305_lane_init (&lanes, ln + i, i, ops[next++],
+					 chunks, is_enc, is_chained);
+	  else
+	    active &= ~((uword) 1 << i);
+	}
+    }
+
+  return n_ops - n_fail;
+}
+
+static u32
+chacha20_poly1305_ops_enc (vlib_main_t *vm, vnet_crypto_op_t *ops[],
+			   u32 n_ops)
+{
+  return chacha20_poly1305_ops (ops, 0, n_ops, /* is_enc */ 1,
+				/* is_chained */ 0);
+}
+
+static u32
+chacha20_poly1305_ops_dec (vlib_main_t *vm, vnet_crypto_op_t *ops[],
+			   u32 n_ops)
+{
+  return chacha20_poly1305_ops (ops, 0, n_ops, /* is_enc */ 0,
+				/* is_chained */ 0);
+}
+
+static u32
+chacha20_poly1305_chained_ops_enc (vlib_main_t *vm, vnet_crypto_op_t *ops[],
+				   vnet_crypto_op_chunk_t *chunks, u32 n_ops)
+{
+  return chacha20_poly1305_ops (ops, chunks, n_ops, /* is_enc */ 1,
+				/* is_chained */ 1);
+}
+
+static u32
+chacha20_poly1305_chained_ops_dec (vlib_main_t *vm, vnet_crypto_op_t *ops[],
+				   vnet_crypto_op_chunk_t *chunks, u32 n_ops)
+{
+  return chacha20_poly1305_ops (ops, chunks, n_ops, /* is_enc */ 0,
+				/* is_chained */ 1);
+}
+
+static void *
+chacha20_poly1305_key_exp (vnet_crypto_key_t *key)
+{
+  chacha20_poly1305_key_data_t *kd;
+
+  kd = clib_mem_alloc_aligned (sizeof (*kd), CLIB_CACHE_LINE_BYTES);
+  clib_memcpy_fast (kd->key, key->data, sizeof (kd->key));
+  return kd;
+}
+
+clib_error_t *
+#ifdef __VAES__
+crypto_native_chacha20_poly1305_init_icl (vlib_main_t *vm)
+#elif __AVX512F__
+crypto_native_chacha20_poly1305_init_skx (vlib_main_t *vm)
+#elif __AVX2__
+crypto_native_chacha20_poly1305_init_hsw (vlib_main_t *vm)
+#elif __aarch64__
+crypto_native_chacha20_poly1305_init_neon (vlib_main_t *vm)
+#else
+crypto_native_chacha20_poly1305_init_slm (vlib_main_t *vm)
+#endif
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+
+  vnet_crypto_register_ops_handlers (
+    vm, cm->crypto_engine_index, VNET_CRYPTO_OP_CHACHA20_POLY1305_ENC,
+    chacha20_poly1305_ops_enc, chacha20_poly1305_chained_ops_enc);
+  vnet_crypto_register_ops_handlers (
+    vm, cm->crypto_engine_index, VNET_CRYPTO_OP_CHACHA20_POLY1305_DEC,
+    chacha20_poly1305_ops_dec, chacha20_poly1305_chained_ops_dec);
+  cm->key_fn[VNET_CRYPTO_ALG_CHACHA20_POLY1305] = chacha20_poly1305_key_exp;
+  return 0;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
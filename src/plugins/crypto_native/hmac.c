@@ -0,0 +1,824 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/plugin/plugin.h>
+#include <vnet/crypto/crypto.h>
+#include <vppinfra/sha2.h>
+#include <crypto_native/crypto_native.h>
+
+#if __GNUC__ > 4  && !__clang__ && CLIB_DEBUG == 0
+#pragma GCC optimize ("O3")
+#endif
+
+/*
+ * Multi-buffer HMAC-SHA1 / SHA-224 / SHA-256 / SHA-384 / SHA-512.
+ *
+ * Each vector lane runs the compression function over a block of a
+ * different op, so one call of hmac_blocks() advances up to
+ * HMAC_N_LANES (SHA-1, SHA-224, SHA-256) or HMAC_N_LANES / 2 (SHA-384,
+ * SHA-512) messages by one block. Lanes are refilled with new ops as
+ * soon as they finish. The inner and outer pad states are computed once
+ * per key, so a packet costs its own blocks plus one outer block.
+ *
+ * With SHA extensions, short batches of SHA-224 / SHA-256 ops are
+ * hashed one at a time, as there are not enough ops to fill the lanes.
+ */
+
+#if defined(CLIB_HAVE_VEC512)
+#define HMAC_N_LANES 16
+typedef u32x16 hmac_u32xn_t;
+typedef u64x8 hmac_u64xn_t;
+#elif defined(CLIB_HAVE_VEC256)
+#define HMAC_N_LANES 8
+typedef u32x8 hmac_u32xn_t;
+typedef u64x4 hmac_u64xn_t;
+#else
+#define HMAC_N_LANES 4
+typedef u32x4 hmac_u32xn_t;
+typedef u64x2 hmac_u64xn_t;
+#endif
+
+#define HMAC_SHANI_MAX_OPS (HMAC_N_LANES / 4)
+
+typedef enum
+{
+  HMAC_SHA1,
+  HMAC_SHA224,
+  HMAC_SHA256,
+  HMAC_SHA384,
+  HMAC_SHA512,
+} hmac_type_t;
+
+#define SHA1_DIGEST_SIZE 20
+
+static const u32 sha1_h[5] = { 0x67452301, 0xefcdab89, 0x98badcfe,
+			       0x10325476, 0xc3d2e1f0 };
+
+typedef struct
+{
+  union
+  {
+    u32 h32[8];
+    u64 h64[8];
+  } ipad, opad;
+} hmac_key_data_t;
+
+/* state word i of all lanes is contiguous, so it loads as one vector */
+typedef union
+{
+  u32 h32[8][HMAC_N_LANES];
+  u64 h64[8][HMAC_N_LANES / 2];
+  hmac_u32xn_t v32[8];
+  hmac_u64xn_t v64[8];
+} hmac_lanes_t;
+
+typedef struct
+{
+  vnet_crypto_op_t *op;
+  vnet_crypto_op_chunk_t *chunk; /* next chunk to process */
+  u8 *src;
+  u32 n_left; /* bytes left in current chunk */
+  u32 n_chunks_left;
+  u32 n_bytes;
+  u8 is_outer;
+  u8 is_last;
+  u8 n_tail;
+  u8 *tail;
+  u8 buf[2 * SHA2_MAX_BLOCK_SIZE];
+} hmac_lane_t;
+
+static_always_inline u32
+hmac_block_size (hmac_type_t t)
+{
+  return t >= HMAC_SHA384 ? SHA512_BLOCK_SIZE : SHA256_BLOCK_SIZE;
+}
+
+static_always_inline u32
+hmac_digest_size (hmac_type_t t)
+{
+  switch (t)
+    {
+    case HMAC_SHA1:
+      return SHA1_DIGEST_SIZE;
+    case HMAC_SHA224:
+      return SHA224_DIGEST_SIZE;
+    case HMAC_SHA256:
+      return SHA256_DIGEST_SIZE;
+    case HMAC_SHA384:
+      return SHA384_DIGEST_SIZE;
+    default:
+      return SHA512_DIGEST_SIZE;
+    }
+}
+
+static_always_inline u32
+hmac_n_lanes (hmac_type_t t)
+{
+  return t >= HMAC_SHA384 ? HMAC_N_LANES / 2 : HMAC_N_LANES;
+}
+
+static_always_inline hmac_u32xn_t
+hmac_rotr32 (hmac_u32xn_t v, int n)
+{
+  return (v >> n) | (v << (32 - n));
+}
+
+static_always_inline hmac_u64xn_t
+hmac_rotr64 (hmac_u64xn_t v, int n)
+{
+  return (v >> n) | (v << (64 - n));
+}
+
+static_always_inline void
+hmac_load_w32 (hmac_u32xn_t w[16], u8 *blk[])
+{
+  u32 tmp[16][HMAC_N_LANES] __clib_aligned (sizeof (hmac_u32xn_t));
+
+  for (int j = 0; j < HMAC_N_LANES; j++)
+    for (int i = 0; i < 16; i++)
+      tmp[i][j] = clib_net_to_host_u32 (clib_mem_unaligned (blk[j] + 4 * i,
+							    u32));
+  for (int i = 0; i < 16; i++)
+    w[i] = *(hmac_u32xn_t *) tmp[i];
+}
+
+static_always_inline void
+hmac_load_w64 (hmac_u64xn_t w[16], u8 *blk[])
+{
+  u64 tmp[16][HMAC_N_LANES / 2] __clib_aligned (sizeof (hmac_u64xn_t));
+
+  for (int j = 0; j < HMAC_N_LANES / 2; j++)
+    for (int i = 0; i < 16; i++)
+      tmp[i][j] = clib_net_to_host_u64 (clib_mem_unaligned (blk[j] + 8 * i,
+							    u64));
+  for (int i = 0; i < 16; i++)
+    w[i] = *(hmac_u64xn_t *) tmp[i];
+}
+
+#define SHA1_MB_ROUND(a, b, c, d, e, f, k, i)                                 \
+  do                                                                          \
+    {                                                                         \
+      if ((i) >= 16)                                                          \
+	{                                                                     \
+	  hmac_u32xn_t x = w[((i) - 3) & 15] ^ w[((i) - 8) & 15] ^            \
+			   w[((i) - 14) & 15] ^ w[(i) & 15];                  \
+	  w[(i) & 15] = hmac_rotr32 (x, 31);                                  \
+	}                                                                     \
+      e += hmac_rotr32 (a, 27) + (f) + (k) + w[(i) & 15];                     \
+      b = hmac_rotr32 (b, 2);                                                 \
+    }                                                                         \
+  while (0)
+
+#define SHA1_CH(b, c, d)  (d ^ (b & (c ^ d)))
+#define SHA1_PAR(b, c, d) (b ^ c ^ d)
+#define SHA1_MAJ(b, c, d) ((b & c) | (d & (b | c)))
+
+#define SHA1_MB_5_ROUNDS(fn, k, i)                                            \
+  SHA1_MB_ROUND (a, b, c, d, e, fn (b, c, d), k, i);                          \
+  SHA1_MB_ROUND (e, a, b, c, d, fn (a, b, c), k, i + 1);                      \
+  SHA1_MB_ROUND (d, e, a, b, c, fn (e, a, b), k, i + 2);                      \
+  SHA1_MB_ROUND (c, d, e, a, b, fn (d, e, a), k, i + 3);                      \
+  SHA1_MB_ROUND (b, c, d, e, a, fn (c, d, e), k, i + 4)
+
+static_always_inline void
+sha1_mb_blocks (hmac_lanes_t *l, u8 *blk[])
+{
+  hmac_u32xn_t w[16], a, b, c, d, e;
+
+  hmac_load_w32 (w, blk);
+
+  a = l->v32[0];
+  b = l->v32[1];
+  c = l->v32[2];
+  d = l->v32[3];
+  e = l->v32[4];
+
+  for (int i = 0; i < 20; i += 5)
+    {
+      SHA1_MB_5_ROUNDS (SHA1_CH, 0x5a827999, i);
+    }
+  for (int i = 20; i < 40; i += 5)
+    {
+      SHA1_MB_5_ROUNDS (SHA1_PAR, 0x6ed9eba1, i);
+    }
+  for (int i = 40; i < 60; i += 5)
+    {
+      SHA1_MB_5_ROUNDS (SHA1_MAJ, 0x8f1bbcdc, i);
+    }
+  for (int i = 60; i < 80; i += 5)
+    {
+      SHA1_MB_5_ROUNDS (SHA1_PAR, 0xca62c1d6, i);
+    }
+
+  l->v32[0] += a;
+  l->v32[1] += b;
+  l->v32[2] += c;
+  l->v32[3] += d;
+  l->v32[4] += e;
+}
+
+#define SHA256_MB_ROUND(a, b, c, d, e, f, g, h, i)                            \
+  do                                                                          \
+    {                                                                         \
+      hmac_u32xn_t t1, t2;                                                    \
+      if ((i) >= 16)                                                          \
+	{                                                                     \
+	  hmac_u32xn_t s0, s1, w1 = w[((i) + 1) & 15], w14 = w[((i) + 14) & 15]; \
+	  s0 = hmac_rotr32 (w1, 7) ^ hmac_rotr32 (w1, 18) ^ (w1 >> 3);        \
+	  s1 = hmac_rotr32 (w14, 17) ^ hmac_rotr32 (w14, 19) ^ (w14 >> 10);   \
+	  w[(i) & 15] += s0 + w[((i) + 9) & 15] + s1;                         \
+	}                                                                     \
+      t1 = h + (hmac_rotr32 (e, 6) ^ hmac_rotr32 (e, 11) ^                    \
+		hmac_rotr32 (e, 25));                                         \
+      t1 += (g ^ (e & (f ^ g))) + sha256_k[(i)] + w[(i) & 15];                \
+      t2 = hmac_rotr32 (a, 2) ^ hmac_rotr32 (a, 13) ^ hmac_rotr32 (a, 22);    \
+      t2 += (a & b) | (c & (a | b));                                          \
+      d += t1;                                                                \
+      h = t1 + t2;                                                            \
+    }                                                                         \
+  while (0)
+
+static_always_inline void
+sha256_mb_blocks (hmac_lanes_t *l, u8 *blk[])
+{
+  hmac_u32xn_t w[16], a, b, c, d, e, f, g, h;
+
+  hmac_load_w32 (w, blk);
+
+  a = l->v32[0];
+  b = l->v32[1];
+  c = l->v32[2];
+  d = l->v32[3];
+  e = l->v32[4];
+  f = l->v32[5];
+  g = l->v32[6];
+  h = l->v32[7];
+
+  for (int i = 0; i < 64; i += 8)
+    {
+      SHA256_MB_ROUND (a, b, c, d, e, f, g, h, i);
+      SHA256_MB_ROUND (h, a, b, c, d, e, f, g, i + 1);
+      SHA256_MB_ROUND (g, h, a, b, c, d, e, f, i + 2);
+      SHA256_MB_ROUND (f, g, h, a, b, c, d, e, i + 3);
+      SHA256_MB_ROUND (e, f, g, h, a, b, c, d, i + 4);
+      SHA256_MB_ROUND (d, e, f, g, h, a, b, c, i + 5);
+      SHA256_MB_ROUND (c, d, e, f, g, h, a, b, i + 6);
+      SHA256_MB_ROUND (b, c, d, e, f, g, h, a, i + 7);
+    }
+
+  l->v32[0] += a;
+  l->v32[1] += b;
+  l->v32[2] += c;
+  l->v32[3] += d;
+  l->v32[4] += e;
+  l->v32[5] += f;
+  l->v32[6] += g;
+  l->v32[7] += h;
+}
+
+#define SHA512_MB_ROUND(a, b, c, d, e, f, g, h, i)                            \
+  do                                                                          \
+    {                                                                         \
+      hmac_u64xn_t t1, t2;                                                    \
+      if ((i) >= 16)                                                          \
+	{                                                                     \
+	  hmac_u64xn_t s0, s1, w1 = w[((i) + 1) & 15], w14 = w[((i) + 14) & 15]; \
+	  s0 = hmac_rotr64 (w1, 1) ^ hmac_rotr64 (w1, 8) ^ (w1 >> 7);         \
+	  s1 = hmac_rotr64 (w14, 19) ^ hmac_rotr64 (w14, 61) ^ (w14 >> 6);    \
+	  w[(i) & 15] += s0 + w[((i) + 9) & 15] + s1;                         \
+	}                                                                     \
+      t1 = h + (hmac_rotr64 (e, 14) ^ hmac_rotr64 (e, 18) ^                   \
+		hmac_rotr64 (e, 41));                                         \
+      t1 += (g ^ (e & (f ^ g))) + sha512_k[(i)] + w[(i) & 15];                \
+      t2 = hmac_rotr64 (a, 28) ^ hmac_rotr64 (a, 34) ^ hmac_rotr64 (a, 39);   \
+      t2 += (a & b) | (c & (a | b));                                          \
+      d += t1;                                                                \
+      h = t1 + t2;                                                            \
+    }                                                                         \
+  while (0)
+
+static_always_inline void
+sha512_mb_blocks (hmac_lanes_t *l, u8 *blk[])
+{
+  hmac_u64xn_t w[16], a, b, c, d, e, f, g, h;
+
+  hmac_load_w64 (w, blk);
+
+  a = l->v64[0];
+  b = l->v64[1];
+  c = l->v64[2];
+  d = l->v64[3];
+  e = l->v64[4];
+  f = l->v64[5];
+  g = l->v64[6];
+  h = l->v64[7];
+
+  for (int i = 0; i < 80; i += 8)
+    {
+      SHA512_MB_ROUND (a, b, c, d, e, f, g, h, i);
+      SHA512_MB_ROUND (h, a, b, c, d, e, f, g, i + 1);
+      SHA512_MB_ROUND (g, h, a, b, c, d, e, f, i + 2);
+      SHA512_MB_ROUND (f, g, h, a, b, c, d, e, i + 3);
+      SHA512_MB_ROUND (e, f, g, h, a, b, c, d, i + 4);
+      SHA512_MB_ROUND (d, e, f, g, h, a, b, c, i + 5);
+      SHA512_MB_ROUND (c, d, e, f, g, h, a, b, i + 6);
+      SHA512_MB_ROUND (b, c, d, e, f, g, h, a, i + 7);
+    }
+
+  l->v64[0] += a;
+  l->v64[1] += b;
+  l->v64[2] += c;
+  l->v64[3] += d;
+  l->v64[4] += e;
+  l->v64[5] += f;
+  l->v64[6] += g;
+  l->v64[7] += h;
+}
+
+static_always_inline void
+hmac_blocks (hmac_type_t t, hmac_lanes_t *l, u8 *blk[])
+{
+  if (t == HMAC_SHA1)
+    sha1_mb_blocks (l, blk);
+  else if (t >= HMAC_SHA384)
+    sha512_mb_blocks (l, blk);
+  else
+    sha256_mb_blocks (l, blk);
+}
+
+static_always_inline void
+hmac_lane_set_state (hmac_type_t t, hmac_lanes_t *l, int lane, void *h)
+{
+  if (t >= HMAC_SHA384)
+    for (int i = 0; i < 8; i++)
+      l->h64[i][lane] = ((u64 *) h)[i];
+  else
+    for (int i = 0; i < 8; i++)
+      l->h32[i][lane] = ((u32 *) h)[i];
+}
+
+static_always_inline void
+hmac_lane_get_digest (hmac_type_t t, hmac_lanes_t *l, int lane, u8 *digest)
+{
+  u32 ds = hmac_digest_size (t);
+
+  if (t >= HMAC_SHA384)
+    for (int i = 0; i < ds / 8; i++)
+      clib_mem_unaligned (digest + 8 * i, u64) =
+	clib_host_to_net_u64 (l->h64[i][lane]);
+  else
+    for (int i = 0; i < ds / 4; i++)
+      clib_mem_unaligned (digest + 4 * i, u32) =
+	clib_host_to_net_u32 (l->h32[i][lane]);
+}
+
+/* append padding and bit length after n_data bytes in buf, return number
+ * of blocks */
+static_always_inline u32
+hmac_pad (hmac_type_t t, u8 *buf, u32 n_data, u64 n_total)
+{
+  u32 bs = hmac_block_size (t);
+  u32 len_sz = t >= HMAC_SHA384 ? 16 : 8;
+  u32 n_blocks = n_data + 1 + len_sz > bs ? 2 : 1;
+
+  buf[n_data] = 0x80;
+  clib_memset_u8 (buf + n_data + 1, 0, n_blocks * bs - n_data - 1);
+  clib_mem_unaligned (buf + n_blocks * bs - 8, u64) =
+    clib_host_to_net_u64 (n_total * 8);
+  return n_blocks;
+}
+
+static_always_inline u8 *
+hmac_lane_tail_block (hmac_type_t t, hmac_lane_t *ln)
+{
+  u8 *p = ln->tail;
+
+  ln->tail += hmac_block_size (t);
+  ln->is_last = --ln->n_tail == 0;
+  return p;
+}
+
+static_always_inline void
+hmac_lane_next_chunk (hmac_lane_t *ln)
+{
+  while (ln->n_left == 0 && ln->n_chunks_left)
+    {
+      ln->src = ln->chunk->src;
+      ln->n_left = ln->chunk->len;
+      ln->chunk++;
+      ln->n_chunks_left--;
+    }
+}
+
+static_always_inline u8 *
+hmac_lane_next_block (hmac_type_t t, hmac_lane_t *ln)
+{
+  u32 bs = hmac_block_size (t);
+  u32 n = 0, len;
+  u8 *p;
+
+  if (ln->n_tail)
+    return hmac_lane_tail_block (t, ln);
+
+  if (PREDICT_TRUE (ln->n_left >= bs))
+    {
+      p = ln->src;
+      ln->src += bs;
+      ln->n_left -= bs;
+      ln->n_bytes += bs;
+      hmac_lane_next_chunk (ln);
+      return p;
+    }
+
+  /* short read, gather from following chunks */
+  while (n < bs && ln->n_left)
+    {
+      len = clib_min (ln->n_left, bs - n);
+      clib_memcpy_fast (ln->buf + n, ln->src, len);
+      ln->src += len;
+      ln->n_left -= len;
+      n += len;
+      hmac_lane_next_chunk (ln);
+    }
+
+  ln->n_bytes += n;
+
+  if (n == bs)
+    return ln->buf;
+
+  /* end of message, inner hash covers the ipad block too */
+  ln->n_tail = hmac_pad (t, ln->buf, n, bs + ln->n_bytes);
+  ln->tail = ln->buf;
+  return hmac_lane_tail_block (t, ln);
+}
+
+static_always_inline hmac_key_data_t *
+hmac_lane_init (hmac_lane_t *ln, vnet_crypto_op_t *op,
+		vnet_crypto_op_chunk_t *chunks, int is_chained)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+
+  ln->op = op;
+  ln->n_bytes = 0;
+  ln->is_outer = 0;
+  ln->is_last = 0;
+  ln->n_tail = 0;
+
+  if (is_chained)
+    {
+      ln->chunk = chunks + op->chunk_index;
+      ln->n_chunks_left = op->n_chunks;
+      ln->n_left = 0;
+      hmac_lane_next_chunk (ln);
+    }
+  else
+    {
+      ln->src = op->src;
+      ln->n_left = op->len;
+      ln->n_chunks_left = 0;
+    }
+
+  return (hmac_key_data_t *) cm->key_data[op->key_index];
+}
+
+/* inner hash done and its digest is in ln->buf, queue the outer block */
+static_always_inline hmac_key_data_t *
+hmac_lane_outer (hmac_type_t t, hmac_lane_t *ln)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+  u32 bs = hmac_block_size (t), ds = hmac_digest_size (t);
+
+  ln->n_tail = hmac_pad (t, ln->buf, ds, bs + ds);
+  ln->tail = ln->buf;
+  ln->is_outer = 1;
+  ln->is_last = 0;
+  return (hmac_key_data_t *) cm->key_data[ln->op->key_index];
+}
+
+static_always_inline int
+hmac_op_finish (vnet_crypto_op_t *op, u8 *digest, u32 ds)
+{
+  u32 len = op->digest_len ? clib_min (op->digest_len, ds) : ds;
+  u8 diff = 0;
+
+  if (op->flags & VNET_CRYPTO_OP_FLAG_HMAC_CHECK)
+    {
+      for (int i = 0; i < len; i++)
+	diff |= digest[i] ^ op->digest[i];
+
+      if (diff)
+	{
+	  op->status = VNET_CRYPTO_OP_STATUS_FAIL_BAD_HMAC;
+	  return 0;
+	}
+    }
+  else
+    clib_memcpy_fast (op->digest, digest, len);
+
+  op->status = VNET_CRYPTO_OP_STATUS_COMPLETED;
+  return 1;
+}
+
+static_always_inline u32
+hmac_mb_ops (hmac_type_t t, vnet_crypto_op_t *ops[],
+	     vnet_crypto_op_chunk_t *chunks, u32 n_ops, int is_chained)
+{
+  u8 zero_block[SHA2_MAX_BLOCK_SIZE] = {};
+  u8 digest[SHA2_MAX_DIGEST_SIZE];
+  hmac_lanes_t lanes;
+  hmac_lane_t ln[HMAC_N_LANES];
+  hmac_key_data_t *kd;
+  u8 *blk[HMAC_N_LANES];
+  u32 n_lanes = hmac_n_lanes (t);
+  u32 next = 0, n_fail = 0, i;
+  uword active = 0;
+
+  for (i = 0; i < HMAC_N_LANES; i++)
+    blk[i] = zero_block;
+
+  for (i = 0; i < n_lanes && next < n_ops; i++)
+    {
+      kd = hmac_lane_init (ln + i, ops[next++], chunks, is_chained);
+      hmac_lane_set_state (t, &lanes, i, &kd->ipad);
+      active |= (uword) 1 << i;
+    }
+
+  while (active)
+    {
+      foreach_set_bit_index (i, active)
+	blk[i] = hmac_lane_next_block (t, ln + i);
+
+      hmac_blocks (t, &lanes, blk);
+
+      foreach_set_bit_index (i, active)
+	{
+	  if (!ln[i].is_last)
+	    continue;
+
+	  if (!ln[i].is_outer)
+	    {
+	      hmac_lane_get_digest (t, &lanes, i, ln[i].buf);
+	      kd = hmac_lane_outer (t, ln + i);
+	      hmac_lane_set_state (t, &lanes, i, &kd->opad);
+	      continue;
+	    }
+
+	  hmac_lane_get_digest (t, &lanes, i, digest);
+	  if (!hmac_op_finish (ln[i].op, digest, hmac_digest_size (t)))
+	    n_fail++;
+
+	  if (next < n_ops)
+	    {
+	      kd = hmac_lane_init (ln + i, ops[next++], chunks, is_chained);
+	      hmac_lane_set_state (t, &lanes, i, &kd->ipad);
+	    }
+	  else
+	    {
+	      active &= ~((uword) 1 << i);
+	      blk[i] = zero_block;
+	    }
+	}
+    }
+
+  return n_ops - n_fail;
+}
+
+#if defined(__SHA__) && defined(__AVX2__)
+/* SHA instructions have no VEX encoding, so clear the upper halves of the
+ * vector registers first to avoid the SSE / AVX transition penalty */
+static_always_inline void
+hmac_shani_blocks (clib_sha2_ctx_t *ctx, u8 *msg, u32 n_blocks)
+{
+  _mm256_zeroupper ();
+  clib_sha256_block (ctx, msg, n_blocks);
+}
+
+static_always_inline u32
+hmac_shani_ops (hmac_type_t t, vnet_crypto_op_t *ops[],
+		vnet_crypto_op_chunk_t *chunks, u32 n_ops, int is_chained)
+{
+  u32 ds = hmac_digest_size (t), n_fail = 0;
+  clib_sha2_ctx_t ctx;
+  hmac_key_data_t *kd;
+  hmac_lane_t ln;
+
+  for (int i = 0; i < n_ops; i++)
+    {
+      kd = hmac_lane_init (&ln, ops[i], chunks, is_chained);
+      clib_memcpy_fast (ctx.h32, kd->ipad.h32, sizeof (ctx.h32));
+
+      while (1)
+	{
+	  /* whole blocks in the current chunk go in one call */
+	  if (ln.n_tail == 0 && ln.n_left >= 2 * SHA256_BLOCK_SIZE)
+	    {
+	      u32 n_blocks = ln.n_left / SHA256_BLOCK_SIZE - 1;
+	      hmac_shani_blocks (&ctx, ln.src, n_blocks);
+	      ln.src += n_blocks * SHA256_BLOCK_SIZE;
+	      ln.n_left -= n_blocks * SHA256_BLOCK_SIZE;
+	      ln.n_bytes += n_blocks * SHA256_BLOCK_SIZE;
+	    }
+
+	  hmac_shani_blocks (&ctx, hmac_lane_next_block (t, &ln), 1);
+
+	  if (!ln.is_last)
+	    continue;
+
+	  for (int j = 0; j < ds / 4; j++)
+	    clib_mem_unaligned (ln.buf + 4 * j, u32) =
+	      clib_host_to_net_u32 (ctx.h32[j]);
+
+	  if (ln.is_outer)
+	    break;
+
+	  kd = hmac_lane_outer (t, &ln);
+	  clib_memcpy_fast (ctx.h32, kd->opad.h32, sizeof (ctx.h32));
+	}
+
+      if (!hmac_op_finish (ops[i], ln.buf, ds))
+	n_fail++;
+    }
+
+  return n_ops - n_fail;
+}
+#endif
+
+static_always_inline u32
+hmac_ops (hmac_type_t t, vnet_crypto_op_t *ops[],
+	  vnet_crypto_op_chunk_t *chunks, u32 n_ops, int is_chained)
+{
+#if defined(__SHA__) && defined(__AVX2__)
+  if ((t == HMAC_SHA224 || t == HMAC_SHA256) && n_ops <= HMAC_SHANI_MAX_OPS)
+    return hmac_shani_ops (t, ops, chunks, n_ops, is_chained);
+#endif
+  return hmac_mb_ops (t, ops, chunks, n_ops, is_chained);
+}
+
+/* hash a single message for key setup, starting from state h; if digest
+ * is not set the message is whole blocks and state is written back to h */
+static void
+hmac_hash_one (hmac_type_t t, void *h, u8 *msg, u32 len, u8 *digest)
+{
+  u8 buf[2 * SHA2_MAX_BLOCK_SIZE], *blk[HMAC_N_LANES];
+  u32 bs = hmac_block_size (t), n_total = len, n_blocks;
+  hmac_lanes_t lanes;
+
+  for (int i = 0; i < hmac_n_lanes (t); i++)
+    hmac_lane_set_state (t, &lanes, i, h);
+
+  for (; len >= bs; msg += bs, len -= bs)
+    {
+      for (int i = 0; i < HMAC_N_LANES; i++)
+	blk[i] = msg;
+      hmac_blocks (t, &lanes, blk);
+    }
+
+  if (digest == 0)
+    {
+      ASSERT (len == 0);
+      if (t >= HMAC_SHA384)
+	for (int i = 0; i < 8; i++)
+	  ((u64 *) h)[i] = lanes.h64[i][0];
+      else
+	for (int i = 0; i < 8; i++)
+	  ((u32 *) h)[i] = lanes.h32[i][0];
+      return;
+    }
+
+  clib_memcpy_fast (buf, msg, len);
+  n_blocks = hmac_pad (t, buf, len, n_total);
+  for (int b = 0; b < n_blocks; b++)
+    {
+      for (int i = 0; i < HMAC_N_LANES; i++)
+	blk[i] = buf + b * bs;
+      hmac_blocks (t, &lanes, blk);
+    }
+  hmac_lane_get_digest (t, &lanes, 0, digest);
+}
+
+static_always_inline void *
+hmac_key_exp (vnet_crypto_key_t *key, hmac_type_t t)
+{
+  u8 block[SHA2_MAX_BLOCK_SIZE], pad[SHA2_MAX_BLOCK_SIZE];
+  u32 bs = hmac_block_size (t), key_len = vec_len (key->data);
+  hmac_key_data_t *kd;
+
+  kd = clib_mem_alloc_aligned (sizeof (*kd), CLIB_CACHE_LINE_BYTES);
+  clib_memset_u8 (kd, 0, sizeof (*kd));
+
+  switch (t)
+    {
+    case HMAC_SHA1:
+      clib_memcpy_fast (kd->ipad.h32, sha1_h, sizeof (sha1_h));
+      break;
+    case HMAC_SHA224:
+      clib_memcpy_fast (kd->ipad.h32, sha224_h, sizeof (sha224_h));
+      break;
+    case HMAC_SHA256:
+      clib_memcpy_fast (kd->ipad.h32, sha256_h, sizeof (sha256_h));
+      break;
+    case HMAC_SHA384:
+      clib_memcpy_fast (kd->ipad.h64, sha384_h, sizeof (sha384_h));
+      break;
+    default:
+      clib_memcpy_fast (kd->ipad.h64, sha512_h, sizeof (sha512_h));
+      break;
+    }
+  kd->opad = kd->ipad;
+
+  clib_memset_u8 (block, 0, bs);
+  if (key_len > bs)
+    hmac_hash_one (t, &kd->ipad, key->data, key_len, block);
+  else
+    clib_memcpy_fast (block, key->data, clib_min (key_len, bs));
+
+  for (int i = 0; i < bs; i++)
+    pad[i] = block[i] ^ 0x36;
+  hmac_hash_one (t, &kd->ipad, pad, bs, 0);
+
+  for (int i = 0; i < bs; i++)
+    pad[i] = block[i] ^ 0x5c;
+  hmac_hash_one (t, &kd->opad, pad, bs, 0);
+
+  return kd;
+}
+
+#define foreach_hmac_type                                                     \
+  _ (SHA1, sha1)                                                              \
+  _ (SHA224, sha224)                                                          \
+  _ (SHA256, sha256)                                                          \
+  _ (SHA384, sha384)                                                          \
+  _ (SHA512, sha512)
+
+#define _(b, s)                                                               \
+  static u32 hmac_##s##_ops (vlib_main_t *vm, vnet_crypto_op_t *ops[],        \
+			     u32 n_ops)                                       \
+  {                                                                           \
+    return hmac_ops (HMAC_##b, ops, 0, n_ops, /* is_chained */ 0);            \
+  }                                                                           \
+                                                                              \
+  static u32 hmac_##s##_chained_ops (vlib_main_t *vm,                         \
+				     vnet_crypto_op_t *ops[],                 \
+				     vnet_crypto_op_chunk_t *chunks,          \
+				     u32 n_ops)                               \
+  {                                                                           \
+    return hmac_ops (HMAC_##b, ops, chunks, n_ops, /* is_chained */ 1);       \
+  }                                                                           \
+                                                                              \
+  static void *hmac_##s##_key_exp (vnet_crypto_key_t *key)                    \
+  {                                                                           \
+    return hmac_key_exp (key, HMAC_##b);                                      \
+  }
+
+foreach_hmac_type;
+#undef _
+
+clib_error_t *
+#ifdef __VAES__
+crypto_native_hmac_init_icl (vlib_main_t *vm)
+#elif __AVX512F__
+crypto_native_hmac_init_skx (vlib_main_t *vm)
+#elif __AVX2__
+crypto_native_hmac_init_hsw (vlib_main_t *vm)
+#elif __aarch64__
+crypto_native_hmac_init_neon (vlib_main_t *vm)
+#else
+crypto_native_hmac_init_slm (vlib_main_t *vm)
+#endif
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+
+#define _(b, s)                                                               \
+  vnet_crypto_register_ops_handlers (vm, cm->crypto_engine_index,             \
+				     VNET_CRYPTO_OP_##b##_HMAC,               \
+				     hmac_##s##_ops, hmac_##s##_chained_ops); \
+  cm->key_fn[VNET_CRYPTO_ALG_HMAC_##b] = hmac_##s##_key_exp;
+
+  foreach_hmac_type;
+#undef _
+
+  return 0;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
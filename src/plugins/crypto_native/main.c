@@ -59,6 +59,63 @@ crypto_native_key_handler (vlib_main_t * vm, vnet_crypto_key_op_t kop,
   cm->key_data[idx] = cm->key_fn[key->alg] (key);
 }
 
+/* ops per batch, so the ciphertext is still in L1 when it is hashed */
+#define CRYPTO_NATIVE_LINKED_BATCH 16
+
+static u32
+crypto_native_linked_ops (vlib_main_t *vm, vnet_crypto_op_t *crypto_ops[],
+			  vnet_crypto_op_t *integ_ops[], u32 n_ops)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+  vnet_crypto_engine_t *e;
+  vnet_crypto_ops_handler_t *crypto_fn, *integ_fn;
+  u32 rv = 0, n, i;
+
+  e = vec_elt_at_index (crypto_main.engines, cm->crypto_engine_index);
+  crypto_fn = e->ops_handlers[crypto_ops[0]->op];
+  integ_fn = e->ops_handlers[integ_ops[0]->op];
+
+  for (; n_ops; n_ops -= n, crypto_ops += n, integ_ops += n)
+    {
+      n = clib_min (n_ops, CRYPTO_NATIVE_LINKED_BATCH);
+      crypto_fn (vm, crypto_ops, n);
+      integ_fn (vm, integ_ops, n);
+
+      for (i = 0; i < n; i++)
+	rv +=
+	  crypto_ops[i]->status == VNET_CRYPTO_OP_STATUS_COMPLETED &&
+	  integ_ops[i]->status == VNET_CRYPTO_OP_STATUS_COMPLETED;
+    }
+
+  return rv;
+}
+
+static void
+crypto_native_register_linked_ops (vlib_main_t *vm)
+{
+  crypto_native_main_t *cm = &crypto_native_main;
+  vnet_crypto_op_id_t crypto_ops[] = {
+    VNET_CRYPTO_OP_AES_128_CBC_ENC,
+    VNET_CRYPTO_OP_AES_192_CBC_ENC,
+    VNET_CRYPTO_OP_AES_256_CBC_ENC,
+  };
+  vnet_crypto_op_id_t integ_ops[] = {
+    VNET_CRYPTO_OP_SHA1_HMAC,	VNET_CRYPTO_OP_SHA224_HMAC,
+    VNET_CRYPTO_OP_SHA256_HMAC, VNET_CRYPTO_OP_SHA384_HMAC,
+    VNET_CRYPTO_OP_SHA512_HMAC,
+  };
+  vnet_crypto_engine_t *e;
+
+  e = vec_elt_at_index (crypto_main.engines, cm->crypto_engine_index);
+
+  for (int i = 0; i < ARRAY_LEN (crypto_ops); i++)
+    for (int j = 0; j < ARRAY_LEN (integ_ops); j++)
+      if (e->ops_handlers[crypto_ops[i]] && e->ops_handlers[integ_ops[j]])
+	vnet_crypto_register_linked_ops_handler (vm, cm->crypto_engine_index,
+						 crypto_ops[i], integ_ops[j],
+						 crypto_native_linked_ops);
+}
+
 clib_error_t *
 crypto_native_init (vlib_main_t * vm)
 {
@@ -126,6 +183,54 @@ crypto_native_init (vlib_main_t * vm)
     goto error;
 #endif
 
+  if (0);
+#if __x86_64__
+  else if (crypto_native_chacha20_poly1305_init_icl &&
+	   clib_cpu_supports_vaes ())
+    error = crypto_native_chacha20_poly1305_init_icl (vm);
+  else if (crypto_native_chacha20_poly1305_init_skx &&
+	   clib_cpu_supports_avx512f ())
+    error = crypto_native_chacha20_poly1305_init_skx (vm);
+  else if (crypto_native_chacha20_poly1305_init_hsw &&
+	   clib_cpu_supports_avx2 ())
+    error = crypto_native_chacha20_poly1305_init_hsw (vm);
+  else if (crypto_native_chacha20_poly1305_init_slm)
+    error = crypto_native_chacha20_poly1305_init_slm (vm);
+#endif
+#if __aarch64__
+  else if (crypto_native_chacha20_poly1305_init_neon)
+    error = crypto_native_chacha20_poly1305_init_neon (vm);
+#endif
+  else
+    error = clib_error_return (0, "No ChaCha20-Poly1305 implemenation "
+				  "available");
+
+  if (error)
+    goto error;
+
+  if (0);
+#if __x86_64__
+  else if (crypto_native_hmac_init_icl && clib_cpu_supports_vaes ())
+    error = crypto_native_hmac_init_icl (vm);
+  else if (crypto_native_hmac_init_skx && clib_cpu_supports_avx512f ())
+    error = crypto_native_hmac_init_skx (vm);
+  else if (crypto_native_hmac_init_hsw && clib_cpu_supports_avx2 ())
+    error = crypto_native_hmac_init_hsw (vm);
+  else if (crypto_native_hmac_init_slm)
+    error = crypto_native_hmac_init_slm (vm);
+#endif
+#if __aarch64__
+  else if (crypto_native_hmac_init_neon)
+    error = crypto_native_hmac_init_neon (vm);
+#endif
+  else
+    error = clib_error_return (0, "No HMAC implementation available");
+
+  if (error)
+    goto error;
+
+  crypto_native_register_linked_ops (vm);
+
   vnet_crypto_register_key_handler (vm, cm->crypto_engine_index,
 				    crypto_native_key_handler);
 
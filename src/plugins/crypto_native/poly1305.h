@@ -0,0 +1,216 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#ifndef __crypto_native_poly1305_h__
+#define __crypto_native_poly1305_h__
+
+/*
+ * Poly1305 one-time authenticator (RFC 8439), 64-bit implementation
+ * with 3 limbs of 44, 44 and 42 bits, based on poly1305-donna by
+ * Andrew Moon.
+ */
+
+#define POLY1305_MASK44 0xfffffffffffULL
+#define POLY1305_MASK42 0x3ffffffffffULL
+
+typedef struct
+{
+  u64 r[3];
+  u64 h[3];
+  u64 pad[2];
+  u8 buf[16];
+  u32 n_buf;
+} poly1305_ctx_t;
+
+static_always_inline void
+poly1305_init (poly1305_ctx_t *ctx, const u8 *key)
+{
+  u64 t0 = clib_mem_unaligned (key, u64);
+  u64 t1 = clib_mem_unaligned (key + 8, u64);
+
+  /* clamp r */
+  ctx->r[0] = t0 & 0xffc0fffffffULL;
+  ctx->r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffffULL;
+  ctx->r[2] = (t1 >> 24) & 0x00ffffffc0fULL;
+
+  ctx->h[0] = ctx->h[1] = ctx->h[2] = 0;
+  ctx->pad[0] = clib_mem_unaligned (key + 16, u64);
+  ctx->pad[1] = clib_mem_unaligned (key + 24, u64);
+  ctx->n_buf = 0;
+}
+
+static_always_inline void
+poly1305_blocks (poly1305_ctx_t *ctx, const u8 *m, uword n_blocks)
+{
+  const u64 hibit = 1ULL << 40;
+  u64 r0 = ctx->r[0], r1 = ctx->r[1], r2 = ctx->r[2];
+  u64 s1 = r1 * (5 << 2), s2 = r2 * (5 << 2);
+  u64 h0 = ctx->h[0], h1 = ctx->h[1], h2 = ctx->h[2];
+  u128 d0, d1, d2;
+  u64 c, t0, t1;
+
+  while (n_blocks--)
+    {
+      t0 = clib_mem_unaligned (m, u64);
+      t1 = clib_mem_unaligned (m + 8, u64);
+
+      h0 += t0 & POLY1305_MASK44;
+      h1 += ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+      h2 += ((t1 >> 24) & POLY1305_MASK42) | hibit;
+
+      d0 = (u128) h0 * r0 + (u128) h1 * s2 + (u128) h2 * s1;
+      d1 = (u128) h0 * r1 + (u128) h1 * r0 + (u128) h2 * s2;
+      d2 = (u128) h0 * r2 + (u128) h1 * r1 + (u128) h2 * r0;
+
+      c = (u64) (d0 >> 44);
+      h0 = (u64) d0 & POLY1305_MASK44;
+      d1 += c;
+      c = (u64) (d1 >> 44);
+      h1 = (u64) d1 & POLY1305_MASK44;
+      d2 += c;
+      c = (u64) (d2 >> 42);
+      h2 = (u64) d2 & POLY1305_MASK42;
+      h0 += c * 5;
+      c = h0 >> 44;
+      h0 &= POLY1305_MASK44;
+      h1 += c;
+
+      m += 16;
+    }
+
+  ctx->h[0] = h0;
+  ctx->h[1] = h1;
+  ctx->h[2] = h2;
+}
+
+static_always_inline void
+poly1305_update (poly1305_ctx_t *ctx, const u8 *m, uword len)
+{
+  uword n;
+
+  if (PREDICT_FALSE (ctx->n_buf))
+    {
+      n = clib_min (len, 16 - ctx->n_buf);
+      clib_memcpy_fast (ctx->buf + ctx->n_buf, m, n);
+      ctx->n_buf += n;
+      m += n;
+      len -= n;
+      if (ctx->n_buf < 16)
+	return;
+      poly1305_blocks (ctx, ctx->buf, 1);
+      ctx->n_buf = 0;
+    }
+
+  if (len >= 16)
+    {
+      n = len / 16;
+      poly1305_blocks (ctx, m, n);
+      m += n * 16;
+      len -= n * 16;
+    }
+
+  if (len)
+    {
+      clib_memcpy_fast (ctx->buf, m, len);
+      ctx->n_buf = len;
+    }
+}
+
+/* zero-pad buffered data to a full block, as AEAD construction requires */
+static_always_inline void
+poly1305_pad16 (poly1305_ctx_t *ctx)
+{
+  if (ctx->n_buf)
+    {
+      clib_memset_u8 (ctx->buf + ctx->n_buf, 0, 16 - ctx->n_buf);
+      poly1305_blocks (ctx, ctx->buf, 1);
+      ctx->n_buf = 0;
+    }
+}
+
+/* data must be padded to full blocks before calling this */
+static_always_inline void
+poly1305_final (poly1305_ctx_t *ctx, u8 *mac)
+{
+  u64 h0 = ctx->h[0], h1 = ctx->h[1], h2 = ctx->h[2];
+  u64 g0, g1, g2, c, t0, t1;
+
+  /* fully carry h */
+  c = h1 >> 44;
+  h1 &= POLY1305_MASK44;
+  h2 += c;
+  c = h2 >> 42;
+  h2 &= POLY1305_MASK42;
+  h0 += c * 5;
+  c = h0 >> 44;
+  h0 &= POLY1305_MASK44;
+  h1 += c;
+  c = h1 >> 44;
+  h1 &= POLY1305_MASK44;
+  h2 += c;
+  c = h2 >> 42;
+  h2 &= POLY1305_MASK42;
+  h0 += c * 5;
+  c = h0 >> 44;
+  h0 &= POLY1305_MASK44;
+  h1 += c;
+
+  /* g = h + -p */
+  g0 = h0 + 5;
+  c = g0 >> 44;
+  g0 &= POLY1305_MASK44;
+  g1 = h1 + c;
+  c = g1 >> 44;
+  g1 &= POLY1305_MASK44;
+  g2 = h2 + c - (1ULL << 42);
+
+  /* select h if h < p, or h + -p if h >= p, in constant time */
+  c = (g2 >> 63) - 1;
+  g0 &= c;
+  g1 &= c;
+  g2 &= c;
+  c = ~c;
+  h0 = (h0 & c) | g0;
+  h1 = (h1 & c) | g1;
+  h2 = (h2 & c) | g2;
+
+  /* h = h + pad */
+  t0 = ctx->pad[0];
+  t1 = ctx->pad[1];
+  h0 += t0 & POLY1305_MASK44;
+  c = h0 >> 44;
+  h0 &= POLY1305_MASK44;
+  h1 += (((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44) + c;
+  c = h1 >> 44;
+  h1 &= POLY1305_MASK44;
+  h2 += ((t1 >> 24) & POLY1305_MASK42) + c;
+  h2 &= POLY1305_MASK42;
+
+  /* mac = h % 2^128 */
+  clib_mem_unaligned (mac, u64) = h0 | (h1 << 44);
+  clib_mem_unaligned (mac + 8, u64) = (h1 >> 20) | (h2 << 24);
+}
+
+#endif /* __crypto_native_poly1305_h__ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -435,29 +435,29 @@ flowprobe_create_state_tables (u32 active_timer)
   vlib_main_t *vm = vlib_get_main ();
   clib_error_t *error = 0;
   u32 num_threads;
-  int i;
+  int i, j;
 
   /* Decide how many worker threads we have */
   num_threads = 1 /* main thread */  + tm->n_threads;
 
-  /* Hash table per worker */
-  fm->ht_log2len = FLOWPROBE_LOG2_HASHSIZE;
-
   /* Init per worker flow state and timer wheels */
   if (active_timer)
     {
       vec_validate (fm->timers_per_worker, num_threads - 1);
       vec_validate (fm->expired_passive_per_worker, num_threads - 1);
-      vec_validate (fm->hash_per_worker, num_threads - 1);
+      vec_validate (fm->buckets_per_worker, num_threads - 1);
       vec_validate (fm->pool_per_worker, num_threads - 1);
 
       for (i = 0; i < num_threads; i++)
 	{
-	  int j;
+	  u32 n_buckets = 1 << (fm->ht_log2len - FLOWPROBE_BUCKET_LOG2_SLOTS);
 	  pool_alloc (fm->pool_per_worker[i], 1 << fm->ht_log2len);
-	  vec_resize (fm->hash_per_worker[i], 1 << fm->ht_log2len);
-	  for (j = 0; j < (1 << fm->ht_log2len); j++)
-	    fm->hash_per_worker[i][j] = ~0;
+	  vec_validate_aligned (fm->buckets_per_worker[i], n_buckets - 1,
+				CLIB_CACHE_LINE_BYTES);
+	  /* Zero signatures mark the slots free */
+	  for (j = 0; j < n_buckets; j++)
+	    clib_memset_u32 (fm->buckets_per_worker[i][j].index, ~0,
+			     FLOWPROBE_BUCKET_N_SLOTS);
 	  fm->timers_per_worker[i] =
 	    clib_mem_alloc (sizeof (TWT (tw_timer_wheel)));
 	  tw_timer_wheel_init_2t_1w_2048sl (fm->timers_per_worker[i],
@@ -789,12 +789,21 @@ flowprobe_show_stats_fn (vlib_main_t * vm,
   vlib_cli_output (vm, "IPFIX table statistics");
   vlib_cli_output (vm, "Flow entry size: %d\n", sizeof (flowprobe_entry_t));
   vlib_cli_output (vm, "Flow pool size per thread: %d\n",
-		   0x1 << FLOWPROBE_LOG2_HASHSIZE);
+		   0x1 << fm->ht_log2len);
+  vlib_cli_output (vm, "Flow cache buckets per thread: %d, %d slots each\n",
+		   0x1 << (fm->ht_log2len - FLOWPROBE_BUCKET_LOG2_SLOTS),
+		   FLOWPROBE_BUCKET_N_SLOTS);
+  if (fm->packet_sample_interval > 1)
+    vlib_cli_output (vm, "Packet sampling: 1 in %u\n",
+		     fm->packet_sample_interval);
+  if (fm->flow_sample_interval > 1)
+    vlib_cli_output (vm, "Flow sampling: 1 in %u\n",
+		     fm->flow_sample_interval);
 
   for (i = 0; i < vec_len (fm->pool_per_worker); i++)
     vlib_cli_output (vm, "Pool utilisation thread %d is %d%%\n", i,
 		     (100 * pool_elts (fm->pool_per_worker[i])) /
-		     (0x1 << FLOWPROBE_LOG2_HASHSIZE));
+		     (0x1 << fm->ht_log2len));
   return 0;
 }
 
@@ -897,6 +906,9 @@ flowprobe_params_command_fn (vlib_main_t * vm,
   bool record_l2 = false, record_l3 = false, record_l4 = false;
   u32 active_timer = ~0;
   u32 passive_timer = ~0;
+  u32 packet_sample = fm->packet_sample_interval;
+  u32 flow_sample = fm->flow_sample_interval;
+  u32 cache_size = 0;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
@@ -904,6 +916,12 @@ flowprobe_params_command_fn (vlib_main_t * vm,
 	;
       else if (unformat (input, "passive %d", &passive_timer))
 	;
+      else if (unformat (input, "sample packets %u", &packet_sample))
+	;
+      else if (unformat (input, "sample flows %u", &flow_sample))
+	;
+      else if (unformat (input, "cache-size %u", &cache_size))
+	;
       else if (unformat (input, "record"))
 	while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
 	  {
@@ -924,10 +942,24 @@ flowprobe_params_command_fn (vlib_main_t * vm,
     return clib_error_return (0,
 			      "Passive timer has to be greater than active one...");
 
+  if (cache_size && (cache_size < (1 << FLOWPROBE_LOG2_HASHSIZE_MIN) ||
+		     cache_size > (1 << FLOWPROBE_LOG2_HASHSIZE_MAX)))
+    return clib_error_return (0, "cache-size must be between %u and %u",
+			      1 << FLOWPROBE_LOG2_HASHSIZE_MIN,
+			      1 << FLOWPROBE_LOG2_HASHSIZE_MAX);
+
+  if (cache_size && fm->initialized)
+    return clib_error_return (0, "Flow cache is already allocated...");
+
   if (flowprobe_params (fm, record_l2, record_l3, record_l4,
 			active_timer, passive_timer))
     return clib_error_return (0,
 			      "Couldn't change flowperpacket params when feature is enabled on some interface ...");
+
+  fm->packet_sample_interval = packet_sample;
+  fm->flow_sample_interval = flow_sample;
+  if (cache_size)
+    fm->ht_log2len = max_log2 (cache_size);
   return 0;
 }
 
@@ -943,6 +975,10 @@ flowprobe_show_params_command_fn (vlib_main_t * vm,
 
   vlib_cli_output (vm, "%U", format_flowprobe_params, flags, active_timer,
 		   passive_timer);
+  if (fm->packet_sample_interval > 1)
+    vlib_cli_output (vm, " sample packets: %u", fm->packet_sample_interval);
+  if (fm->flow_sample_interval > 1)
+    vlib_cli_output (vm, " sample flows: %u", fm->flow_sample_interval);
   return 0;
 }
 
@@ -970,7 +1006,8 @@ VLIB_CLI_COMMAND (flowprobe_enable_disable_command, static) = {
 VLIB_CLI_COMMAND (flowprobe_params_command, static) = {
     .path = "flowprobe params",
     .short_help =
-    "flowprobe params record <[l2] [l3] [l4]> [active <timer> passive <timer>]",
+    "flowprobe params record <[l2] [l3] [l4]> [active <timer> passive <timer>]"
+    " [sample packets <n>] [sample flows <n>] [cache-size <n>]",
     .function = flowprobe_params_command_fn,
 };
 
@@ -1098,6 +1135,9 @@ flowprobe_init (vlib_main_t * vm)
       vec_validate (fm->context[i].next_record_offset_per_worker,
 		    num_threads - 1);
     }
+  vec_validate (fm->packet_sample_count_per_worker, num_threads - 1);
+
+  fm->ht_log2len = FLOWPROBE_LOG2_HASHSIZE;
 
   fm->active_timer = FLOWPROBE_TIMER_ACTIVE;
   fm->passive_timer = FLOWPROBE_TIMER_PASSIVE;
@@ -32,6 +32,14 @@
 #define FLOWPROBE_TIMER_PASSIVE  120	// XXXX: FOR TESTING (30*60)
 #define FLOWPROBE_LOG2_HASHSIZE  (18)
 
+/* Flow cache bucket geometry: one cache line, 8 signatures + 8 indices */
+#define FLOWPROBE_BUCKET_LOG2_SLOTS (3)
+#define FLOWPROBE_BUCKET_N_SLOTS (1 << FLOWPROBE_BUCKET_LOG2_SLOTS)
+
+/* cache-size range: at least two buckets, at most 16M entries per thread */
+#define FLOWPROBE_LOG2_HASHSIZE_MIN (FLOWPROBE_BUCKET_LOG2_SLOTS + 1)
+#define FLOWPROBE_LOG2_HASHSIZE_MAX (24)
+
 typedef enum
 {
   FLOW_RECORD_L2 = 1 << 0,
@@ -113,6 +121,19 @@ typedef struct
   } prot;
 } flowprobe_entry_t;
 
+/*
+ * Flow cache bucket. A zero signature marks a free slot, lookups compare
+ * all signatures of a bucket at once and only touch the pool entries whose
+ * signature matches.
+ */
+typedef struct
+{
+  u32 sig[FLOWPROBE_BUCKET_N_SLOTS];
+  u32 index[FLOWPROBE_BUCKET_N_SLOTS];
+} flowprobe_bucket_t;
+
+STATIC_ASSERT_SIZEOF (flowprobe_bucket_t, 64);
+
 /**
  * @file
  * @brief flow-per-packet plugin header file
@@ -131,8 +152,8 @@ typedef struct
   f64 vlib_time_0;
 
   /** Per CPU flow-state */
-  u8 ht_log2len;		/* Hash table size is 2^log2len */
-  u32 **hash_per_worker;
+  u8 ht_log2len;		/* Flow cache size is 2^log2len entries */
+  flowprobe_bucket_t **buckets_per_worker;
   flowprobe_entry_t **pool_per_worker;
   /* *INDENT-OFF* */
   TWT (tw_timer_wheel) ** timers_per_worker;
@@ -144,6 +165,11 @@ typedef struct
   u32 passive_timer;
   flowprobe_entry_t *stateless_entry;
 
+  /** Sampling, 1-in-N packets and 1-in-N flows, 0 or 1 is off */
+  u32 packet_sample_interval;
+  u32 flow_sample_interval;
+  u32 *packet_sample_count_per_worker;
+
   bool initialized;
   bool disabled;
 
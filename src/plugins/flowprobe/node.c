@@ -105,7 +105,7 @@ vlib_node_registration_t flowprobe_l2_node;
 
 /* No counters at the moment */
 #define foreach_flowprobe_error			\
-_(COLLISION, "Hash table collisions")		\
+_(EVICTED, "Flow cache evictions")		\
 _(BUFFER, "Buffer allocation error")		\
 _(EXPORTED_PACKETS, "Exported packets")		\
 _(INPATH, "Exported packets in path")
@@ -287,7 +287,6 @@ flowprobe_l4_add (vlib_buffer_t * to_b, flowprobe_entry_t * e, u16 offset)
 static inline u32
 flowprobe_hash (flowprobe_key_t * k)
 {
-  flowprobe_main_t *fm = &flowprobe_main;
   u32 h = 0;
 
 #ifdef clib_crc32c_uses_intrinsics
@@ -301,29 +300,76 @@ flowprobe_hash (flowprobe_key_t * k)
   h = clib_xxhash (tmp);
 #endif
 
-  return h >> (32 - fm->ht_log2len);
+  return h;
+}
+
+static_always_inline flowprobe_bucket_t *
+flowprobe_get_bucket (u32 my_cpu_number, u32 h)
+{
+  flowprobe_main_t *fm = &flowprobe_main;
+  u32 log2_n_buckets = fm->ht_log2len - FLOWPROBE_BUCKET_LOG2_SLOTS;
+
+  return fm->buckets_per_worker[my_cpu_number] + (h >> (32 - log2_n_buckets));
+}
+
+/* Signature stored in the bucket, zero is reserved for free slots */
+static_always_inline u32
+flowprobe_hash_sig (u32 h)
+{
+  return h | 1;
+}
+
+/*
+ * Compare all signatures in a bucket against sig. Returns a mask with
+ * the low bit of nibble i set when slot i matches.
+ */
+static_always_inline u32
+flowprobe_bucket_match (flowprobe_bucket_t * b, u32 sig)
+{
+#if defined(CLIB_HAVE_VEC256)
+  u32x8 r = u32x8_load_unaligned (b->sig) == u32x8_splat (sig);
+  return u8x32_msb_mask ((u8x32) r) & 0x11111111;
+#elif defined(CLIB_HAVE_VEC128) && defined(CLIB_HAVE_VEC128_MSB_MASK)
+  u32x4 s = u32x4_splat (sig);
+  u32x4 r0 = u32x4_load_unaligned (b->sig) == s;
+  u32x4 r1 = u32x4_load_unaligned (b->sig + 4) == s;
+  return (u8x16_msb_mask ((u8x16) r0) |
+	  u8x16_msb_mask ((u8x16) r1) << 16) & 0x11111111;
+#else
+  u32 i, mask = 0;
+  for (i = 0; i < FLOWPROBE_BUCKET_N_SLOTS; i++)
+    if (b->sig[i] == sig)
+      mask |= 1 << (i * 4);
+  return mask;
+#endif
+}
+
+static_always_inline u32
+flowprobe_bucket_next_slot (u32 * mask)
+{
+  u32 slot = count_trailing_zeros (*mask) >> 2;
+  *mask = clear_lowest_set_bit (*mask);
+  return slot;
 }
 
 flowprobe_entry_t *
-flowprobe_lookup (u32 my_cpu_number, flowprobe_key_t * k, u32 * poolindex,
-		  bool * collision)
+flowprobe_lookup (u32 my_cpu_number, flowprobe_key_t * k, u32 h,
+		  u32 * poolindex)
 {
   flowprobe_main_t *fm = &flowprobe_main;
+  flowprobe_bucket_t *b = flowprobe_get_bucket (my_cpu_number, h);
   flowprobe_entry_t *e;
-  u32 h;
+  u32 mask;
 
-  h = (fm->active_timer) ? flowprobe_hash (k) : 0;
-
-  /* Lookup in the flow state pool */
-  *poolindex = fm->hash_per_worker[my_cpu_number][h];
-  if (*poolindex != ~0)
+  mask = flowprobe_bucket_match (b, flowprobe_hash_sig (h));
+  while (mask)
     {
-      e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number], *poolindex);
-      if (e)
+      u32 slot = flowprobe_bucket_next_slot (&mask);
+      e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number],
+			     b->index[slot]);
+      if (memcmp (k, &e->key, sizeof (flowprobe_key_t)) == 0)
 	{
-	  /* Verify key or report collision */
-	  if (memcmp (k, &e->key, sizeof (flowprobe_key_t)))
-	    *collision = true;
+	  *poolindex = b->index[slot];
 	  return e;
 	}
     }
@@ -331,29 +377,68 @@ flowprobe_lookup (u32 my_cpu_number, flowprobe_key_t * k, u32 * poolindex,
   return 0;
 }
 
+/*
+ * Take a slot for a new flow. Uses a free slot of the bucket if there is
+ * one, otherwise evicts the least recently updated flow of the bucket,
+ * exporting whatever it has accumulated, and reuses its pool entry.
+ */
 flowprobe_entry_t *
-flowprobe_create (u32 my_cpu_number, flowprobe_key_t * k, u32 * poolindex)
+flowprobe_create (vlib_main_t * vm, u32 my_cpu_number, flowprobe_key_t * k,
+		  u32 h, u32 * poolindex, bool * evicted)
 {
   flowprobe_main_t *fm = &flowprobe_main;
-  u32 h;
-
+  flowprobe_bucket_t *b = flowprobe_get_bucket (my_cpu_number, h);
   flowprobe_entry_t *e;
+  u32 mask, slot = 0;
 
-  /* Get my index */
-  h = (fm->active_timer) ? flowprobe_hash (k) : 0;
+  mask = flowprobe_bucket_match (b, 0);
+  if (PREDICT_TRUE (mask != 0))
+    {
+      slot = flowprobe_bucket_next_slot (&mask);
+      pool_get (fm->pool_per_worker[my_cpu_number], e);
+      *poolindex = e - fm->pool_per_worker[my_cpu_number];
+      clib_memset (e, 0, sizeof (*e));
+      e->key = *k;
 
-  pool_get (fm->pool_per_worker[my_cpu_number], e);
-  *poolindex = e - fm->pool_per_worker[my_cpu_number];
-  fm->hash_per_worker[my_cpu_number][h] = *poolindex;
+      if (fm->passive_timer > 0)
+	{
+	  e->passive_timer_handle = tw_timer_start_2t_1w_2048sl
+	    (fm->timers_per_worker[my_cpu_number], *poolindex, 0,
+	     fm->passive_timer);
+	}
+    }
+  else
+    {
+      flowprobe_entry_t *oldest = 0;
+      u32 i, handle;
 
-  e->key = *k;
+      for (i = 0; i < FLOWPROBE_BUCKET_N_SLOTS; i++)
+	{
+	  e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number],
+				 b->index[i]);
+	  if (oldest == 0 || e->last_updated < oldest->last_updated)
+	    {
+	      oldest = e;
+	      slot = i;
+	    }
+	}
 
-  if (fm->passive_timer > 0)
-    {
-      e->passive_timer_handle = tw_timer_start_2t_1w_2048sl
-	(fm->timers_per_worker[my_cpu_number], *poolindex, 0,
-	 fm->passive_timer);
+      /* Flush data and clean up entry for reuse, the passive timer keeps
+       * running for the pool index and now covers the new flow. */
+      e = oldest;
+      if (e->packetcount)
+	flowprobe_export_entry (vm, e);
+      *poolindex = b->index[slot];
+      handle = e->passive_timer_handle;
+      clib_memset (e, 0, sizeof (*e));
+      e->passive_timer_handle = handle;
+      e->key = *k;
+      *evicted = true;
     }
+
+  b->sig[slot] = flowprobe_hash_sig (h);
+  b->index[slot] = *poolindex;
+
   return e;
 }
 
@@ -361,7 +446,8 @@ static inline void
 add_to_flow_record_state (vlib_main_t * vm, vlib_node_runtime_t * node,
 			  flowprobe_main_t * fm, vlib_buffer_t * b,
 			  timestamp_nsec_t timestamp, u16 length,
-			  flowprobe_variant_t which, flowprobe_trace_t * t)
+			  flowprobe_variant_t which, u32 packet_weight,
+			  flowprobe_trace_t * t)
 {
   if (fm->disabled)
     return;
@@ -477,27 +563,31 @@ add_to_flow_record_state (vlib_main_t * vm, vlib_node_runtime_t * node,
 
   flowprobe_entry_t *e = 0;
   f64 now = vlib_time_now (vm);
+  u32 h = 0;
+
+  if (fm->active_timer > 0 || fm->flow_sample_interval > 1)
+    h = flowprobe_hash (&k);
+
+  /* 1-in-N flow sampling, the decision is a function of the key only so
+   * every packet of a sampled flow is accounted. */
+  if (fm->flow_sample_interval > 1 && (h % fm->flow_sample_interval) != 0)
+    return;
+
   if (fm->active_timer > 0)
     {
       u32 poolindex = ~0;
-      bool collision = false;
+      bool evicted = false;
 
-      e = flowprobe_lookup (my_cpu_number, &k, &poolindex, &collision);
-      if (collision)
-	{
-	  /* Flush data and clean up entry for reuse. */
-	  if (e->packetcount)
-	    flowprobe_export_entry (vm, e);
-	  e->key = k;
-	  e->flow_start = timestamp;
-	  vlib_node_increment_counter (vm, node->node_index,
-				       FLOWPROBE_ERROR_COLLISION, 1);
-	}
+      e = flowprobe_lookup (my_cpu_number, &k, h, &poolindex);
       if (!e)			/* Create new entry */
 	{
-	  e = flowprobe_create (my_cpu_number, &k, &poolindex);
+	  e = flowprobe_create (vm, my_cpu_number, &k, h, &poolindex,
+				&evicted);
 	  e->last_exported = now;
 	  e->flow_start = timestamp;
+	  if (evicted)
+	    vlib_node_increment_counter (vm, node->node_index,
+					 FLOWPROBE_ERROR_EVICTED, 1);
 	}
     }
   else
@@ -508,9 +598,9 @@ add_to_flow_record_state (vlib_main_t * vm, vlib_node_runtime_t * node,
 
   if (e)
     {
-      /* Updating entry */
-      e->packetcount++;
-      e->octetcount += octets;
+      /* Updating entry, scaled up when only 1-in-N packets are seen */
+      e->packetcount += packet_weight;
+      e->octetcount += (u64) octets * packet_weight;
       e->last_updated = now;
       e->flow_end = timestamp;
       e->prot.tcp.flags |= tcp_flags;
@@ -527,6 +617,33 @@ flowprobe_get_headersize (void)
     sizeof (ipfix_message_header_t) + sizeof (ipfix_set_header_t);
 }
 
+static void
+flowprobe_export_put_frame (vlib_main_t * vm, flowprobe_variant_t which)
+{
+  flowprobe_main_t *fm = &flowprobe_main;
+  u32 my_cpu_number = vm->thread_index;
+  vlib_frame_t *f = fm->context[which].frames_per_worker[my_cpu_number];
+
+  if (f == 0)
+    return;
+
+  vlib_node_increment_counter (vm, flowprobe_l2_node.index,
+			       FLOWPROBE_ERROR_EXPORTED_PACKETS,
+			       f->n_vectors);
+  vlib_put_frame_to_node (vm, ip4_lookup_node.index, f);
+  fm->context[which].frames_per_worker[my_cpu_number] = 0;
+}
+
+/* Hand all pending export frames of this thread to ip4-lookup */
+static void
+flowprobe_export_flush_frames (vlib_main_t * vm)
+{
+  flowprobe_variant_t which;
+
+  for (which = 0; which < FLOW_N_VARIANTS; which++)
+    flowprobe_export_put_frame (vm, which);
+}
+
 static void
 flowprobe_export_send (vlib_main_t * vm, vlib_buffer_t * b0,
 		       flowprobe_variant_t which)
@@ -535,6 +652,7 @@ flowprobe_export_send (vlib_main_t * vm, vlib_buffer_t * b0,
   flow_report_main_t *frm = &flow_report_main;
   ipfix_exporter_t *exp = pool_elt_at_index (frm->exporters, 0);
   vlib_frame_t *f;
+  u32 *to_next;
   ip4_ipfix_template_packet_t *tp;
   ipfix_set_header_t *s;
   ipfix_message_header_t *h;
@@ -614,26 +732,22 @@ flowprobe_export_send (vlib_main_t * vm, vlib_buffer_t * b0,
 
   ASSERT (ip4_header_checksum_is_valid (ip));
 
-  /* Find or allocate a frame */
+  /* Find or allocate a frame, it is handed to ip4-lookup once full or
+   * when the node or walker run that filled it completes. */
   f = fm->context[which].frames_per_worker[my_cpu_number];
   if (PREDICT_FALSE (f == 0))
     {
-      u32 *to_next;
       f = vlib_get_frame_to_node (vm, ip4_lookup_node.index);
       fm->context[which].frames_per_worker[my_cpu_number] = f;
-      u32 bi0 = vlib_get_buffer_index (vm, b0);
-
-      /* Enqueue the buffer */
-      to_next = vlib_frame_vector_args (f);
-      to_next[0] = bi0;
-      f->n_vectors = 1;
     }
 
-  vlib_put_frame_to_node (vm, ip4_lookup_node.index, f);
-  vlib_node_increment_counter (vm, flowprobe_l2_node.index,
-			       FLOWPROBE_ERROR_EXPORTED_PACKETS, 1);
+  /* Enqueue the buffer */
+  to_next = vlib_frame_vector_args (f);
+  to_next[f->n_vectors++] = vlib_get_buffer_index (vm, b0);
+
+  if (f->n_vectors == VLIB_FRAME_SIZE)
+    flowprobe_export_put_frame (vm, which);
 
-  fm->context[which].frames_per_worker[my_cpu_number] = 0;
   fm->context[which].buffers_per_worker[my_cpu_number] = 0;
   fm->context[which].next_record_offset_per_worker[my_cpu_number] =
     flowprobe_get_headersize ();
@@ -729,6 +843,21 @@ flowprobe_export_entry (vlib_main_t * vm, flowprobe_entry_t * e)
     flowprobe_export_send (vm, b0, which);
 }
 
+/*
+ * 1-in-N packet sampling. Returns the weight the packet carries in the
+ * flow record, 0 if it is not sampled.
+ */
+static_always_inline u32
+flowprobe_packet_sample (flowprobe_main_t * fm, u32 * count)
+{
+  if (PREDICT_TRUE (fm->packet_sample_interval <= 1))
+    return 1;
+  if (++count[0] < fm->packet_sample_interval)
+    return 0;
+  count[0] = 0;
+  return fm->packet_sample_interval;
+}
+
 uword
 flowprobe_node_fn (vlib_main_t * vm,
 		   vlib_node_runtime_t * node, vlib_frame_t * frame,
@@ -738,6 +867,7 @@ flowprobe_node_fn (vlib_main_t * vm,
   flowprobe_next_t next_index;
   flowprobe_main_t *fm = &flowprobe_main;
   timestamp_nsec_t timestamp;
+  u32 sample_count = fm->packet_sample_count_per_worker[vm->thread_index];
 
   unix_time_now_nsec_fraction (&timestamp.sec, &timestamp.nsec);
 
@@ -756,6 +886,7 @@ flowprobe_node_fn (vlib_main_t * vm,
 	  u32 next0 = FLOWPROBE_NEXT_DROP;
 	  u32 next1 = FLOWPROBE_NEXT_DROP;
 	  u16 len0, len1;
+	  u32 weight0, weight1;
 	  u32 bi0, bi1;
 	  vlib_buffer_t *b0, *b1;
 
@@ -791,21 +922,23 @@ flowprobe_node_fn (vlib_main_t * vm,
 	  ethernet_header_t *eh0 = vlib_buffer_get_current (b0);
 	  u16 ethertype0 = clib_net_to_host_u16 (eh0->type);
 
-	  if (PREDICT_TRUE ((b0->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
+	  if (PREDICT_TRUE ((b0->flags & VNET_BUFFER_F_FLOW_REPORT) == 0)
+	      && (weight0 = flowprobe_packet_sample (fm, &sample_count)))
 	    add_to_flow_record_state (vm, node, fm, b0, timestamp, len0,
 				      flowprobe_get_variant
 				      (which, fm->context[which].flags,
-				       ethertype0), 0);
+				       ethertype0), weight0, 0);
 
 	  len1 = vlib_buffer_length_in_chain (vm, b1);
 	  ethernet_header_t *eh1 = vlib_buffer_get_current (b1);
 	  u16 ethertype1 = clib_net_to_host_u16 (eh1->type);
 
-	  if (PREDICT_TRUE ((b1->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
+	  if (PREDICT_TRUE ((b1->flags & VNET_BUFFER_F_FLOW_REPORT) == 0)
+	      && (weight1 = flowprobe_packet_sample (fm, &sample_count)))
 	    add_to_flow_record_state (vm, node, fm, b1, timestamp, len1,
 				      flowprobe_get_variant
 				      (which, fm->context[which].flags,
-				       ethertype1), 0);
+				       ethertype1), weight1, 0);
 
 	  /* verify speculative enqueues, maybe switch current next frame */
 	  vlib_validate_buffer_enqueue_x2 (vm, node, next_index,
@@ -818,6 +951,7 @@ flowprobe_node_fn (vlib_main_t * vm,
 	  u32 bi0;
 	  vlib_buffer_t *b0;
 	  u32 next0 = FLOWPROBE_NEXT_DROP;
+	  u32 weight0;
 	  u16 len0;
 
 	  /* speculatively enqueue b0 to the current next frame */
@@ -836,7 +970,8 @@ flowprobe_node_fn (vlib_main_t * vm,
 	  ethernet_header_t *eh0 = vlib_buffer_get_current (b0);
 	  u16 ethertype0 = clib_net_to_host_u16 (eh0->type);
 
-	  if (PREDICT_TRUE ((b0->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
+	  if (PREDICT_TRUE ((b0->flags & VNET_BUFFER_F_FLOW_REPORT) == 0)
+	      && (weight0 = flowprobe_packet_sample (fm, &sample_count)))
 	    {
 	      flowprobe_trace_t *t = 0;
 	      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
@@ -846,7 +981,7 @@ flowprobe_node_fn (vlib_main_t * vm,
 	      add_to_flow_record_state (vm, node, fm, b0, timestamp, len0,
 					flowprobe_get_variant
 					(which, fm->context[which].flags,
-					 ethertype0), t);
+					 ethertype0), weight0, t);
 	    }
 
 	  /* verify speculative enqueue, maybe switch current next frame */
@@ -857,6 +992,10 @@ flowprobe_node_fn (vlib_main_t * vm,
 
       vlib_put_next_frame (vm, node, next_index, n_left_to_next);
     }
+
+  fm->packet_sample_count_per_worker[vm->thread_index] = sample_count;
+  flowprobe_export_flush_frames (vm);
+
   return frame->n_vectors;
 }
 
@@ -888,6 +1027,7 @@ flush_record (flowprobe_variant_t which)
   vlib_buffer_t *b = flowprobe_get_buffer (vm, which);
   if (b)
     flowprobe_export_send (vm, b, which);
+  flowprobe_export_put_frame (vm, which);
 }
 
 void
@@ -915,16 +1055,26 @@ static void
 flowprobe_delete_by_index (u32 my_cpu_number, u32 poolindex)
 {
   flowprobe_main_t *fm = &flowprobe_main;
+  flowprobe_bucket_t *b;
   flowprobe_entry_t *e;
-  u32 h;
+  u32 h, mask;
 
   e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number], poolindex);
 
-  /* Get my index */
+  /* Free the cache slot pointing at the entry */
   h = flowprobe_hash (&e->key);
-
-  /* Reset hash */
-  fm->hash_per_worker[my_cpu_number][h] = ~0;
+  b = flowprobe_get_bucket (my_cpu_number, h);
+  mask = flowprobe_bucket_match (b, flowprobe_hash_sig (h));
+  while (mask)
+    {
+      u32 slot = flowprobe_bucket_next_slot (&mask);
+      if (b->index[slot] == poolindex)
+	{
+	  b->sig[slot] = 0;
+	  b->index[slot] = ~0;
+	  break;
+	}
+    }
 
   pool_put_index (fm->pool_per_worker[my_cpu_number], poolindex);
 }
@@ -1008,6 +1158,8 @@ flowprobe_walker_process (vlib_main_t * vm,
   vec_foreach (i, to_be_removed) flowprobe_delete_by_index (cpu_index, *i);
   vec_free (to_be_removed);
 
+  flowprobe_export_flush_frames (vm);
+
   return 0;
 }
 
@@ -0,0 +1,970 @@
+/*
+ * hqos.c - hierarchical QoS scheduler
+ *
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Hierarchical QoS scheduler on interface output.
+ *
+ * Packets on the interface-output arc are classified to a pipe
+ * (subscriber) and queue, buffered, and released by the hqos-sched
+ * input node subject to port, subport, pipe and traffic class token
+ * buckets. Every port is owned by a single thread which does both
+ * enqueue and scheduling; other threads hand packets off to it.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/plugin/plugin.h>
+#include <vnet/feature/feature.h>
+#include <vpp/app/version.h>
+#include <hqos/hqos.h>
+
+hqos_main_t hqos_main;
+
+/* bucket deep enough to cover ~1ms of traffic, and at least a few MTUs */
+static u32
+hqos_tb_default_size (u64 rate)
+{
+  return clib_max (rate / 1000, 4 * 9216);
+}
+
+static void
+hqos_tb_params_set (hqos_tb_params_t *p, u64 rate, u32 size)
+{
+  p->rate = rate;
+  p->size = size ? size : hqos_tb_default_size (rate);
+}
+
+static void
+hqos_port_free_queues (vlib_main_t *vm, hqos_port_t *port)
+{
+  hqos_pipe_t *pipe;
+  hqos_queue_t *q;
+
+  vec_foreach (pipe, port->pipes)
+    for (q = pipe->queues; q < pipe->queues + HQOS_N_QUEUES; q++)
+      {
+	while (q->n_elts)
+	  vlib_buffer_free_one (vm, hqos_queue_deq (q, port->queue_size));
+	vec_free (q->buffers);
+      }
+}
+
+static void
+hqos_sched_node_update (hqos_main_t *hm, u32 thread_index)
+{
+  vlib_main_t *vm = vlib_get_main_by_index (thread_index);
+  int active = thread_index < vec_len (hm->ports_by_thread) &&
+	       vec_len (hm->ports_by_thread[thread_index]);
+
+  vlib_node_set_state (vm, hqos_sched_node.index,
+		       active ? VLIB_NODE_STATE_POLLING :
+				VLIB_NODE_STATE_DISABLED);
+}
+
+int
+hqos_port_config (u32 sw_if_index, u32 n_subports, u32 n_pipes,
+		  hqos_tb_params_t *tb, u32 queue_size, u32 thread_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_sw_interface_t *sw;
+  vnet_hw_interface_t *hw;
+  hqos_pipe_profile_t *pp;
+  hqos_subport_t *sp;
+  hqos_port_t *port;
+  u32 i;
+
+  if (pool_is_free_index (hm->vnet_main->interface_main.sw_interfaces,
+			  sw_if_index))
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  /* Not a physical port? */
+  sw = vnet_get_sw_interface (hm->vnet_main, sw_if_index);
+  if (sw->type != VNET_SW_INTERFACE_TYPE_HARDWARE)
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  if (hqos_port_get_by_sw_if_index (hm, sw_if_index))
+    return VNET_API_ERROR_VALUE_EXIST;
+
+  if (n_subports == 0 || n_subports > HQOS_MAX_SUBPORTS || n_pipes == 0 ||
+      n_pipes > HQOS_MAX_PIPES ||
+      (u64) n_subports * n_pipes > HQOS_MAX_PORT_PIPES || queue_size == 0)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (thread_index >= vlib_get_n_threads ())
+    return VNET_API_ERROR_INVALID_WORKER;
+
+  if (vlib_num_workers () && hm->frame_queue_index == ~0)
+    hm->frame_queue_index =
+      vlib_frame_queue_main_init (hqos_enqueue_node.index, 0);
+
+  pool_get_zero (hm->ports, port);
+  port->sw_if_index = sw_if_index;
+  port->thread_index = thread_index;
+  port->n_pipes_per_subport = n_pipes;
+  port->queue_size = queue_size;
+  port->frame_overhead = HQOS_DEFAULT_FRAME_OVERHEAD;
+
+  /* default to link speed */
+  hw = vnet_get_sup_hw_interface (hm->vnet_main, sw_if_index);
+  if (tb->rate == 0)
+    tb->rate = (u64) hw->link_speed * 1000 / 8;
+  hqos_tb_params_set (&port->tb_params, tb->rate, tb->size);
+
+  vec_validate (port->subports, n_subports - 1);
+  vec_foreach (sp, port->subports)
+    sp->first_pipe = (sp - port->subports) * n_pipes;
+  vec_validate (port->pipes, n_subports * n_pipes - 1);
+
+  /* profile 0: no pipe shaping, equal best-effort weights */
+  vec_validate (port->pipe_profiles, 0);
+  pp = port->pipe_profiles;
+  for (i = 0; i < HQOS_N_BE_QUEUES; i++)
+    pp->wrr_weights[i] = 1;
+
+  /* class selector 7..5 -> TC0, 4 -> TC1, 3..2 -> TC2, rest best-effort */
+  for (i = 0; i < ARRAY_LEN (port->dscp_to_queue); i++)
+    {
+      static const u8 cs_to_queue[8] = { HQOS_BE_QUEUE0,
+					 HQOS_BE_QUEUE0 + 1,
+					 2,
+					 2,
+					 1,
+					 0,
+					 0,
+					 0 };
+      port->dscp_to_queue[i] = cs_to_queue[i >> 3];
+    }
+
+  vec_validate_init_empty (hm->port_by_sw_if_index, sw_if_index, ~0);
+  hm->port_by_sw_if_index[sw_if_index] = port - hm->ports;
+
+  vec_validate (hm->ports_by_thread, thread_index);
+  vec_add1 (hm->ports_by_thread[thread_index], port - hm->ports);
+  hqos_sched_node_update (hm, thread_index);
+
+  vnet_feature_enable_disable ("interface-output", "hqos-enqueue",
+			       sw_if_index, 1, 0, 0);
+  return 0;
+}
+
+int
+hqos_port_delete (u32 sw_if_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_port_t *port;
+  hqos_subport_t *sp;
+  u32 port_index, i, *ports;
+
+  port = hqos_port_get_by_sw_if_index (hm, sw_if_index);
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  vnet_feature_enable_disable ("interface-output", "hqos-enqueue",
+			       sw_if_index, 0, 0, 0);
+
+  port_index = port - hm->ports;
+  ports = hm->ports_by_thread[port->thread_index];
+  for (i = 0; i < vec_len (ports); i++)
+    if (ports[i] == port_index)
+      {
+	vec_del1 (ports, i);
+	break;
+      }
+  hm->ports_by_thread[port->thread_index] = ports;
+  hqos_sched_node_update (hm, port->thread_index);
+
+  /* called with workers stopped, queued packets are ours to free */
+  hqos_port_free_queues (hm->vlib_main, port);
+  vec_foreach (sp, port->subports)
+    clib_bitmap_free (sp->active_pipes);
+  vec_free (port->subports);
+  vec_free (port->pipes);
+  vec_free (port->pipe_profiles);
+  clib_bitmap_free (port->active_subports);
+  hash_free (port->pipe_by_ip4);
+
+  hm->port_by_sw_if_index[sw_if_index] = ~0;
+  pool_put (hm->ports, port);
+  return 0;
+}
+
+int
+hqos_subport_config (u32 sw_if_index, u32 subport, hqos_tb_params_t *tb)
+{
+  hqos_port_t *port = hqos_port_get_by_sw_if_index (&hqos_main, sw_if_index);
+  hqos_subport_t *sp;
+
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+  if (subport >= vec_len (port->subports))
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  sp = vec_elt_at_index (port->subports, subport);
+  hqos_tb_params_set (&sp->tb_params, tb->rate, tb->size);
+  return 0;
+}
+
+int
+hqos_pipe_profile_config (u32 sw_if_index, u32 profile,
+			  hqos_pipe_profile_t *pp)
+{
+  hqos_port_t *port = hqos_port_get_by_sw_if_index (&hqos_main, sw_if_index);
+  hqos_pipe_profile_t *p;
+  u32 i;
+
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  /* profiles are numbered densely */
+  if (profile > vec_len (port->pipe_profiles))
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  for (i = 0; i < HQOS_N_BE_QUEUES; i++)
+    if (pp->wrr_weights[i] == 0)
+      return VNET_API_ERROR_INVALID_VALUE;
+
+  vec_validate (port->pipe_profiles, profile);
+  p = vec_elt_at_index (port->pipe_profiles, profile);
+  hqos_tb_params_set (&p->tb, pp->tb.rate, pp->tb.size);
+  for (i = 0; i < HQOS_N_TC; i++)
+    hqos_tb_params_set (p->tc_tb + i, pp->tc_tb[i].rate, pp->tc_tb[i].size);
+  clib_memcpy_fast (p->wrr_weights, pp->wrr_weights,
+		    sizeof (p->wrr_weights));
+  return 0;
+}
+
+static hqos_pipe_t *
+hqos_pipe_get (hqos_port_t *port, u32 subport, u32 pipe)
+{
+  if (subport >= vec_len (port->subports) ||
+      pipe >= port->n_pipes_per_subport)
+    return 0;
+  return vec_elt_at_index (port->pipes,
+			   subport * port->n_pipes_per_subport + pipe);
+}
+
+int
+hqos_pipe_config (u32 sw_if_index, u32 subport, u32 pipe, u32 profile)
+{
+  hqos_port_t *port = hqos_port_get_by_sw_if_index (&hqos_main, sw_if_index);
+  hqos_pipe_profile_t *pp;
+  hqos_pipe_t *p;
+
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+  if ((p = hqos_pipe_get (port, subport, pipe)) == 0)
+    return VNET_API_ERROR_INVALID_VALUE;
+  if (profile >= vec_len (port->pipe_profiles))
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  pp = vec_elt_at_index (port->pipe_profiles, profile);
+  p->profile_index = profile;
+  p->wrr_credit = pp->wrr_weights[p->wrr_queue];
+  return 0;
+}
+
+int
+hqos_classify_ip4 (u32 sw_if_index, ip4_address_t *addr, u32 subport,
+		   u32 pipe, int is_add)
+{
+  hqos_port_t *port = hqos_port_get_by_sw_if_index (&hqos_main, sw_if_index);
+  hqos_pipe_t *p;
+
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  if (!is_add)
+    {
+      if (addr)
+	hash_unset (port->pipe_by_ip4, addr->as_u32);
+      return 0;
+    }
+
+  if ((p = hqos_pipe_get (port, subport, pipe)) == 0)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (addr == 0)
+    port->default_pipe = p - port->pipes;
+  else
+    hash_set (port->pipe_by_ip4, addr->as_u32, p - port->pipes);
+  return 0;
+}
+
+int
+hqos_dscp_map (u32 sw_if_index, u8 dscp, u32 tc, u32 queue)
+{
+  hqos_port_t *port = hqos_port_get_by_sw_if_index (&hqos_main, sw_if_index);
+
+  if (port == 0)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+  if (dscp >= ARRAY_LEN (port->dscp_to_queue) || tc >= HQOS_N_TC)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (tc < HQOS_BE_TC)
+    port->dscp_to_queue[dscp] = tc;
+  else if (queue < HQOS_N_BE_QUEUES)
+    port->dscp_to_queue[dscp] = HQOS_BE_QUEUE0 + queue;
+  else
+    return VNET_API_ERROR_INVALID_VALUE;
+  return 0;
+}
+
+static uword
+unformat_hqos_rate (unformat_input_t *input, va_list *args)
+{
+  u64 *rate = va_arg (*args, u64 *);
+  f64 r;
+
+  /* bits per second in, bytes per second out */
+  if (unformat (input, "%fg", &r) || unformat (input, "%fG", &r))
+    r *= 1e9;
+  else if (unformat (input, "%fm", &r) || unformat (input, "%fM", &r))
+    r *= 1e6;
+  else if (unformat (input, "%fk", &r) || unformat (input, "%fK", &r))
+    r *= 1e3;
+  else if (!unformat (input, "%f", &r))
+    return 0;
+
+  *rate = r / 8;
+  return 1;
+}
+
+static u8 *
+format_hqos_rate (u8 *s, va_list *args)
+{
+  hqos_tb_params_t *p = va_arg (*args, hqos_tb_params_t *);
+
+  if (p->rate == 0)
+    return format (s, "unlimited");
+  return format (s, "%.3f Mbps burst %u", (f64) p->rate * 8 / 1e6, p->size);
+}
+
+static clib_error_t *
+hqos_api_error (int rv)
+{
+  switch (rv)
+    {
+    case 0:
+      return 0;
+    case VNET_API_ERROR_INVALID_SW_IF_INDEX:
+      return clib_error_return (0, "not a physical interface");
+    case VNET_API_ERROR_VALUE_EXIST:
+      return clib_error_return (0, "hqos already configured on interface");
+    case VNET_API_ERROR_NO_SUCH_ENTRY:
+      return clib_error_return (0, "no such hqos port, subport or profile");
+    case VNET_API_ERROR_INVALID_WORKER:
+      return clib_error_return (0, "invalid thread");
+    case VNET_API_ERROR_INVALID_VALUE:
+      return clib_error_return (0, "invalid value");
+    default:
+      return clib_error_return (0, "error %d", rv);
+    }
+}
+
+static clib_error_t *
+hqos_port_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  hqos_tb_params_t tb = {};
+  u32 sw_if_index = ~0, n_subports = 1, n_pipes = 1024;
+  u32 queue_size = HQOS_DEFAULT_QUEUE_SIZE;
+  u32 thread_index = vlib_num_workers () ? 1 : 0;
+  int is_del = 0;
+  clib_error_t *error = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface,
+		    hm->vnet_main, &sw_if_index))
+	;
+      else if (unformat (line_input, "subports %u", &n_subports))
+	;
+      else if (unformat (line_input, "pipes %u", &n_pipes))
+	;
+      else if (unformat (line_input, "rate %U", unformat_hqos_rate,
+			 &tb.rate))
+	;
+      else if (unformat (line_input, "burst %u", &tb.size))
+	;
+      else if (unformat (line_input, "queue-size %u", &queue_size))
+	;
+      else if (unformat (line_input, "thread %u", &thread_index))
+	;
+      else if (unformat (line_input, "disable"))
+	is_del = 1;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0)
+    {
+      error = clib_error_return (0, "please specify interface");
+      goto done;
+    }
+
+  if (is_del)
+    error = hqos_api_error (hqos_port_delete (sw_if_index));
+  else
+    error = hqos_api_error (hqos_port_config (
+      sw_if_index, n_subports, n_pipes, &tb, queue_size, thread_index));
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Enable the hierarchical QoS scheduler on an interface. The port rate
+ * defaults to the link speed, all pipes use profile 0 (unshaped) until
+ * configured otherwise. Scheduling for the port runs on the given
+ * thread, by default the first worker.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos port TenGigabitEthernet1/0/0 subports 4 pipes 4096 rate 10g}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_port_command, static) = {
+  .path = "hqos port",
+  .short_help = "hqos port <interface> [subports <n>] [pipes <n>] "
+		"[rate <bps>] [burst <bytes>] [queue-size <n>] [thread <n>] "
+		"[disable]",
+  .function = hqos_port_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_subport_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			 vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  hqos_tb_params_t tb = {};
+  u32 sw_if_index = ~0, subport = ~0;
+  clib_error_t *error = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface,
+		    hm->vnet_main, &sw_if_index))
+	;
+      else if (unformat (line_input, "subport %u", &subport))
+	;
+      else if (unformat (line_input, "rate %U", unformat_hqos_rate,
+			 &tb.rate))
+	;
+      else if (unformat (line_input, "burst %u", &tb.size))
+	;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || subport == ~0)
+    {
+      error = clib_error_return (0, "please specify interface and subport");
+      goto done;
+    }
+
+  error = hqos_api_error (hqos_subport_config (sw_if_index, subport, &tb));
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_subport_command, static) = {
+  .path = "hqos subport",
+  .short_help = "hqos subport <interface> subport <n> rate <bps> "
+		"[burst <bytes>]",
+  .function = hqos_subport_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_pipe_profile_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			      vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  hqos_pipe_profile_t pp = {};
+  u32 sw_if_index = ~0, profile = ~0, tc, w[HQOS_N_BE_QUEUES], i;
+  u64 rate;
+  clib_error_t *error = 0;
+
+  for (i = 0; i < HQOS_N_BE_QUEUES; i++)
+    pp.wrr_weights[i] = 1;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface,
+		    hm->vnet_main, &sw_if_index))
+	;
+      else if (unformat (line_input, "profile %u", &profile))
+	;
+      else if (unformat (line_input, "tc %u rate %U", &tc, unformat_hqos_rate,
+			 &rate))
+	{
+	  if (tc >= HQOS_N_TC)
+	    {
+	      error = clib_error_return (0, "traffic class must be < %u",
+					 HQOS_N_TC);
+	      goto done;
+	    }
+	  pp.tc_tb[tc].rate = rate;
+	}
+      else if (unformat (line_input, "rate %U", unformat_hqos_rate,
+			 &pp.tb.rate))
+	;
+      else if (unformat (line_input, "burst %u", &pp.tb.size))
+	;
+      else if (unformat (line_input, "weights %u %u %u %u", &w[0], &w[1],
+			 &w[2], &w[3]))
+	{
+	  for (i = 0; i < HQOS_N_BE_QUEUES; i++)
+	    pp.wrr_weights[i] = clib_min (w[i], 255);
+	}
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || profile == ~0)
+    {
+      error = clib_error_return (0, "please specify interface and profile");
+      goto done;
+    }
+
+  error =
+    hqos_api_error (hqos_pipe_profile_config (sw_if_index, profile, &pp));
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Create or update a pipe profile. Each traffic class may be shaped
+ * below the pipe rate; weights set the number of packets served per
+ * round from each of the four best-effort queues.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos pipe-profile TenGigabitEthernet1/0/0 profile 1 rate 100m tc 0 rate 10m weights 8 4 2 1}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_pipe_profile_command, static) = {
+  .path = "hqos pipe-profile",
+  .short_help = "hqos pipe-profile <interface> profile <n> [rate <bps>] "
+		"[burst <bytes>] [tc <n> rate <bps>] [weights <w0> <w1> <w2> "
+		"<w3>]",
+  .function = hqos_pipe_profile_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_pipe_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  u32 sw_if_index = ~0, subport = 0, pipe = ~0, profile = ~0;
+  clib_error_t *error = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface,
+		    hm->vnet_main, &sw_if_index))
+	;
+      else if (unformat (line_input, "subport %u", &subport))
+	;
+      else if (unformat (line_input, "pipe %u", &pipe))
+	;
+      else if (unformat (line_input, "profile %u", &profile))
+	;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || pipe == ~0 || profile == ~0)
+    {
+      error =
+	clib_error_return (0, "please specify interface, pipe and profile");
+      goto done;
+    }
+
+  error =
+    hqos_api_error (hqos_pipe_config (sw_if_index, subport, pipe, profile));
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_pipe_command, static) = {
+  .path = "hqos pipe",
+  .short_help = "hqos pipe <interface> [subport <n>] pipe <n> profile <n>",
+  .function = hqos_pipe_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_classify_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			  vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  u32 sw_if_index = ~0, subport = 0, pipe = ~0;
+  ip4_address_t addr, *a = 0;
+  int is_add = 1, is_default = 0;
+  clib_error_t *error = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface,
+		    hm->vnet_main, &sw_if_index))
+	;
+      else if (unformat (line_input, "ip4 %U", unformat_ip4_address, &addr))
+	a = &addr;
+      else if (unformat (line_input, "default"))
+	is_default = 1;
+      else if (unformat (line_input, "subport %u", &subport))
+	;
+      else if (unformat (line_input, "pipe %u", &pipe))
+	;
+      else if (unformat (line_input, "del"))
+	is_add = 0;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || (a == 0) == (is_default == 0))
+    {
+      error = clib_error_return (
+	0, "please specify interface and either ip4 address or default");
+      goto done;
+    }
+  if (is_add && pipe == ~0)
+    {
+      error = clib_error_return (0, "please specify pipe");
+      goto done;
+    }
+  if (is_default && !is_add)
+    {
+      error = clib_error_return (0, "default pipe cannot be deleted");
+      goto done;
+    }
+
+  error = hqos_api_error (
+    hqos_classify_ip4 (sw_if_index, a, subport, pipe, is_add));
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Map an IPv4 destination address to a subscriber pipe. Unmatched
+ * traffic goes to the default pipe (subport 0 pipe 0 unless set).
+ *
+ * @cliexpar
+ * @cliexcmd{hqos classify TenGigabitEthernet1/0/0 ip4 10.0.0.1 subport 0 pipe 1}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_classify_command, static) = {
+  .path = "hqos classify",
+  .short_help = "hqos classify <interface> ip4 <address>|default "
+		"[subport <n>] pipe <n> [del]",
+  .function = hqos_classify_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_dscp_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  u32 sw_if_index = ~0, dscp = ~0, tc = ~0, queue = 0;
+  clib_error_t *error = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "%U", unformat_vnet_sw_interface,
+		    hm->vnet_main, &sw_if_index))
+	;
+      else if (unformat (line_input, "dscp %u", &dscp))
+	;
+      else if (unformat (line_input, "tc %u", &tc))
+	;
+      else if (unformat (line_input, "queue %u", &queue))
+	;
+      else
+	{
+	  error = clib_error_return (0, "unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0 || dscp > 63 || tc == ~0)
+    {
+      error = clib_error_return (0, "please specify interface, dscp and tc");
+      goto done;
+    }
+
+  error = hqos_api_error (hqos_dscp_map (sw_if_index, dscp, tc, queue));
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_dscp_command, static) = {
+  .path = "hqos dscp",
+  .short_help = "hqos dscp <interface> dscp <0-63> tc <n> [queue <n>]",
+  .function = hqos_dscp_command_fn,
+};
+/* *INDENT-ON* */
+
+static u8 *
+format_hqos_pipe (u8 *s, va_list *args)
+{
+  hqos_port_t *port = va_arg (*args, hqos_port_t *);
+  hqos_pipe_t *pipe = va_arg (*args, hqos_pipe_t *);
+  u32 indent = format_get_indent (s);
+  hqos_pipe_profile_t *pp = port->pipe_profiles + pipe->profile_index;
+  hqos_queue_t *q;
+  u32 i;
+
+  s = format (s, "subport %u pipe %u profile %u rate %U buffered %u",
+	      (pipe - port->pipes) / port->n_pipes_per_subport,
+	      (pipe - port->pipes) % port->n_pipes_per_subport,
+	      pipe->profile_index, format_hqos_rate, &pp->tb,
+	      pipe->n_buffered);
+
+  for (i = 0; i < HQOS_N_QUEUES; i++)
+    {
+      u32 tc = clib_min (i, HQOS_BE_TC);
+
+      q = pipe->queues + i;
+      s = format (s,
+		  "\n%Uqueue %u tc %u: depth %u enq %llu deq %llu "
+		  "deq-bytes %llu drop %llu",
+		  format_white_space, indent + 2, i, tc,
+		  q->n_elts, q->n_enq, q->n_deq, q->n_deq_bytes,
+		  q->n_drop);
+    }
+
+  return s;
+}
+
+u8 *
+format_hqos_port (u8 *s, va_list *args)
+{
+  hqos_port_t *port = va_arg (*args, hqos_port_t *);
+  int verbose = va_arg (*args, int);
+  u32 indent = format_get_indent (s);
+  hqos_main_t *hm = &hqos_main;
+  hqos_pipe_profile_t *pp;
+  hqos_subport_t *sp;
+  u32 i;
+
+  s = format (s, "%U: thread %u rate %U", format_vnet_sw_if_index_name,
+	      hm->vnet_main, port->sw_if_index, port->thread_index,
+	      format_hqos_rate, &port->tb_params);
+  s = format (s,
+	      "\n%Usubports %u pipes-per-subport %u queue-size %u "
+	      "buffered %u active-pipes %u",
+	      format_white_space, indent + 2, vec_len (port->subports),
+	      port->n_pipes_per_subport, port->queue_size, port->n_buffered,
+	      port->n_active_pipes);
+
+  vec_foreach (sp, port->subports)
+    s = format (s, "\n%Usubport %u rate %U deq %llu deq-bytes %llu",
+		format_white_space, indent + 2, sp - port->subports,
+		format_hqos_rate, &sp->tb_params, sp->n_deq, sp->n_deq_bytes);
+
+  if (!verbose)
+    return s;
+
+  vec_foreach (pp, port->pipe_profiles)
+    {
+      s = format (s, "\n%Uprofile %u rate %U weights", format_white_space,
+		  indent + 2, pp - port->pipe_profiles, format_hqos_rate,
+		  &pp->tb);
+      for (i = 0; i < HQOS_N_BE_QUEUES; i++)
+	s = format (s, " %u", pp->wrr_weights[i]);
+      for (i = 0; i < HQOS_N_TC; i++)
+	if (pp->tc_tb[i].rate)
+	  s = format (s, "\n%Utc %u rate %U", format_white_space, indent + 4,
+		      i, format_hqos_rate, pp->tc_tb + i);
+    }
+
+  s = format (s, "\n%Udscp to queue:", format_white_space, indent + 2);
+  for (i = 0; i < ARRAY_LEN (port->dscp_to_queue); i++)
+    s = format (s, "%s%2u:%u", i % 16 ? " " : "\n    ", i,
+		port->dscp_to_queue[i]);
+
+  return s;
+}
+
+static clib_error_t *
+show_hqos_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		      vlib_cli_command_t *cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  u32 sw_if_index = ~0, subport = ~0, pipe = ~0;
+  hqos_port_t *port;
+  hqos_pipe_t *p;
+  int verbose = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "%U", unformat_vnet_sw_interface, hm->vnet_main,
+		    &sw_if_index))
+	;
+      else if (unformat (input, "subport %u", &subport))
+	;
+      else if (unformat (input, "pipe %u", &pipe))
+	;
+      else if (unformat (input, "verbose"))
+	verbose = 1;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (pipe != ~0)
+    {
+      if (sw_if_index == ~0)
+	return clib_error_return (0, "please specify interface");
+      port = hqos_port_get_by_sw_if_index (hm, sw_if_index);
+      if (port == 0)
+	return clib_error_return (0, "hqos not enabled on interface");
+      p = hqos_pipe_get (port, subport == ~0 ? 0 : subport, pipe);
+      if (p == 0)
+	return clib_error_return (0, "no such pipe");
+      vlib_cli_output (vm, "%U", format_hqos_pipe, port, p);
+      return 0;
+    }
+
+  /* *INDENT-OFF* */
+  pool_foreach (port, hm->ports)
+    {
+      if (sw_if_index == ~0 || sw_if_index == port->sw_if_index)
+	vlib_cli_output (vm, "%U", format_hqos_port, port, verbose);
+    }
+  /* *INDENT-ON* */
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_hqos_command, static) = {
+  .path = "show hqos",
+  .short_help = "show hqos [<interface> [subport <n>] [pipe <n>]] [verbose]",
+  .function = show_hqos_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_interface_add_del (vnet_main_t *vnm, u32 sw_if_index, u32 is_add)
+{
+  if (!is_add && hqos_port_get_by_sw_if_index (&hqos_main, sw_if_index))
+    hqos_port_delete (sw_if_index);
+  return 0;
+}
+
+VNET_SW_INTERFACE_ADD_DEL_FUNCTION (hqos_interface_add_del);
+
+static clib_error_t *
+hqos_init (vlib_main_t *vm)
+{
+  hqos_main_t *hm = &hqos_main;
+
+  hm->vlib_main = vm;
+  hm->vnet_main = vnet_get_main ();
+  hm->frame_queue_index = ~0;
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (hqos_init);
+
+/* *INDENT-OFF* */
+VNET_FEATURE_INIT (hqos_enqueue, static) = {
+  .arc_name = "interface-output",
+  .node_name = "hqos-enqueue",
+  .runs_before = VNET_FEATURES ("interface-output-arc-end"),
+};
+/* *INDENT-ON* */
+
+/* *INDENT-OFF* */
+VLIB_PLUGIN_REGISTER () =
+{
+  .version = VPP_BUILD_VER,
+  .description = "Hierarchical QoS Scheduler",
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,242 @@
+/*
+ * hqos.h - hierarchical QoS scheduler
+ *
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __included_hqos_h__
+#define __included_hqos_h__
+
+#include <vnet/vnet.h>
+#include <vnet/ip/ip.h>
+#include <vnet/ethernet/ethernet.h>
+
+#include <vppinfra/hash.h>
+#include <vppinfra/bitmap.h>
+#include <vppinfra/error.h>
+
+/*
+ * Hierarchy: port -> subport -> pipe -> traffic class -> queue.
+ *
+ * Traffic classes 0 .. HQOS_N_TC - 2 are served in strict priority and
+ * own one queue each. The last (best-effort) traffic class owns
+ * HQOS_N_BE_QUEUES queues served weighted round-robin.
+ */
+#define HQOS_N_TC	  4
+#define HQOS_BE_TC	  (HQOS_N_TC - 1)
+#define HQOS_N_BE_QUEUES  4
+#define HQOS_N_QUEUES	  (HQOS_BE_TC + HQOS_N_BE_QUEUES)
+#define HQOS_BE_QUEUE0	  HQOS_BE_TC
+
+#define HQOS_MAX_SUBPORTS (4 << 10)
+#define HQOS_MAX_PIPES	  (64 << 10) /**< per subport */
+#define HQOS_MAX_PORT_PIPES (1 << 20) /**< subports x pipes */
+#define HQOS_PIPE_BURST	  8	     /**< packets per pipe visit */
+
+#define HQOS_DEFAULT_QUEUE_SIZE	   64
+#define HQOS_DEFAULT_FRAME_OVERHEAD 24 /**< preamble, SFD, FCS and IFG */
+
+/** Token bucket parameters, rate 0 means unlimited */
+typedef struct
+{
+  u64 rate; /**< bytes per second */
+  u32 size; /**< bytes */
+} hqos_tb_params_t;
+
+/** Token bucket state, refilled lazily when visited */
+typedef struct
+{
+  f64 tokens;
+  f64 last_update;
+} hqos_tb_t;
+
+typedef struct
+{
+  u32 *buffers; /**< ring of queue_size, allocated on first use */
+  u32 head;
+  u32 n_elts;
+  u64 n_enq;
+  u64 n_deq;
+  u64 n_deq_bytes;
+  u64 n_drop;
+} hqos_queue_t;
+
+typedef struct
+{
+  hqos_tb_params_t tb;
+  hqos_tb_params_t tc_tb[HQOS_N_TC];
+  u8 wrr_weights[HQOS_N_BE_QUEUES]; /**< packets per round */
+} hqos_pipe_profile_t;
+
+typedef struct
+{
+  hqos_tb_t tb;
+  hqos_tb_t tc_tb[HQOS_N_TC];
+  u32 profile_index;
+  u32 n_buffered;
+  u8 wrr_queue;	 /**< best-effort queue being served */
+  u8 wrr_credit; /**< packets left for it in this round */
+  hqos_queue_t queues[HQOS_N_QUEUES];
+} hqos_pipe_t;
+
+typedef struct
+{
+  hqos_tb_params_t tb_params;
+  hqos_tb_t tb;
+  u32 first_pipe; /**< index of pipe 0 in port->pipes */
+  uword *active_pipes;
+  u32 next_pipe;
+  u64 n_deq;
+  u64 n_deq_bytes;
+} hqos_subport_t;
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 thread_index;	 /**< worker running enqueue and scheduler */
+  u32 n_pipes_per_subport;
+  u32 queue_size;
+  u32 frame_overhead;
+
+  hqos_tb_params_t tb_params;
+  hqos_tb_t tb;
+
+  hqos_subport_t *subports;
+  hqos_pipe_t *pipes;
+  hqos_pipe_profile_t *pipe_profiles;
+
+  uword *active_subports;
+  u32 next_subport;
+  u32 n_active_pipes;
+  u32 n_buffered;
+
+  /* classification */
+  uword *pipe_by_ip4; /**< dst ip4 -> index in pipes */
+  u32 default_pipe;
+  u8 dscp_to_queue[64];
+} hqos_port_t;
+
+typedef struct
+{
+  hqos_port_t *ports;
+  u32 *port_by_sw_if_index;
+  u32 **ports_by_thread;
+  u32 frame_queue_index;
+
+  /* convenience */
+  vlib_main_t *vlib_main;
+  vnet_main_t *vnet_main;
+} hqos_main_t;
+
+extern hqos_main_t hqos_main;
+extern vlib_node_registration_t hqos_enqueue_node;
+extern vlib_node_registration_t hqos_sched_node;
+
+#define foreach_hqos_error                                                    \
+  _ (ENQUEUED, "packets enqueued")                                            \
+  _ (QUEUE_FULL, "packets dropped, queue full")                               \
+  _ (NO_PORT, "packets dropped, no hqos port")                                \
+  _ (CONGESTION_DROP, "packets dropped, handoff congestion")                  \
+  _ (NO_TX_QUEUE, "packets dropped, no tx queue on hqos thread")
+
+typedef enum
+{
+#define _(sym, str) HQOS_ERROR_##sym,
+  foreach_hqos_error
+#undef _
+    HQOS_N_ERROR,
+} hqos_error_t;
+
+static_always_inline hqos_port_t *
+hqos_port_get_by_sw_if_index (hqos_main_t *hm, u32 sw_if_index)
+{
+  u32 pi;
+
+  if (sw_if_index >= vec_len (hm->port_by_sw_if_index))
+    return 0;
+  pi = hm->port_by_sw_if_index[sw_if_index];
+  return pi == ~0 ? 0 : pool_elt_at_index (hm->ports, pi);
+}
+
+static_always_inline int
+hqos_queue_enq (hqos_queue_t *q, u32 queue_size, u32 bi)
+{
+  u32 tail;
+
+  if (q->n_elts >= queue_size)
+    return 0;
+
+  if (PREDICT_FALSE (q->buffers == 0))
+    vec_validate (q->buffers, queue_size - 1);
+
+  tail = q->head + q->n_elts;
+  tail = tail >= queue_size ? tail - queue_size : tail;
+  q->buffers[tail] = bi;
+  q->n_elts++;
+  return 1;
+}
+
+static_always_inline u32
+hqos_queue_deq (hqos_queue_t *q, u32 queue_size)
+{
+  u32 bi = q->buffers[q->head];
+
+  q->head = q->head + 1 == queue_size ? 0 : q->head + 1;
+  q->n_elts--;
+  return bi;
+}
+
+static_always_inline void
+hqos_tb_update (hqos_tb_t *tb, hqos_tb_params_t *p, f64 now)
+{
+  tb->tokens += (now - tb->last_update) * p->rate;
+  tb->last_update = now;
+  if (tb->tokens > p->size)
+    tb->tokens = p->size;
+}
+
+static_always_inline int
+hqos_tb_has_tokens (hqos_tb_t *tb, hqos_tb_params_t *p, u32 n_bytes)
+{
+  return p->rate == 0 || tb->tokens >= n_bytes;
+}
+
+static_always_inline void
+hqos_tb_consume (hqos_tb_t *tb, hqos_tb_params_t *p, u32 n_bytes)
+{
+  if (p->rate)
+    tb->tokens -= n_bytes;
+}
+
+int hqos_port_config (u32 sw_if_index, u32 n_subports, u32 n_pipes,
+		      hqos_tb_params_t *tb, u32 queue_size, u32 thread_index);
+int hqos_port_delete (u32 sw_if_index);
+int hqos_subport_config (u32 sw_if_index, u32 subport, hqos_tb_params_t *tb);
+int hqos_pipe_profile_config (u32 sw_if_index, u32 profile,
+			      hqos_pipe_profile_t *pp);
+int hqos_pipe_config (u32 sw_if_index, u32 subport, u32 pipe, u32 profile);
+int hqos_classify_ip4 (u32 sw_if_index, ip4_address_t *addr, u32 subport,
+		       u32 pipe, int is_add);
+int hqos_dscp_map (u32 sw_if_index, u8 dscp, u32 tc, u32 queue);
+
+format_function_t format_hqos_port;
+
+#endif /* __included_hqos_h__ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,494 @@
+/*
+ * node.c - hierarchical QoS enqueue and scheduler nodes
+ *
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vlib/vlib.h>
+#include <vnet/vnet.h>
+#include <vnet/feature/feature.h>
+#include <hqos/hqos.h>
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 pipe;
+  u8 queue;
+  u8 is_handoff;
+  u8 is_drop;
+} hqos_enqueue_trace_t;
+
+#ifndef CLIB_MARCH_VARIANT
+static u8 *
+format_hqos_enqueue_trace (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  hqos_enqueue_trace_t *t = va_arg (*args, hqos_enqueue_trace_t *);
+
+  if (t->is_handoff)
+    return format (s, "HQOS: sw_if_index %d handed off to owner thread",
+		   t->sw_if_index);
+
+  s = format (s, "HQOS: sw_if_index %d pipe %u queue %u", t->sw_if_index,
+	      t->pipe, t->queue);
+  if (t->is_drop)
+    s = format (s, " dropped");
+  return s;
+}
+
+static char *hqos_error_strings[] = {
+#define _(sym, string) string,
+  foreach_hqos_error
+#undef _
+};
+#endif /* CLIB_MARCH_VARIANT */
+
+static_always_inline void
+hqos_classify (hqos_port_t *port, vlib_buffer_t *b, u32 *pipe, u8 *queue)
+{
+  ethernet_header_t *eh = vlib_buffer_get_current (b);
+  u16 ethertype = clib_net_to_host_u16 (eh->type);
+  u8 *l3 = (u8 *) (eh + 1);
+  u8 dscp = 0;
+  uword *p;
+
+  *pipe = port->default_pipe;
+
+  if (ethernet_frame_is_tagged (ethertype))
+    {
+      ethernet_vlan_header_t *vlan = (ethernet_vlan_header_t *) l3;
+
+      ethertype = clib_net_to_host_u16 (vlan->type);
+      l3 += sizeof (*vlan);
+      if (ethernet_frame_is_tagged (ethertype))
+	{
+	  vlan++;
+	  ethertype = clib_net_to_host_u16 (vlan->type);
+	  l3 += sizeof (*vlan);
+	}
+    }
+
+  if (ethertype == ETHERNET_TYPE_IP4)
+    {
+      ip4_header_t *ip4 = (ip4_header_t *) l3;
+
+      dscp = ip4_header_get_dscp (ip4);
+      p = hash_get (port->pipe_by_ip4, ip4->dst_address.as_u32);
+      if (p)
+	*pipe = p[0];
+    }
+  else if (ethertype == ETHERNET_TYPE_IP6)
+    dscp = ip6_dscp_network_order ((ip6_header_t *) l3);
+
+  *queue = port->dscp_to_queue[dscp];
+}
+
+VLIB_NODE_FN (hqos_enqueue_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  hqos_main_t *hm = &hqos_main;
+  u32 thread_index = vm->thread_index;
+  u32 n_left, *from, n_enq = 0, n_full = 0, n_no_port = 0;
+  u32 drops[VLIB_FRAME_SIZE], n_drops = 0;
+  u32 handoff[VLIB_FRAME_SIZE], n_handoff = 0;
+  u16 threads[VLIB_FRAME_SIZE];
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  hqos_port_t *port = 0;
+  u32 last_sw_if_index = ~0;
+
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
+
+  while (n_left > 0)
+    {
+      u32 sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_TX];
+      u32 pipe_index = ~0;
+      u8 queue = 0, is_drop = 0, is_handoff = 0;
+
+      if (sw_if_index != last_sw_if_index)
+	{
+	  port = hqos_port_get_by_sw_if_index (hm, sw_if_index);
+	  last_sw_if_index = sw_if_index;
+	}
+
+      if (PREDICT_FALSE (port == 0))
+	{
+	  drops[n_drops++] = from[0];
+	  n_no_port++;
+	  is_drop = 1;
+	}
+      else if (port->thread_index != thread_index)
+	{
+	  /* only the owner thread touches the port, no locks needed */
+	  handoff[n_handoff] = from[0];
+	  threads[n_handoff++] = port->thread_index;
+	  is_handoff = 1;
+	}
+      else
+	{
+	  hqos_subport_t *sp;
+	  hqos_pipe_t *pipe;
+	  hqos_queue_t *q;
+	  u32 subport;
+
+	  hqos_classify (port, b[0], &pipe_index, &queue);
+	  pipe = vec_elt_at_index (port->pipes, pipe_index);
+	  q = pipe->queues + queue;
+
+	  if (!hqos_queue_enq (q, port->queue_size, from[0]))
+	    {
+	      drops[n_drops++] = from[0];
+	      q->n_drop++;
+	      n_full++;
+	      is_drop = 1;
+	    }
+	  else
+	    {
+	      q->n_enq++;
+	      n_enq++;
+	      port->n_buffered++;
+
+	      if (pipe->n_buffered++ == 0)
+		{
+		  subport = pipe_index / port->n_pipes_per_subport;
+		  sp = vec_elt_at_index (port->subports, subport);
+
+		  sp->active_pipes = clib_bitmap_set (
+		    sp->active_pipes, pipe_index - sp->first_pipe, 1);
+		  port->active_subports =
+		    clib_bitmap_set (port->active_subports, subport, 1);
+		  port->n_active_pipes++;
+		}
+	    }
+	}
+
+      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE) &&
+			 (b[0]->flags & VLIB_BUFFER_IS_TRACED)))
+	{
+	  hqos_enqueue_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->sw_if_index = sw_if_index;
+	  t->pipe = pipe_index;
+	  t->queue = queue;
+	  t->is_handoff = is_handoff;
+	  t->is_drop = is_drop;
+	}
+
+      from++;
+      b++;
+      n_left--;
+    }
+
+  if (n_handoff)
+    {
+      u32 n_handed;
+
+      n_handed = vlib_buffer_enqueue_to_thread (
+	vm, node, hm->frame_queue_index, handoff, threads, n_handoff, 1);
+      if (n_handed < n_handoff)
+	vlib_node_increment_counter (vm, node->node_index,
+				     HQOS_ERROR_CONGESTION_DROP,
+				     n_handoff - n_handed);
+    }
+
+  if (n_drops)
+    vlib_buffer_free (vm, drops, n_drops);
+
+  vlib_node_increment_counter (vm, node->node_index, HQOS_ERROR_ENQUEUED,
+			       n_enq);
+  if (n_full)
+    vlib_node_increment_counter (vm, node->node_index, HQOS_ERROR_QUEUE_FULL,
+				 n_full);
+  if (n_no_port)
+    vlib_node_increment_counter (vm, node->node_index, HQOS_ERROR_NO_PORT,
+				 n_no_port);
+
+  return frame->n_vectors;
+}
+
+#ifndef CLIB_MARCH_VARIANT
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (hqos_enqueue_node) = {
+  .name = "hqos-enqueue",
+  .vector_size = sizeof (u32),
+  .format_trace = format_hqos_enqueue_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+
+  .n_errors = ARRAY_LEN (hqos_error_strings),
+  .error_strings = hqos_error_strings,
+
+  .n_next_nodes = 1,
+  .next_nodes = {
+    [0] = "error-drop",
+  },
+};
+/* *INDENT-ON* */
+#endif /* CLIB_MARCH_VARIANT */
+
+typedef struct
+{
+  u32 sw_if_index;
+} hqos_sched_trace_t;
+
+#ifndef CLIB_MARCH_VARIANT
+static u8 *
+format_hqos_sched_trace (u8 *s, va_list *args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  hqos_sched_trace_t *t = va_arg (*args, hqos_sched_trace_t *);
+
+  return format (s, "HQOS-SCHED: sw_if_index %d", t->sw_if_index);
+}
+#endif /* CLIB_MARCH_VARIANT */
+
+/*
+ * Dequeue head packet of a queue if every shaper on its path has
+ * enough tokens. Returns 0 if the queue is empty or shaped.
+ */
+static_always_inline int
+hqos_queue_dequeue (vlib_main_t *vm, hqos_port_t *port, hqos_subport_t *sp,
+		    hqos_pipe_t *pipe, hqos_pipe_profile_t *pp, u32 tc,
+		    u32 queue, u32 *bi)
+{
+  hqos_queue_t *q = pipe->queues + queue;
+  vlib_buffer_t *b;
+  u32 n_bytes;
+
+  if (q->n_elts == 0)
+    return 0;
+
+  b = vlib_get_buffer (vm, q->buffers[q->head]);
+  n_bytes = vlib_buffer_length_in_chain (vm, b) + port->frame_overhead;
+
+  if (!hqos_tb_has_tokens (&port->tb, &port->tb_params, n_bytes) ||
+      !hqos_tb_has_tokens (&sp->tb, &sp->tb_params, n_bytes) ||
+      !hqos_tb_has_tokens (&pipe->tb, &pp->tb, n_bytes) ||
+      !hqos_tb_has_tokens (pipe->tc_tb + tc, pp->tc_tb + tc, n_bytes))
+    return 0;
+
+  hqos_tb_consume (&port->tb, &port->tb_params, n_bytes);
+  hqos_tb_consume (&sp->tb, &sp->tb_params, n_bytes);
+  hqos_tb_consume (&pipe->tb, &pp->tb, n_bytes);
+  hqos_tb_consume (pipe->tc_tb + tc, pp->tc_tb + tc, n_bytes);
+
+  *bi = hqos_queue_deq (q, port->queue_size);
+  q->n_deq++;
+  q->n_deq_bytes += n_bytes;
+  sp->n_deq++;
+  sp->n_deq_bytes += n_bytes;
+  return 1;
+}
+
+/* Serve one pipe, returns number of packets dequeued */
+static_always_inline u32
+hqos_pipe_dequeue (vlib_main_t *vm, hqos_port_t *port, hqos_subport_t *sp,
+		   hqos_pipe_t *pipe, f64 now, u32 *to, u32 n_max)
+{
+  hqos_pipe_profile_t *pp = port->pipe_profiles + pipe->profile_index;
+  u32 n = 0, tc, i;
+
+  hqos_tb_update (&pipe->tb, &pp->tb, now);
+  for (tc = 0; tc < HQOS_N_TC; tc++)
+    hqos_tb_update (pipe->tc_tb + tc, pp->tc_tb + tc, now);
+
+  /* strict priority between traffic classes */
+  for (tc = 0; tc < HQOS_BE_TC && n < n_max; tc++)
+    while (n < n_max &&
+	   hqos_queue_dequeue (vm, port, sp, pipe, pp, tc, tc, to + n))
+      n++;
+
+  /* weighted round-robin between best-effort queues */
+  for (i = 0; i < HQOS_N_BE_QUEUES && n < n_max;)
+    {
+      u32 queue = HQOS_BE_QUEUE0 + pipe->wrr_queue;
+
+      if (pipe->wrr_credit && pipe->queues[queue].n_elts)
+	{
+	  /* all best-effort queues share the same shapers */
+	  if (!hqos_queue_dequeue (vm, port, sp, pipe, pp, HQOS_BE_TC, queue,
+				   to + n))
+	    break;
+	  n++;
+	  pipe->wrr_credit--;
+	  i = 0;
+	  continue;
+	}
+
+      pipe->wrr_queue = (pipe->wrr_queue + 1) % HQOS_N_BE_QUEUES;
+      pipe->wrr_credit = pp->wrr_weights[pipe->wrr_queue];
+      i++;
+    }
+
+  pipe->n_buffered -= n;
+  return n;
+}
+
+/*
+ * Hand a burst straight to the interface tx node. The packets have already
+ * been through interface-output, so fill in the tx frame scalar from the
+ * queue assigned to this thread, as interface-output would have done.
+ */
+static_always_inline void
+hqos_port_enqueue_to_tx (vlib_main_t *vm, vlib_node_runtime_t *node,
+			 hqos_port_t *port, u32 *buffers, u32 n)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_hw_interface_t *hi;
+  vnet_hw_if_output_node_runtime_t *r = 0;
+  vnet_hw_if_tx_frame_t *tf;
+  vlib_frame_t *f;
+
+  hi = vnet_get_sup_hw_interface (vnm, port->sw_if_index);
+  if (hi->output_node_thread_runtimes)
+    r = vec_elt_at_index (hi->output_node_thread_runtimes, vm->thread_index);
+
+  if (r && r->n_queues == 0)
+    {
+      /* errors are counted on hqos-enqueue, sched has none of its own */
+      vlib_error_drop_buffers (vm, node, buffers, 1, n, 0,
+			       hqos_enqueue_node.index,
+			       HQOS_ERROR_NO_TX_QUEUE);
+      return;
+    }
+
+  f = vlib_get_frame_to_node (vm, hi->tx_node_index);
+  tf = vlib_frame_scalar_args (f);
+  if (r)
+    clib_memcpy_fast (tf, r->frame, sizeof (*tf));
+  else
+    clib_memset (tf, 0, sizeof (*tf));
+
+  vlib_buffer_copy_indices (vlib_frame_vector_args (f), buffers, n);
+  f->n_vectors = n;
+  vlib_put_frame_to_node (vm, hi->tx_node_index, f);
+}
+
+static_always_inline u32
+hqos_port_dequeue (vlib_main_t *vm, vlib_node_runtime_t *node,
+		   hqos_port_t *port, f64 now)
+{
+  u32 to[VLIB_FRAME_SIZE], n = 0, n_idle = 0;
+
+  if (port->n_buffered == 0)
+    return 0;
+
+  hqos_tb_update (&port->tb, &port->tb_params, now);
+
+  /* stop after a full round in which no pipe could send */
+  while (n < VLIB_FRAME_SIZE && port->n_active_pipes &&
+	 n_idle < port->n_active_pipes)
+    {
+      hqos_subport_t *sp;
+      hqos_pipe_t *pipe;
+      uword si, pi;
+      u32 n_pipe;
+
+      si = clib_bitmap_next_set (port->active_subports, port->next_subport);
+      if (si == ~0)
+	si = clib_bitmap_first_set (port->active_subports);
+      sp = vec_elt_at_index (port->subports, si);
+
+      pi = clib_bitmap_next_set (sp->active_pipes, sp->next_pipe);
+      if (pi == ~0)
+	pi = clib_bitmap_first_set (sp->active_pipes);
+
+      hqos_tb_update (&sp->tb, &sp->tb_params, now);
+      pipe = vec_elt_at_index (port->pipes, sp->first_pipe + pi);
+      n_pipe = hqos_pipe_dequeue (vm, port, sp, pipe, now, to + n,
+				  clib_min (HQOS_PIPE_BURST,
+					    VLIB_FRAME_SIZE - n));
+      n += n_pipe;
+      n_idle = n_pipe ? 0 : n_idle + 1;
+
+      if (pipe->n_buffered == 0)
+	{
+	  sp->active_pipes = clib_bitmap_set (sp->active_pipes, pi, 0);
+	  if (clib_bitmap_is_zero (sp->active_pipes))
+	    port->active_subports =
+	      clib_bitmap_set (port->active_subports, si, 0);
+	  port->n_active_pipes--;
+	}
+
+      sp->next_pipe = pi + 1;
+      port->next_subport = si + 1;
+    }
+
+  if (n == 0)
+    return 0;
+
+  port->n_buffered -= n;
+
+  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
+    {
+      u32 i;
+      for (i = 0; i < n; i++)
+	{
+	  vlib_buffer_t *b = vlib_get_buffer (vm, to[i]);
+	  if (b->flags & VLIB_BUFFER_IS_TRACED)
+	    {
+	      hqos_sched_trace_t *t = vlib_add_trace (vm, node, b, sizeof (*t));
+	      t->sw_if_index = port->sw_if_index;
+	    }
+	}
+    }
+
+  hqos_port_enqueue_to_tx (vm, node, port, to, n);
+  return n;
+}
+
+VLIB_NODE_FN (hqos_sched_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  hqos_main_t *hm = &hqos_main;
+  u32 *pi, *ports, n = 0;
+  f64 now;
+
+  if (vm->thread_index >= vec_len (hm->ports_by_thread))
+    return 0;
+
+  ports = hm->ports_by_thread[vm->thread_index];
+  now = vlib_time_now (vm);
+
+  vec_foreach (pi, ports)
+    n += hqos_port_dequeue (vm, node, pool_elt_at_index (hm->ports, pi[0]),
+			    now);
+
+  return n;
+}
+
+#ifndef CLIB_MARCH_VARIANT
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (hqos_sched_node) = {
+  .name = "hqos-sched",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+  .format_trace = format_hqos_sched_trace,
+
+  .n_next_nodes = 1,
+  .next_nodes = {
+    [0] = "error-drop",
+  },
+};
+/* *INDENT-ON* */
+#endif /* CLIB_MARCH_VARIANT */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -148,6 +148,7 @@ start_send_data (hcs_session_t *hs, http_status_code_t status)
   msg.type = HTTP_MSG_REPLY;
   msg.code = status;
   msg.content_type = HTTP_CONTENT_TEXT_HTML;
+  msg.content_encoding = HTTP_CONTENT_ENCODING_IDENTITY;
   msg.data.type = HTTP_MSG_DATA_INLINE;
   msg.data.len = vec_len (hs->tx_buf);
 
@@ -0,0 +1,624 @@
+/*
+ * http_client.c - vpp built-in http load generator
+ *
+ * Copyright (c) 2017-2022 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/session/application.h>
+#include <vnet/session/application_interface.h>
+#include <vnet/session/session.h>
+#include <vlibmemory/api.h>
+
+/*
+ * Opens a number of tcp sessions to an http server and issues GET requests
+ * on each of them, keeping up to pipeline requests in flight per session.
+ * Reports requests per second once all sessions completed their requests.
+ */
+
+#define HCC_MAX_HDRS_LEN (8 << 10)
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  session_handle_t vpp_session_handle;
+  u32 n_sent;	 /**< requests sent */
+  u32 n_done;	 /**< replies received */
+  u32 body_left; /**< bytes of the current reply body not yet received */
+  u8 is_closed;
+} hcc_session_t;
+
+typedef struct
+{
+  hcc_session_t *sessions;
+  u8 *rx_buf;
+  u64 n_errors;
+} hcc_worker_t;
+
+typedef enum
+{
+  HCC_EVT_CONNECTED = 1,
+  HCC_EVT_DONE,
+  HCC_EVT_FAILED,
+} hcc_cli_evt_t;
+
+typedef struct
+{
+  hcc_worker_t *wrk;
+  u32 app_index;
+  u32 cli_node_index;
+  vlib_main_t *vlib_main;
+  u8 attached;
+  u8 barrier_acq_needed;
+  volatile u32 n_ready;
+  volatile u32 n_finished;
+
+  /*
+   * Config
+   */
+  u8 *uri;
+  u8 *appns_id;
+  u64 appns_secret;
+  session_endpoint_cfg_t connect_sep;
+  u8 *path;
+  u8 *req;
+  u32 n_sessions;
+  u32 n_requests;
+  u32 pipeline;
+  u32 fifo_size;
+  u64 private_segment_size;
+  f64 syn_timeout;
+  f64 test_timeout;
+} hcc_main_t;
+
+static hcc_main_t hcc_main;
+
+static void
+hcc_signal_cli_i (int *code)
+{
+  hcc_main_t *hcm = &hcc_main;
+  vlib_process_signal_event (hcm->vlib_main, hcm->cli_node_index, *code, 0);
+}
+
+static void
+hcc_signal_cli (int code)
+{
+  if (vlib_get_thread_index () != 0)
+    vl_api_rpc_call_main_thread (hcc_signal_cli_i, (u8 *) &code,
+				 sizeof (code));
+  else
+    hcc_signal_cli_i (&code);
+}
+
+static inline hcc_worker_t *
+hcc_worker_get (u32 thread_index)
+{
+  return vec_elt_at_index (hcc_main.wrk, thread_index);
+}
+
+static void
+hcc_session_finish (hcc_session_t *hs)
+{
+  hcc_main_t *hcm = &hcc_main;
+  vnet_disconnect_args_t a = {
+    .handle = hs->vpp_session_handle,
+    .app_index = hcm->app_index,
+  };
+
+  if (hs->is_closed)
+    return;
+
+  hs->is_closed = 1;
+  vnet_disconnect_session (&a);
+
+  if (clib_atomic_add_fetch (&hcm->n_finished, 1) == hcm->n_sessions)
+    hcc_signal_cli (HCC_EVT_DONE);
+}
+
+static void
+hcc_send_requests (hcc_session_t *hs, session_t *s, u32 n_reqs)
+{
+  hcc_main_t *hcm = &hcc_main;
+  u32 req_len = vec_len (hcm->req);
+  int rv, n_sent = 0;
+
+  n_reqs = clib_min (n_reqs, hcm->n_requests - hs->n_sent);
+  n_reqs = clib_min (n_reqs, svm_fifo_max_enqueue_prod (s->tx_fifo) / req_len);
+
+  while (n_sent < n_reqs)
+    {
+      rv = svm_fifo_enqueue (s->tx_fifo, req_len, hcm->req);
+      if (rv != req_len)
+	break;
+      n_sent++;
+    }
+
+  if (!n_sent)
+    return;
+
+  hs->n_sent += n_sent;
+  if (svm_fifo_set_event (s->tx_fifo))
+    session_send_io_evt_to_thread (s->tx_fifo, SESSION_IO_EVT_TX);
+}
+
+/**
+ * Parse reply headers at the head of the rx fifo. Returns the number of
+ * header bytes, 0 if the headers are incomplete and -1 on error.
+ */
+static int
+hcc_parse_reply_headers (hcc_worker_t *wrk, hcc_session_t *hs, session_t *s)
+{
+  u32 max_deq, i, cl = 0, line;
+  u8 *buf;
+  int n;
+
+  max_deq = svm_fifo_max_dequeue_cons (s->rx_fifo);
+  n = clib_min (max_deq, HCC_MAX_HDRS_LEN);
+  vec_validate (wrk->rx_buf, n - 1);
+  buf = wrk->rx_buf;
+  n = svm_fifo_peek (s->rx_fifo, 0, n, buf);
+
+  for (i = 0; i + 3 < n; i++)
+    if (buf[i] == '\r' && !memcmp (buf + i, "\r\n\r\n", 4))
+      break;
+
+  if (i + 3 >= n)
+    return n == HCC_MAX_HDRS_LEN ? -1 : 0;
+
+  if (i < 12 || memcmp (buf, "HTTP/1.", 7) || memcmp (buf + 8, " 200", 4))
+    return -1;
+
+  for (line = 0; line < i; line++)
+    {
+      if (buf[line] != '\n' || i - line < 16)
+	continue;
+      if (!strncasecmp ((char *) buf + line + 1, "content-length:", 15))
+	{
+	  u8 *p = buf + line + 16;
+	  while (*p == ' ')
+	    p++;
+	  while (*p >= '0' && *p <= '9')
+	    cl = cl * 10 + *p++ - '0';
+	  break;
+	}
+    }
+
+  hs->body_left = cl;
+  return i + 4;
+}
+
+static int
+hcc_session_rx_callback (session_t *s)
+{
+  hcc_main_t *hcm = &hcc_main;
+  u32 max_deq, n_done = 0, n;
+  hcc_session_t *hs;
+  hcc_worker_t *wrk;
+  int rv;
+
+  wrk = hcc_worker_get (s->thread_index);
+  hs = pool_elt_at_index (wrk->sessions, s->opaque);
+
+  if (hs->is_closed)
+    {
+      svm_fifo_dequeue_drop_all (s->rx_fifo);
+      return 0;
+    }
+
+  while ((max_deq = svm_fifo_max_dequeue_cons (s->rx_fifo)))
+    {
+      if (hs->body_left)
+	{
+	  n = clib_min (max_deq, hs->body_left);
+	  svm_fifo_dequeue_drop (s->rx_fifo, n);
+	  hs->body_left -= n;
+	  if (hs->body_left)
+	    break;
+	  n_done++;
+	  continue;
+	}
+
+      rv = hcc_parse_reply_headers (wrk, hs, s);
+      if (rv == 0)
+	break;
+      if (rv < 0)
+	{
+	  wrk->n_errors++;
+	  hcc_session_finish (hs);
+	  return 0;
+	}
+      svm_fifo_dequeue_drop (s->rx_fifo, rv);
+      if (!hs->body_left)
+	n_done++;
+    }
+
+  if (svm_fifo_is_empty_cons (s->rx_fifo))
+    svm_fifo_unset_event (s->rx_fifo);
+
+  hs->n_done += n_done;
+  if (hs->n_done >= hcm->n_requests)
+    {
+      hcc_session_finish (hs);
+      return 0;
+    }
+
+  /* Keep the pipeline full */
+  hcc_send_requests (hs, s, hcm->pipeline - (hs->n_sent - hs->n_done));
+
+  return 0;
+}
+
+static int
+hcc_session_connected_callback (u32 app_index, u32 api_context, session_t *s,
+				session_error_t err)
+{
+  hcc_main_t *hcm = &hcc_main;
+  hcc_session_t *hs;
+  hcc_worker_t *wrk;
+
+  if (err)
+    {
+      clib_warning ("connection %u failed: %U", api_context,
+		    format_session_error, err);
+      hcc_signal_cli (HCC_EVT_FAILED);
+      return 0;
+    }
+
+  wrk = hcc_worker_get (s->thread_index);
+  pool_get_zero (wrk->sessions, hs);
+  hs->vpp_session_handle = session_handle (s);
+  s->opaque = hs - wrk->sessions;
+
+  hcc_send_requests (hs, s, hcm->pipeline);
+
+  if (clib_atomic_add_fetch (&hcm->n_ready, 1) == hcm->n_sessions)
+    hcc_signal_cli (HCC_EVT_CONNECTED);
+
+  return 0;
+}
+
+static void
+hcc_session_disconnect_callback (session_t *s)
+{
+  hcc_session_t *hs;
+  hcc_worker_t *wrk;
+
+  wrk = hcc_worker_get (s->thread_index);
+  hs = pool_elt_at_index (wrk->sessions, s->opaque);
+  if (!hs->is_closed)
+    wrk->n_errors++;
+  hcc_session_finish (hs);
+}
+
+static void
+hcc_session_reset_callback (session_t *s)
+{
+  hcc_session_disconnect_callback (s);
+}
+
+static int
+hcc_session_accept_callback (session_t *s)
+{
+  return -1;
+}
+
+static int
+hcc_add_segment_callback (u32 client_index, u64 segment_handle)
+{
+  return 0;
+}
+
+static session_cb_vft_t hcc_session_cb_vft = {
+  .session_connected_callback = hcc_session_connected_callback,
+  .session_accept_callback = hcc_session_accept_callback,
+  .session_disconnect_callback = hcc_session_disconnect_callback,
+  .session_reset_callback = hcc_session_reset_callback,
+  .builtin_app_rx_callback = hcc_session_rx_callback,
+  .add_segment_callback = hcc_add_segment_callback,
+};
+
+static clib_error_t *
+hcc_attach (void)
+{
+  hcc_main_t *hcm = &hcc_main;
+  vnet_app_attach_args_t _a, *a = &_a;
+  u64 options[APP_OPTIONS_N_OPTIONS];
+  int rv;
+
+  clib_memset (a, 0, sizeof (*a));
+  clib_memset (options, 0, sizeof (options));
+
+  a->api_client_index = ~0;
+  a->name = format (0, "http_client");
+  a->session_cb_vft = &hcc_session_cb_vft;
+  a->options = options;
+  a->options[APP_OPTIONS_SEGMENT_SIZE] = hcm->private_segment_size;
+  a->options[APP_OPTIONS_ADD_SEGMENT_SIZE] = hcm->private_segment_size;
+  a->options[APP_OPTIONS_RX_FIFO_SIZE] = hcm->fifo_size;
+  a->options[APP_OPTIONS_TX_FIFO_SIZE] = hcm->fifo_size;
+  a->options[APP_OPTIONS_FLAGS] = APP_OPTIONS_FLAGS_IS_BUILTIN;
+  if (hcm->appns_id)
+    {
+      a->options[APP_OPTIONS_NAMESPACE_SECRET] = hcm->appns_secret;
+      a->namespace_id = hcm->appns_id;
+    }
+
+  if ((rv = vnet_application_attach (a)))
+    return clib_error_return (0, "attach returned %d", rv);
+
+  hcm->app_index = a->app_index;
+  hcm->attached = 1;
+  vec_free (a->name);
+
+  return 0;
+}
+
+static void
+hcc_detach (void)
+{
+  hcc_main_t *hcm = &hcc_main;
+  vnet_app_detach_args_t _da, *da = &_da;
+
+  if (!hcm->attached)
+    return;
+
+  da->app_index = hcm->app_index;
+  da->api_client_index = ~0;
+  vnet_application_detach (da);
+  hcm->attached = 0;
+}
+
+static clib_error_t *
+hcc_connect (vlib_main_t *vm)
+{
+  hcc_main_t *hcm = &hcc_main;
+  vnet_connect_args_t _a = {}, *a = &_a;
+  clib_error_t *error = 0;
+  u32 i;
+  int rv;
+
+  clib_memcpy (&a->sep_ext, &hcm->connect_sep, sizeof (hcm->connect_sep));
+  a->app_index = hcm->app_index;
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  for (i = 0; i < hcm->n_sessions; i++)
+    {
+      a->api_context = i;
+      if ((rv = vnet_connect (a)))
+	{
+	  error = clib_error_return (0, "connect returned: %d", rv);
+	  break;
+	}
+
+      /* Crude pacing for call setups */
+      if ((i % 16) == 15)
+	{
+	  vlib_worker_thread_barrier_release (vm);
+	  vlib_process_suspend (vm, 50e-6);
+	  vlib_worker_thread_barrier_sync (vm);
+	}
+    }
+
+  vlib_worker_thread_barrier_release (vm);
+
+  return error;
+}
+
+static void
+hcc_cleanup (hcc_main_t *hcm)
+{
+  hcc_worker_t *wrk;
+
+  vec_foreach (wrk, hcm->wrk)
+    {
+      pool_free (wrk->sessions);
+      vec_free (wrk->rx_buf);
+    }
+  vec_free (hcm->wrk);
+  vec_free (hcm->uri);
+  vec_free (hcm->appns_id);
+  vec_free (hcm->path);
+  vec_free (hcm->req);
+
+  if (hcm->barrier_acq_needed)
+    vlib_worker_thread_barrier_sync (hcm->vlib_main);
+}
+
+static clib_error_t *
+hcc_command_fn (vlib_main_t *vm, unformat_input_t *input,
+		vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  char *default_uri = "tcp://6.0.1.1/80";
+  hcc_main_t *hcm = &hcc_main;
+  uword *event_data = 0, event_type;
+  clib_error_t *error = 0;
+  u64 n_reqs = 0, n_errors = 0;
+  f64 start, delta;
+  hcc_worker_t *wrk;
+  int rv;
+
+  if (hcm->attached)
+    return clib_error_return (0, "failed: already running!");
+
+  hcm->n_sessions = 1;
+  hcm->n_requests = 1000;
+  hcm->pipeline = 1;
+  hcm->fifo_size = 64 << 10;
+  hcm->private_segment_size = 256 << 20;
+  hcm->syn_timeout = 20.0;
+  hcm->test_timeout = 20.0;
+  hcm->n_ready = 0;
+  hcm->n_finished = 0;
+  hcm->barrier_acq_needed = 0;
+  hcm->appns_secret = 0;
+
+  if (unformat_user (input, unformat_line_input, line_input))
+    {
+      while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+	{
+	  if (unformat (line_input, "uri %s", &hcm->uri))
+	    ;
+	  else if (unformat (line_input, "path %s", &hcm->path))
+	    ;
+	  else if (unformat (line_input, "sessions %u", &hcm->n_sessions))
+	    ;
+	  else if (unformat (line_input, "requests %u", &hcm->n_requests))
+	    ;
+	  else if (unformat (line_input, "pipeline %u", &hcm->pipeline))
+	    ;
+	  else if (unformat (line_input, "fifo-size %u", &hcm->fifo_size))
+	    hcm->fifo_size <<= 10;
+	  else if (unformat (line_input, "private-segment-size %U",
+			     unformat_memory_size,
+			     &hcm->private_segment_size))
+	    ;
+	  else if (unformat (line_input, "appns %_%v%_", &hcm->appns_id))
+	    ;
+	  else if (unformat (line_input, "secret %lu", &hcm->appns_secret))
+	    ;
+	  else if (unformat (line_input, "syn-timeout %f", &hcm->syn_timeout))
+	    ;
+	  else if (unformat (line_input, "test-timeout %f",
+			     &hcm->test_timeout))
+	    ;
+	  else
+	    {
+	      error = clib_error_return (0, "unknown input `%U'",
+					 format_unformat_error, line_input);
+	      unformat_free (line_input);
+	      goto cleanup;
+	    }
+	}
+      unformat_free (line_input);
+    }
+
+  if (!hcm->n_sessions || !hcm->n_requests || !hcm->pipeline)
+    {
+      error = clib_error_return (0, "sessions, requests and pipeline must "
+				    "be non-zero");
+      goto cleanup;
+    }
+
+  if (!hcm->uri)
+    hcm->uri = format (0, "%s", default_uri);
+  vec_add1 (hcm->uri, 0);
+
+  if ((rv = parse_uri ((char *) hcm->uri, &hcm->connect_sep)))
+    {
+      error = clib_error_return (0, "uri parse error: %d", rv);
+      goto cleanup;
+    }
+
+  vec_add1 (hcm->path, 0);
+  hcm->req = format (0, "GET %s%s HTTP/1.1\r\nHost: %U\r\n\r\n",
+		     hcm->path[0] == '/' ? "" : "/", hcm->path,
+		     format_ip46_address, &hcm->connect_sep.ip,
+		     hcm->connect_sep.is_ip4 ? IP46_TYPE_IP4 : IP46_TYPE_IP6);
+  if (hcm->pipeline * vec_len (hcm->req) > hcm->fifo_size)
+    {
+      error = clib_error_return (0, "pipeline does not fit in tx fifo");
+      goto cleanup;
+    }
+
+  hcm->cli_node_index = vlib_get_current_process (vm)->node_runtime.node_index;
+  hcm->vlib_main = vm;
+  vec_validate (hcm->wrk, vlib_num_workers ());
+
+  if (vlib_num_workers () && vlib_thread_is_main_w_barrier ())
+    {
+      hcm->barrier_acq_needed = 1;
+      vlib_worker_thread_barrier_release (vm);
+    }
+
+  vlib_worker_thread_barrier_sync (vm);
+  vnet_session_enable_disable (vm, 1 /* turn on session and transports */);
+  vlib_worker_thread_barrier_release (vm);
+
+  if ((error = hcc_attach ()))
+    goto cleanup;
+
+  start = vlib_time_now (vm);
+  if ((error = hcc_connect (vm)))
+    goto cleanup;
+
+  vlib_process_wait_for_event_or_clock (vm, hcm->syn_timeout);
+  event_type = vlib_process_get_events (vm, &event_data);
+  if (event_type == HCC_EVT_CONNECTED)
+    {
+      vlib_process_wait_for_event_or_clock (vm, hcm->test_timeout);
+      event_type = vlib_process_get_events (vm, &event_data);
+    }
+
+  delta = vlib_time_now (vm) - start;
+
+  switch (event_type)
+    {
+    case HCC_EVT_DONE:
+      break;
+    case HCC_EVT_FAILED:
+      error = clib_error_return (0, "failed: connect error");
+      goto cleanup;
+    case ~0:
+      error = clib_error_return (0, "failed: timeout with %u sessions up, "
+				    "%u finished", hcm->n_ready,
+				 hcm->n_finished);
+      goto cleanup;
+    default:
+      error = clib_error_return (0, "failed: unexpected event %d",
+				 event_type);
+      goto cleanup;
+    }
+
+  vec_foreach (wrk, hcm->wrk)
+    {
+      hcc_session_t *hs;
+      pool_foreach (hs, wrk->sessions)
+	n_reqs += hs->n_done;
+      n_errors += wrk->n_errors;
+    }
+
+  vlib_cli_output (vm, "%u sessions, pipeline %u: %lu replies in %.3fs, "
+		   "%.2f requests/s, %lu errors", hcm->n_sessions,
+		   hcm->pipeline, n_reqs, delta, (f64) n_reqs / delta,
+		   n_errors);
+
+cleanup:
+
+  /* Let pending disconnects go through before detaching */
+  vlib_process_wait_for_event_or_clock (vm, 10e-3);
+  vec_free (event_data);
+  hcc_detach ();
+  hcc_cleanup (hcm);
+
+  return error;
+}
+
+VLIB_CLI_COMMAND (hcc_command, static) = {
+  .path = "test http clients",
+  .short_help = "test http clients [uri <tcp://ip/port>] [path <path>] "
+		"[sessions <n>] [requests <n>] [pipeline <n>] "
+		"[fifo-size <nKB>] [private-segment-size <nMG>] "
+		"[appns <id> secret <n>] [syn-timeout <s>] [test-timeout <s>]",
+  .function = hcc_command_fn,
+  .is_mp_safe = 1,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
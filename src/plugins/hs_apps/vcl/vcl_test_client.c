@@ -49,6 +49,7 @@ typedef struct
   vcl_test_t post_test;
   uint8_t proto;
   uint8_t incremental_stats;
+  uint8_t zero_copy;
   uint32_t n_workers;
   volatile int active_workers;
   volatile int test_running;
@@ -312,13 +313,57 @@ vtc_inc_stats_check (vcl_test_session_t *ts)
     }
 }
 
+#define VTC_ZC_MAX_SEGS 4
+
+/**
+ * Reserve tx fifo space and queue a commit for it, without writing the
+ * payload. Unlike @ref vcl_test_write, this avoids the copy into the fifo
+ * and the per write notification to vpp, as all commits are submitted, and
+ * vpp notified, in one batch at the end of a select round.
+ */
+static int
+vtc_zc_write (vcl_test_session_t *ts, vppcom_io_op_t *op)
+{
+  vppcom_data_segment_t ds[VTC_ZC_MAX_SEGS];
+  vcl_test_stats_t *stats = &ts->stats;
+  uint64_t max_bytes;
+  int rv;
+
+  max_bytes = vtc_min (ts->cfg.txbuf_size,
+		       ts->cfg.total_bytes - stats->tx_bytes);
+  stats->tx_xacts++;
+  rv = vppcom_session_reserve_segments (ts->fd, ds, VTC_ZC_MAX_SEGS,
+					max_bytes);
+  if (rv < 0)
+    {
+      if (rv == VPPCOM_EWOULDBLOCK)
+	{
+	  stats->tx_eagain++;
+	  return 0;
+	}
+      vterr ("vppcom_session_reserve_segments()", rv);
+      return rv;
+    }
+  if (rv < max_bytes)
+    stats->tx_incomp++;
+
+  memset (op, 0, sizeof (*op));
+  op->sh = ts->fd;
+  op->op = VPPCOM_IO_OP_COMMIT;
+  op->len = rv;
+  stats->tx_bytes += rv;
+
+  return rv;
+}
+
 static void *
 vtc_worker_loop (void *arg)
 {
   vcl_test_client_main_t *vcm = &vcl_client_main;
   vcl_test_session_t *ctrl = &vcm->ctrl_session;
+  vppcom_io_op_t zc_ops[VCL_TEST_CFG_MAX_TEST_SESS];
   vcl_test_client_worker_t *wrk = arg;
-  uint32_t n_active_sessions;
+  uint32_t n_active_sessions, n_zc_ops;
   fd_set _wfdset, *wfdset = &_wfdset;
   fd_set _rfdset, *rfdset = &_rfdset;
   vcl_test_session_t *ts;
@@ -353,6 +398,7 @@ vtc_worker_loop (void *arg)
       else if (rv == 0)
 	continue;
 
+      n_zc_ops = 0;
       for (i = 0; i < wrk->cfg.num_test_sessions; i++)
 	{
 	  ts = &wrk->sessions[i];
@@ -370,7 +416,14 @@ vtc_worker_loop (void *arg)
 	  if (FD_ISSET (vppcom_session_index (ts->fd), wfdset)
 	      && ts->stats.tx_bytes < ts->cfg.total_bytes)
 	    {
-	      rv = ts->write (ts, ts->txbuf, ts->cfg.txbuf_size);
+	      if (vcm->zero_copy)
+		{
+		  rv = vtc_zc_write (ts, &zc_ops[n_zc_ops]);
+		  if (rv > 0)
+		    n_zc_ops++;
+		}
+	      else
+		rv = ts->write (ts, ts->txbuf, ts->cfg.txbuf_size);
 	      if (rv < 0)
 		{
 		  vtwrn ("vppcom_test_write (%d) failed -- aborting test",
@@ -388,6 +441,20 @@ vtc_worker_loop (void *arg)
 	      n_active_sessions--;
 	    }
 	}
+
+      if (n_zc_ops)
+	{
+	  vppcom_io_submit (zc_ops, n_zc_ops);
+	  rv = vppcom_io_complete (zc_ops, n_zc_ops, 0 /* wait */);
+	  for (i = 0; i < rv; i++)
+	    {
+	      if (zc_ops[i].rv < 0)
+		{
+		  vterr ("vppcom_io_complete()", zc_ops[i].rv);
+		  goto exit;
+		}
+	    }
+	}
     }
 exit:
   vtinf ("Worker %d done ...", wrk->wrk_index);
@@ -690,6 +757,7 @@ print_usage_and_exit (void)
     "  -I <N>           Use N sessions.\n"
     "  -s <N>           Use N sessions.\n"
     "  -S	       	Print incremental stats per session.\n"
+    "  -Z               Zero-copy tx, reserve and commit fifo segments.\n"
     "  -q <n>           QUIC : use N Ssessions on top of n Qsessions\n");
   exit (1);
 }
@@ -701,7 +769,7 @@ vtc_process_opts (vcl_test_client_main_t * vcm, int argc, char **argv)
   int c, v;
 
   opterr = 0;
-  while ((c = getopt (argc, argv, "chnp:w:XE:I:N:R:T:UBV6DLs:q:S")) != -1)
+  while ((c = getopt (argc, argv, "chnp:w:XE:I:N:R:T:UBV6DLs:q:SZ")) != -1)
     switch (c)
       {
       case 'c':
@@ -860,6 +928,10 @@ vtc_process_opts (vcl_test_client_main_t * vcm, int argc, char **argv)
 	vcm->incremental_stats = 1;
 	break;
 
+      case 'Z':
+	vcm->zero_copy = 1;
+	break;
+
       case '?':
 	switch (optopt)
 	  {
@@ -892,6 +964,13 @@ vtc_process_opts (vcl_test_client_main_t * vcm, int argc, char **argv)
       print_usage_and_exit ();
     }
 
+  if (vcm->zero_copy &&
+      (vcm->proto == VPPCOM_PROTO_UDP || vcm->proto == VPPCOM_PROTO_DTLS))
+    {
+      vtwrn ("Zero-copy tx only supported by stream transports!");
+      print_usage_and_exit ();
+    }
+
   ctrl->cfg.num_test_qsessions = vcm->proto != VPPCOM_PROTO_QUIC ? 0 :
     (ctrl->cfg.num_test_sessions + ctrl->cfg.num_test_sessions_perq - 1) /
     ctrl->cfg.num_test_sessions_perq;
@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2021 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Ping-pong latency test for vcl epoll wakeups. Server echoes everything
+ * it receives, client sends one message at a time, waits for the echo with
+ * vppcom_epoll_wait and reports round trip time percentiles. Run the client
+ * with and without -b to compare blocking and busy-poll epoll modes.
+ */
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <hs_apps/vcl/vcl_test.h>
+
+#define VTL_DEFAULT_ITERS	100000
+#define VTL_DEFAULT_WARMUP	1000
+#define VTL_DEFAULT_MSG_SIZE	64
+#define VTL_MAX_MSG_SIZE	(64 << 10)
+#define VTL_MAX_EVENTS		64
+
+typedef struct
+{
+  uint8_t is_server;
+  uint8_t proto;
+  uint8_t is_ip6;
+  uint16_t port;
+  uint32_t n_iters;
+  uint32_t n_warmup;
+  uint32_t msg_size;
+  union
+  {
+    struct in_addr v4;
+    struct in6_addr v6;
+  } addr;
+} vcl_test_latency_main_t;
+
+static vcl_test_latency_main_t vcl_test_latency_main;
+
+static int
+vtl_u64_cmp (const void *a, const void *b)
+{
+  uint64_t x = *(uint64_t *) a, y = *(uint64_t *) b;
+  return x < y ? -1 : x > y;
+}
+
+static inline uint64_t
+vtl_time_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+vtl_endpt_init (vcl_test_latency_main_t *vlm, vppcom_endpt_t *ep)
+{
+  memset (ep, 0, sizeof (*ep));
+  ep->is_ip4 = !vlm->is_ip6;
+  ep->ip = (uint8_t *) &vlm->addr;
+  ep->port = htons (vlm->port);
+}
+
+static int
+vtl_server_run (vcl_test_latency_main_t *vlm)
+{
+  struct epoll_event ev, events[VTL_MAX_EVENTS];
+  int listen_sh, vep_sh, sh, rv, n_evts, i;
+  vppcom_endpt_t ep;
+  uint8_t *buf;
+
+  buf = malloc (VTL_MAX_MSG_SIZE);
+
+  listen_sh = vppcom_session_create (vlm->proto, 1 /* is_nonblocking */);
+  if (listen_sh < 0)
+    vtfail ("vppcom_session_create()", listen_sh);
+
+  vtl_endpt_init (vlm, &ep);
+  rv = vppcom_session_bind (listen_sh, &ep);
+  if (rv < 0)
+    vtfail ("vppcom_session_bind()", rv);
+
+  rv = vppcom_session_listen (listen_sh, 10);
+  if (rv < 0)
+    vtfail ("vppcom_session_listen()", rv);
+
+  vep_sh = vppcom_epoll_create ();
+  if (vep_sh < 0)
+    vtfail ("vppcom_epoll_create()", vep_sh);
+
+  ev.events = EPOLLIN;
+  ev.data.u32 = listen_sh;
+  rv = vppcom_epoll_ctl (vep_sh, EPOLL_CTL_ADD, listen_sh, &ev);
+  if (rv < 0)
+    vtfail ("vppcom_epoll_ctl()", rv);
+
+  printf ("Waiting for connections on port %u ...\n", vlm->port);
+
+  while (1)
+    {
+      n_evts = vppcom_epoll_wait (vep_sh, events, VTL_MAX_EVENTS, -1);
+      if (n_evts < 0)
+	vtfail ("vppcom_epoll_wait()", n_evts);
+
+      for (i = 0; i < n_evts; i++)
+	{
+	  sh = events[i].data.u32;
+	  if (sh == listen_sh)
+	    {
+	      sh = vppcom_session_accept (listen_sh, 0, O_NONBLOCK);
+	      if (sh < 0)
+		continue;
+	      ev.events = EPOLLIN | EPOLLRDHUP;
+	      ev.data.u32 = sh;
+	      vppcom_epoll_ctl (vep_sh, EPOLL_CTL_ADD, sh, &ev);
+	      continue;
+	    }
+
+	  if (events[i].events & (EPOLLHUP | EPOLLRDHUP))
+	    {
+	      vppcom_epoll_ctl (vep_sh, EPOLL_CTL_DEL, sh, 0);
+	      vppcom_session_close (sh);
+	      continue;
+	    }
+
+	  while ((rv = vppcom_session_read (sh, buf, VTL_MAX_MSG_SIZE)) > 0)
+	    {
+	      if (vppcom_session_write (sh, buf, rv) != rv)
+		break;
+	    }
+	}
+    }
+
+  return 0;
+}
+
+static int
+vtl_client_run (vcl_test_latency_main_t *vlm)
+{
+  uint64_t *rtts, t0, sum = 0;
+  vppcom_epoll_stats_t stats;
+  uint32_t i, n_rx, n_total, flags, flags_len;
+  struct epoll_event ev;
+  int sh, vep_sh, rv;
+  vppcom_endpt_t ep;
+  uint8_t *buf;
+
+  buf = calloc (1, vlm->msg_size);
+  n_total = vlm->n_warmup + vlm->n_iters;
+  rtts = calloc (vlm->n_iters, sizeof (uint64_t));
+
+  sh = vppcom_session_create (vlm->proto, 0 /* is_nonblocking */);
+  if (sh < 0)
+    vtfail ("vppcom_session_create()", sh);
+
+  vtl_endpt_init (vlm, &ep);
+  rv = vppcom_session_connect (sh, &ep);
+  if (rv < 0)
+    vtfail ("vppcom_session_connect()", rv);
+
+  /* Connect blocking, but then only wait for data in epoll */
+  flags = O_NONBLOCK;
+  flags_len = sizeof (flags);
+  rv = vppcom_session_attr (sh, VPPCOM_ATTR_SET_FLAGS, &flags, &flags_len);
+  if (rv < 0)
+    vtfail ("vppcom_session_attr()", rv);
+
+  vep_sh = vppcom_epoll_create ();
+  if (vep_sh < 0)
+    vtfail ("vppcom_epoll_create()", vep_sh);
+
+  ev.events = EPOLLIN | EPOLLET;
+  ev.data.u32 = sh;
+  rv = vppcom_epoll_ctl (vep_sh, EPOLL_CTL_ADD, sh, &ev);
+  if (rv < 0)
+    vtfail ("vppcom_epoll_ctl()", rv);
+
+  for (i = 0; i < n_total; i++)
+    {
+      if (i == vlm->n_warmup)
+	vppcom_worker_epoll_stats (&stats, 1 /* clear */);
+
+      t0 = vtl_time_ns ();
+      rv = vppcom_session_write (sh, buf, vlm->msg_size);
+      if (rv != vlm->msg_size)
+	vtfail ("vppcom_session_write()", rv < 0 ? rv : -EIO);
+
+      n_rx = 0;
+      while (n_rx < vlm->msg_size)
+	{
+	  rv = vppcom_epoll_wait (vep_sh, &ev, 1, -1);
+	  if (rv < 0)
+	    vtfail ("vppcom_epoll_wait()", rv);
+	  if (ev.events & (EPOLLHUP | EPOLLRDHUP))
+	    vtfail ("vppcom_epoll_wait()", -ECONNRESET);
+	  while (n_rx < vlm->msg_size)
+	    {
+	      rv = vppcom_session_read (sh, buf, vlm->msg_size - n_rx);
+	      if (rv <= 0)
+		break;
+	      n_rx += rv;
+	    }
+	}
+
+      if (i >= vlm->n_warmup)
+	rtts[i - vlm->n_warmup] = vtl_time_ns () - t0;
+    }
+
+  vppcom_worker_epoll_stats (&stats, 0 /* clear */);
+  vppcom_session_close (sh);
+
+  qsort (rtts, vlm->n_iters, sizeof (uint64_t), vtl_u64_cmp);
+  for (i = 0; i < vlm->n_iters; i++)
+    sum += rtts[i];
+
+#define _pct(_p) (rtts[(uint64_t) (vlm->n_iters - 1) * _p / 1000] / 1e3)
+  printf ("\nRTT for %u round trips of %u bytes (us):\n"
+	  "  min %.2f avg %.2f p50 %.2f p90 %.2f p99 %.2f p99.9 %.2f "
+	  "max %.2f\n",
+	  vlm->n_iters, vlm->msg_size, rtts[0] / 1e3,
+	  sum / 1e3 / vlm->n_iters, _pct (500), _pct (900), _pct (990),
+	  _pct (999), rtts[vlm->n_iters - 1] / 1e3);
+#undef _pct
+
+  printf ("\nEpoll wakeups (busy-poll budget %u us):\n"
+	  "  spin %lu (avg wait %.2f us) pause %lu (avg wait %.2f us)\n"
+	  "  sleep %lu (avg wait %.2f us) timeouts %lu\n",
+	  stats.busy_poll_budget_us, stats.n_spin_wakes,
+	  stats.n_spin_wakes ?
+	    stats.spin_wait_time * 1e6 / stats.n_spin_wakes : 0,
+	  stats.n_pause_wakes,
+	  stats.n_pause_wakes ?
+	    stats.pause_wait_time * 1e6 / stats.n_pause_wakes : 0,
+	  stats.n_sleep_wakes,
+	  stats.n_sleep_wakes ?
+	    stats.sleep_wait_time * 1e6 / stats.n_sleep_wakes : 0,
+	  stats.n_timeouts);
+
+  free (rtts);
+  free (buf);
+  return 0;
+}
+
+static void
+print_usage_and_exit (void)
+{
+  fprintf (stderr,
+	   "vcl_test_latency [OPTIONS] <ipaddr> <port>\n"
+	   "vcl_test_latency -s [OPTIONS] <port>\n"
+	   "  OPTIONS\n"
+	   "  -h               Print this message and exit.\n"
+	   "  -s               Run as echo server.\n"
+	   "  -6               Use IPv6.\n"
+	   "  -p <proto>       Use <proto> transport layer, default tcp.\n"
+	   "  -n <iters>       Number of measured round trips.\n"
+	   "  -w <iters>       Number of warmup round trips.\n"
+	   "  -m <bytes>       Message size.\n"
+	   "  -b <us>          Busy-poll epoll up to <us> before blocking.\n");
+  exit (1);
+}
+
+static void
+vtl_process_opts (vcl_test_latency_main_t *vlm, int argc, char **argv)
+{
+  int c;
+
+  vlm->proto = VPPCOM_PROTO_TCP;
+  vlm->n_iters = VTL_DEFAULT_ITERS;
+  vlm->n_warmup = VTL_DEFAULT_WARMUP;
+  vlm->msg_size = VTL_DEFAULT_MSG_SIZE;
+
+  opterr = 0;
+  while ((c = getopt (argc, argv, "hs6p:n:w:m:b:")) != -1)
+    switch (c)
+      {
+      case 's':
+	vlm->is_server = 1;
+	break;
+      case '6':
+	vlm->is_ip6 = 1;
+	break;
+      case 'p':
+	if (vppcom_unformat_proto (&vlm->proto, optarg))
+	  {
+	    vtwrn ("Invalid vppcom protocol %s!", optarg);
+	    print_usage_and_exit ();
+	  }
+	break;
+      case 'n':
+	if (sscanf (optarg, "%u", &vlm->n_iters) != 1 || !vlm->n_iters)
+	  print_usage_and_exit ();
+	break;
+      case 'w':
+	if (sscanf (optarg, "%u", &vlm->n_warmup) != 1)
+	  print_usage_and_exit ();
+	break;
+      case 'm':
+	if (sscanf (optarg, "%u", &vlm->msg_size) != 1 || !vlm->msg_size ||
+	    vlm->msg_size > VTL_MAX_MSG_SIZE)
+	  print_usage_and_exit ();
+	break;
+      case 'b':
+	/* Must be set before vcl reads its configuration */
+	setenv (VPPCOM_ENV_EPOLL_BUSY_POLL, optarg, 1 /* overwrite */);
+	break;
+      case 'h':
+      default:
+	print_usage_and_exit ();
+      }
+
+  if (vlm->is_server)
+    {
+      if (argc != optind + 1)
+	print_usage_and_exit ();
+      vlm->port = atoi (argv[optind]);
+      return;
+    }
+
+  if (argc != optind + 2)
+    print_usage_and_exit ();
+
+  if (inet_pton (vlm->is_ip6 ? AF_INET6 : AF_INET, argv[optind],
+		 &vlm->addr) != 1)
+    {
+      vtwrn ("Invalid address %s!", argv[optind]);
+      print_usage_and_exit ();
+    }
+  vlm->port = atoi (argv[optind + 1]);
+}
+
+int
+main (int argc, char **argv)
+{
+  vcl_test_latency_main_t *vlm = &vcl_test_latency_main;
+  int rv;
+
+  vtl_process_opts (vlm, argc, argv);
+
+  rv = vppcom_app_create (vlm->is_server ? "vcl_test_latency_server" :
+					   "vcl_test_latency_client");
+  if (rv < 0)
+    vtfail ("vppcom_app_create()", rv);
+
+  if (vlm->is_server)
+    rv = vtl_server_run (vlm);
+  else
+    rv = vtl_client_run (vlm);
+
+  vppcom_app_destroy ();
+  return rv;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -16,10 +16,13 @@
 #include <http/http.h>
 #include <vnet/session/session.h>
 #include <http/http_timer.h>
+#include <vppinfra/random.h>
 
 static http_main_t http_main;
 
 #define HTTP_FIFO_THRESH (16 << 10)
+#define HTTP_MAX_REQ_HDRS_LEN (8 << 10)
+#define HTTP_MAX_REQ_LEN (1 << 20)
 
 const char *http_status_code_str[] = {
 #define _(c, s, str) str,
@@ -33,6 +36,11 @@ const char *http_content_type_str[] = {
 #undef _
 };
 
+const char *http_content_encoding_hdr[] = {
+  [HTTP_CONTENT_ENCODING_IDENTITY] = "",
+  [HTTP_CONTENT_ENCODING_GZIP] = "Content-Encoding: gzip\r\n",
+};
+
 const http_buffer_type_t msg_to_buf_type[] = {
   [HTTP_MSG_DATA_INLINE] = HTTP_BUFFER_FIFO,
   [HTTP_MSG_DATA_PTR] = HTTP_BUFFER_PTR,
@@ -254,8 +262,37 @@ static const char *http_response_template = "HTTP/1.1 200 OK\r\n"
 					    "Expires: %U GMT\r\n"
 					    "Server: VPP Static\r\n"
 					    "Content-Type: %s\r\n"
+					    "%s"
 					    "Content-Length: %d\r\n\r\n";
 
+/**
+ * Notify the transport session of new data in its tx fifo. Transport
+ * sessions are owned by the connection's thread, so the event is added to
+ * the worker's io event list directly instead of going through the message
+ * queue. Events added while the session queue node runs are handled in the
+ * same dispatch, so replies to many sessions are sent in the same frame.
+ */
+static void
+http_ts_program_tx_evt (session_t *ts, session_evt_type_t evt_type)
+{
+  session_worker_t *wrk;
+  session_evt_elt_t *elt;
+
+  if (PREDICT_FALSE (ts->thread_index != vlib_get_thread_index ()))
+    {
+      session_send_io_evt_to_thread (ts->tx_fifo, evt_type);
+      return;
+    }
+
+  wrk = session_main_get_worker (ts->thread_index);
+  elt = session_evt_alloc_new (wrk);
+  elt->evt.session_index = ts->session_index;
+  elt->evt.event_type = evt_type;
+
+  if (PREDICT_FALSE (wrk->state == SESSION_WRK_INTERRUPT))
+    vlib_node_set_interrupt_pending (wrk->vm, session_queue_node.index);
+}
+
 static u32
 send_data (http_conn_t *hc, u8 *data, u32 length, u32 offset)
 {
@@ -273,7 +310,7 @@ send_data (http_conn_t *hc, u8 *data, u32 length, u32 offset)
     return offset;
 
   if (svm_fifo_set_event (ts->tx_fifo))
-    session_send_io_evt_to_thread (ts->tx_fifo, SESSION_IO_EVT_TX);
+    http_ts_program_tx_evt (ts, SESSION_IO_EVT_TX);
 
   return (offset + sent);
 }
@@ -320,27 +357,179 @@ read_request (http_conn_t *hc)
   return 0;
 }
 
+/**
+ * Find @a str in @a vec within [@a offset, @a offset + @a num). Candidate
+ * positions are found by comparing the first character of the needle a
+ * vector at a time, the full needle is only compared on candidates.
+ */
 static int
-v_find_index (u8 *vec, u32 offset, char *str)
+v_find_index (u8 *vec, u32 offset, u32 num, char *str)
 {
-  int start_index = offset;
   u32 slen = (u32) strnlen_s_inline (str, 8);
-  u32 vlen = vec_len (vec);
+  u32 vlen = clib_min (offset + num, vec_len (vec));
+  u8 *p, *end;
 
   ASSERT (slen > 0);
 
-  if (vlen <= slen)
+  if (vlen < slen || offset > vlen - slen)
     return -1;
 
-  for (; start_index < (vlen - slen); start_index++)
+  p = vec + offset;
+  /* first position past the last one where the needle fits */
+  end = vec + vlen - slen + 1;
+
+#if defined(CLIB_HAVE_VEC256)
+  u8x32 first32 = u8x32_splat (str[0]);
+  while (p + 32 <= end)
+    {
+      u8x32 eq = (u8x32) (u8x32_load_unaligned (p) == first32);
+      u32 mask = u8x32_msb_mask (eq);
+      while (mask)
+	{
+	  u8 *c = p + get_lowest_set_bit_index (mask);
+	  if (!memcmp (c, str, slen))
+	    return c - vec;
+	  mask = clear_lowest_set_bit (mask);
+	}
+      p += 32;
+    }
+#endif
+#if defined(CLIB_HAVE_VEC128) && defined(CLIB_HAVE_VEC128_MSB_MASK)
+  u8x16 first16 = u8x16_splat (str[0]);
+  while (p + 16 <= end)
+    {
+      u8x16 eq = (u8x16) (u8x16_load_unaligned (p) == first16);
+      u32 mask = u8x16_msb_mask (eq);
+      while (mask)
+	{
+	  u8 *c = p + get_lowest_set_bit_index (mask);
+	  if (!memcmp (c, str, slen))
+	    return c - vec;
+	  mask = clear_lowest_set_bit (mask);
+	}
+      p += 16;
+    }
+#endif
+
+  for (; p < end; p++)
+    {
+      if (p[0] == str[0] && !memcmp (p, str, slen))
+	return p - vec;
+    }
+
+  return -1;
+}
+
+/**
+ * Look for header @a name in header lines between @a start and @a end.
+ * Returns 0 and the bounds of its value, stripped of surrounding spaces,
+ * in @a val_start and @a val_end if found, -1 otherwise.
+ */
+static int
+http_find_header (u8 *buf, u32 start, u32 end, const char *name,
+		  u32 *val_start, u32 *val_end)
+{
+  u32 name_len = strlen (name);
+  int line_end, colon;
+  u32 pos = start;
+
+  while (pos < end)
     {
-      if (!memcmp (vec + start_index, str, slen))
-	return start_index;
+      line_end = v_find_index (buf, pos, end - pos, "\r\n");
+      if (line_end < 0)
+	break;
+
+      colon = v_find_index (buf, pos, line_end - pos, ":");
+      if (colon >= 0 && colon - pos == name_len &&
+	  !strncasecmp ((char *) buf + pos, name, name_len))
+	{
+	  pos = colon + 1;
+	  while (pos < line_end && buf[pos] == ' ')
+	    pos++;
+	  while (line_end > pos && buf[line_end - 1] == ' ')
+	    line_end--;
+	  *val_start = pos;
+	  *val_end = line_end;
+	  return 0;
+	}
+
+      pos = line_end + 2;
     }
 
   return -1;
 }
 
+/**
+ * Look for Content-Length in header lines between @a start and @a end.
+ * Returns 0 and the value in @a len if found, -1 if the header is not
+ * present and -2 if it is malformed or too large.
+ */
+static int
+http_content_length (u8 *buf, u32 start, u32 end, u32 *len)
+{
+  u32 pos, val_end;
+  u64 val = 0;
+
+  if (http_find_header (buf, start, end, "content-length", &pos, &val_end))
+    return -1;
+
+  if (pos == val_end)
+    return -2;
+
+  for (; pos < val_end; pos++)
+    {
+      if (buf[pos] < '0' || buf[pos] > '9')
+	return -2;
+      val = val * 10 + buf[pos] - '0';
+      if (val > HTTP_MAX_REQ_LEN)
+	return -2;
+    }
+  *len = val;
+
+  return 0;
+}
+
+/**
+ * Pick the content encoding to offer the app from the Accept-Encoding
+ * header between @a start and @a end. Only gzip is of interest, and only
+ * if not refused with a zero weight.
+ */
+static http_content_encoding_t
+http_accept_encoding (u8 *buf, u32 start, u32 end)
+{
+  u32 pos, val_end, tok_end;
+  int comma, q;
+
+  if (http_find_header (buf, start, end, "accept-encoding", &pos, &val_end))
+    return HTTP_CONTENT_ENCODING_IDENTITY;
+
+  while (pos < val_end)
+    {
+      comma = v_find_index (buf, pos, val_end - pos, ",");
+      tok_end = comma < 0 ? val_end : comma;
+
+      while (pos < tok_end && buf[pos] == ' ')
+	pos++;
+      if (tok_end - pos >= 4 && !strncasecmp ((char *) buf + pos, "gzip", 4) &&
+	  (pos + 4 == tok_end || buf[pos + 4] == ' ' || buf[pos + 4] == ';'))
+	{
+	  /* q=0, q=0.000 and the like mean not acceptable */
+	  q = v_find_index (buf, pos, tok_end - pos, "q=");
+	  if (q < 0)
+	    return HTTP_CONTENT_ENCODING_GZIP;
+	  for (q += 2; q < tok_end && (buf[q] == '0' || buf[q] == '.'); q++)
+	    ;
+	  if (q < tok_end && buf[q] != ' ')
+	    return HTTP_CONTENT_ENCODING_GZIP;
+	  break;
+	}
+
+      pos = tok_end + 1;
+    }
+
+  return HTTP_CONTENT_ENCODING_IDENTITY;
+}
+
 /**
  * waiting for request method from peer - parse request method and data
  */
@@ -349,43 +538,76 @@ state_wait_method (http_conn_t *hc, transport_send_params_t *sp)
 {
   http_status_code_t ec;
   app_worker_t *app_wrk;
+  u32 len, req_len, body_len;
+  int i, rv, hdr_end, line_end;
   http_msg_t msg;
   session_t *as;
-  int i, rv;
-  u32 len;
   u8 *buf;
 
   rv = read_request (hc);
 
-  /* Nothing yet, wait for data or timer expire */
-  if (rv)
+  /* Nothing yet, wait for data or timer expire. Pipelined requests left
+   * over from a previous read are served even if no new data arrived */
+  if (rv && !vec_len (hc->rx_buf))
     return 0;
 
-  if (vec_len (hc->rx_buf) < 8)
+  /* Ignore empty lines preceding the request line, rfc7230 3.5 */
+  for (i = 0; i + 1 < vec_len (hc->rx_buf); i += 2)
+    if (hc->rx_buf[i] != '\r' || hc->rx_buf[i + 1] != '\n')
+      break;
+  if (i)
+    vec_delete (hc->rx_buf, i, 0);
+
+  /* Headers may span multiple reads, wait for all of them */
+  hdr_end = v_find_index (hc->rx_buf, 0, vec_len (hc->rx_buf), "\r\n\r\n");
+  if (hdr_end < 0)
     {
-      ec = HTTP_STATUS_BAD_REQUEST;
-      goto error;
+      if (vec_len (hc->rx_buf) > HTTP_MAX_REQ_HDRS_LEN)
+	{
+	  ec = HTTP_STATUS_BAD_REQUEST;
+	  goto error;
+	}
+      return 0;
     }
+  hdr_end += 4;
 
-  if ((i = v_find_index (hc->rx_buf, 0, "GET ")) >= 0)
+  line_end = v_find_index (hc->rx_buf, 0, hdr_end, "\r\n");
+
+  if (!memcmp (hc->rx_buf, "GET ", 4))
     {
       hc->method = HTTP_REQ_GET;
-      hc->rx_buf_offset = i + 5;
+      hc->rx_buf_offset = 5;
 
-      i = v_find_index (hc->rx_buf, hc->rx_buf_offset, "HTTP");
+      i = v_find_index (hc->rx_buf, hc->rx_buf_offset,
+			line_end - hc->rx_buf_offset + 1, " HTTP/");
       if (i < 0)
 	{
 	  ec = HTTP_STATUS_BAD_REQUEST;
 	  goto error;
 	}
 
-      len = i - hc->rx_buf_offset - 1;
+      len = i - hc->rx_buf_offset;
+      req_len = hdr_end;
     }
-  else if ((i = v_find_index (hc->rx_buf, 0, "POST ")) >= 0)
+  else if (hdr_end > 5 && !memcmp (hc->rx_buf, "POST ", 5))
     {
       hc->method = HTTP_REQ_POST;
-      hc->rx_buf_offset = i + 6;
-      len = vec_len (hc->rx_buf) - hc->rx_buf_offset - 1;
+      hc->rx_buf_offset = 6;
+
+      /* Without a length the body is whatever was received so far */
+      rv = http_content_length (hc->rx_buf, line_end + 2, hdr_end, &body_len);
+      if (rv == -2)
+	{
+	  ec = HTTP_STATUS_BAD_REQUEST;
+	  goto error;
+	}
+      req_len = rv ? vec_len (hc->rx_buf) : hdr_end + body_len;
+
+      /* Wait for the rest of the body */
+      if (req_len > vec_len (hc->rx_buf))
+	return 0;
+
+      len = req_len - hc->rx_buf_offset;
     }
   else
     {
@@ -399,6 +621,8 @@ state_wait_method (http_conn_t *hc, transport_send_params_t *sp)
   msg.type = HTTP_MSG_REQUEST;
   msg.method_type = hc->method;
   msg.content_type = HTTP_CONTENT_TEXT_HTML;
+  msg.content_encoding =
+    http_accept_encoding (hc->rx_buf, line_end + 2, hdr_end);
   msg.data.type = HTTP_MSG_DATA_INLINE;
   msg.data.len = len;
 
@@ -415,7 +639,8 @@ state_wait_method (http_conn_t *hc, transport_send_params_t *sp)
       return -1;
     }
 
-  vec_free (hc->rx_buf);
+  /* Keep pipelined requests for when the reply is sent */
+  vec_delete (hc->rx_buf, req_len, 0);
   hc->req_state = HTTP_REQ_STATE_WAIT_APP;
 
   app_wrk = app_worker_get_if_valid (as->app_wrk_index);
@@ -473,6 +698,7 @@ state_wait_app (http_conn_t *hc, transport_send_params_t *sp)
    * - current time
    * - expiration time
    * - content type
+   * - content encoding, if not identity
    * - data length
    */
   now = clib_timebase_now (&hm->timebase);
@@ -483,6 +709,8 @@ state_wait_app (http_conn_t *hc, transport_send_params_t *sp)
 		   format_clib_timebase_time, now + 600.0,
 		   /* Content type */
 		   http_content_type_str[msg.content_type],
+		   /* Content encoding */
+		   http_content_encoding_hdr[msg.content_encoding],
 		   /* Length */
 		   msg.data.len);
 
@@ -540,7 +768,7 @@ state_send_more_data (http_conn_t *hc, transport_send_params_t *sp)
   if (!http_buffer_is_drained (hb))
     {
       if (sent && svm_fifo_set_event (ts->tx_fifo))
-	session_send_io_evt_to_thread (ts->tx_fifo, SESSION_IO_EVT_TX);
+	http_ts_program_tx_evt (ts, SESSION_IO_EVT_TX);
 
       if (svm_fifo_max_enqueue (ts->tx_fifo) < HTTP_FIFO_THRESH)
 	{
@@ -554,11 +782,15 @@ state_send_more_data (http_conn_t *hc, transport_send_params_t *sp)
   else
     {
       if (sent && svm_fifo_set_event (ts->tx_fifo))
-	session_send_io_evt_to_thread (ts->tx_fifo, SESSION_IO_EVT_TX_FLUSH);
+	http_ts_program_tx_evt (ts, SESSION_IO_EVT_TX_FLUSH);
 
       /* Finished transaction, back to HTTP_REQ_STATE_WAIT_METHOD */
       hc->req_state = HTTP_REQ_STATE_WAIT_METHOD;
       http_buffer_free (&hc->tx_buf);
+
+      /* Serve pipelined requests right away */
+      if (vec_len (hc->rx_buf) || svm_fifo_max_dequeue_cons (ts->rx_fifo))
+	return 1;
     }
 
   return 0;
@@ -599,9 +831,10 @@ http_ts_rx_callback (session_t *ts)
 
   hc = http_conn_get_w_thread (ts->opaque, ts->thread_index);
 
+  /* Pipelined request, handled once the reply to the current one is sent */
   if (hc->req_state != HTTP_REQ_STATE_WAIT_METHOD)
     {
-      clib_warning ("tcp data in req state %u", hc->req_state);
+      HTTP_DBG (1, "tcp data in req state %u", hc->req_state);
       return 0;
     }
 
@@ -986,6 +1219,124 @@ http_transport_init (vlib_main_t *vm)
 
 VLIB_INIT_FUNCTION (http_transport_init);
 
+/* Reference for v_find_index, one byte at a time */
+static int
+http_test_find_index_scalar (u8 *vec, u32 offset, u32 num, char *str)
+{
+  u32 slen = strlen (str);
+  u32 vlen = clib_min (offset + num, vec_len (vec));
+  u32 i;
+
+  for (i = offset; i + slen <= vlen; i++)
+    if (!memcmp (vec + i, str, slen))
+      return i;
+  return -1;
+}
+
+/* Every needle the parser looks for, from every offset of every prefix of
+   buf, i.e. from every point a read could have split the stream at, with
+   the search bounded by the prefix or running past it */
+static int
+http_test_find_index (vlib_main_t *vm, u8 *buf)
+{
+  char *needles[] = { "\r\n\r\n", "\r\n", ":", ",", " HTTP/", "q=" };
+  u32 i, k, n, offset, num;
+  u8 *prefix = 0;
+  int rv = 0;
+
+  for (n = 0; n <= vec_len (buf) && !rv; n++)
+    {
+      vec_reset_length (prefix);
+      vec_add (prefix, buf, n);
+
+      for (offset = 0; offset <= n && !rv; offset++)
+	for (k = 0; k < 2 && !rv; k++)
+	  for (i = 0; i < ARRAY_LEN (needles); i++)
+	    {
+	      int v, r;
+
+	      num = n - offset + k * 7;
+	      v = v_find_index (prefix, offset, num, needles[i]);
+	      r = http_test_find_index_scalar (prefix, offset, num,
+					       needles[i]);
+	      if (v != r)
+		{
+		  vlib_cli_output (vm,
+				   "needle %u at %u+%u of %u bytes: "
+				   "vector %d, scalar %d",
+				   i, offset, num, n, v, r);
+		  rv = -1;
+		  break;
+		}
+	    }
+    }
+
+  vec_free (prefix);
+  return rv;
+}
+
+static clib_error_t *
+test_http_parser_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			     vlib_cli_command_t *cmd)
+{
+  char alphabet[] = "\r\n:, HTq=GET/";
+  u32 n_alphabet = ARRAY_LEN (alphabet) - 1;
+  u32 seed = 0xdeadbeef, iterations = 100, i, j;
+  clib_error_t *error = 0;
+  u8 *buf = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "seed %u", &seed))
+	;
+      else if (unformat (input, "iterations %u", &iterations))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  /* pipelined requests, with empty lines between them, a body, headers
+     the parser looks into and a request line longer than a vector */
+  buf = format (buf, "\r\nGET /index.html HTTP/1.1\r\nHost: vpp\r\n"
+		     "Accept-Encoding: deflate, gzip;q=0.5\r\n\r\n"
+		     "\r\n\r\nPOST /form HTTP/1.1\r\nContent-Length: 12\r\n"
+		     "\r\nkey=value\r\n\r\nGET /");
+  for (i = 0; i < 48; i++)
+    vec_add1 (buf, 'a' + i % 26);
+  buf = format (buf, " HTTP/1.1\r\n\r\nGET / HTTP/1.0\r\n\r\n");
+  if (http_test_find_index (vm, buf))
+    {
+      error = clib_error_return (0, "pipelined requests: failed");
+      goto done;
+    }
+
+  /* random streams dense in partial matches */
+  for (i = 0; i < iterations; i++)
+    {
+      vec_reset_length (buf);
+      for (j = random_u32 (&seed) % 100; j > 0; j--)
+	vec_add1 (buf, alphabet[random_u32 (&seed) % n_alphabet]);
+      if (http_test_find_index (vm, buf))
+	{
+	  error = clib_error_return (0, "random stream %u: failed", i);
+	  goto done;
+	}
+    }
+
+  vlib_cli_output (vm, "parser tests passed");
+
+done:
+  vec_free (buf);
+  return error;
+}
+
+VLIB_CLI_COMMAND (test_http_parser_command, static) = {
+  .path = "test http parser",
+  .short_help = "test http parser [seed <n>] [iterations <n>]",
+  .function = test_http_parser_command_fn,
+};
+
 VLIB_PLUGIN_REGISTER () = {
   .version = VPP_BUILD_VER,
   .description = "Hypertext Transfer Protocol (HTTP)",
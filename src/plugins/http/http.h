@@ -92,6 +92,12 @@ typedef enum http_content_type_
 #undef _
 } http_content_type_t;
 
+typedef enum http_content_encoding_
+{
+  HTTP_CONTENT_ENCODING_IDENTITY = 0,
+  HTTP_CONTENT_ENCODING_GZIP,
+} http_content_encoding_t;
+
 #define foreach_http_status_code                                              \
   _ (200, OK, "200 OK")                                                       \
   _ (400, BAD_REQUEST, "400 Bad Request")                                     \
@@ -129,6 +135,8 @@ typedef struct http_msg_
     http_status_code_t code;
   };
   http_content_type_t content_type;
+  /* requests: best encoding the peer accepts, replies: encoding of data */
+  http_content_encoding_t content_encoding;
   http_msg_data_t data;
 } http_msg_t;
 
@@ -17,6 +17,20 @@
 #include <vppinfra/bihash_template.c>
 #include <vppinfra/unix.h>
 #include <vlib/vlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+/*
+ * Lookups and detaches run on all workers without taking the cache lock.
+ * The entry pool is fixed, so a looked up index always points to mapped
+ * memory. A lookup attaches by incrementing inuse with a CAS, which fails
+ * once an eviction has set it to HSS_CACHE_ENTRY_DEAD, and then checks the
+ * generation stored in the hash against the entry's to catch a slot that
+ * was reused meanwhile. Lookups only stamp last_used; the LRU list is
+ * reordered lazily, under the lock, when an eviction finds a tail entry
+ * used since it was put at the head.
+ */
 
 static void
 hss_cache_lock (hss_cache_t *hc)
@@ -46,13 +60,13 @@ lru_validate (hss_cache_t *hc)
     {
       ce = pool_elt_at_index (hc->cache_pool, index);
       /* Timestamps should be smaller (older) as we walk the fwd list */
-      if (ce->last_used > last_timestamp)
+      if (ce->lru_time > last_timestamp)
 	{
-	  clib_warning ("%d[%d]: last used %.6f, last_timestamp %.6f", index,
-			i, ce->last_used, last_timestamp);
+	  clib_warning ("%d[%d]: lru time %.6f, last_timestamp %.6f", index,
+			i, ce->lru_time, last_timestamp);
 	}
       index = ce->next_index;
-      last_timestamp = ce->last_used;
+      last_timestamp = ce->lru_time;
       i++;
     }
 
@@ -61,13 +75,13 @@ lru_validate (hss_cache_t *hc)
     {
       ce = pool_elt_at_index (hc->cache_pool, index);
       /* Timestamps should be larger (newer) as we walk the rev list */
-      if (ce->last_used < last_timestamp)
+      if (ce->lru_time < last_timestamp)
 	{
-	  clib_warning ("%d[%d]: last used %.6f, last_timestamp %.6f", index,
-			i, ce->last_used, last_timestamp);
+	  clib_warning ("%d[%d]: lru time %.6f, last_timestamp %.6f", index,
+			i, ce->lru_time, last_timestamp);
 	}
       index = ce->prev_index;
-      last_timestamp = ce->last_used;
+      last_timestamp = ce->lru_time;
       i++;
     }
 #endif
@@ -137,7 +151,7 @@ lru_add (hss_cache_t *hc, hss_cache_entry_t *ce, f64 now)
   /* single session case: also the tail of the reverse LRU list */
   if (hc->last_index == ~0)
     hc->last_index = ce_index;
-  ce->last_used = now;
+  ce->lru_time = now;
 
   lru_validate (hc);
 }
@@ -151,23 +165,20 @@ lru_update (hss_cache_t *hc, hss_cache_entry_t *ep, f64 now)
   lru_add (hc, ep, now);
 }
 
-static void
-hss_cache_attach_entry (hss_cache_t *hc, u32 ce_index, u8 **data,
-			u64 *data_len)
+/** \brief Take a reference unless the entry has been evicted
+ */
+static inline int
+hss_cache_entry_try_attach (hss_cache_entry_t *ce)
 {
-  hss_cache_entry_t *ce;
+  int inuse = clib_atomic_load_acq_n (&ce->inuse);
 
-  /* Expect ce_index to be validated outside */
-  ce = pool_elt_at_index (hc->cache_pool, ce_index);
-  ce->inuse++;
-  *data = ce->data;
-  *data_len = vec_len (ce->data);
-
-  /* Update the cache entry, mark it in-use */
-  lru_update (hc, ce, vlib_time_now (vlib_get_main ()));
-
-  if (hc->debug_level > 1)
-    clib_warning ("index %d refcnt now %d", ce_index, ce->inuse);
+  while (inuse != HSS_CACHE_ENTRY_DEAD)
+    {
+      if (clib_atomic_cmp_and_swap_acq_relax_n (&ce->inuse, &inuse,
+						inuse + 1, 0 /* weak */))
+	return 1;
+    }
+  return 0;
 }
 
 /** \brief Detach cache entry from session
@@ -176,100 +187,184 @@ void
 hss_cache_detach_entry (hss_cache_t *hc, u32 ce_index)
 {
   hss_cache_entry_t *ce;
+  int inuse;
 
-  hss_cache_lock (hc);
-
-  ce = pool_elt_at_index (hc->cache_pool, ce_index);
-  ce->inuse--;
+  ce = hc->cache_pool + ce_index;
+  inuse = clib_atomic_fetch_sub_rel (&ce->inuse, 1);
+  ASSERT (inuse > 0);
 
   if (hc->debug_level > 1)
-    clib_warning ("index %d refcnt now %d", ce_index, ce->inuse);
-
-  hss_cache_unlock (hc);
+    clib_warning ("index %d refcnt now %d", ce_index, inuse - 1);
 }
 
-static u32
-hss_cache_lookup (hss_cache_t *hc, u8 *path)
+u32
+hss_cache_lookup_and_attach (hss_cache_t *hc, u8 *path, u8 **data,
+			     u64 *data_len)
 {
   BVT (clib_bihash_kv) kv;
-  int rv;
+  hss_cache_entry_t *ce;
+  u32 ce_index;
 
   kv.key = (u64) path;
-  kv.value = ~0;
+  if (BV (clib_bihash_search) (&hc->name_to_data, &kv, &kv))
+    {
+      if (hc->debug_level > 1)
+	clib_warning ("lookup '%s' fail", path);
+      return ~0;
+    }
+
+  ce_index = (u32) kv.value;
+  ce = hc->cache_pool + ce_index;
+
+  if (!hss_cache_entry_try_attach (ce))
+    return ~0;
+
+  /* Slot evicted and reused for another file since the hash lookup */
+  if (ce->generation != (u32) (kv.value >> 32))
+    {
+      clib_atomic_fetch_sub_rel (&ce->inuse, 1);
+      return ~0;
+    }
 
-  /* Value updated only if lookup succeeds */
-  rv = BV (clib_bihash_search) (&hc->name_to_data, &kv, &kv);
-  ASSERT (!rv || kv.value == ~0);
+  *data = ce->data;
+  *data_len = ce->data_len;
+  ce->last_used = vlib_time_now (vlib_get_main ());
 
   if (hc->debug_level > 1)
-    clib_warning ("lookup '%s' %s", kv.key, kv.value == ~0 ? "fail" : "found");
+    clib_warning ("lookup '%s' found index %d", path, ce_index);
 
-  return kv.value;
+  return ce_index;
 }
 
-u32
-hss_cache_lookup_and_attach (hss_cache_t *hc, u8 *path, u8 **data,
-			     u64 *data_len)
+/** \brief Remove an unreferenced entry, called with the lock held
+ */
+static int
+hss_cache_entry_evict (hss_cache_t *hc, hss_cache_entry_t *ce)
 {
-  u32 ce_index;
+  BVT (clib_bihash_kv) kv;
+  int inuse = 0;
 
-  /* Make sure nobody removes the entry while we look it up */
-  hss_cache_lock (hc);
+  /* Which could be in use... */
+  if (!clib_atomic_cmp_and_swap_acq_relax_n (
+	&ce->inuse, &inuse, HSS_CACHE_ENTRY_DEAD, 0 /* weak */))
+    {
+      if (hc->debug_level > 1)
+	clib_warning ("index %d in use refcnt %d", ce - hc->cache_pool,
+		      inuse);
+      return 0;
+    }
 
-  ce_index = hss_cache_lookup (hc, path);
-  if (ce_index != ~0)
-    hss_cache_attach_entry (hc, ce_index, data, data_len);
+  kv.key = (u64) (ce->filename);
+  kv.value = ~0ULL;
+  if (BV (clib_bihash_add_del) (&hc->name_to_data, &kv, 0 /* is_add */) < 0)
+    {
+      clib_warning ("LRU delete '%s' FAILED!", ce->filename);
+    }
+  else if (hc->debug_level > 1)
+    clib_warning ("LRU delete '%s' ok", ce->filename);
+
+  lru_remove (hc, ce);
+  hc->cache_size -= ce->data_len;
+  hc->cache_evictions++;
+  vec_free (ce->filename);
+  if (ce->data)
+    munmap (ce->data, ce->data_len);
+  ce->data = 0;
+  ce->data_len = 0;
 
-  hss_cache_unlock (hc);
+  if (hc->debug_level > 1)
+    clib_warning ("pool put index %d", ce - hc->cache_pool);
 
-  return ce_index;
+  pool_put (hc->cache_pool, ce);
+  return 1;
 }
 
 static void
 hss_cache_do_evictions (hss_cache_t *hc)
 {
-  BVT (clib_bihash_kv) kv;
   hss_cache_entry_t *ce;
-  u32 free_index;
+  u32 free_index, n_left;
+  f64 now;
 
+  now = vlib_time_now (vlib_get_main ());
+  n_left = pool_elts (hc->cache_pool);
   free_index = hc->last_index;
 
-  while (free_index != ~0)
+  while (free_index != ~0 && n_left--)
     {
       /* pick the LRU */
       ce = pool_elt_at_index (hc->cache_pool, free_index);
-      /* Which could be in use... */
-      if (ce->inuse)
-	{
-	  if (hc->debug_level > 1)
-	    clib_warning ("index %d in use refcnt %d", free_index, ce->inuse);
-	}
       free_index = ce->prev_index;
-      kv.key = (u64) (ce->filename);
-      kv.value = ~0ULL;
-      if (BV (clib_bihash_add_del) (&hc->name_to_data, &kv, 0 /* is_add */) <
-	  0)
+
+      /* Used since it was put at the head, give it another round */
+      if (ce->last_used > ce->lru_time)
 	{
-	  clib_warning ("LRU delete '%s' FAILED!", ce->filename);
+	  lru_update (hc, ce, now);
+	  free_index = hc->last_index;
+	  continue;
 	}
-      else if (hc->debug_level > 1)
-	clib_warning ("LRU delete '%s' ok", ce->filename);
-
-      lru_remove (hc, ce);
-      hc->cache_size -= vec_len (ce->data);
-      hc->cache_evictions++;
-      vec_free (ce->filename);
-      vec_free (ce->data);
 
-      if (hc->debug_level > 1)
-	clib_warning ("pool put index %d", ce - hc->cache_pool);
+      if (!hss_cache_entry_evict (hc, ce))
+	continue;
 
-      pool_put (hc->cache_pool, ce);
-      if (hc->cache_size < hc->cache_limit)
+      if (hc->cache_size < hc->cache_limit &&
+	  pool_elts (hc->cache_pool) < HSS_CACHE_MAX_ENTRIES)
 	break;
     }
 }
 
+/** \brief Read a file into anonymous memory, outside of the main heap
+ */
+static clib_error_t *
+hss_cache_read_file (u8 *path, u8 **data, u64 *data_len)
+{
+  clib_error_t *error = 0;
+  struct stat st;
+  u8 *p = 0;
+  ssize_t n;
+  u64 off;
+  int fd;
+
+  if ((fd = open ((char *) path, O_RDONLY)) < 0)
+    return clib_error_return_unix (0, "open `%s'", path);
+
+  if (fstat (fd, &st) < 0)
+    {
+      error = clib_error_return_unix (0, "stat `%s'", path);
+      goto done;
+    }
+
+  if (st.st_size == 0)
+    goto done;
+
+  p = mmap (0, st.st_size, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+    {
+      p = 0;
+      error = clib_error_return_unix (0, "mmap `%s'", path);
+      goto done;
+    }
+
+  for (off = 0; off < st.st_size; off += n)
+    {
+      n = read (fd, p + off, st.st_size - off);
+      if (n <= 0)
+	{
+	  error = clib_error_return_unix (0, "read `%s'", path);
+	  munmap (p, st.st_size);
+	  p = 0;
+	  goto done;
+	}
+    }
+
+done:
+  close (fd);
+  *data = p;
+  *data_len = p ? st.st_size : 0;
+  return error;
+}
+
 u32
 hss_cache_add_and_attach (hss_cache_t *hc, u8 *path, u8 **data, u64 *data_len)
 {
@@ -277,44 +372,62 @@ hss_cache_add_and_attach (hss_cache_t *hc, u8 *path, u8 **data, u64 *data_len)
   hss_cache_entry_t *ce;
   clib_error_t *error;
   u8 *file_data;
+  u64 file_len;
   u32 ce_index;
 
   hss_cache_lock (hc);
 
+  /* Someone else may have added it while we were waiting for the lock */
+  ce_index = hss_cache_lookup_and_attach (hc, path, data, data_len);
+  if (ce_index != ~0)
+    goto done;
+
   /* Need to recycle one (or more cache) entries? */
-  if (hc->cache_size > hc->cache_limit)
+  if (hc->cache_size > hc->cache_limit ||
+      pool_elts (hc->cache_pool) >= HSS_CACHE_MAX_ENTRIES)
     hss_cache_do_evictions (hc);
 
+  if (pool_elts (hc->cache_pool) >= HSS_CACHE_MAX_ENTRIES)
+    {
+      clib_warning ("cache full of busy entries");
+      goto done;
+    }
+
   /* Read the file */
-  error = clib_file_contents ((char *) path, &file_data);
+  error = hss_cache_read_file (path, &file_data, &file_len);
   if (error)
     {
       clib_warning ("Error reading '%s'", path);
       clib_error_report (error);
-      return ~0;
+      goto done;
     }
 
-  /* Create a cache entry for it */
-  pool_get_zero (hc->cache_pool, ce);
+  /* Create a cache entry for it, generation survives slot reuse */
+  pool_get (hc->cache_pool, ce);
+  ce->generation++;
   ce->filename = vec_dup (path);
   ce->data = file_data;
+  ce->data_len = file_len;
+  ce->last_used = 0;
 
-  /* Attach cache entry without additional lock */
-  ce->inuse++;
   *data = file_data;
-  *data_len = vec_len (file_data);
+  *data_len = file_len;
   lru_add (hc, ce, vlib_time_now (vlib_get_main ()));
 
-  hc->cache_size += vec_len (ce->data);
+  hc->cache_size += file_len;
+  hc->cache_loads++;
   ce_index = ce - hc->cache_pool;
 
+  /* Attach cache entry, publishes the entry to lock-free lookups */
+  clib_atomic_store_rel_n (&ce->inuse, 1);
+
   if (hc->debug_level > 1)
     clib_warning ("index %d refcnt now %d", ce_index, ce->inuse);
 
   /* Add to the lookup table */
 
   kv.key = (u64) vec_dup (path);
-  kv.value = ce_index;
+  kv.value = (u64) ce->generation << 32 | ce_index;
 
   if (hc->debug_level > 1)
     clib_warning ("add '%s' value %lld", kv.key, kv.value);
@@ -324,6 +437,7 @@ hss_cache_add_and_attach (hss_cache_t *hc, u8 *path, u8 **data, u64 *data_len)
       clib_warning ("BUG: add failed!");
     }
 
+done:
   hss_cache_unlock (hc);
 
   return ce_index;
@@ -334,7 +448,6 @@ hss_cache_clear (hss_cache_t *hc)
 {
   u32 free_index, busy_items = 0;
   hss_cache_entry_t *ce;
-  BVT (clib_bihash_kv) kv;
 
   hss_cache_lock (hc);
 
@@ -344,30 +457,8 @@ hss_cache_clear (hss_cache_t *hc)
     {
       ce = pool_elt_at_index (hc->cache_pool, free_index);
       free_index = ce->prev_index;
-      /* Which could be in use... */
-      if (ce->inuse)
-	{
-	  busy_items++;
-	  free_index = ce->next_index;
-	  continue;
-	}
-      kv.key = (u64) (ce->filename);
-      kv.value = ~0ULL;
-      if (BV (clib_bihash_add_del) (&hc->name_to_data, &kv, 0 /* is_add */) <
-	  0)
-	{
-	  clib_warning ("BUG: cache clear delete '%s' FAILED!", ce->filename);
-	}
-
-      lru_remove (hc, ce);
-      hc->cache_size -= vec_len (ce->data);
-      hc->cache_evictions++;
-      vec_free (ce->filename);
-      vec_free (ce->data);
-      if (hc->debug_level > 1)
-	clib_warning ("pool put index %d", ce - hc->cache_pool);
-      pool_put (hc->cache_pool, ce);
-      free_index = hc->last_index;
+      if (!hss_cache_entry_evict (hc, ce))
+	busy_items++;
     }
 
   hss_cache_unlock (hc);
@@ -383,6 +474,8 @@ hss_cache_init (hss_cache_t *hc, uword cache_size, u8 debug_level)
   /* Init path-to-cache hash table */
   BV (clib_bihash_init) (&hc->name_to_data, "http cache", 128, 32 << 20);
 
+  pool_init_fixed (hc->cache_pool, HSS_CACHE_MAX_ENTRIES);
+
   hc->cache_limit = cache_size;
   hc->debug_level = debug_level;
   hc->first_index = hc->last_index = ~0;
@@ -402,8 +495,8 @@ format_hss_cache_entry (u8 *s, va_list *args)
       s = format (s, "%40s%12s%20s", "File", "Size", "Age");
       return s;
     }
-  s = format (s, "%40s%12lld%20.2f", ep->filename, vec_len (ep->data),
-	      now - ep->last_used);
+  s = format (s, "%40s%12lld%20.2f", ep->filename, ep->data_len,
+	      now - clib_max (ep->last_used, ep->lru_time));
   return s;
 }
 
@@ -419,21 +512,24 @@ format_hss_cache (u8 *s, va_list *args)
 
   if (verbose == 0)
     {
-      s = format (s, "cache size %lld bytes, limit %lld bytes, evictions %lld",
-		  hc->cache_size, hc->cache_limit, hc->cache_evictions);
-      return 0;
+      s = format (s,
+		  "cache size %lld bytes, limit %lld bytes, loads %lld, "
+		  "evictions %lld",
+		  hc->cache_size, hc->cache_limit, hc->cache_loads,
+		  hc->cache_evictions);
+      return s;
     }
 
   vm = vlib_get_main ();
   now = vlib_time_now (vm);
 
-  s = format (s, "%U", format_hss_cache_entry, 0 /* header */, now);
+  s = format (s, "%U\n", format_hss_cache_entry, 0 /* header */, now);
 
   for (index = hc->first_index; index != ~0;)
     {
       ce = pool_elt_at_index (hc->cache_pool, index);
       index = ce->next_index;
-      s = format (s, "%U", format_hss_cache_entry, ce, now);
+      s = format (s, "%U\n", format_hss_cache_entry, ce, now);
     }
 
   s = format (s, "%40s%12lld", "Total Size", hc->cache_size);
@@ -18,29 +18,44 @@
 
 #include <vppinfra/bihash_vec8_8.h>
 
+/** Reference count of an evicted entry, lookups fail to attach to it */
+#define HSS_CACHE_ENTRY_DEAD (-1)
+
+/** Size of the fixed cache entry pool */
+#define HSS_CACHE_MAX_ENTRIES (64 << 10)
+
 typedef struct hss_cache_entry_
 {
   /** Name of the file */
   u8 *filename;
-  /** Contents of the file, as a u8 * vector */
+  /** Contents of the file, mmap'd outside of the main heap */
   u8 *data;
-  /** Last time the cache entry was used */
+  /** Length of the file */
+  u64 data_len;
+  /** Last time the cache entry was used, written without the lock */
   f64 last_used;
+  /** Time the entry was put at the head of the LRU list */
+  f64 lru_time;
   /** Cache LRU links */
   u32 next_index;
   u32 prev_index;
+  /** Incremented each time the pool slot is reused */
+  u32 generation;
   /** Reference count, so we don't recycle while referenced */
   int inuse;
 } hss_cache_entry_t;
 
 typedef struct hss_cache_
 {
-  /** Unified file data cache pool */
+  /**
+   * Unified file data cache pool. Fixed size, so entries never move and
+   * lookups can run without the lock
+   */
   hss_cache_entry_t *cache_pool;
-  /** Hash table which maps file name to file data */
+  /** Hash table which maps file name to entry index and generation */
   BVT (clib_bihash) name_to_data;
 
-  /** Session pool lock */
+  /** Serializes adds, evictions and LRU list updates */
   clib_spinlock_t cache_lock;
 
   /** Current cache size */
@@ -49,6 +64,8 @@ typedef struct hss_cache_
   u64 cache_limit;
   /** Number of cache evictions */
   u64 cache_evictions;
+  /** Number of files read into the cache, every other lookup was a hit */
+  u64 cache_loads;
 
   /** Cache LRU listheads */
   u32 first_index;
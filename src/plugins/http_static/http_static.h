@@ -50,6 +50,10 @@ typedef struct
   int free_data;
   /** File cache pool index */
   u32 cache_pool_index;
+  /** Best content encoding the peer accepts */
+  http_content_encoding_t accept_encoding;
+  /** Content encoding of data */
+  http_content_encoding_t content_encoding;
 } hss_session_t;
 
 typedef struct hss_session_handle_
@@ -77,8 +81,11 @@ typedef struct hss_url_handler_args_
     /* Request args */
     struct
     {
+      /* path and query, if any, not null terminated */
       u8 *request;
       http_req_method_t reqtype;
+      /* handlers may compress data if the peer accepts it */
+      http_content_encoding_t accept_encoding;
     };
 
     /* Reply args */
@@ -88,6 +95,7 @@ typedef struct hss_url_handler_args_
       uword data_len;
       u8 free_vec_data;
       http_status_code_t sc;
+      http_content_encoding_t content_encoding;
     };
   };
 } hss_url_handler_args_t;
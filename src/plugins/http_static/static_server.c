@@ -90,6 +90,7 @@ start_send_data (hss_session_t *hs, http_status_code_t status)
   msg.type = HTTP_MSG_REPLY;
   msg.code = status;
   msg.content_type = HTTP_CONTENT_TEXT_HTML;
+  msg.content_encoding = hs->content_encoding;
   msg.data.len = hs->data_len;
 
   if (hs->data_len > hss_main.use_ptr_thresh)
@@ -140,6 +141,7 @@ hss_session_send_data (hss_url_handler_args_t *args)
   hs->data = args->data;
   hs->data_len = args->data_len;
   hs->free_data = args->free_vec_data;
+  hs->content_encoding = args->content_encoding;
   start_send_data (hs, args->sc);
 }
 
@@ -150,6 +152,7 @@ try_url_handler (hss_main_t *hsm, hss_session_t *hs, http_req_method_t rt,
   http_status_code_t sc = HTTP_STATUS_OK;
   hss_url_handler_args_t args = {};
   uword *p, *url_table;
+  u8 *path;
   int rv;
 
   if (!hsm->enable_url_handlers || !request)
@@ -159,7 +162,11 @@ try_url_handler (hss_main_t *hsm, hss_session_t *hs, http_req_method_t rt,
   url_table =
     (rt == HTTP_REQ_GET) ? hsm->get_url_handlers : hsm->post_url_handlers;
 
-  p = hash_get_mem (url_table, request);
+  /* Handlers are registered by path, the query is theirs to parse */
+  path = format (0, "%v%c", request, 0);
+  path[strcspn ((char *) path, "?")] = 0;
+  p = hash_get_mem (url_table, path);
+  vec_free (path);
   if (!p)
     return -1;
 
@@ -172,6 +179,7 @@ try_url_handler (hss_main_t *hsm, hss_session_t *hs, http_req_method_t rt,
 
   args.reqtype = rt;
   args.request = request;
+  args.accept_encoding = hs->accept_encoding;
   args.sh.thread_index = hs->thread_index;
   args.sh.session_index = hs->session_index;
 
@@ -191,6 +199,7 @@ try_url_handler (hss_main_t *hsm, hss_session_t *hs, http_req_method_t rt,
   hs->data = args.data;
   hs->data_len = args.data_len;
   hs->free_data = args.free_vec_data;
+  hs->content_encoding = args.content_encoding;
 
   start_send_data (hs, sc);
 
@@ -305,6 +314,13 @@ try_file_handler (hss_main_t *hsm, hss_session_t *hs, http_req_method_t rt,
   if (hs->data && hs->free_data)
     vec_free (hs->data);
 
+  /* Previous reply on this connection has been sent, drop its entry */
+  if (hs->cache_pool_index != ~0)
+    {
+      hss_cache_detach_entry (&hsm->cache, hs->cache_pool_index);
+      hs->cache_pool_index = ~0;
+    }
+
   hs->path = path;
   hs->data_offset = 0;
 
@@ -369,6 +385,8 @@ hss_ts_rx_callback (session_t *ts)
   rv = svm_fifo_dequeue (ts->rx_fifo, sizeof (msg), (u8 *) &msg);
   ASSERT (rv == sizeof (msg));
 
+  hs->content_encoding = HTTP_CONTENT_ENCODING_IDENTITY;
+
   if (msg.type != HTTP_MSG_REQUEST ||
       (msg.method_type != HTTP_REQ_GET && msg.method_type != HTTP_REQ_POST))
     {
@@ -385,6 +403,8 @@ hss_ts_rx_callback (session_t *ts)
       ASSERT (rv == msg.data.len);
     }
 
+  hs->accept_encoding = msg.content_encoding;
+
   /* Find and send data */
   handle_request (hs, msg.method_type, request);
 
@@ -896,6 +916,80 @@ VLIB_CLI_COMMAND (clear_hss_cache_command, static) = {
   .function = hss_clear_cache_command_fn,
 };
 
+static clib_error_t *
+hss_test_cache_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  hss_main_t *hsm = &hss_main;
+  hss_cache_t *hc = &hsm->cache;
+  u32 n_iterations = 1 << 20, i, ce_index, n_lookups = 0, n_miss = 0;
+  u8 **paths = 0, *data;
+  hss_cache_entry_t *ce;
+  u64 data_len;
+  f64 t0, t1;
+
+  if (hsm->www_root == 0)
+    return clib_error_return (0, "Static server disabled");
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "iterations %u", &n_iterations))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  clib_spinlock_lock (&hc->cache_lock);
+  pool_foreach (ce, hc->cache_pool)
+    vec_add1 (paths, vec_dup (ce->filename));
+  clib_spinlock_unlock (&hc->cache_lock);
+
+  if (vec_len (paths) == 0)
+    return clib_error_return (0, "cache is empty, fetch some files first");
+
+  t0 = vlib_time_now (vm);
+  for (i = 0; i < n_iterations; i++)
+    {
+      ce_index = hss_cache_lookup_and_attach (
+	hc, paths[i % vec_len (paths)], &data, &data_len);
+      if (ce_index == ~0)
+	{
+	  n_miss++;
+	  continue;
+	}
+      hss_cache_detach_entry (hc, ce_index);
+      n_lookups++;
+    }
+  t1 = vlib_time_now (vm);
+
+  vlib_cli_output (vm, "%u entries, %u lookups, %u misses, %.2f Mlookups/s",
+		   vec_len (paths), n_lookups, n_miss,
+		   n_iterations / (t1 - t0) * 1e-6);
+
+  for (i = 0; i < vec_len (paths); i++)
+    vec_free (paths[i]);
+  vec_free (paths);
+  return 0;
+}
+
+/*?
+ * Measure lookup and attach rate of the static http server cache, using
+ * the files currently in the cache. Lookups take no lock, so the rate
+ * should not drop while workers serve requests
+ *
+ * @cliexpar
+ * @clistart
+ * test http static cache iterations 10000000
+ * @cliend
+ * @cliexcmd{test http static cache [iterations <n>]}
+?*/
+VLIB_CLI_COMMAND (test_hss_cache_command, static) = {
+  .path = "test http static cache",
+  .short_help = "test http static cache [iterations <n>]",
+  .function = hss_test_cache_command_fn,
+};
+
 static clib_error_t *
 hss_main_init (vlib_main_t *vm)
 {
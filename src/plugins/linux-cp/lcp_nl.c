@@ -59,6 +59,15 @@ typedef struct nl_main
   u32 batch_size;
   u32 batch_delay_ms;
 
+  /* route coalescing state, rebuilt for each batch */
+  uword *route_key_hash;
+  struct lcp_nl_route_key_t_ *route_keys;
+  uword *superseded;
+  u64 n_coalesced;
+
+  /* raw message recording, for offline replay */
+  int record_fd;
+
 } nl_main_t;
 
 #define NL_RX_BUF_SIZE_DEF    (1 << 27) /* 128 MB */
@@ -71,8 +80,25 @@ static nl_main_t nl_main = {
   .tx_buf_size = NL_TX_BUF_SIZE_DEF,
   .batch_size = NL_BATCH_SIZE_DEF,
   .batch_delay_ms = NL_BATCH_DELAY_MS_DEF,
+  .record_fd = -1,
 };
 
+/*
+ * The identity of a kernel route, as far as the FIB is concerned. Two
+ * route messages with the same key program the same FIB entry from the
+ * same source.
+ */
+typedef struct lcp_nl_route_key_t_
+{
+  ip46_address_t dst;
+  u32 table;
+  u32 priority;
+  u8 family;
+  u8 dst_len;
+  u8 tos;
+  u8 protocol;
+} lcp_nl_route_key_t;
+
 /* #define foreach_nl_nft_proto  \ */
 /*   _(IP4, "ip", AF_INT)  \ */
 /*   _(IP6, "ip6", NFPROTO_IPV6) */
@@ -224,18 +250,134 @@ nl_route_dispatch (struct nl_object *obj, void *arg)
     }
 }
 
+static int
+nl_route_key_attr_cb (const struct nlattr *attr, void *data)
+{
+  lcp_nl_route_key_t *key = data;
+
+  switch (mnl_attr_get_type (attr))
+    {
+    case RTA_DST:
+      if (mnl_attr_get_payload_len (attr) > sizeof (key->dst))
+	return MNL_CB_ERROR;
+      clib_memcpy (&key->dst, mnl_attr_get_payload (attr),
+		   mnl_attr_get_payload_len (attr));
+      break;
+    case RTA_TABLE:
+      key->table = mnl_attr_get_u32 (attr);
+      break;
+    case RTA_PRIORITY:
+      key->priority = mnl_attr_get_u32 (attr);
+      break;
+    }
+
+  return MNL_CB_OK;
+}
+
+/*
+ * Extract the route key straight from the raw message, without
+ * allocating a libnl object. Returns 1 if the message is an IPv4
+ * unicast-class route, i.e. one whose RTM_NEWROUTE is programmed as a
+ * complete replacement of the FIB entry's paths for its source.
+ */
+static int
+nl_route_key_get (struct nl_msg *msg, lcp_nl_route_key_t *key)
+{
+  struct nlmsghdr *nlh = nlmsg_hdr (msg);
+  struct rtmsg *rtm;
+
+  if (nlh->nlmsg_type != RTM_NEWROUTE && nlh->nlmsg_type != RTM_DELROUTE)
+    return 0;
+  if (nlh->nlmsg_len < NLMSG_LENGTH (sizeof (*rtm)))
+    return 0;
+
+  rtm = mnl_nlmsg_get_payload (nlh);
+  if (rtm->rtm_family != AF_INET || rtm->rtm_type == RTN_MULTICAST)
+    return 0;
+
+  clib_memset (key, 0, sizeof (*key));
+  key->family = rtm->rtm_family;
+  key->dst_len = rtm->rtm_dst_len;
+  key->tos = rtm->rtm_tos;
+  key->protocol = rtm->rtm_protocol;
+  key->table = rtm->rtm_table;
+
+  if (mnl_attr_parse (nlh, sizeof (*rtm), nl_route_key_attr_cb, key) !=
+      MNL_CB_OK)
+    return 0;
+
+  return 1;
+}
+
+/*
+ * Find the messages in the next batch that are made redundant by a later
+ * message in the same batch: an IPv4 route add replaces all the paths the
+ * source has for the prefix, so an earlier add of that route, with no
+ * delete in between, has no lasting effect. Deletes are always kept, since
+ * a later add whose paths do not resolve programs nothing. When the kernel
+ * churns through a full table (e.g. BGP session flap) this saves parsing
+ * and programming most of the intermediate states.
+ */
+static void
+nl_route_coalesce (u32 n_msgs)
+{
+  nl_main_t *nm = &nl_main;
+  lcp_nl_route_key_t *key;
+  struct nl_msg *msg;
+  int i;
+
+  clib_bitmap_zero (nm->superseded);
+  vec_validate (nm->route_keys, n_msgs);
+  if (!nm->route_key_hash)
+    nm->route_key_hash =
+      hash_create_mem (0, sizeof (lcp_nl_route_key_t), sizeof (uword));
+
+  for (i = n_msgs - 1; i >= 0; i--)
+    {
+      msg = nm->nl_msg_queue[i].msg;
+      key = &nm->route_keys[i];
+
+      if (!nl_route_key_get (msg, key))
+	continue;
+
+      /* a delete is never dropped, and it is a barrier: an add before it
+       * is still needed to replace whatever the delete applies to */
+      if (nlmsg_hdr (msg)->nlmsg_type != RTM_NEWROUTE)
+	{
+	  hash_unset_mem (nm->route_key_hash, key);
+	  continue;
+	}
+
+      if (hash_get_mem (nm->route_key_hash, key))
+	{
+	  nm->superseded = clib_bitmap_set (nm->superseded, i, 1);
+	  continue;
+	}
+
+      if (!(nlmsg_hdr (msg)->nlmsg_flags & NLM_F_APPEND))
+	hash_set_mem (nm->route_key_hash, key, i);
+    }
+
+  hash_free (nm->route_key_hash);
+}
+
 static int
 nl_route_process_msgs (void)
 {
   nl_main_t *nm = &nl_main;
   nl_msg_info_t *msg_info;
-  int err, n_msgs = 0;
+  int err, n_msgs = 0, n_coalesced = 0;
+
+  if (vec_len (nm->nl_msg_queue) > 1)
+    nl_route_coalesce (clib_min (vec_len (nm->nl_msg_queue), nm->batch_size));
 
   /* process a batch of messages. break if we hit our limit */
   vec_foreach (msg_info, nm->nl_msg_queue)
     {
-      if ((err = nl_msg_parse (msg_info->msg, nl_route_dispatch, msg_info)) <
-	  0)
+      if (clib_bitmap_get (nm->superseded, n_msgs))
+	n_coalesced++;
+      else if ((err = nl_msg_parse (msg_info->msg, nl_route_dispatch,
+				    msg_info)) < 0)
 	NL_ERROR ("Unable to parse object: %s", nl_geterror (err));
       nlmsg_free (msg_info->msg);
       if (++n_msgs >= nm->batch_size)
@@ -246,7 +388,10 @@ nl_route_process_msgs (void)
   if (n_msgs)
     vec_delete (nm->nl_msg_queue, n_msgs, 0);
 
-  NL_INFO ("Processed %u messages", n_msgs);
+  clib_bitmap_zero (nm->superseded);
+  nm->n_coalesced += n_coalesced;
+
+  NL_INFO ("Processed %u messages, %u coalesced", n_msgs, n_coalesced);
 
   return n_msgs;
 }
@@ -310,6 +455,19 @@ nl_route_cb (struct nl_msg *msg, void *arg)
   nl_main_t *nm = &nl_main;
   nl_msg_info_t *msg_info = 0;
 
+  if (PREDICT_FALSE (nm->record_fd >= 0))
+    {
+      struct nlmsghdr *nlh = nlmsg_hdr (msg);
+
+      if (write (nm->record_fd, nlh, NLMSG_ALIGN (nlh->nlmsg_len)) < 0)
+	{
+	  NL_ERROR ("netlink record write failed, stopping: %s",
+		    strerror (errno));
+	  close (nm->record_fd);
+	  nm->record_fd = -1;
+	}
+    }
+
   /* delay processing - increment ref count and queue for later */
   vec_add2 (nm->nl_msg_queue, msg_info, 1);
 
@@ -442,6 +600,133 @@ lcp_itf_pair_config (vlib_main_t *vm, unformat_input_t *input)
 
 VLIB_CONFIG_FUNCTION (lcp_itf_pair_config, "linux-nl");
 
+static clib_error_t *
+lcp_nl_record_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			  vlib_cli_command_t *cmd)
+{
+  nl_main_t *nm = &nl_main;
+  u8 *file = 0;
+  int fd;
+
+  if (unformat (input, "off"))
+    ;
+  else if (!unformat (input, "%s", &file))
+    return clib_error_return (0, "file name or 'off' required");
+
+  if (nm->record_fd >= 0)
+    {
+      close (nm->record_fd);
+      nm->record_fd = -1;
+    }
+
+  if (!file)
+    return 0;
+
+  vec_add1 (file, 0);
+  fd = open ((char *) file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      clib_error_t *err =
+	clib_error_return_unix (0, "failed to open '%s'", file);
+      vec_free (file);
+      return err;
+    }
+
+  nm->record_fd = fd;
+  vec_free (file);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (lcp_nl_record_command, static) = {
+  .path = "lcp nl record",
+  .short_help = "lcp nl record <file>|off",
+  .function = lcp_nl_record_command_fn,
+};
+
+/*
+ * Benchmark the ingestion path: feed a recorded netlink stream through
+ * the same queue, coalescing and dispatch code as the live socket.
+ * Routes are only programmed for tables and interfaces that have
+ * linux-cp pairs, exactly as they would be for the live stream.
+ */
+static clib_error_t *
+lcp_nl_replay_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			  vlib_cli_command_t *cmd)
+{
+  nl_main_t *nm = &nl_main;
+  clib_error_t *err = 0;
+  struct nlmsghdr *nlh;
+  u8 *file = 0, *data = 0;
+  u32 iterations = 1, i, n_msgs = 0;
+  u64 n_coalesced;
+  f64 t0, t_total = 0;
+  int len;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "iterations %u", &iterations))
+	;
+      else if (unformat (input, "%s", &file))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (!file)
+    return clib_error_return (0, "file name required");
+
+  vec_add1 (file, 0);
+  if ((err = clib_file_contents ((char *) file, &data)))
+    goto done;
+
+  if (vec_len (nm->nl_msg_queue))
+    {
+      err = clib_error_return (0, "netlink queue busy, try again");
+      goto done;
+    }
+
+  n_coalesced = nm->n_coalesced;
+
+  for (i = 0; i < iterations; i++)
+    {
+      len = vec_len (data);
+      nlh = (struct nlmsghdr *) data;
+
+      while (mnl_nlmsg_ok (nlh, len))
+	{
+	  nl_msg_info_t *msg_info;
+
+	  vec_add2 (nm->nl_msg_queue, msg_info, 1);
+	  msg_info->msg = nlmsg_convert (nlh);
+	  msg_info->ts = vlib_time_now (vm);
+	  nlh = mnl_nlmsg_next (nlh, &len);
+	  n_msgs++;
+	}
+
+      t0 = vlib_time_now (vm);
+      while (vec_len (nm->nl_msg_queue))
+	nl_route_process_msgs ();
+      t_total += vlib_time_now (vm) - t0;
+    }
+
+  vlib_cli_output (vm, "%u messages in %.3f sec, %.0f msgs/sec",
+		   n_msgs, t_total, t_total > 0 ? n_msgs / t_total : 0.0);
+  vlib_cli_output (vm, "%llu messages coalesced",
+		   nm->n_coalesced - n_coalesced);
+
+done:
+  vec_free (file);
+  vec_free (data);
+  return err;
+}
+
+VLIB_CLI_COMMAND (lcp_nl_replay_command, static) = {
+  .path = "lcp nl replay",
+  .short_help = "lcp nl replay <file> [iterations <n>]",
+  .function = lcp_nl_replay_command_fn,
+};
+
 static void
 lcp_nl_close_socket (void)
 {
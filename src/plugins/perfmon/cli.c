@@ -349,11 +349,10 @@ VLIB_CLI_COMMAND (show_perfmon_active_bundle_command, static) = {
 };
 
 static clib_error_t *
-show_perfmon_stats_command_fn (vlib_main_t *vm, unformat_input_t *input,
-			       vlib_cli_command_t *cmd)
+show_perfmon_bundle_stats (vlib_main_t *vm, perfmon_bundle_t *b,
+			   perfmon_thread_runtime_t *thread_runtimes)
 {
   perfmon_main_t *pm = &perfmon_main;
-  perfmon_bundle_t *b = pm->active_bundle;
   clib_error_t *err = 0;
   table_t table = {}, *t = &table;
   u32 n_instances;
@@ -363,9 +362,6 @@ show_perfmon_stats_command_fn (vlib_main_t *vm, unformat_input_t *input,
   u8 *s = 0;
   int n_row = 0;
 
-  if (b == 0)
-    return clib_error_return (0, "no bundle selected");
-
   n_instances = vec_len (it->instances);
   vec_validate (readings, n_instances - 1);
 
@@ -404,7 +400,7 @@ show_perfmon_stats_command_fn (vlib_main_t *vm, unformat_input_t *input,
       if (b->active_type == PERFMON_BUNDLE_TYPE_NODE)
 	{
 	  perfmon_thread_runtime_t *tr;
-	  tr = vec_elt_at_index (pm->thread_runtimes, i);
+	  tr = vec_elt_at_index (thread_runtimes, i);
 	  for (int j = 0; j < tr->n_nodes; j++)
 	    if (tr->node_stats[j].n_calls)
 	      {
@@ -441,6 +437,44 @@ done:
   return err;
 }
 
+static clib_error_t *
+show_perfmon_stats_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			       vlib_cli_command_t *cmd)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_bundle_t *b = pm->active_bundle;
+  clib_error_t *err = 0;
+  f64 duration;
+
+  if (b == 0)
+    return clib_error_return (0, "no bundle selected");
+
+  if (vec_len (pm->mux_bundles) == 0)
+    return show_perfmon_bundle_stats (vm, b, pm->thread_runtimes);
+
+  /* multiplexed, every bundle only counted for its share of the time */
+  duration = pm->is_running ? vlib_time_now (vm) - pm->sample_time :
+			      pm->sample_time;
+
+  for (int i = 0; i < vec_len (pm->mux_bundles) && err == 0; i++)
+    {
+      perfmon_mux_bundle_t *mb = vec_elt_at_index (pm->mux_bundles, i);
+      f64 t = mb->time_active;
+
+      if (pm->is_running && i == pm->mux_active)
+	t += vlib_time_now (vm) - pm->mux_slice_start;
+
+      vlib_cli_output (vm, "%s: active %.2f of %.2f sec (%.1f%%)%s",
+		       mb->bundle->name, t, duration,
+		       duration > 0 ? 100 * t / duration : 0,
+		       pm->is_running && i == pm->mux_active ? ", counting" :
+							       "");
+      err = show_perfmon_bundle_stats (vm, mb->bundle, mb->thread_runtimes);
+    }
+
+  return err;
+}
+
 VLIB_CLI_COMMAND (show_perfmon_stats_command, static) = {
   .path = "show perfmon statistics",
   .short_help = "show perfmon statistics [raw]",
@@ -469,8 +503,11 @@ perfmon_start_command_fn (vlib_main_t *vm, unformat_input_t *input,
 {
   perfmon_main_t *pm = &perfmon_main;
   unformat_input_t _line_input, *line_input = &_line_input;
-  perfmon_bundle_t *b = 0;
+  perfmon_bundle_t *b = 0, **bundles = 0;
   perfmon_bundle_type_t bundle_type = PERFMON_BUNDLE_TYPE_UNKNOWN;
+  clib_error_t *err = 0;
+  int multiplex = 0;
+  f64 slice = 100;
 
   if (pm->is_running)
     return clib_error_return (0, "please stop first");
@@ -481,16 +518,58 @@ perfmon_start_command_fn (vlib_main_t *vm, unformat_input_t *input,
   while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
     {
       if (unformat (line_input, "bundle %U", unformat_perfmon_bundle_name, &b))
-	;
+	vec_add1 (bundles, b);
       else if (unformat (line_input, "type %U", unformat_perfmon_active_type,
 			 b, &bundle_type))
 	;
+      else if (unformat (line_input, "multiplex"))
+	multiplex = 1;
+      else if (unformat (line_input, "slice %f", &slice))
+	;
       else
-	return clib_error_return (0, "unknown input '%U'",
-				  format_unformat_error, line_input);
+	{
+	  vec_free (bundles);
+	  return clib_error_return (0, "unknown input '%U'",
+				    format_unformat_error, line_input);
+	}
     }
   unformat_free (line_input);
 
+  if (multiplex || vec_len (bundles) > 1)
+    {
+      if (slice < 1)
+	err = clib_error_return (0, "slice must be at least 1 msec");
+
+      /* all node bundles available on this cpu, if none given */
+      if (vec_len (bundles) == 0)
+	{
+	  char *key;
+	  hash_foreach_mem (key, b, pm->bundle_by_name, {
+	    if (b->type_flags & 1 << PERFMON_BUNDLE_TYPE_NODE)
+	      vec_add1 (bundles, b);
+	  });
+	  vec_sort_with_function (bundles, bundle_name_sort_cmp);
+	}
+
+      for (int i = 0; i < vec_len (bundles) && err == 0; i++)
+	if (!(bundles[i]->type_flags & 1 << PERFMON_BUNDLE_TYPE_NODE))
+	  err = clib_error_return (0,
+				   "bundle '%s' can't be attributed to nodes "
+				   "and can't be multiplexed",
+				   bundles[i]->name);
+
+      if (err == 0 && vec_len (bundles) == 0)
+	err = clib_error_return (0, "no node bundles available");
+
+      if (err == 0)
+	err = perfmon_mux_start (vm, bundles, slice * 1e-3);
+
+      vec_free (bundles);
+      return err;
+    }
+
+  vec_free (bundles);
+
   if (b == 0)
     return clib_error_return (0, "please specify bundle name");
 
@@ -517,7 +596,9 @@ perfmon_start_command_fn (vlib_main_t *vm, unformat_input_t *input,
 
 VLIB_CLI_COMMAND (perfmon_start_command, static) = {
   .path = "perfmon start",
-  .short_help = "perfmon start bundle [<bundle-name>] type [<node|thread>]",
+  .short_help = "perfmon start bundle [<bundle-name>] type [<node|thread>] "
+		"| perfmon start [bundle <bundle-name>]... multiplex "
+		"[slice <msec>]",
   .function = perfmon_start_command_fn,
   .is_mp_safe = 1,
 };
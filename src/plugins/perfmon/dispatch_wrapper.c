@@ -34,7 +34,8 @@ perfmon_read_pmcs (u64 *counters, u32 *indexes, u8 n_counters)
 
 static_always_inline uword
 perfmon_dispatch_wrapper_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
-				 vlib_frame_t *frame, u8 n_events)
+				 vlib_frame_t *frame, u8 n_events,
+				 int with_clocks)
 {
   perfmon_main_t *pm = &perfmon_main;
   perfmon_thread_runtime_t *rt =
@@ -46,19 +47,28 @@ perfmon_dispatch_wrapper_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   {
     u64 t[2][PERF_MAX_EVENTS];
   } samples;
+  u64 clocks = 0;
   uword rv;
 
   clib_prefetch_load (s);
 
+  /* multiplexed bundles only see part of the run, so they also count
+     clocks to put the nodes on a common scale */
+  if (with_clocks)
+    clocks = clib_cpu_time_now ();
   perfmon_read_pmcs (&samples.t[0][0], &rt->indexes[0], n_events);
   rv = node->function (vm, node, frame);
   perfmon_read_pmcs (&samples.t[1][0], &rt->indexes[0], n_events);
+  if (with_clocks)
+    clocks = clib_cpu_time_now () - clocks;
 
   if (rv == 0)
     return rv;
 
   s->n_calls += 1;
   s->n_packets += rv;
+  if (with_clocks)
+    s->n_clocks += clocks;
 
   for (int i = 0; i < n_events; i++)
     {
@@ -83,7 +93,12 @@ perfmon_dispatch_wrapper_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   static uword perfmon_dispatch_wrapper##x (                                  \
     vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)          \
   {                                                                           \
-    return perfmon_dispatch_wrapper_inline (vm, node, frame, x);              \
+    return perfmon_dispatch_wrapper_inline (vm, node, frame, x, 0);           \
+  }                                                                           \
+  static uword perfmon_dispatch_wrapper_clocks##x (                           \
+    vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)          \
+  {                                                                           \
+    return perfmon_dispatch_wrapper_inline (vm, node, frame, x, 1);           \
   }
 
 foreach_n_events
@@ -94,3 +109,9 @@ foreach_n_events
     foreach_n_events
 #undef _
   };
+
+vlib_node_function_t *perfmon_dispatch_wrappers_clocks[PERF_MAX_EVENTS + 1] = {
+#define _(x) [x] = &perfmon_dispatch_wrapper_clocks##x,
+  foreach_n_events
+#undef _
+};
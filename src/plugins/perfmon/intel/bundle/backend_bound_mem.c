@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include <math.h>
 #include <perfmon/perfmon.h>
 #include <perfmon/intel/core.h>
 
@@ -28,23 +29,16 @@ enum
   THREAD = 7,
 };
 
-static u8 *
-format_intel_backend_bound_mem (u8 *s, va_list *args)
+static f64
+intel_backend_bound_mem_value (perfmon_node_stats_t *ss, u32 row)
 {
-  perfmon_node_stats_t *ss = va_arg (*args, perfmon_node_stats_t *);
-  int row = va_arg (*args, int);
   f64 sv = 0;
 
   if (!ss->n_packets)
-    return s;
+    return NAN;
 
   if (0 == row)
-    {
-      sv = ss->value[THREAD] / ss->n_packets;
-
-      s = format (s, "%.0f", sv);
-      return s;
-    }
+    return ss->value[THREAD] / ss->n_packets;
 
   switch (row)
     {
@@ -68,11 +62,20 @@ format_intel_backend_bound_mem (u8 *s, va_list *args)
       break;
     }
 
-  sv = clib_max ((sv / ss->value[THREAD]) * 100, 0);
+  return clib_max ((sv / ss->value[THREAD]) * 100, 0);
+}
 
-  s = format (s, "%04.1f", sv);
+static u8 *
+format_intel_backend_bound_mem (u8 *s, va_list *args)
+{
+  perfmon_node_stats_t *ss = va_arg (*args, perfmon_node_stats_t *);
+  int row = va_arg (*args, int);
+
+  if (!ss->n_packets)
+    return s;
 
-  return s;
+  return format (s, row ? "%04.1f" : "%.0f",
+		 intel_backend_bound_mem_value (ss, row));
 }
 
 static perfmon_cpu_supports_t backend_bound_mem_cpu_supports[] = {
@@ -94,9 +97,11 @@ PERFMON_REGISTER_BUNDLE (intel_core_backend_bound_mem) = {
   .events[7] = INTEL_CORE_E_CPU_CLK_UNHALTED_THREAD_P,	    /* 0xFF */
   .n_events = 8,
   .format_fn = format_intel_backend_bound_mem,
+  .node_value_fn = intel_backend_bound_mem_value,
   .cpu_supports = backend_bound_mem_cpu_supports,
   .n_cpu_supports = ARRAY_LEN (backend_bound_mem_cpu_supports),
   .column_headers = PERFMON_STRINGS ("Clocks/Packet", "%Store Bound",
 				     "%L1 Bound", "%FB Full", "%L2 Bound",
 				     "%L3 Bound", "%DRAM Bound"),
+  .stall_columns = 0x7e,
 };
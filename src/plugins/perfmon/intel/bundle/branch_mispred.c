@@ -14,33 +14,38 @@
  */
 
 #include <vnet/vnet.h>
+#include <math.h>
 #include <perfmon/perfmon.h>
 #include <perfmon/intel/core.h>
 
-static u8 *
-format_branch_mispredictions (u8 *s, va_list *args)
+static f64
+branch_mispredictions_value (perfmon_node_stats_t *ns, u32 row)
 {
-  perfmon_node_stats_t *ns = va_arg (*args, perfmon_node_stats_t *);
-  int row = va_arg (*args, int);
-
   switch (row)
     {
     case 0:
-      s = format (s, "%9.2f", ns->value[0] / (f64) ns->n_calls);
-      break;
+      return ns->value[0] / (f64) ns->n_calls;
     case 1:
-      s = format (s, "%9.2f", ns->value[0] / (f64) ns->n_packets);
-      break;
+      return ns->value[0] / (f64) ns->n_packets;
     case 2:
-      s = format (s, "%9.2f", ns->value[1] / (f64) ns->n_calls);
-      break;
+      return ns->value[1] / (f64) ns->n_calls;
     case 3:
-      s = format (s, "%9.2f", ns->value[1] / (f64) ns->n_packets);
-      break;
+      return ns->value[1] / (f64) ns->n_packets;
     case 4:
-      s = format (s, "%05.2f", (ns->value[2] / (f64) ns->value[0]) * 100);
-      break;
+      return (ns->value[2] / (f64) ns->value[0]) * 100;
     }
+  return NAN;
+}
+
+static u8 *
+format_branch_mispredictions (u8 *s, va_list *args)
+{
+  perfmon_node_stats_t *ns = va_arg (*args, perfmon_node_stats_t *);
+  int row = va_arg (*args, int);
+
+  if (row < 5)
+    s = format (s, row < 4 ? "%9.2f" : "%05.2f",
+		branch_mispredictions_value (ns, row));
   return s;
 }
 
@@ -54,6 +59,7 @@ PERFMON_REGISTER_BUNDLE (branch_mispredictions) = {
   .events[2] = INTEL_CORE_E_BR_MISP_RETIRED_ALL_BRANCHES,
   .n_events = 3,
   .format_fn = format_branch_mispredictions,
+  .node_value_fn = branch_mispredictions_value,
   .column_headers = PERFMON_STRINGS ("Branches/call", "Branches/pkt",
 				     "Taken/call", "Taken/pkt", "% MisPred"),
 };
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include <math.h>
 #include <perfmon/perfmon.h>
 #include <perfmon/intel/core.h>
 
@@ -24,28 +25,21 @@ enum
   LSD_UOPS,
 };
 
-static u8 *
-format_intel_frontend_bound_bw (u8 *s, va_list *args)
+static f64
+intel_frontend_bound_bw_value (perfmon_node_stats_t *ss, u32 row)
 {
-  perfmon_node_stats_t *ss = va_arg (*args, perfmon_node_stats_t *);
-  int row = va_arg (*args, int);
   f64 sv = 0;
   f64 uops = ss->value[DSB_UOPS] + ss->value[MS_UOPS] + ss->value[MITE_UOPS] +
 	     ss->value[LSD_UOPS];
 
   if (!ss->n_packets)
-    return s;
-
-  if (row == 0)
-    {
-      sv = uops / ss->n_packets;
-      s = format (s, "%.0f", sv);
-
-      return s;
-    }
+    return NAN;
 
   switch (row)
     {
+    case 0:
+      sv = uops / ss->n_packets;
+      break;
     case 1:
       sv = (ss->value[DSB_UOPS] / uops) * 100;
       break;
@@ -60,9 +54,20 @@ format_intel_frontend_bound_bw (u8 *s, va_list *args)
       break;
     }
 
-  s = format (s, "%04.1f", sv);
+  return sv;
+}
+
+static u8 *
+format_intel_frontend_bound_bw (u8 *s, va_list *args)
+{
+  perfmon_node_stats_t *ss = va_arg (*args, perfmon_node_stats_t *);
+  int row = va_arg (*args, int);
+
+  if (!ss->n_packets)
+    return s;
 
-  return s;
+  return format (s, row ? "%04.1f" : "%.0f",
+		 intel_frontend_bound_bw_value (ss, row));
 }
 
 static perfmon_cpu_supports_t frontend_bound_bw_cpu_supports[] = {
@@ -80,6 +85,7 @@ PERFMON_REGISTER_BUNDLE (intel_core_frontend_bound_bw) = {
   .events[3] = INTEL_CORE_E_LSD_UOPS,	   /* 0x0F */
   .n_events = 4,
   .format_fn = format_intel_frontend_bound_bw,
+  .node_value_fn = intel_frontend_bound_bw_value,
   .cpu_supports = frontend_bound_bw_cpu_supports,
   .n_cpu_supports = ARRAY_LEN (frontend_bound_bw_cpu_supports),
   .column_headers = PERFMON_STRINGS ("UOPs/PKT", "% DSB UOPS", "% MS UOPS",
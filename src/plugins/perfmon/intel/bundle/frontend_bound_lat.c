@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include <math.h>
 #include <perfmon/perfmon.h>
 #include <perfmon/intel/core.h>
 
@@ -29,25 +30,17 @@ enum
   THREAD,
 };
 
-static u8 *
-format_intel_frontend_bound_lat (u8 *s, va_list *args)
+static f64
+intel_frontend_bound_lat_value (perfmon_node_stats_t *ss, u32 row)
 {
-  perfmon_node_stats_t *ss = va_arg (*args, perfmon_node_stats_t *);
-  int row = va_arg (*args, int);
   f64 sv = 0;
   f64 cycles = ss->value[THREAD];
 
   if (!ss->n_packets)
-    return s;
+    return NAN;
 
   if (!row)
-    {
-      sv = ss->value[THREAD] / ss->n_packets;
-
-      s = format (s, "%.0f", sv);
-
-      return s;
-    }
+    return ss->value[THREAD] / ss->n_packets;
 
   switch (row)
     {
@@ -66,9 +59,20 @@ format_intel_frontend_bound_lat (u8 *s, va_list *args)
       break;
     }
 
-  s = format (s, "%04.1f", sv * 100);
+  return sv * 100;
+}
+
+static u8 *
+format_intel_frontend_bound_lat (u8 *s, va_list *args)
+{
+  perfmon_node_stats_t *ss = va_arg (*args, perfmon_node_stats_t *);
+  int row = va_arg (*args, int);
+
+  if (!ss->n_packets)
+    return s;
 
-  return s;
+  return format (s, row ? "%04.1f" : "%.0f",
+		 intel_frontend_bound_lat_value (ss, row));
 }
 
 static perfmon_cpu_supports_t frontend_bound_lat_cpu_supports[] = {
@@ -88,11 +92,13 @@ PERFMON_REGISTER_BUNDLE (intel_core_frontend_bound_lat) = {
   .events[5] = INTEL_CORE_E_CPU_CLK_UNHALTED_THREAD_P,	      /* FIXED */
   .n_events = 6,
   .format_fn = format_intel_frontend_bound_lat,
+  .node_value_fn = intel_frontend_bound_lat_value,
   .cpu_supports = frontend_bound_lat_cpu_supports,
   .n_cpu_supports = ARRAY_LEN (frontend_bound_lat_cpu_supports),
   .column_headers = PERFMON_STRINGS ("Clocks/Packet", "% iCache Miss",
 				     "% DSB Switch", "% Branch Resteer",
 				     "% MS Switch"),
+  .stall_columns = 0x1e,
   .footer =
     "For more information, see the Intel(R) 64 and IA-32 Architectures\n"
     "Optimization Reference Manual on the Front End.",
@@ -14,36 +14,41 @@
  */
 
 #include <vnet/vnet.h>
+#include <math.h>
 #include <perfmon/perfmon.h>
 #include <perfmon/intel/core.h>
 
-static u8 *
-format_inst_and_clock (u8 *s, va_list *args)
+static f64
+inst_and_clock_value (perfmon_node_stats_t *ns, u32 row)
 {
-  perfmon_node_stats_t *ns = va_arg (*args, perfmon_node_stats_t *);
-  int row = va_arg (*args, int);
-
   switch (row)
     {
     case 0:
-      s = format (s, "%lu", ns->n_calls);
-      break;
+      return ns->n_calls;
     case 1:
-      s = format (s, "%lu", ns->n_packets);
-      break;
+      return ns->n_packets;
     case 2:
-      s = format (s, "%.2f", (f64) ns->n_packets / ns->n_calls);
-      break;
+      return (f64) ns->n_packets / ns->n_calls;
     case 3:
-      s = format (s, "%.2f", (f64) ns->value[1] / ns->n_packets);
-      break;
+      return (f64) ns->value[1] / ns->n_packets;
     case 4:
-      s = format (s, "%.2f", (f64) ns->value[0] / ns->n_packets);
-      break;
+      return (f64) ns->value[0] / ns->n_packets;
     case 5:
-      s = format (s, "%.2f", (f64) ns->value[0] / ns->value[1]);
-      break;
+      return (f64) ns->value[0] / ns->value[1];
     }
+  return NAN;
+}
+
+static u8 *
+format_inst_and_clock (u8 *s, va_list *args)
+{
+  perfmon_node_stats_t *ns = va_arg (*args, perfmon_node_stats_t *);
+  int row = va_arg (*args, int);
+
+  if (row < 2)
+    return format (s, "%lu", row ? ns->n_packets : ns->n_calls);
+  if (row < 6)
+    s = format (s, "%.2f", inst_and_clock_value (ns, row));
   return s;
 }
 
@@ -57,6 +62,7 @@ PERFMON_REGISTER_BUNDLE (inst_and_clock) = {
   .events[2] = INTEL_CORE_E_CPU_CLK_UNHALTED_REF_TSC,
   .n_events = 3,
   .format_fn = format_inst_and_clock,
+  .node_value_fn = inst_and_clock_value,
   .column_headers = PERFMON_STRINGS ("Calls", "Packets", "Packets/Call",
 				     "Clocks/Packet", "Instructions/Packet",
 				     "IPC"),
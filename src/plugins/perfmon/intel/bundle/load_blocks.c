@@ -14,33 +14,39 @@
  */
 
 #include <vnet/vnet.h>
+#include <math.h>
 #include <perfmon/perfmon.h>
 #include <perfmon/intel/core.h>
 
-static u8 *
-format_load_blocks (u8 *s, va_list *args)
+static f64
+load_blocks_value (perfmon_node_stats_t *ns, u32 row)
 {
-  perfmon_node_stats_t *ns = va_arg (*args, perfmon_node_stats_t *);
-  int row = va_arg (*args, int);
-
   switch (row)
     {
     case 0:
-      s = format (s, "%12lu", ns->n_calls);
-      break;
+      return ns->n_calls;
     case 1:
-      s = format (s, "%12lu", ns->n_packets);
-      break;
+      return ns->n_packets;
     case 2:
-      s = format (s, "%9.2f", (f64) ns->value[0] / ns->n_calls);
-      break;
+      return (f64) ns->value[0] / ns->n_calls;
     case 3:
-      s = format (s, "%9.2f", (f64) ns->value[1] / ns->n_calls);
-      break;
+      return (f64) ns->value[1] / ns->n_calls;
     case 4:
-      s = format (s, "%9.2f", (f64) ns->value[2] / ns->n_calls);
-      break;
+      return (f64) ns->value[2] / ns->n_calls;
     }
+  return NAN;
+}
+
+static u8 *
+format_load_blocks (u8 *s, va_list *args)
+{
+  perfmon_node_stats_t *ns = va_arg (*args, perfmon_node_stats_t *);
+  int row = va_arg (*args, int);
+
+  if (row < 2)
+    return format (s, "%12lu", row ? ns->n_packets : ns->n_calls);
+  if (row < 5)
+    s = format (s, "%9.2f", load_blocks_value (ns, row));
   return s;
 }
 
@@ -54,6 +60,7 @@ PERFMON_REGISTER_BUNDLE (load_blocks) = {
   .events[2] = INTEL_CORE_E_LD_BLOCKS_PARTIAL_ADDRESS_ALIAS,
   .n_events = 3,
   .format_fn = format_load_blocks,
+  .node_value_fn = load_blocks_value,
   .column_headers = PERFMON_STRINGS ("Calls", "Packets", "[1]", "[2]", "[3]"),
   .footer = "Per node call statistics:\n"
 	    "[1] Loads blocked due to overlapping with a preceding store that "
@@ -14,30 +14,27 @@
  */
 
 #include <vnet/vnet.h>
+#include <math.h>
 #include <perfmon/perfmon.h>
 #include <perfmon/intel/core.h>
 
+static f64
+power_licensing_value (perfmon_node_stats_t *ns, u32 row)
+{
+  /* LVL0, LVL1, LVL2 and throttle cycles follow the thread cycles */
+  if (row < 4)
+    return (ns->value[row + 1] / (f64) ns->value[0]) * 100;
+  return NAN;
+}
+
 static u8 *
 format_power_licensing (u8 *s, va_list *args)
 {
   perfmon_node_stats_t *ns = va_arg (*args, perfmon_node_stats_t *);
   int row = va_arg (*args, int);
 
-  switch (row)
-    {
-    case 0:
-      s = format (s, "%.2f", (ns->value[1] / (f64) ns->value[0]) * 100);
-      break;
-    case 1:
-      s = format (s, "%.2f", (ns->value[2] / (f64) ns->value[0]) * 100);
-      break;
-    case 2:
-      s = format (s, "%.2f", (ns->value[3] / (f64) ns->value[0]) * 100);
-      break;
-    case 3:
-      s = format (s, "%.2f", (ns->value[4] / (f64) ns->value[0]) * 100);
-      break;
-    }
+  if (row < 4)
+    s = format (s, "%.2f", power_licensing_value (ns, row));
   return s;
 }
 
@@ -53,5 +50,6 @@ PERFMON_REGISTER_BUNDLE (power_licensing) = {
   .events[4] = INTEL_CORE_E_CORE_POWER_THROTTLE,
   .n_events = 5,
   .format_fn = format_power_licensing,
+  .node_value_fn = power_licensing_value,
   .column_headers = PERFMON_STRINGS ("LVL0", "LVL1", "LVL2", "Throttle"),
 };
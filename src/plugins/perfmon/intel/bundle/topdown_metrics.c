@@ -15,6 +15,7 @@
 
 #include <vnet/vnet.h>
 #include <vppinfra/math.h>
+#include <math.h>
 #include <perfmon/perfmon.h>
 #include <perfmon/intel/core.h>
 
@@ -179,6 +180,14 @@ format_topdown_lvl2 (u8 *s, va_list *args)
   return s;
 }
 
+static f64
+topdown_lvl2_node_value (perfmon_node_stats_t *ns, u32 col)
+{
+  if (col >= TOPDOWN_E_MAX)
+    return NAN;
+  return topdown_lvl2_rdpmc_metric (ns, (topdown_e_t) col);
+}
+
 static perfmon_cpu_supports_t topdown_lvl2_cpu_supports[] = {
   /* Intel SPR supports papi/thread or rdpmc/node */
   { clib_cpu_supports_avx512_fp16, PERFMON_BUNDLE_TYPE_NODE_OR_THREAD }
@@ -202,10 +211,12 @@ PERFMON_REGISTER_BUNDLE (topdown_lvl2_metric) = {
   .cpu_supports = topdown_lvl2_cpu_supports,
   .n_cpu_supports = ARRAY_LEN (topdown_lvl2_cpu_supports),
   .format_fn = format_topdown_lvl2,
+  .node_value_fn = topdown_lvl2_node_value,
   .column_headers = PERFMON_STRINGS ("% RT", "% BS", "% FE", "% BE", "% RT.HO",
 				     "% RT.LO", "% BS.BM", "% BS.MC",
 				     "% FE.FL", "% FE.FB", "% BE.MB",
 				     "% BE.CB"),
+  .stall_columns = 0xfc0,
   .footer = "Retiring (RT), Bad Speculation (BS),\n"
 	    " FrontEnd bound (1FE), BackEnd bound (BE),\n"
 	    " Light Operations (LO), Heavy Operations (HO),\n"
@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/vnet.h>
+#include <vpp/app/version.h>
+#include <perfmon/perfmon.h>
+#include <fcntl.h>
+#include <math.h>
+
+VLIB_REGISTER_LOG_CLASS (perfmon_mux_log, static) = {
+  .class_name = "perfmon",
+  .subclass_name = "multiplex",
+};
+
+#define log_err(fmt, ...)                                                     \
+  vlib_log_err (perfmon_mux_log.class, fmt, __VA_ARGS__)
+
+/*
+ * Multiplexed mode: a number of node bundles are opened together and
+ * take turns counting, mux_slice seconds each. Each bundle keeps its own
+ * per thread node stats, and the clock counting dispatch wrappers add
+ * the clocks spent in each node, so the bundles can be put on a common
+ * scale afterwards and the nodes ranked by where the time goes.
+ */
+
+static uword
+perfmon_mux_process (vlib_main_t *vm, vlib_node_runtime_t *rt, vlib_frame_t *f)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  clib_error_t *err;
+  uword *event_data = 0;
+
+  while (1)
+    {
+      if (pm->is_running && vec_len (pm->mux_bundles) > 1)
+	vlib_process_wait_for_event_or_clock (vm, pm->mux_slice);
+      else
+	vlib_process_wait_for_event (vm);
+
+      vlib_process_get_events (vm, &event_data);
+      vec_reset_length (event_data);
+
+      if (!pm->is_running || vec_len (pm->mux_bundles) < 2)
+	continue;
+
+      if (vlib_time_now (vm) - pm->mux_slice_start < pm->mux_slice)
+	continue;
+
+      vlib_worker_thread_barrier_sync (vm);
+      err = perfmon_mux_disable (vm);
+      if (err == 0)
+	err = perfmon_mux_enable (
+	  vm, (pm->mux_active + 1) % vec_len (pm->mux_bundles));
+      vlib_worker_thread_barrier_release (vm);
+
+      if (err)
+	{
+	  log_err ("bundle rotation failed, stopping: %U", format_clib_error,
+		   err);
+	  clib_error_free (err);
+	  perfmon_reset (vm);
+	}
+    }
+
+  return 0;
+}
+
+VLIB_REGISTER_NODE (perfmon_mux_process_node) = {
+  .function = perfmon_mux_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "perfmon-mux-process",
+};
+
+static clib_error_t *
+perfmon_mux_init (vlib_main_t *vm)
+{
+  perfmon_main_t *pm = &perfmon_main;
+
+  pm->mux_node_index = perfmon_mux_process_node.index;
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (perfmon_mux_init);
+
+typedef struct
+{
+  u32 node_index;
+  u64 n_calls;
+  u64 n_packets;
+  u64 n_clocks;
+  /* per bundle vector of column values, NaN when not available or when
+     the bundle has no node_value_fn */
+  f64 **values;
+  f64 bottleneck;
+  u32 bottleneck_bundle;
+  u32 bottleneck_column;
+} perfmon_hotspot_t;
+
+static u32
+perfmon_bundle_n_columns (perfmon_bundle_t *b)
+{
+  u32 n = 0;
+
+  if (b->column_headers)
+    while (b->column_headers[n])
+      n++;
+  return n;
+}
+
+static f64
+perfmon_mux_bundle_time_active (vlib_main_t *vm, u32 index)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_mux_bundle_t *mb = vec_elt_at_index (pm->mux_bundles, index);
+  f64 t = mb->time_active;
+
+  if (pm->is_running && index == pm->mux_active)
+    t += vlib_time_now (vm) - pm->mux_slice_start;
+  return t;
+}
+
+/* fold the per thread stats of one node into a single set, summing the
+   accumulated events and taking the sample pairs of the busiest thread */
+static void
+perfmon_mux_merge_node_stats (perfmon_mux_bundle_t *mb, u32 node_index,
+			      perfmon_node_stats_t *ns)
+{
+  perfmon_bundle_t *b = mb->bundle;
+  u64 busiest = 0;
+
+  clib_memset (ns, 0, sizeof (*ns));
+
+  for (int i = 0; i < vec_len (mb->thread_runtimes); i++)
+    {
+      perfmon_thread_runtime_t *tr = vec_elt_at_index (mb->thread_runtimes, i);
+      perfmon_node_stats_t *s;
+
+      if (node_index >= vec_len (tr->node_stats))
+	continue;
+
+      s = tr->node_stats + node_index;
+      if (s->n_calls == 0)
+	continue;
+
+      ns->n_calls += s->n_calls;
+      ns->n_packets += s->n_packets;
+      ns->n_clocks += s->n_clocks;
+
+      for (int j = 0; j < b->n_events; j++)
+	if (!(b->preserve_samples & 1 << j))
+	  ns->value[j] += s->value[j];
+	else if (s->n_clocks >= busiest)
+	  {
+	    ns->t[0].value[j] = s->t[0].value[j];
+	    ns->t[1].value[j] = s->t[1].value[j];
+	  }
+
+      busiest = clib_max (busiest, s->n_clocks);
+    }
+}
+
+static perfmon_hotspot_t *
+perfmon_mux_collect (vlib_main_t *vm)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_hotspot_t *hs, *hotspots = 0;
+  u32 n_nodes = vec_len (vm->node_main.nodes);
+
+  for (u32 ni = 0; ni < n_nodes; ni++)
+    {
+      perfmon_hotspot_t h = { .node_index = ni, .bottleneck = NAN };
+      u64 n_calls = 0;
+
+      for (int m = 0; m < vec_len (pm->mux_bundles); m++)
+	{
+	  perfmon_mux_bundle_t *mb = vec_elt_at_index (pm->mux_bundles, m);
+	  perfmon_bundle_t *b = mb->bundle;
+	  u32 n_cols = perfmon_bundle_n_columns (b);
+	  perfmon_node_stats_t ns;
+	  f64 *v = 0;
+
+	  perfmon_mux_merge_node_stats (mb, ni, &ns);
+	  n_calls += ns.n_calls;
+	  h.n_calls += ns.n_calls;
+	  h.n_packets += ns.n_packets;
+	  h.n_clocks += ns.n_clocks;
+
+	  if (n_cols)
+	    vec_validate_init_empty (v, n_cols - 1, NAN);
+	  for (u32 c = 0; b->node_value_fn && ns.n_calls && c < n_cols; c++)
+	    {
+	      f64 val = b->node_value_fn (&ns, c);
+
+	      if (!isfinite (val))
+		continue;
+	      v[c] = val;
+
+	      if ((b->stall_columns & 1 << c) &&
+		  (isnan (h.bottleneck) || val > h.bottleneck))
+		{
+		  h.bottleneck = val;
+		  h.bottleneck_bundle = m;
+		  h.bottleneck_column = c;
+		}
+	    }
+	  vec_add1 (h.values, v);
+	}
+
+      if (n_calls == 0)
+	{
+	  for (int m = 0; m < vec_len (h.values); m++)
+	    vec_free (h.values[m]);
+	  vec_free (h.values);
+	  continue;
+	}
+
+      vec_add2 (hotspots, hs, 1);
+      hs[0] = h;
+    }
+
+  return hotspots;
+}
+
+static void
+perfmon_mux_free_hotspots (perfmon_hotspot_t *hotspots)
+{
+  for (int i = 0; i < vec_len (hotspots); i++)
+    {
+      for (int m = 0; m < vec_len (hotspots[i].values); m++)
+	vec_free (hotspots[i].values[m]);
+      vec_free (hotspots[i].values);
+    }
+  vec_free (hotspots);
+}
+
+static int
+perfmon_hotspot_sort_cmp (void *a1, void *a2)
+{
+  perfmon_hotspot_t *h1 = a1;
+  perfmon_hotspot_t *h2 = a2;
+
+  if (h1->n_clocks != h2->n_clocks)
+    return h1->n_clocks > h2->n_clocks ? -1 : 1;
+  return h1->n_packets > h2->n_packets ? -1 : h1->n_packets < h2->n_packets;
+}
+
+static u8 *
+format_perfmon_hotspot_bottleneck (u8 *s, va_list *args)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_hotspot_t *h = va_arg (*args, perfmon_hotspot_t *);
+  perfmon_bundle_t *b;
+
+  if (isnan (h->bottleneck))
+    return format (s, "-");
+
+  b = pm->mux_bundles[h->bottleneck_bundle].bundle;
+  return format (s, "%s %s (%.1f)", b->name,
+		 b->column_headers[h->bottleneck_column], h->bottleneck);
+}
+
+static u8 *
+format_perfmon_json_f64 (u8 *s, va_list *args)
+{
+  f64 v = va_arg (*args, f64);
+
+  if (isnan (v))
+    return format (s, "null");
+  return format (s, "%.3f", v);
+}
+
+static u8 *
+format_perfmon_hotspots_json (u8 *s, va_list *args)
+{
+  vlib_main_t *vm = va_arg (*args, vlib_main_t *);
+  perfmon_hotspot_t *hotspots = va_arg (*args, perfmon_hotspot_t *);
+  u32 n_top = va_arg (*args, u32);
+  f64 duration = va_arg (*args, f64);
+  u64 total_clocks = va_arg (*args, u64);
+  perfmon_main_t *pm = &perfmon_main;
+
+  s = format (s, "{\n  \"version\": \"%s\",\n", VPP_BUILD_VER);
+  s = format (s, "  \"duration\": %.3f,\n", duration);
+  s = format (s, "  \"slice\": %.3f,\n", pm->mux_slice);
+
+  s = format (s, "  \"bundles\": [\n");
+  for (int m = 0; m < vec_len (pm->mux_bundles); m++)
+    {
+      perfmon_mux_bundle_t *mb = vec_elt_at_index (pm->mux_bundles, m);
+      perfmon_bundle_t *b = mb->bundle;
+      u32 n_cols = perfmon_bundle_n_columns (b);
+
+      s = format (s, "    { \"name\": \"%s\", \"time_active\": %.3f, ",
+		  b->name, perfmon_mux_bundle_time_active (vm, m));
+      s = format (s, "\"slices\": %lu, \"columns\": [", mb->n_slices);
+      for (u32 c = 0; c < n_cols; c++)
+	s = format (s, "%s\"%s\"", c ? ", " : "", b->column_headers[c]);
+      s = format (s, "] }%s\n", m + 1 < vec_len (pm->mux_bundles) ? "," : "");
+    }
+  s = format (s, "  ],\n");
+
+  s = format (s, "  \"nodes\": [\n");
+  for (u32 i = 0; i < n_top; i++)
+    {
+      perfmon_hotspot_t *h = vec_elt_at_index (hotspots, i);
+
+      s = format (s, "    {\n      \"name\": \"%U\",\n", format_vlib_node_name,
+		  vm, h->node_index);
+      s = format (s, "      \"calls\": %lu,\n", h->n_calls);
+      s = format (s, "      \"packets\": %lu,\n", h->n_packets);
+      s = format (s, "      \"clocks\": %lu,\n", h->n_clocks);
+      s = format (s, "      \"clocks_per_packet\": %U,\n",
+		  format_perfmon_json_f64,
+		  h->n_packets ? (f64) h->n_clocks / h->n_packets : NAN);
+      s = format (s, "      \"clocks_share\": %U,\n", format_perfmon_json_f64,
+		  total_clocks ? 100.0 * h->n_clocks / total_clocks : NAN);
+
+      if (isnan (h->bottleneck))
+	s = format (s, "      \"bottleneck\": null,\n");
+      else
+	{
+	  perfmon_bundle_t *b = pm->mux_bundles[h->bottleneck_bundle].bundle;
+	  s = format (s,
+		      "      \"bottleneck\": { \"bundle\": \"%s\", "
+		      "\"column\": \"%s\", \"value\": %U },\n",
+		      b->name, b->column_headers[h->bottleneck_column],
+		      format_perfmon_json_f64, h->bottleneck);
+	}
+
+      s = format (s, "      \"metrics\": {\n");
+      for (int m = 0; m < vec_len (h->values); m++)
+	{
+	  s = format (s, "        \"%s\": [", pm->mux_bundles[m].bundle->name);
+	  for (int c = 0; c < vec_len (h->values[m]); c++)
+	    s = format (s, "%s%U", c ? ", " : "", format_perfmon_json_f64,
+			h->values[m][c]);
+	  s = format (s, "]%s\n", m + 1 < vec_len (h->values) ? "," : "");
+	}
+      s = format (s, "      }\n    }%s\n", i + 1 < n_top ? "," : "");
+    }
+  s = format (s, "  ]\n}\n");
+
+  return s;
+}
+
+static clib_error_t *
+show_perfmon_hotspots_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				  vlib_cli_command_t *cmd)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  unformat_input_t _line_input, *line_input = &_line_input;
+  perfmon_hotspot_t *hotspots;
+  clib_error_t *err = 0;
+  u8 *filename = 0, *s = 0;
+  int verbose = 0, json = 0;
+  u64 total_clocks = 0;
+  u32 n_top = 20;
+  f64 duration;
+
+  if (unformat_user (input, unformat_line_input, line_input))
+    {
+      while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+	{
+	  if (unformat (line_input, "top %u", &n_top))
+	    ;
+	  else if (unformat (line_input, "verbose"))
+	    verbose = 1;
+	  else if (unformat (line_input, "json"))
+	    json = 1;
+	  else if (unformat (line_input, "file %U", unformat_vlib_tmpfile,
+			     &filename))
+	    json = 1;
+	  else
+	    {
+	      err = clib_error_return (0, "unknown input `%U'",
+				       format_unformat_error, line_input);
+	      unformat_free (line_input);
+	      goto done;
+	    }
+	}
+      unformat_free (line_input);
+    }
+
+  if (vec_len (pm->mux_bundles) == 0)
+    {
+      err = clib_error_return (0, "perfmon was not started in multiplexed "
+				  "mode");
+      goto done;
+    }
+
+  hotspots = perfmon_mux_collect (vm);
+  vec_sort_with_function (hotspots, perfmon_hotspot_sort_cmp);
+
+  for (int i = 0; i < vec_len (hotspots); i++)
+    total_clocks += hotspots[i].n_clocks;
+
+  n_top = clib_min (n_top, vec_len (hotspots));
+  duration = pm->is_running ? vlib_time_now (vm) - pm->sample_time :
+			      pm->sample_time;
+
+  if (json)
+    {
+      s = format (s, "%U", format_perfmon_hotspots_json, vm, hotspots, n_top,
+		  duration, total_clocks);
+      if (filename)
+	{
+	  int fd;
+
+	  fd = open ((char *) filename, O_CREAT | O_TRUNC | O_WRONLY, 0664);
+
+	  if (fd < 0 || write (fd, s, vec_len (s)) != vec_len (s))
+	    err = clib_error_return_unix (0, "failed to write '%s'", filename);
+	  else
+	    vlib_cli_output (vm, "%u nodes written to %s", n_top, filename);
+	  if (fd >= 0)
+	    close (fd);
+	}
+      else
+	vlib_cli_output (vm, "%v", s);
+      perfmon_mux_free_hotspots (hotspots);
+      goto done;
+    }
+
+  vlib_cli_output (vm, "%u bundles over %.2f sec, %.0f msec slices",
+		   vec_len (pm->mux_bundles), duration, pm->mux_slice * 1e3);
+  for (int m = 0; m < vec_len (pm->mux_bundles); m++)
+    vlib_cli_output (vm, "  %-20s active %.2f sec in %lu slices",
+		     pm->mux_bundles[m].bundle->name,
+		     perfmon_mux_bundle_time_active (vm, m),
+		     pm->mux_bundles[m].n_slices);
+
+  vlib_cli_output (vm, "\n%-4s%-32s%14s%14s%8s%10s  %s", "#", "Node", "Calls",
+		   "Packets", "Clocks", "Clk/Pkt", "Bottleneck");
+  for (u32 i = 0; i < n_top; i++)
+    {
+      perfmon_hotspot_t *h = vec_elt_at_index (hotspots, i);
+
+      vlib_cli_output (vm, "%-4u%-32U%14lu%14lu%7.1f%%%10.1f  %U", i + 1,
+		       format_vlib_node_name, vm, h->node_index, h->n_calls,
+		       h->n_packets,
+		       total_clocks ? 100.0 * h->n_clocks / total_clocks : 0,
+		       h->n_packets ? (f64) h->n_clocks / h->n_packets : 0,
+		       format_perfmon_hotspot_bottleneck, h);
+
+      if (!verbose)
+	continue;
+
+      for (int m = 0; m < vec_len (h->values); m++)
+	{
+	  perfmon_bundle_t *b = pm->mux_bundles[m].bundle;
+
+	  vec_reset_length (s);
+	  for (int c = 0; c < vec_len (h->values[m]); c++)
+	    if (!isnan (h->values[m][c]))
+	      s = format (s, " %s=%.2f", b->column_headers[c],
+			  h->values[m][c]);
+	  if (vec_len (s))
+	    vlib_cli_output (vm, "    %s:%v", b->name, s);
+	}
+    }
+
+  perfmon_mux_free_hotspots (hotspots);
+
+done:
+  vec_free (filename);
+  vec_free (s);
+  return err;
+}
+
+VLIB_CLI_COMMAND (show_perfmon_hotspots_command, static) = {
+  .path = "show perfmon hotspots",
+  .short_help = "show perfmon hotspots [top <n>] [verbose] [json] "
+		"[file <filename>]",
+  .function = show_perfmon_hotspots_command_fn,
+  .is_mp_safe = 1,
+};
@@ -41,11 +41,26 @@ VLIB_REGISTER_LOG_CLASS (if_default_log, static) = {
   vlib_log_warn (if_default_log.class, fmt, __VA_ARGS__)
 #define log_err(fmt, ...) vlib_log_err (if_default_log.class, fmt, __VA_ARGS__)
 
+static void
+perfmon_free_thread_runtimes (perfmon_thread_runtime_t *thread_runtimes)
+{
+  uword page_size = clib_mem_get_page_size ();
+
+  for (int i = 0; i < vec_len (thread_runtimes); i++)
+    {
+      perfmon_thread_runtime_t *tr = vec_elt_at_index (thread_runtimes, i);
+      vec_free (tr->node_stats);
+      for (int j = 0; j < PERF_MAX_EVENTS; j++)
+	if (tr->mmap_pages[j])
+	  munmap (tr->mmap_pages[j], page_size);
+    }
+  vec_free (thread_runtimes);
+}
+
 void
 perfmon_reset (vlib_main_t *vm)
 {
   perfmon_main_t *pm = &perfmon_main;
-  uword page_size = clib_mem_get_page_size ();
 
   if (pm->is_running)
     for (int i = 0; i < vlib_get_n_threads (); i++)
@@ -54,6 +69,19 @@ perfmon_reset (vlib_main_t *vm)
   for (int i = 0; i < vec_len (pm->fds_to_close); i++)
     close (pm->fds_to_close[i]);
   vec_free (pm->fds_to_close);
+
+  for (int i = 0; i < vec_len (pm->mux_bundles); i++)
+    {
+      perfmon_mux_bundle_t *mb = vec_elt_at_index (pm->mux_bundles, i);
+      if (mb->thread_runtimes == pm->thread_runtimes)
+	pm->thread_runtimes = 0;
+      if (mb->group_fds == pm->group_fds)
+	pm->group_fds = 0;
+      perfmon_free_thread_runtimes (mb->thread_runtimes);
+      vec_free (mb->group_fds);
+    }
+  vec_free (pm->mux_bundles);
+
   vec_free (pm->group_fds);
   if (pm->default_instance_type)
     {
@@ -64,23 +92,21 @@ perfmon_reset (vlib_main_t *vm)
       vec_free (pm->default_instance_type);
     }
 
-  for (int i = 0; i < vec_len (pm->thread_runtimes); i++)
-    {
-      perfmon_thread_runtime_t *tr = vec_elt_at_index (pm->thread_runtimes, i);
-      vec_free (tr->node_stats);
-      for (int j = 0; j < PERF_MAX_EVENTS; j++)
-	if (tr->mmap_pages[j])
-	  munmap (tr->mmap_pages[j], page_size);
-    }
-  vec_free (pm->thread_runtimes);
+  perfmon_free_thread_runtimes (pm->thread_runtimes);
+  pm->thread_runtimes = 0;
 
   pm->is_running = 0;
   pm->active_instance_type = 0;
   pm->active_bundle = 0;
 }
 
-static clib_error_t *
-perfmon_set (vlib_main_t *vm, perfmon_bundle_t *b)
+/*
+ * Open the events of a bundle, disabled, into pm->group_fds and, for node
+ * bundles, pm->thread_runtimes. Nothing else is reset so several node
+ * bundles can be opened side by side for multiplexing.
+ */
+clib_error_t *
+perfmon_open_bundle (vlib_main_t *vm, perfmon_bundle_t *b)
 {
   clib_error_t *err = 0;
   perfmon_main_t *pm = &perfmon_main;
@@ -92,8 +118,6 @@ perfmon_set (vlib_main_t *vm, perfmon_bundle_t *b)
   perfmon_event_t *e;
   perfmon_instance_type_t *it = 0;
 
-  perfmon_reset (vm);
-
   s = b->src;
   ASSERT (b->n_events);
 
@@ -102,17 +126,21 @@ perfmon_set (vlib_main_t *vm, perfmon_bundle_t *b)
 
   if (s->instances_by_type == 0)
     {
-      vec_add2 (pm->default_instance_type, it, 1);
-      it->name = is_node ? "Thread/Node" : "Thread";
-      for (int i = 0; i < vlib_get_n_threads (); i++)
+      if (pm->default_instance_type == 0)
 	{
-	  vlib_worker_thread_t *w = vlib_worker_threads + i;
-	  perfmon_instance_t *in;
-	  vec_add2 (it->instances, in, 1);
-	  in->cpu = w->cpu_id;
-	  in->pid = w->lwp;
-	  in->name = (char *) format (0, "%s (%u)%c", w->name, i, 0);
+	  vec_add2 (pm->default_instance_type, it, 1);
+	  it->name = is_node ? "Thread/Node" : "Thread";
+	  for (int i = 0; i < vlib_get_n_threads (); i++)
+	    {
+	      vlib_worker_thread_t *w = vlib_worker_threads + i;
+	      perfmon_instance_t *in;
+	      vec_add2 (it->instances, in, 1);
+	      in->cpu = w->cpu_id;
+	      in->pid = w->lwp;
+	      in->name = (char *) format (0, "%s (%u)%c", w->name, i, 0);
+	    }
 	}
+      it = pm->default_instance_type;
       if (is_node)
 	vec_validate (pm->thread_runtimes, vlib_get_n_threads () - 1);
     }
@@ -202,8 +230,6 @@ perfmon_set (vlib_main_t *vm, perfmon_bundle_t *b)
 	}
     }
 
-  pm->active_bundle = b;
-
 error:
   if (err)
     {
@@ -213,6 +239,20 @@ error:
   return err;
 }
 
+static clib_error_t *
+perfmon_set (vlib_main_t *vm, perfmon_bundle_t *b)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  clib_error_t *err;
+
+  perfmon_reset (vm);
+
+  if ((err = perfmon_open_bundle (vm, b)) == 0)
+    pm->active_bundle = b;
+
+  return err;
+}
+
 static_always_inline u32
 perfmon_mmap_read_index (const struct perf_event_mmap_page *mmap_page)
 {
@@ -319,11 +359,138 @@ perfmon_stop (vlib_main_t *vm)
 	}
     }
 
+  if (vec_len (pm->mux_bundles))
+    pm->mux_bundles[pm->mux_active].time_active +=
+      vlib_time_now (vm) - pm->mux_slice_start;
+
   pm->is_running = 0;
   pm->sample_time = vlib_time_now (vm) - pm->sample_time;
   return 0;
 }
 
+/*
+ * Make a multiplexed bundle the counting one: enable its event groups,
+ * pick up their rdpmc indexes and install the clock counting dispatch
+ * wrappers. Workers must be parked at the barrier, or not running yet.
+ */
+clib_error_t *
+perfmon_mux_enable (vlib_main_t *vm, u32 index)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_mux_bundle_t *mb = vec_elt_at_index (pm->mux_bundles, index);
+  perfmon_bundle_t *b = mb->bundle;
+
+  for (int i = 0; i < vec_len (mb->group_fds); i++)
+    if (ioctl (mb->group_fds[i], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) ==
+	-1)
+      return clib_error_return_unix (0, "ioctl(PERF_EVENT_IOC_ENABLE)");
+
+  for (int i = 0; i < vec_len (mb->thread_runtimes); i++)
+    {
+      perfmon_thread_runtime_t *tr = vec_elt_at_index (mb->thread_runtimes, i);
+
+      for (int j = 0; j < b->n_events; j++)
+	{
+	  tr->indexes[j] = perfmon_mmap_read_index (tr->mmap_pages[j]);
+	  if (!tr->indexes[j])
+	    return clib_error_return (0, "invalid rdpmc index");
+	}
+    }
+
+  pm->thread_runtimes = mb->thread_runtimes;
+  pm->group_fds = mb->group_fds;
+  pm->active_bundle = b;
+  pm->mux_active = index;
+  pm->mux_slice_start = vlib_time_now (vm);
+  mb->n_slices++;
+
+  for (int i = 0; i < vlib_get_n_threads (); i++)
+    {
+      vlib_main_t *ovm = vlib_get_main_by_index (i);
+      vlib_node_set_dispatch_wrapper (ovm, 0);
+      vlib_node_set_dispatch_wrapper (
+	ovm, perfmon_dispatch_wrappers_clocks[b->n_events]);
+    }
+
+  return 0;
+}
+
+/*
+ * Stop counting the active multiplexed bundle. Its node stats stay
+ * where they are and keep adding up the next time it is enabled.
+ */
+clib_error_t *
+perfmon_mux_disable (vlib_main_t *vm)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_mux_bundle_t *mb;
+
+  mb = vec_elt_at_index (pm->mux_bundles, pm->mux_active);
+
+  for (int i = 0; i < vec_len (mb->group_fds); i++)
+    if (ioctl (mb->group_fds[i], PERF_EVENT_IOC_DISABLE,
+	       PERF_IOC_FLAG_GROUP) == -1)
+      return clib_error_return_unix (0, "ioctl(PERF_EVENT_IOC_DISABLE)");
+
+  mb->time_active += vlib_time_now (vm) - pm->mux_slice_start;
+  return 0;
+}
+
+/*
+ * Open all given node bundles and let them take turns counting, one
+ * slice at a time; see multiplex.c.
+ */
+clib_error_t *
+perfmon_mux_start (vlib_main_t *vm, perfmon_bundle_t **bundles, f64 slice)
+{
+  perfmon_main_t *pm = &perfmon_main;
+  perfmon_mux_bundle_t *mb;
+  clib_error_t *err;
+
+  if (pm->is_running == 1)
+    return clib_error_return (0, "already running");
+
+  perfmon_reset (vm);
+
+  for (int i = 0; i < vec_len (bundles); i++)
+    {
+      perfmon_bundle_t *b = bundles[i];
+
+      b->active_type = PERFMON_BUNDLE_TYPE_NODE;
+      if ((err = perfmon_open_bundle (vm, b)) != 0)
+	{
+	  /* close the bundles opened so far */
+	  perfmon_reset (vm);
+	  return err;
+	}
+
+      vec_add2 (pm->mux_bundles, mb, 1);
+      mb->bundle = b;
+      mb->thread_runtimes = pm->thread_runtimes;
+      mb->group_fds = pm->group_fds;
+      pm->thread_runtimes = 0;
+      pm->group_fds = 0;
+    }
+
+  /* perfmon start is mp-safe, park the workers while the wrappers go in */
+  vlib_worker_thread_barrier_sync (vm);
+  err = perfmon_mux_enable (vm, 0);
+  vlib_worker_thread_barrier_release (vm);
+
+  if (err)
+    {
+      perfmon_reset (vm);
+      return err;
+    }
+
+  pm->mux_slice = slice;
+  pm->sample_time = vlib_time_now (vm);
+  pm->is_running = 1;
+
+  vlib_process_signal_event (vm, pm->mux_node_index, 0, 0);
+  return 0;
+}
+
 static_always_inline u8
 is_enough_counters (perfmon_bundle_t *b)
 {
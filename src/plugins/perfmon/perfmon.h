@@ -87,6 +87,8 @@ typedef struct
 
 struct perfmon_source;
 extern vlib_node_function_t *perfmon_dispatch_wrappers[PERF_MAX_EVENTS + 1];
+extern vlib_node_function_t
+  *perfmon_dispatch_wrappers_clocks[PERF_MAX_EVENTS + 1];
 
 typedef clib_error_t *(perfmon_source_init_fn_t) (vlib_main_t *vm,
 						  struct perfmon_source *);
@@ -106,10 +108,15 @@ typedef struct perfmon_source
 } perfmon_source_t;
 
 struct perfmon_bundle;
+struct perfmon_node_stats;
 
 typedef clib_error_t *(perfmon_bundle_init_fn_t) (vlib_main_t *vm,
 						  struct perfmon_bundle *);
 
+/* value of one column for the stats of a node, NaN if it has none */
+typedef f64 (perfmon_bundle_node_value_fn_t) (struct perfmon_node_stats *ns,
+					      u32 column);
+
 typedef struct
 {
   clib_cpu_supports_func_t cpu_supports;
@@ -142,6 +149,11 @@ typedef struct perfmon_bundle
 
   char **column_headers;
   format_function_t *format_fn;
+  perfmon_bundle_node_value_fn_t *node_value_fn;
+
+  /* columns giving the % of cycles lost to one kind of stall, used by
+     'show perfmon hotspots' to name the bottleneck of a node */
+  u32 stall_columns;
 
   /* do not set manually */
   perfmon_source_t *src;
@@ -156,11 +168,12 @@ typedef struct
   u64 value[PERF_MAX_EVENTS];
 } perfmon_reading_t;
 
-typedef struct
+typedef struct perfmon_node_stats
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
   u64 n_calls;
   u64 n_packets;
+  u64 n_clocks; /* multiplexed mode only */
   union
   {
     struct
@@ -182,6 +195,15 @@ typedef struct
   struct perf_event_mmap_page *mmap_pages[PERF_MAX_EVENTS];
 } perfmon_thread_runtime_t;
 
+typedef struct
+{
+  perfmon_bundle_t *bundle;
+  perfmon_thread_runtime_t *thread_runtimes;
+  int *group_fds;
+  u64 n_slices;
+  f64 time_active;
+} perfmon_mux_bundle_t;
+
 typedef struct
 {
   perfmon_thread_runtime_t *thread_runtimes;
@@ -196,6 +218,14 @@ typedef struct
   int *fds_to_close;
   perfmon_instance_type_t *default_instance_type;
   perfmon_instance_type_t *active_instance_type;
+
+  /* multiplexed mode, node bundles take turns every mux_slice seconds;
+     thread_runtimes and group_fds point at the active one */
+  perfmon_mux_bundle_t *mux_bundles;
+  u32 mux_active;
+  f64 mux_slice;
+  f64 mux_slice_start;
+  u32 mux_node_index;
 } perfmon_main_t;
 
 extern perfmon_main_t perfmon_main;
@@ -258,8 +288,13 @@ perfmon_cpu_update_bundle_type (perfmon_bundle_t *b)
   perfmon_bundle_t __perfmon_bundle_##x
 
 void perfmon_reset (vlib_main_t *vm);
+clib_error_t *perfmon_open_bundle (vlib_main_t *vm, perfmon_bundle_t *b);
 clib_error_t *perfmon_start (vlib_main_t *vm, perfmon_bundle_t *);
 clib_error_t *perfmon_stop (vlib_main_t *vm);
+clib_error_t *perfmon_mux_start (vlib_main_t *vm, perfmon_bundle_t **bundles,
+				 f64 slice);
+clib_error_t *perfmon_mux_enable (vlib_main_t *vm, u32 index);
+clib_error_t *perfmon_mux_disable (vlib_main_t *vm);
 
 #define PERFMON_STRINGS(...)                                                  \
   (char *[]) { __VA_ARGS__, 0 }
@@ -19,176 +19,385 @@
 #include <vpp-api/client/stat_client.h>
 #include <vpp/stats/stat_segment.h>
 #include <ctype.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* replies to a full session event queue are retried with a doubling
+ * back off, about 100ms in total */
+#define PROM_RPC_N_RETRIES 10
+#define PROM_RPC_RETRY_USEC 100
 
 static prom_main_t prom_main;
 
-static u8 *
-make_stat_name (char *name)
+static void
+prom_entry_free (prom_entry_t *e)
 {
-  prom_main_t *pm = &prom_main;
-  char *p = name;
+  prom_chunk_t *c;
 
-  while (*p)
+  vec_foreach (c, e->chunks)
     {
-      if (!isalnum (*p))
-	*p = '_';
-      p++;
+      vec_free (c->values);
+      vec_free (c->text);
     }
+  vec_free (e->chunks);
+  vec_free (e->stat_name);
+  vec_free (e->name);
+}
+
+/* Drop everything rendered so far, with the pm->lock held */
+static void
+prom_cache_flush (prom_main_t *pm)
+{
+  prom_entry_t *e;
 
-  /* Reuse vector, instead of always allocating, when building a name. */
-  vec_reset_length (pm->name_scratch_pad);
-  pm->name_scratch_pad =
-    format (pm->name_scratch_pad, "%v%s", pm->stat_name_prefix, name);
-  return pm->name_scratch_pad;
+  vec_foreach (e, pm->entries)
+    prom_entry_free (e);
+  vec_free (pm->entries);
+  pm->last_scrape = 0;
 }
 
-static u8 *
-dump_counter_vector_simple (stat_segment_data_t *res, u8 *s, u8 used_only)
+static prom_entry_t *
+prom_entry_get (prom_main_t *pm, u32 index, char *stat_name)
 {
-  u8 need_header = 1;
-  int j, k;
-  u8 *name;
+  prom_entry_t *e;
+  u8 *p;
 
-  name = make_stat_name (res->name);
+  vec_validate (pm->entries, index);
+  e = vec_elt_at_index (pm->entries, index);
 
-  for (k = 0; k < vec_len (res->simple_counter_vec); k++)
-    for (j = 0; j < vec_len (res->simple_counter_vec[k]); j++)
-      {
-	if (used_only && !res->simple_counter_vec[k][j])
-	  continue;
-	if (need_header)
-	  {
-	    s = format (s, "# TYPE %v counter\n", name);
-	    need_header = 0;
-	  }
-	s = format (s, "%v{thread=\"%d\",interface=\"%d\"} %lld\n", name, k, j,
-		    res->simple_counter_vec[k][j]);
-      }
+  /* Directory indices are reused once entries are deleted */
+  if (e->stat_name && !strcmp (e->stat_name, stat_name))
+    return e;
+
+  prom_entry_free (e);
+  e->stat_name = (char *) format (0, "%s%c", stat_name, 0);
+  e->name = format (0, "%v%s", pm->stat_name_prefix, stat_name);
+  vec_foreach (p, e->name)
+    if (!isalnum (*p))
+      *p = '_';
 
+  return e;
+}
+
+/*
+ * Returns chunk @a chunk_index of @a e, for @a n_bytes worth of counters
+ * of thread @a thread_index starting at index @a first. If they are not
+ * the ones the chunk text was rendered from, the chunk keeps a copy of
+ * them and @a render is set, for the caller to render its text again.
+ */
+static prom_chunk_t *
+prom_chunk_get (prom_entry_t *e, u32 chunk_index, u32 thread_index,
+		u32 first, void *values, uword n_bytes, int *render)
+{
+  prom_chunk_t *c;
+
+  vec_validate (e->chunks, chunk_index);
+  c = vec_elt_at_index (e->chunks, chunk_index);
+
+  *render = c->thread_index != thread_index || c->first != first ||
+	    vec_len (c->values) != n_bytes ||
+	    memcmp (c->values, values, n_bytes);
+  if (!*render)
+    return c;
+
+  c->thread_index = thread_index;
+  c->first = first;
+  vec_reset_length (c->values);
+  vec_add (c->values, values, n_bytes);
+  vec_reset_length (c->text);
+
+  return c;
+}
+
+/* Forget chunks past the @a n_chunks used by the last render */
+static void
+prom_entry_trim (prom_entry_t *e, u32 n_chunks)
+{
+  u32 i;
+
+  for (i = n_chunks; i < vec_len (e->chunks); i++)
+    {
+      vec_free (e->chunks[i].values);
+      vec_free (e->chunks[i].text);
+    }
+  if (n_chunks < vec_len (e->chunks))
+    _vec_len (e->chunks) = n_chunks;
+}
+
+/* Metrics without any sample are left out, header included */
+static u8 *
+prom_end_metric (u8 *s, u32 start, u32 samples_start)
+{
+  if (vec_len (s) == samples_start)
+    _vec_len (s) = start;
   return s;
 }
 
 static u8 *
-dump_counter_vector_combined (stat_segment_data_t *res, u8 *s, u8 used_only)
+dump_counter_vector_simple (prom_main_t *pm, prom_entry_t *e,
+			    stat_segment_data_t *res, u8 *s)
 {
-  u8 need_header = 1;
-  int j, k;
-  u8 *name;
+  u32 i, j, k, n, start, ci = 0;
+  char *type = "counter";
+  prom_chunk_t *c;
+  counter_t *v;
+  int render;
+
+  if (res->type == STAT_DIR_TYPE_GAUGE_VECTOR)
+    type = "gauge";
 
-  name = make_stat_name (res->name);
+  start = vec_len (s);
+  s = format (s, "# TYPE %v %s\n", e->name, type);
+  n = vec_len (s);
 
   for (k = 0; k < vec_len (res->simple_counter_vec); k++)
-    for (j = 0; j < vec_len (res->combined_counter_vec[k]); j++)
-      {
-	if (used_only && !res->combined_counter_vec[k][j].packets)
-	  continue;
-	if (need_header)
-	  {
-	    s = format (s, "# TYPE %v_packets counter\n", name);
-	    s = format (s, "# TYPE %v_bytes counter\n", name);
-	    need_header = 0;
-	  }
-	s = format (s, "%v_packets{thread=\"%d\",interface=\"%d\"} %lld\n",
-		    name, k, j, res->combined_counter_vec[k][j].packets);
-	s = format (s, "%v_bytes{thread=\"%d\",interface=\"%d\"} %lld\n", name,
-		    k, j, res->combined_counter_vec[k][j].bytes);
-      }
+    {
+      v = res->simple_counter_vec[k];
+      for (j = 0; j < vec_len (v); j += PROM_CHUNK_SIZE)
+	{
+	  c = prom_chunk_get (e, ci++, k, j, v + j,
+			      clib_min (PROM_CHUNK_SIZE, vec_len (v) - j) *
+				sizeof (v[0]),
+			      &render);
+	  for (i = j; render && i < vec_len (v) && i < j + PROM_CHUNK_SIZE;
+	       i++)
+	    {
+	      if (pm->used_only && !v[i])
+		continue;
+	      c->text = format (c->text, "%v{thread=\"%d\",interface=\"%d\"} "
+				"%lld\n", e->name, k, i, v[i]);
+	    }
+	  vec_append (s, c->text);
+	}
+    }
 
-  return s;
+  prom_entry_trim (e, ci);
+  return prom_end_metric (s, start, n);
 }
 
+/* Log-linear histograms, merged across threads by the stat client */
 static u8 *
-dump_error_index (stat_segment_data_t *res, u8 *s, u8 used_only)
+dump_histogram_vector (prom_main_t *pm, prom_entry_t *e,
+		       stat_segment_data_t *res, u8 *s)
 {
-  u8 *name;
-  int j;
+  counter_t *values = 0, seen;
+  u32 b, j, n, start, last;
+  stat_histogram_t *h;
+  prom_chunk_t *c;
+  int render;
 
-  name = make_stat_name (res->name);
+  start = vec_len (s);
+  s = format (s, "# TYPE %v histogram\n", e->name);
+  n = vec_len (s);
 
-  for (j = 0; j < vec_len (res->error_vector); j++)
+  for (j = 0; j < vec_len (res->histogram_vec); j++)
     {
-      if (used_only && !res->error_vector[j])
-	continue;
-      s = format (s, "# TYPE %v counter\n", name);
-      s =
-	format (s, "%v{thread=\"%d\"} %lld\n", name, j, res->error_vector[j]);
+      h = res->histogram_vec + j;
+
+      /* Rendered from the sum and the buckets */
+      vec_reset_length (values);
+      vec_add1 (values, h->sum);
+      vec_append (values, h->buckets);
+      c = prom_chunk_get (e, j, 0, j, values,
+			  vec_len (values) * sizeof (values[0]), &render);
+
+      /* Buckets are many, leave out histograms which never counted */
+      if (render && h->count && vec_len (h->buckets))
+	{
+	  /* The last bucket is open ended, it only shows up as +Inf */
+	  last = vec_len (h->buckets) - 1;
+	  for (b = 0, seen = 0; b < last; b++)
+	    {
+	      seen += h->buckets[b];
+	      c->text = format (
+		c->text, "%v_bucket{index=\"%d\",le=\"%llu\"} %lld\n",
+		e->name, j,
+		vlib_histogram_bucket_min (b + 1, h->log2_sub_buckets) - 1,
+		seen);
+	    }
+	  c->text = format (c->text,
+			    "%v_bucket{index=\"%d\",le=\"+Inf\"} %lld\n"
+			    "%v_sum{index=\"%d\"} %lld\n"
+			    "%v_count{index=\"%d\"} %lld\n",
+			    e->name, j, h->count, e->name, j, h->sum, e->name,
+			    j, h->count);
+	}
+      vec_append (s, c->text);
     }
+  vec_free (values);
 
-  return s;
+  prom_entry_trim (e, vec_len (res->histogram_vec));
+  return prom_end_metric (s, start, n);
 }
 
 static u8 *
-dump_scalar_index (stat_segment_data_t *res, u8 *s, u8 used_only)
+dump_counter_vector_combined (prom_main_t *pm, prom_entry_t *e,
+			      stat_segment_data_t *res, u8 *s)
 {
-  u8 *name;
+  u32 i, j, k, n, start, ci = 0;
+  vlib_counter_t *v;
+  prom_chunk_t *c;
+  int render;
 
-  if (used_only && !res->scalar_value)
-    return s;
+  start = vec_len (s);
+  s = format (s, "# TYPE %v_packets counter\n", e->name);
+  s = format (s, "# TYPE %v_bytes counter\n", e->name);
+  n = vec_len (s);
+
+  for (k = 0; k < vec_len (res->combined_counter_vec); k++)
+    {
+      v = res->combined_counter_vec[k];
+      for (j = 0; j < vec_len (v); j += PROM_CHUNK_SIZE)
+	{
+	  c = prom_chunk_get (e, ci++, k, j, v + j,
+			      clib_min (PROM_CHUNK_SIZE, vec_len (v) - j) *
+				sizeof (v[0]),
+			      &render);
+	  for (i = j; render && i < vec_len (v) && i < j + PROM_CHUNK_SIZE;
+	       i++)
+	    {
+	      if (pm->used_only && !v[i].packets)
+		continue;
+	      c->text = format (c->text, "%v_packets{thread=\"%d\","
+				"interface=\"%d\"} %lld\n", e->name, k, i,
+				v[i].packets);
+	      c->text = format (c->text, "%v_bytes{thread=\"%d\","
+				"interface=\"%d\"} %lld\n", e->name, k, i,
+				v[i].bytes);
+	    }
+	  vec_append (s, c->text);
+	}
+    }
+
+  prom_entry_trim (e, ci);
+  return prom_end_metric (s, start, n);
+}
 
-  name = make_stat_name (res->name);
+static u8 *
+dump_error_index (prom_main_t *pm, prom_entry_t *e, stat_segment_data_t *res,
+		  u8 *s)
+{
+  counter_t *v = res->error_vector;
+  u32 j, n, start;
+  prom_chunk_t *c;
+  int render;
+
+  start = vec_len (s);
+  s = format (s, "# TYPE %v counter\n", e->name);
+  n = vec_len (s);
+
+  c = prom_chunk_get (e, 0, 0, 0, v, vec_len (v) * sizeof (v[0]), &render);
+  for (j = 0; render && j < vec_len (v); j++)
+    {
+      if (pm->used_only && !v[j])
+	continue;
+      c->text = format (c->text, "%v{thread=\"%d\"} %lld\n", e->name, j, v[j]);
+    }
+  vec_append (s, c->text);
+
+  return prom_end_metric (s, start, n);
+}
+
+static u8 *
+dump_scalar_index (prom_main_t *pm, prom_entry_t *e, stat_segment_data_t *res,
+		   u8 *s)
+{
+  if (pm->used_only && !res->scalar_value)
+    return s;
 
-  s = format (s, "# TYPE %v counter\n", name);
-  s = format (s, "%v %.2f\n", name, res->scalar_value);
+  s = format (s, "# TYPE %v counter\n", e->name);
+  s = format (s, "%v %.2f\n", e->name, res->scalar_value);
 
   return s;
 }
 
 static u8 *
-dump_name_vector (stat_segment_data_t *res, u8 *s, u8 used_only)
+dump_name_vector (prom_main_t *pm, prom_entry_t *e, stat_segment_data_t *res,
+		  u8 *s)
 {
-  u8 *name;
-  int k;
+  u8 **names = res->name_vector, *values = 0;
+  u32 i, j, n, start, ci = 0;
+  prom_chunk_t *c;
+  int render;
 
-  name = make_stat_name (res->name);
+  start = vec_len (s);
+  s = format (s, "# TYPE %v_info gauge\n", e->name);
+  n = vec_len (s);
 
-  s = format (s, "# TYPE %v_info gauge\n", name);
-  for (k = 0; k < vec_len (res->name_vector); k++)
-    s = format (s, "%v_info{index=\"%d\",name=\"%s\"} 1\n", name, k,
-		res->name_vector[k]);
+  for (j = 0; j < vec_len (names); j += PROM_CHUNK_SIZE)
+    {
+      /* Names of the chunk, null terminated, is what it is rendered from */
+      vec_reset_length (values);
+      for (i = j; i < vec_len (names) && i < j + PROM_CHUNK_SIZE; i++)
+	if (names[i])
+	  vec_add (values, names[i], strlen ((char *) names[i]) + 1);
+	else
+	  vec_add1 (values, 0);
+
+      c = prom_chunk_get (e, ci++, 0, j, values, vec_len (values), &render);
+      for (i = j; render && i < vec_len (names) && i < j + PROM_CHUNK_SIZE;
+	   i++)
+	if (names[i])
+	  c->text = format (c->text, "%v_info{index=\"%d\",name=\"%s\"} 1\n",
+			    e->name, i, names[i]);
+      vec_append (s, c->text);
+    }
+  vec_free (values);
 
-  return s;
+  prom_entry_trim (e, ci);
+  return prom_end_metric (s, start, n);
 }
 
+/* Scrape counters matching @a patterns, with the pm->lock held */
 static u8 *
-scrape_stats_segment (u8 *s, u8 **patterns, u8 used_only)
+scrape_stats_segment (prom_main_t *pm, u8 *s, u8 **patterns)
 {
   stat_segment_data_t *res;
-  static u32 *stats = 0;
+  prom_entry_t *e;
+  u32 *stats;
   int i;
 
+retry:
   stats = stat_segment_ls (patterns);
+  if (!vec_len (stats))
+    return s;
 
-retry:
   res = stat_segment_dump (stats);
   if (res == 0)
     { /* Memory layout has changed */
-      if (stats)
-	vec_free (stats);
-      stats = stat_segment_ls (patterns);
+      vec_free (stats);
       goto retry;
     }
 
   for (i = 0; i < vec_len (res); i++)
     {
+      e = prom_entry_get (pm, stats[i], res[i].name);
+
       switch (res[i].type)
 	{
 	case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
-	  s = dump_counter_vector_simple (&res[i], s, used_only);
+	case STAT_DIR_TYPE_GAUGE_VECTOR:
+	  s = dump_counter_vector_simple (pm, e, &res[i], s);
+	  break;
+
+	case STAT_DIR_TYPE_HISTOGRAM_VECTOR:
+	  s = dump_histogram_vector (pm, e, &res[i], s);
 	  break;
 
 	case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
-	  s = dump_counter_vector_combined (&res[i], s, used_only);
+	  s = dump_counter_vector_combined (pm, e, &res[i], s);
 	  break;
 	case STAT_DIR_TYPE_ERROR_INDEX:
-	  s = dump_error_index (&res[i], s, used_only);
+	  s = dump_error_index (pm, e, &res[i], s);
 	  break;
 
 	case STAT_DIR_TYPE_SCALAR_INDEX:
-	  s = dump_scalar_index (&res[i], s, used_only);
+	  s = dump_scalar_index (pm, e, &res[i], s);
 	  break;
 
 	case STAT_DIR_TYPE_NAME_VECTOR:
-	  s = dump_name_vector (&res[i], s, used_only);
+	  s = dump_name_vector (pm, e, &res[i], s);
 	  break;
 
 	case STAT_DIR_TYPE_EMPTY:
@@ -200,126 +409,229 @@ retry:
 	}
     }
   stat_segment_data_free (res);
+  vec_free (stats);
 
   return s;
 }
 
-static void
-send_data_to_hss (hss_session_handle_t sh)
+#ifdef HAVE_ZLIB
+static u8 *
+prom_gzip (u8 *data)
 {
-  hss_url_handler_args_t args = {};
-  prom_main_t *pm = &prom_main;
-
-  args.sh = sh;
-  args.data = vec_dup (pm->stats);
-  args.data_len = vec_len (pm->stats);
-  args.sc = HTTP_STATUS_OK;
-  args.free_vec_data = 1;
+  z_stream zs = {};
+  u8 *out = 0;
+
+  /* Window bits past 15 ask for a gzip header and trailer */
+  if (deflateInit2 (&zs, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8,
+		    Z_DEFAULT_STRATEGY) != Z_OK)
+    return 0;
+
+  vec_validate (out, deflateBound (&zs, vec_len (data)) - 1);
+  zs.next_in = data;
+  zs.avail_in = vec_len (data);
+  zs.next_out = out;
+  zs.avail_out = vec_len (out);
+
+  if (deflate (&zs, Z_FINISH) == Z_STREAM_END)
+    _vec_len (out) = zs.total_out;
+  else
+    vec_free (out);
+  deflateEnd (&zs);
 
-  pm->send_data (&args);
+  return out;
 }
+#else
+static u8 *
+prom_gzip (u8 *data)
+{
+  return 0;
+}
+#endif
 
 static void
 send_data_to_hss_rpc (void *rpc_args)
 {
-  send_data_to_hss (*(hss_session_handle_t *) rpc_args);
+  hss_url_handler_args_t *args = rpc_args;
+
+  prom_main.send_data (args);
+  clib_mem_free (args);
 }
 
-static uword
-prom_scraper_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
-		      vlib_frame_t *f)
+static void
+prom_serve_request (prom_main_t *pm, prom_request_t *req)
 {
-  uword *event_data = 0, event_type;
-  prom_main_t *pm = &prom_main;
-  hss_session_handle_t sh;
-  f64 timeout = 10000.0;
+  int gzip = req->accept_encoding == HTTP_CONTENT_ENCODING_GZIP;
+  hss_url_handler_args_t *args;
+  u8 *data, *gz = 0;
+  f64 now;
 
-  while (1)
+  pthread_mutex_lock (&pm->lock);
+
+  if (req->patterns)
     {
-      vlib_process_wait_for_event_or_clock (vm, timeout);
-      event_type = vlib_process_get_events (vm, (uword **) &event_data);
-      switch (event_type)
+      data = scrape_stats_segment (pm, 0, req->patterns);
+      if (gzip && (gz = prom_gzip (data)))
+	{
+	  vec_free (data);
+	  data = gz;
+	}
+    }
+  else
+    {
+      /* If we've recently scraped stats, return data */
+      now = unix_time_now ();
+      if (now - pm->last_scrape >= pm->min_scrape_interval)
 	{
-	case ~0:
-	  /* timeout, do nothing */
-	  break;
-	case PROM_SCRAPER_EVT_RUN:
-	  sh.as_u64 = event_data[0];
 	  vec_reset_length (pm->stats);
-	  pm->stats = scrape_stats_segment (pm->stats, pm->stats_patterns,
-					    pm->used_only);
-	  session_send_rpc_evt_to_thread_force (sh.thread_index,
-						send_data_to_hss_rpc, &sh);
-	  pm->last_scrape = vlib_time_now (vm);
-	  break;
-	default:
-	  clib_warning ("unexpected event %u", event_type);
-	  break;
+	  pm->stats = scrape_stats_segment (pm, pm->stats, pm->stats_patterns);
+	  vec_free (pm->stats_gzip);
+	  pm->last_scrape = now;
 	}
+      if (gzip && !pm->stats_gzip)
+	pm->stats_gzip = prom_gzip (pm->stats);
+      gz = gzip ? pm->stats_gzip : 0;
+      data = vec_dup (gz ? gz : pm->stats);
+    }
 
-      vec_reset_length (event_data);
+  pthread_mutex_unlock (&pm->lock);
+
+  args = clib_mem_alloc (sizeof (*args));
+  clib_memset (args, 0, sizeof (*args));
+  args->sh = req->sh;
+  args->data = data;
+  args->data_len = vec_len (data);
+  args->sc = HTTP_STATUS_OK;
+  args->free_vec_data = 1;
+  args->content_encoding =
+    gz ? HTTP_CONTENT_ENCODING_GZIP : HTTP_CONTENT_ENCODING_IDENTITY;
+
+  /* the session thread's event queue can be full for a moment, back off
+   * and retry rather than leave the request without a reply */
+  for (int i = 0; i < PROM_RPC_N_RETRIES; i++)
+    {
+      if (!session_send_rpc_evt_to_thread_force (req->sh.thread_index,
+						 send_data_to_hss_rpc, args))
+	return;
+      usleep (PROM_RPC_RETRY_USEC << i);
     }
-  return 0;
-}
 
-VLIB_REGISTER_NODE (prom_scraper_process_node) = {
-  .function = prom_scraper_process,
-  .type = VLIB_NODE_TYPE_PROCESS,
-  .name = "prom-scraper-process",
-  .state = VLIB_NODE_STATE_DISABLED,
-};
+  clib_warning ("failed to send reply to thread %u", req->sh.thread_index);
+  vec_free (args->data);
+  clib_mem_free (args);
+}
 
-static void
-prom_scraper_process_enable (vlib_main_t *vm)
+static void *
+prom_scraper_thread_fn (void *arg)
 {
-  prom_main_t *pm = &prom_main;
-  vlib_node_t *n;
+  prom_main_t *pm = arg;
+  prom_request_t *reqs = 0, *req, *tmp;
+  u8 **pattern;
+
+  pthread_mutex_lock (&pm->queue_lock);
+  while (1)
+    {
+      if (!vec_len (pm->requests))
+	{
+	  pthread_cond_wait (&pm->queue_cond, &pm->queue_lock);
+	  continue;
+	}
+
+      tmp = pm->requests;
+      pm->requests = reqs;
+      reqs = tmp;
+      pthread_mutex_unlock (&pm->queue_lock);
+
+      vec_foreach (req, reqs)
+	{
+	  prom_serve_request (pm, req);
+	  vec_foreach (pattern, req->patterns)
+	    vec_free (*pattern);
+	  vec_free (req->patterns);
+	}
+      vec_reset_length (reqs);
 
-  vlib_node_set_state (vm, prom_scraper_process_node.index,
-		       VLIB_NODE_STATE_POLLING);
-  n = vlib_get_node (vm, prom_scraper_process_node.index);
-  vlib_start_process (vm, n->runtime_index);
+      pthread_mutex_lock (&pm->queue_lock);
+    }
 
-  pm->scraper_node_index = n->index;
+  return 0;
 }
 
-static void
-signal_run_to_scraper (uword *args)
+static int
+prom_hex_digit (u8 c)
 {
-  prom_main_t *pm = &prom_main;
-  ASSERT (vlib_get_thread_index () == 0);
-  vlib_process_signal_event (pm->vm, pm->scraper_node_index,
-			     PROM_SCRAPER_EVT_RUN, *args);
+  return isdigit (c) ? c - '0' : tolower (c) - 'a' + 10;
 }
 
-hss_url_handler_rc_t
-prom_stats_dump (hss_url_handler_args_t *args)
+/*
+ * Patterns passed as match=<regex> in the query of the request, percent
+ * decoded and null terminated for stat_segment_ls
+ */
+static u8 **
+prom_query_patterns (u8 *request)
 {
-  vlib_main_t *vm = vlib_get_main ();
-  f64 now = vlib_time_now (vm);
-  prom_main_t *pm = &prom_main;
+  u32 i, end, len = vec_len (request);
+  u8 **patterns = 0, *p = 0;
+
+  for (i = 0; i < len && request[i] != '?'; i++)
+    ;
 
-  /* If we've recently scraped stats, return data */
-  if ((now - pm->last_scrape) < pm->min_scrape_interval)
+  for (i++; i < len; i = end + 1)
     {
-      send_data_to_hss (args->sh);
-      return HSS_URL_HANDLER_ASYNC;
-    }
+      for (end = i; end < len && request[end] != '&'; end++)
+	;
 
-  if (vm->thread_index != 0)
-    vl_api_rpc_call_main_thread (signal_run_to_scraper, (u8 *) &args->sh,
-				 sizeof (args->sh));
-  else
-    signal_run_to_scraper (&args->sh.as_u64);
+      vec_reset_length (p);
+      for (; i < end; i++)
+	{
+	  if (request[i] == '%' && i + 2 < end && isxdigit (request[i + 1]) &&
+	      isxdigit (request[i + 2]))
+	    {
+	      vec_add1 (p, prom_hex_digit (request[i + 1]) << 4 |
+			     prom_hex_digit (request[i + 2]));
+	      i += 2;
+	    }
+	  else
+	    vec_add1 (p, request[i] == '+' ? ' ' : request[i]);
+	}
 
-  return HSS_URL_HANDLER_ASYNC;
+      if (vec_len (p) > 6 && !memcmp (p, "match=", 6))
+	vec_delete (p, 6, 0);
+      else if (vec_len (p) > 8 && !memcmp (p, "match[]=", 8))
+	vec_delete (p, 8, 0);
+      else
+	continue;
+
+      vec_add1 (p, 0);
+      vec_add1 (patterns, p);
+      p = 0;
+    }
+  vec_free (p);
+
+  return patterns;
 }
 
-void
-prom_stat_patterns_add (u8 **patterns)
+hss_url_handler_rc_t
+prom_stats_dump (hss_url_handler_args_t *args)
 {
   prom_main_t *pm = &prom_main;
+  prom_request_t req = {
+    .sh = args->sh,
+    .patterns = prom_query_patterns (args->request),
+    .accept_encoding = args->accept_encoding,
+  };
+
+  /* Scraping is left to the scraper thread, not to stall this one */
+  pthread_mutex_lock (&pm->queue_lock);
+  vec_add1 (pm->requests, req);
+  pthread_cond_signal (&pm->queue_cond);
+  pthread_mutex_unlock (&pm->queue_lock);
+
+  return HSS_URL_HANDLER_ASYNC;
+}
 
+static void
+stat_patterns_add (prom_main_t *pm, u8 **patterns)
+{
   u8 **pattern, **existing;
   u8 found;
   u32 len;
@@ -343,10 +655,9 @@ prom_stat_patterns_add (u8 **patterns)
     }
 }
 
-void
-prom_stat_patterns_free (void)
+static void
+stat_patterns_free (prom_main_t *pm)
 {
-  prom_main_t *pm = &prom_main;
   u8 **pattern;
 
   vec_foreach (pattern, pm->stats_patterns)
@@ -354,11 +665,43 @@ prom_stat_patterns_free (void)
   vec_free (pm->stats_patterns);
 }
 
+/*
+ * Configs are changed with the scraper thread out of the way, and don't
+ * wait for min-scrape-interval to show
+ */
+
+void
+prom_stat_patterns_add (u8 **patterns)
+{
+  prom_main_t *pm = &prom_main;
+
+  pthread_mutex_lock (&pm->lock);
+  stat_patterns_add (pm, patterns);
+  pm->last_scrape = 0;
+  pthread_mutex_unlock (&pm->lock);
+}
+
+void
+prom_stat_patterns_free (void)
+{
+  prom_main_t *pm = &prom_main;
+
+  pthread_mutex_lock (&pm->lock);
+  stat_patterns_free (pm);
+  pm->last_scrape = 0;
+  pthread_mutex_unlock (&pm->lock);
+}
+
 void
 prom_stat_patterns_set (u8 **patterns)
 {
-  prom_stat_patterns_free ();
-  prom_stat_patterns_add (patterns);
+  prom_main_t *pm = &prom_main;
+
+  pthread_mutex_lock (&pm->lock);
+  stat_patterns_free (pm);
+  stat_patterns_add (pm, patterns);
+  pm->last_scrape = 0;
+  pthread_mutex_unlock (&pm->lock);
 }
 
 u8 **
@@ -372,8 +715,11 @@ prom_stat_name_prefix_set (u8 *prefix)
 {
   prom_main_t *pm = &prom_main;
 
+  pthread_mutex_lock (&pm->lock);
   vec_free (pm->stat_name_prefix);
   pm->stat_name_prefix = prefix;
+  prom_cache_flush (pm);
+  pthread_mutex_unlock (&pm->lock);
 }
 
 void
@@ -381,7 +727,10 @@ prom_report_used_only (u8 used_only)
 {
   prom_main_t *pm = &prom_main;
 
+  pthread_mutex_lock (&pm->lock);
   pm->used_only = used_only;
+  prom_cache_flush (pm);
+  pthread_mutex_unlock (&pm->lock);
 }
 
 static void
@@ -407,15 +756,20 @@ prom_enable (vlib_main_t *vm)
 					     "hss_register_url_handler");
   pm->send_data =
     vlib_get_plugin_symbol ("http_static_plugin.so", "hss_session_send_data");
-  pm->register_url (prom_stats_dump, "stats.prom", HTTP_REQ_GET);
 
-  pm->is_enabled = 1;
-  pm->vm = vm;
   if (!pm->stat_name_prefix)
     pm->stat_name_prefix = format (0, "vpp");
 
-  prom_scraper_process_enable (vm);
   prom_stat_segment_client_init ();
+
+  if (pthread_create (&pm->scraper, NULL, prom_scraper_thread_fn, pm))
+    {
+      clib_warning ("failed to start scraper thread");
+      return;
+    }
+
+  pm->register_url (prom_stats_dump, "stats.prom", HTTP_REQ_GET);
+  pm->is_enabled = 1;
 }
 
 static clib_error_t *
@@ -428,6 +782,10 @@ prom_init (vlib_main_t *vm)
   pm->used_only = 0;
   pm->stat_name_prefix = 0;
 
+  pthread_mutex_init (&pm->lock, NULL);
+  pthread_mutex_init (&pm->queue_lock, NULL);
+  pthread_cond_init (&pm->queue_cond, NULL);
+
   return 0;
 }
 
@@ -16,19 +16,60 @@
 #ifndef SRC_PLUGINS_PROM_PROM_H_
 #define SRC_PLUGINS_PROM_PROM_H_
 
+#include <pthread.h>
 #include <vnet/session/session.h>
 #include <http_static/http_static.h>
 
+/* Counters rendered together, and rendered again only if one changed */
+#define PROM_CHUNK_SIZE 256
+
+typedef struct prom_chunk_
+{
+  u32 thread_index;
+  u32 first;
+  /* Raw copy of the values text was rendered from */
+  u8 *values;
+  u8 *text;
+} prom_chunk_t;
+
+/* Render cache of a stat directory entry */
+typedef struct prom_entry_
+{
+  char *stat_name;
+  /* Sanitized and prefixed exposition name */
+  u8 *name;
+  prom_chunk_t *chunks;
+} prom_entry_t;
+
+typedef struct prom_request_
+{
+  hss_session_handle_t sh;
+  /* From the request query, used instead of the configured patterns */
+  u8 **patterns;
+  http_content_encoding_t accept_encoding;
+} prom_request_t;
+
 typedef struct prom_main_
 {
   u8 *stats;
+  u8 *stats_gzip;
   f64 last_scrape;
   hss_register_url_fn register_url;
   hss_session_send_fn send_data;
-  u32 scraper_node_index;
   u8 is_enabled;
-  u8 *name_scratch_pad;
-  vlib_main_t *vm;
+
+  /*
+   * Scraper thread. Requests are queued by the http sessions and served
+   * off the main thread, counters are rendered incrementally into
+   * entries, indexed by stat directory index.
+   */
+  pthread_t scraper;
+  pthread_mutex_t queue_lock;
+  pthread_cond_t queue_cond;
+  prom_request_t *requests;
+  /* Held while scraping, and while changing configs */
+  pthread_mutex_t lock;
+  prom_entry_t *entries;
 
   /*
    * Configs
@@ -39,11 +80,6 @@ typedef struct prom_main_
   u8 used_only;
 } prom_main_t;
 
-typedef enum prom_process_evt_codes_
-{
-  PROM_SCRAPER_EVT_RUN,
-} prom_process_evt_codes_t;
-
 void prom_enable (vlib_main_t *vm);
 prom_main_t *prom_get_main (void);
 
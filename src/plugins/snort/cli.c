@@ -83,7 +83,7 @@ snort_attach_command_fn (vlib_main_t *vm, unformat_input_t *input,
   unformat_input_t _line_input, *line_input = &_line_input;
   vnet_main_t *vnm = vnet_get_main ();
   clib_error_t *err = 0;
-  u8 *name = 0;
+  u8 *name = 0, **names = 0, **n;
   u32 sw_if_index = ~0;
   snort_attach_dir_t dir = SNORT_INOUT;
 
@@ -97,7 +97,10 @@ snort_attach_command_fn (vlib_main_t *vm, unformat_input_t *input,
 		    vnm, &sw_if_index))
 	;
       else if (unformat (line_input, "instance %s", &name))
-	;
+	{
+	  vec_add1 (names, name);
+	  name = 0;
+	}
       else if (unformat (line_input, "input"))
 	dir = SNORT_INPUT;
       else if (unformat (line_input, "output"))
@@ -118,25 +121,27 @@ snort_attach_command_fn (vlib_main_t *vm, unformat_input_t *input,
       goto done;
     }
 
-  if (!name)
+  if (!names)
     {
       err = clib_error_return (0, "please specify instance name");
       goto done;
     }
 
-  err =
-    snort_interface_enable_disable (vm, (char *) name, sw_if_index, 1, dir);
+  err = snort_interface_enable_disable (vm, (char **) names, sw_if_index, 1,
+					dir);
 
 done:
-  vec_free (name);
+  vec_foreach (n, names)
+    vec_free (n[0]);
+  vec_free (names);
   unformat_free (line_input);
   return err;
 }
 
 VLIB_CLI_COMMAND (snort_attach_command, static) = {
   .path = "snort attach",
-  .short_help = "snort attach instance <name> interface <if-name> "
-		"[input|ouput|inout]",
+  .short_help = "snort attach instance <name> [instance <name> ...] "
+		"interface <if-name> [input|ouput|inout]",
   .function = snort_attach_command_fn,
 };
 
@@ -211,18 +216,26 @@ snort_show_interfaces_command_fn (vlib_main_t *vm, unformat_input_t *input,
   snort_main_t *sm = &snort_main;
   vnet_main_t *vnm = vnet_get_main ();
   snort_instance_t *si;
-  u32 *index;
+  u32 *index, *i;
+  u8 *s = 0;
 
   vlib_cli_output (vm, "interface\tsnort instance");
   vec_foreach (index, sm->instance_by_sw_if_index)
     {
       if (index[0] != ~0)
 	{
-	  si = vec_elt_at_index (sm->instances, index[0]);
-	  vlib_cli_output (vm, "%U:\t%s", format_vnet_sw_if_index_name, vnm,
-			   index - sm->instance_by_sw_if_index, si->name);
+	  u32 sw_if_index = index - sm->instance_by_sw_if_index;
+	  vec_reset_length (s);
+	  vec_foreach (i, sm->instances_by_sw_if_index[sw_if_index])
+	    {
+	      si = vec_elt_at_index (sm->instances, i[0]);
+	      s = format (s, "%s%s", vec_len (s) ? " " : "", si->name);
+	    }
+	  vlib_cli_output (vm, "%U:\t%v", format_vnet_sw_if_index_name, vnm,
+			   sw_if_index, s);
 	}
     }
+  vec_free (s);
   return 0;
 }
 
@@ -232,6 +245,46 @@ VLIB_CLI_COMMAND (snort_show_interfaces_command, static) = {
   .function = snort_show_interfaces_command_fn,
 };
 
+static u8 *
+format_snort_latency_bucket (u8 *s, va_list *args)
+{
+  u32 bucket = va_arg (*args, u32);
+
+  if (bucket == 0)
+    return format (s, "< 1us");
+  if (bucket == SNORT_LATENCY_N_BUCKETS - 1)
+    return format (s, ">= %uus", 1 << (bucket - 1));
+  return format (s, "%u-%uus", 1 << (bucket - 1), (1 << bucket) - 1);
+}
+
+static clib_error_t *
+snort_show_latency_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			       vlib_cli_command_t *cmd)
+{
+  snort_main_t *sm = &snort_main;
+  snort_instance_t *si;
+  u32 i, b;
+
+  pool_foreach (si, sm->instances)
+    {
+      vlib_cli_output (vm, "instance '%s':", si->name);
+      vec_foreach_index (i, si->latency.counters)
+	for (b = 0; b < SNORT_LATENCY_N_BUCKETS; b++)
+	  if (si->latency.counters[i][b])
+	    vlib_cli_output (vm, "  qpair %u %-16U %llu", i,
+			     format_snort_latency_bucket, b,
+			     si->latency.counters[i][b]);
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (snort_show_latency_command, static) = {
+  .path = "show snort latency",
+  .short_help = "show snort latency",
+  .function = snort_show_latency_command_fn,
+};
+
 static clib_error_t *
 snort_show_clients_command_fn (vlib_main_t *vm, unformat_input_t *input,
 			       vlib_cli_command_t *cmd)
@@ -11,6 +11,7 @@
 #include <sys/un.h>
 #include <sys/mman.h>
 #include <errno.h>
+#include <time.h>
 #include <sys/epoll.h>
 
 #include <vppinfra/cache.h>
@@ -32,6 +33,10 @@
 static DAQ_VariableDesc_t vpp_variable_descriptions[] = {
   { "debug", "Enable debugging output to stdout",
     DAQ_VAR_DESC_FORBIDS_ARGUMENT },
+  { "poll_usec",
+    "In interrupt mode, keep polling rings for <usec> after the last "
+    "received packet before blocking",
+    DAQ_VAR_DESC_REQUIRES_ARGUMENT },
 };
 
 static DAQ_BaseAPI_t daq_base_api;
@@ -72,6 +77,8 @@ typedef struct _vpp_qpair
   int deq_fd;
   VPPDescData *desc_data;
   volatile int lock;
+  /* verdicts posted but not yet signalled to vpp */
+  uint32_t n_deq_unsignalled;
 } VPPQueuePair;
 
 typedef enum
@@ -114,6 +121,10 @@ typedef struct _vpp_context
   daq_vpp_input_mode_t input_mode;
   const char *socket_name;
   volatile bool interrupted;
+
+  /* adaptive polling, interrupt mode only */
+  uint64_t poll_nsec;
+  uint64_t last_recv_nsec;
 } VPP_Context_t;
 
 static VPP_Context_t *global_vpp_ctx = 0;
@@ -302,6 +313,8 @@ vpp_daq_instantiate (const DAQ_ModuleConfig_h modcfg,
 	{
 	  vc->socket_name = varValue;
 	}
+      else if (!strcmp (varKey, "poll_usec"))
+	vc->poll_nsec = strtoull (varValue, 0, 10) * 1000;
       daq_base_api.config_next_variable (modcfg, &varKey, &varValue);
     }
 
@@ -556,26 +569,50 @@ vpp_daq_msg_receive_one (VPP_Context_t *vc, VPPQueuePair *qp,
   return n_recv;
 }
 
-static unsigned
-vpp_daq_msg_receive (void *handle, const unsigned max_recv,
-		     const DAQ_Msg_t *msgs[], DAQ_RecvStatus *rstat)
+static inline uint64_t
+vpp_daq_time_nsec (void)
 {
-  VPP_Context_t *vc = (VPP_Context_t *) handle;
-  uint32_t n_qpairs_left = vc->num_qpairs;
-  uint32_t n, n_recv = 0;
-  int32_t n_events;
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-  /* If the receive has been interrupted, break out of loop and return. */
-  if (vc->interrupted)
+/* verdicts are signalled once per receive call instead of once per
+ * finalized message, vpp picks all of them up in a single dequeue run */
+static inline int
+vpp_daq_signal_verdicts (VPP_Context_t *vc)
+{
+  uint64_t counter_increment = 1;
+  int rv = DAQ_SUCCESS;
+
+  if (vc->input_mode != DAQ_VPP_INPUT_MODE_INTERRUPT)
+    return rv;
+
+  for (int i = 0; i < vc->num_qpairs; i++)
     {
-      vc->interrupted = false;
-      *rstat = DAQ_RSTAT_INTERRUPTED;
-      return 0;
+      VPPQueuePair *qp = vc->qpairs + i;
+
+      if (__atomic_load_n (&qp->n_deq_unsignalled, __ATOMIC_RELAXED) == 0 ||
+	  __atomic_exchange_n (&qp->n_deq_unsignalled, 0, __ATOMIC_ACQ_REL) ==
+	    0)
+	continue;
+
+      if (write (qp->deq_fd, &counter_increment, sizeof (counter_increment)) !=
+	  sizeof (counter_increment))
+	rv = DAQ_ERROR;
     }
 
-  /* first, we visit all qpairs. If we find any work there then we can give
-   * it back immediatelly. To avoid bias towards qpair 0 we remeber what
-   * next qpair */
+  return rv;
+}
+
+static inline uint32_t
+vpp_daq_msg_receive_all (VPP_Context_t *vc, const DAQ_Msg_t *msgs[],
+			 unsigned max_recv)
+{
+  uint32_t n_qpairs_left = vc->num_qpairs;
+  uint32_t n, n_recv = 0;
+
+  /* To avoid bias towards qpair 0 we remember what next qpair is */
   while (n_qpairs_left)
     {
       VPPQueuePair *qp = vc->qpairs + vc->next_qpair;
@@ -593,14 +630,56 @@ vpp_daq_msg_receive (void *handle, const unsigned max_recv,
       n_qpairs_left--;
     }
 
+  return n_recv;
+}
+
+static unsigned
+vpp_daq_msg_receive (void *handle, const unsigned max_recv,
+		     const DAQ_Msg_t *msgs[], DAQ_RecvStatus *rstat)
+{
+  VPP_Context_t *vc = (VPP_Context_t *) handle;
+  uint32_t n, n_recv = 0;
+  int32_t n_events;
+
+  /* If the receive has been interrupted, break out of loop and return. */
+  if (vc->interrupted)
+    {
+      vc->interrupted = false;
+      *rstat = DAQ_RSTAT_INTERRUPTED;
+      return 0;
+    }
+
+  /* let vpp know about verdicts finalized since the last call */
+  vpp_daq_signal_verdicts (vc);
+
+  /* first, we visit all qpairs. If we find any work there then we can give
+   * it back immediatelly. */
+  n_recv = vpp_daq_msg_receive_all (vc, msgs, max_recv);
+
   if (vc->input_mode == DAQ_VPP_INPUT_MODE_POLLING)
     {
       *rstat = DAQ_RSTAT_OK;
       return n_recv;
     }
 
+  /* while traffic is flowing keep polling for a while before falling back
+   * to blocking in epoll, saves a wakeup per batch */
+  if (n_recv == 0 && vc->poll_nsec)
+    {
+      uint64_t now = vpp_daq_time_nsec ();
+      while (now - vc->last_recv_nsec < vc->poll_nsec && !vc->interrupted)
+	{
+	  if ((n_recv = vpp_daq_msg_receive_all (vc, msgs, max_recv)))
+	    break;
+	  VPP_DAQ_PAUSE ();
+	  now = vpp_daq_time_nsec ();
+	}
+    }
+
   if (n_recv)
     {
+      if (vc->poll_nsec)
+	vc->last_recv_nsec = vpp_daq_time_nsec ();
       *rstat = DAQ_RSTAT_OK;
       return n_recv;
     }
@@ -643,8 +722,6 @@ vpp_daq_msg_finalize (void *handle, const DAQ_Msg_t *msg, DAQ_Verdict verdict)
   VPPQueuePair *qp = vc->qpairs + dd->qpair_index;
   daq_vpp_desc_t *d;
   uint32_t mask, head;
-  uint64_t counter_increment = 1;
-  int rv, retv = DAQ_SUCCESS;
 
   vpp_daq_qpair_lock (qp);
   mask = qp->queue_size - 1;
@@ -659,16 +736,12 @@ vpp_daq_msg_finalize (void *handle, const DAQ_Msg_t *msg, DAQ_Verdict verdict)
   head = head + 1;
   __atomic_store_n (qp->deq_head, head, __ATOMIC_RELEASE);
 
+  /* signalled in batch on next receive */
   if (vc->input_mode == DAQ_VPP_INPUT_MODE_INTERRUPT)
-    {
-      rv = write (qp->deq_fd, &counter_increment, sizeof (counter_increment));
-
-      if (rv != sizeof (counter_increment))
-	retv = DAQ_ERROR;
-    }
+    __atomic_add_fetch (&qp->n_deq_unsignalled, 1, __ATOMIC_RELEASE);
 
   vpp_daq_qpair_unlock (qp);
-  return retv;
+  return DAQ_SUCCESS;
 }
 
 static int
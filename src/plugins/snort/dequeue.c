@@ -43,15 +43,32 @@ static char *snort_deq_error_strings[] = {
 #undef _
 };
 
+static_always_inline void
+snort_deq_latency_update (vlib_main_t *vm, snort_instance_t *si,
+			  u32 *hist)
+{
+  for (u32 i = 0; i < SNORT_LATENCY_N_BUCKETS; i++)
+    if (hist[i])
+      vlib_increment_simple_counter (&si->latency, vm->thread_index, i,
+				     hist[i]);
+}
+
+/* Takes all verdicts posted since last call in one go: descriptor indices
+ * are copied out of the dequeue ring first, then validated and resolved,
+ * and returned to the freelist with a single vector add */
 static_always_inline uword
 snort_deq_instance (vlib_main_t *vm, u32 instance_index, snort_qpair_t *qp,
-		    u32 *buffer_indices, u16 *nexts, u32 max_recv)
+		    u32 *buffer_indices, u16 *nexts, u32 max_recv,
+		    int is_interrupt)
 {
   snort_main_t *sm = &snort_main;
-  snort_per_thread_data_t *ptd =
-    vec_elt_at_index (sm->per_thread_data, vm->thread_index);
+  snort_instance_t *si = vec_elt_at_index (sm->instances, instance_index);
   u32 mask = pow2_mask (qp->log2_queue_size);
-  u32 head, next, n_recv = 0, n_left;
+  u32 desc_indices[VLIB_FRAME_SIZE], *freed = desc_indices;
+  u32 hist[SNORT_LATENCY_N_BUCKETS] = {};
+  u32 head, next, slot, n_recv = 0, n_left, n_bad_index = 0, n_bad_desc = 0;
+  f64 usec_per_clock = sm->usec_per_cpu_clock;
+  u64 now;
 
   head = __atomic_load_n (qp->deq_head, __ATOMIC_ACQUIRE);
   next = qp->next_desc;
@@ -64,34 +81,53 @@ snort_deq_instance (vlib_main_t *vm, u32 instance_index, snort_qpair_t *qp,
   if (n_left > max_recv)
     {
       n_left = max_recv;
-      clib_interrupt_set (ptd->interrupts, instance_index);
-      vlib_node_set_interrupt_pending (vm, snort_deq_node.index);
+      if (is_interrupt)
+	{
+	  snort_per_thread_data_t *ptd =
+	    vec_elt_at_index (sm->per_thread_data, vm->thread_index);
+	  clib_interrupt_set (ptd->interrupts, instance_index);
+	  vlib_node_set_interrupt_pending (vm, snort_deq_node.index);
+	}
     }
 
-  while (n_left)
+  /* copy ring slots out, ring may wrap */
+  slot = next & mask;
+  if (slot + n_left <= mask + 1)
+    clib_memcpy_fast (desc_indices, (u32 *) qp->deq_ring + slot,
+		      n_left * sizeof (u32));
+  else
     {
-      u32 desc_index, bi;
+      u32 n = mask + 1 - slot;
+      clib_memcpy_fast (desc_indices, (u32 *) qp->deq_ring + slot,
+			n * sizeof (u32));
+      clib_memcpy_fast (desc_indices + n, (u32 *) qp->deq_ring,
+			(n_left - n) * sizeof (u32));
+    }
+  qp->next_desc = next + n_left;
+  now = clib_cpu_time_now ();
+
+  for (u32 i = 0; i < n_left; i++)
+    {
+      u32 desc_index = desc_indices[i], bi;
       daq_vpp_desc_t *d;
 
       /* check if descriptor index taken from dequqe ring is valid */
-      if ((desc_index = qp->deq_ring[next & mask]) & ~mask)
+      if (PREDICT_FALSE (desc_index & ~mask))
 	{
-	  vlib_node_increment_counter (vm, snort_deq_node.index,
-				       SNORT_DEQ_ERROR_BAD_DESC_INDEX, 1);
-	  goto next;
+	  n_bad_index++;
+	  continue;
 	}
 
       /* check if descriptor index taken from dequeue ring points to enqueued
        * buffer */
-      if ((bi = qp->buffer_indices[desc_index]) == ~0)
+      if (PREDICT_FALSE ((bi = qp->buffer_indices[desc_index]) == ~0))
 	{
-	  vlib_node_increment_counter (vm, snort_deq_node.index,
-				       SNORT_DEQ_ERROR_BAD_DESC, 1);
-	  goto next;
+	  n_bad_desc++;
+	  continue;
 	}
 
-      /* put descriptor back to freelist */
-      vec_add1 (qp->freelist, desc_index);
+      /* descriptor goes back to freelist */
+      freed++[0] = desc_index;
       d = qp->descriptors + desc_index;
       buffer_indices++[0] = bi;
       if (d->action == DAQ_VPP_ACTION_FORWARD)
@@ -99,16 +135,21 @@ snort_deq_instance (vlib_main_t *vm, u32 instance_index, snort_qpair_t *qp,
       else
 	nexts[0] = SNORT_ENQ_NEXT_DROP;
       qp->buffer_indices[desc_index] = ~0;
+      hist[snort_latency_bucket ((now - qp->enq_cpu_time[desc_index]) *
+				 usec_per_clock)]++;
       nexts++;
       n_recv++;
-
-      /* next */
-    next:
-      next = next + 1;
-      n_left--;
     }
 
-  qp->next_desc = next;
+  vec_add (qp->freelist, desc_indices, freed - desc_indices);
+  snort_deq_latency_update (vm, si, hist);
+
+  if (PREDICT_FALSE (n_bad_index))
+    vlib_node_increment_counter (vm, snort_deq_node.index,
+				 SNORT_DEQ_ERROR_BAD_DESC_INDEX, n_bad_index);
+  if (PREDICT_FALSE (n_bad_desc))
+    vlib_node_increment_counter (vm, snort_deq_node.index,
+				 SNORT_DEQ_ERROR_BAD_DESC, n_bad_desc);
 
   return n_recv;
 }
@@ -197,7 +238,8 @@ snort_deq_node_interrupt (vlib_main_t *vm, vlib_node_runtime_t *node,
 	n = snort_deq_instance_all_interrupt (vm, inst, qp, bi, nexts, n_left,
 					      si->drop_on_disconnect);
       else
-	n = snort_deq_instance (vm, inst, qp, bi, nexts, n_left);
+	n = snort_deq_instance (vm, inst, qp, bi, nexts, n_left,
+				/* is_interrupt */ 1);
 
       n_left -= n;
       bi += n;
@@ -216,69 +258,6 @@ enq:
   return n;
 }
 
-static_always_inline uword
-snort_deq_instance_poll (vlib_main_t *vm, snort_qpair_t *qp,
-			 u32 *buffer_indices, u16 *nexts, u32 max_recv)
-{
-  u32 mask = pow2_mask (qp->log2_queue_size);
-  u32 head, next, n_recv = 0, n_left;
-
-  head = __atomic_load_n (qp->deq_head, __ATOMIC_ACQUIRE);
-  next = qp->next_desc;
-
-  n_left = head - next;
-
-  if (n_left == 0)
-    return 0;
-
-  if (n_left > max_recv)
-    n_left = max_recv;
-
-  while (n_left)
-    {
-      u32 desc_index, bi;
-      daq_vpp_desc_t *d;
-
-      /* check if descriptor index taken from dequqe ring is valid */
-      if ((desc_index = qp->deq_ring[next & mask]) & ~mask)
-	{
-	  vlib_node_increment_counter (vm, snort_deq_node.index,
-				       SNORT_DEQ_ERROR_BAD_DESC_INDEX, 1);
-	  goto next;
-	}
-
-      /* check if descriptor index taken from dequeue ring points to enqueued
-       * buffer */
-      if ((bi = qp->buffer_indices[desc_index]) == ~0)
-	{
-	  vlib_node_increment_counter (vm, snort_deq_node.index,
-				       SNORT_DEQ_ERROR_BAD_DESC, 1);
-	  goto next;
-	}
-
-      /* put descriptor back to freelist */
-      vec_add1 (qp->freelist, desc_index);
-      d = qp->descriptors + desc_index;
-      buffer_indices++[0] = bi;
-      if (d->action == DAQ_VPP_ACTION_FORWARD)
-	nexts[0] = qp->next_indices[desc_index];
-      else
-	nexts[0] = SNORT_ENQ_NEXT_DROP;
-      qp->buffer_indices[desc_index] = ~0;
-      nexts++;
-      n_recv++;
-
-      /* next */
-    next:
-      next = next + 1;
-      n_left--;
-    }
-
-  qp->next_desc = next;
-
-  return n_recv;
-}
-
 static_always_inline uword
 snort_deq_instance_all_poll (vlib_main_t *vm, snort_qpair_t *qp,
 			     u32 *buffer_indices, u16 *nexts, u32 max_recv,
@@ -315,7 +294,8 @@ snort_deq_node_polling (vlib_main_t *vm, vlib_node_runtime_t *node,
 	n = snort_deq_instance_all_poll (vm, qp, bi, nexts, n_left,
 					 si->drop_on_disconnect);
       else
-	n = snort_deq_instance_poll (vm, qp, bi, nexts, n_left);
+	n = snort_deq_instance (vm, si->index, qp, bi, nexts, n_left,
+				/* is_interrupt */ 0);
 
       n_left -= n;
       bi += n;
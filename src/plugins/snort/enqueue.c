@@ -4,6 +4,9 @@
 
 #include <vlib/vlib.h>
 #include <vnet/feature/feature.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/udp/udp_packet.h>
+#include <vppinfra/xxhash.h>
 #include <snort/snort.h>
 
 typedef struct
@@ -56,6 +59,36 @@ static char *snort_enq_error_strings[] = {
 #undef _
 };
 
+/* symmetric, so both directions of a flow hash to the same instance */
+static_always_inline u32
+snort_enq_flow_hash (ip4_header_t *ip)
+{
+  u64 key = ip->src_address.as_u32 ^ ip->dst_address.as_u32;
+
+  key |= (u64) ip->protocol << 32;
+  if ((ip->protocol == IP_PROTOCOL_TCP || ip->protocol == IP_PROTOCOL_UDP) &&
+      !ip4_is_fragment (ip))
+    {
+      udp_header_t *udp = ip4_next_header (ip);
+      key ^= (u64) (udp->src_port ^ udp->dst_port) << 40;
+    }
+
+  return clib_xxhash (key);
+}
+
+static_always_inline u32
+snort_enq_select_instance (snort_main_t *sm, u64 fa_data, u8 *l3)
+{
+  u32 *indices;
+
+  if (PREDICT_TRUE ((fa_data & SNORT_FA_DATA_FLOW_HASH) == 0))
+    return fa_data & SNORT_FA_DATA_INDEX_MASK;
+
+  indices = sm->instances_by_sw_if_index[fa_data & SNORT_FA_DATA_INDEX_MASK];
+  return indices[snort_enq_flow_hash ((ip4_header_t *) l3) %
+		 vec_len (indices)];
+}
+
 static_always_inline uword
 snort_enq_node_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 		       vlib_frame_t *frame, int with_trace)
@@ -67,6 +100,7 @@ snort_enq_node_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   u32 n_left = frame->n_vectors;
   u32 n_trace = 0;
   u32 total_enq = 0, n_processed = 0;
+  u64 now = clib_cpu_time_now ();
   u32 *from = vlib_frame_vector_args (frame);
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
   u16 nexts[VLIB_FRAME_SIZE], *next = nexts;
@@ -82,9 +116,11 @@ snort_enq_node_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
       fa_data =
 	*(u64 *) vnet_feature_next_with_data (&next_index, b[0], sizeof (u64));
 
-      instance_index = (u32) (fa_data & 0xffffffff);
-      l3_offset =
-	(fa_data >> 32) ? vnet_buffer (b[0])->ip.save_rewrite_length : 0;
+      l3_offset = (fa_data & SNORT_FA_DATA_OUTPUT) ?
+		    vnet_buffer (b[0])->ip.save_rewrite_length :
+		    0;
+      instance_index = snort_enq_select_instance (
+	sm, fa_data, vlib_buffer_get_current (b[0]) + l3_offset);
       si = vec_elt_at_index (sm->instances, instance_index);
 
       /* if client isn't connected skip enqueue and take default action */
@@ -171,6 +207,7 @@ snort_enq_node_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  qp->next_indices[desc_index] = qp->pending_nexts[i];
 	  ASSERT (qp->buffer_indices[desc_index] == ~0);
 	  qp->buffer_indices[desc_index] = qp->pending_buffers[i];
+	  qp->enq_cpu_time[desc_index] = now;
 	  clib_memcpy_fast (qp->descriptors + desc_index,
 			    qp->pending_descs + i, sizeof (daq_vpp_desc_t));
 	  qp->enq_ring[head & mask] = desc_index;
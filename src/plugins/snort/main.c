@@ -374,6 +374,7 @@ snort_instance_create (vlib_main_t *vm, char *name, u8 log2_queue_sz,
       vec_validate_aligned (qp->buffer_indices, qsz - 1,
 			    CLIB_CACHE_LINE_BYTES);
       vec_validate_aligned (qp->next_indices, qsz - 1, CLIB_CACHE_LINE_BYTES);
+      vec_validate_aligned (qp->enq_cpu_time, qsz - 1, CLIB_CACHE_LINE_BYTES);
       clib_memset_u32 (qp->buffer_indices, ~0, qsz);
 
       /* pre-populate freelist */
@@ -392,6 +393,11 @@ snort_instance_create (vlib_main_t *vm, char *name, u8 log2_queue_sz,
       clib_interrupt_resize (&ptd->interrupts, vec_len (sm->instances));
     }
 
+  si->latency.name = (char *) si->name;
+  si->latency.stat_segment_name =
+    (char *) format (0, "/snort/%s/latency%c", name, 0);
+  vlib_validate_simple_counter (&si->latency, SNORT_LATENCY_N_BUCKETS - 1);
+
   for (i = 0; i < vlib_get_n_threads (); i++)
     vlib_node_set_state (vlib_get_main_by_index (i), snort_deq_node.index,
 			 sm->input_mode);
@@ -408,7 +414,7 @@ done:
 }
 
 clib_error_t *
-snort_interface_enable_disable (vlib_main_t *vm, char *instance_name,
+snort_interface_enable_disable (vlib_main_t *vm, char **instance_names,
 				u32 sw_if_index, int is_enable,
 				snort_attach_dir_t snort_dir)
 {
@@ -416,18 +422,32 @@ snort_interface_enable_disable (vlib_main_t *vm, char *instance_name,
   vnet_main_t *vnm = vnet_get_main ();
   snort_instance_t *si;
   clib_error_t *err = 0;
+  u32 *indices = 0;
+  char **name;
   u64 fa_data;
   u32 index;
 
   if (is_enable)
     {
-      if ((si = snort_get_instance_by_name (instance_name)) == 0)
+      vec_foreach (name, instance_names)
+	{
+	  if ((si = snort_get_instance_by_name (name[0])) == 0)
+	    {
+	      err = clib_error_return (0, "unknown instance '%s'", name[0]);
+	      goto done;
+	    }
+	  if (vec_search (indices, si->index) == ~0)
+	    vec_add1 (indices, si->index);
+	}
+
+      if (vec_len (indices) == 0)
 	{
-	  err = clib_error_return (0, "unknown instance '%s'", instance_name);
+	  err = clib_error_return (0, "no instance specified");
 	  goto done;
 	}
 
       vec_validate_init_empty (sm->instance_by_sw_if_index, sw_if_index, ~0);
+      vec_validate (sm->instances_by_sw_if_index, sw_if_index);
 
       index = sm->instance_by_sw_if_index[sw_if_index];
       if (index != ~0)
@@ -441,16 +461,23 @@ snort_interface_enable_disable (vlib_main_t *vm, char *instance_name,
 	  goto done;
 	}
 
-      index = sm->instance_by_sw_if_index[sw_if_index] = si->index;
+      sm->instance_by_sw_if_index[sw_if_index] = indices[0];
+      sm->instances_by_sw_if_index[sw_if_index] = indices;
+
+      /* with more than one instance the enqueue node picks one by flow hash,
+       * so both directions of a flow are inspected by the same instance */
+      if (vec_len (indices) > 1)
+	fa_data = SNORT_FA_DATA_FLOW_HASH | sw_if_index;
+      else
+	fa_data = indices[0];
+      indices = 0;
+
       if (snort_dir & SNORT_INPUT)
-	{
-	  fa_data = (u64) index;
-	  vnet_feature_enable_disable ("ip4-unicast", "snort-enq", sw_if_index,
-				       1, &fa_data, sizeof (fa_data));
-	}
+	vnet_feature_enable_disable ("ip4-unicast", "snort-enq", sw_if_index,
+				     1, &fa_data, sizeof (fa_data));
       if (snort_dir & SNORT_OUTPUT)
 	{
-	  fa_data = (1LL << 32 | index);
+	  fa_data |= SNORT_FA_DATA_OUTPUT;
 	  vnet_feature_enable_disable ("ip4-output", "snort-enq", sw_if_index,
 				       1, &fa_data, sizeof (fa_data));
 	}
@@ -468,24 +495,28 @@ snort_interface_enable_disable (vlib_main_t *vm, char *instance_name,
 	  goto done;
 	}
       index = sm->instance_by_sw_if_index[sw_if_index];
-      si = vec_elt_at_index (sm->instances, index);
+      indices = sm->instances_by_sw_if_index[sw_if_index];
+
+      if (vec_len (indices) > 1)
+	fa_data = SNORT_FA_DATA_FLOW_HASH | sw_if_index;
+      else
+	fa_data = index;
 
       sm->instance_by_sw_if_index[sw_if_index] = ~0;
+      sm->instances_by_sw_if_index[sw_if_index] = 0;
       if (snort_dir & SNORT_INPUT)
-	{
-	  fa_data = (u64) index;
-	  vnet_feature_enable_disable ("ip4-unicast", "snort-enq", sw_if_index,
-				       0, &fa_data, sizeof (fa_data));
-	}
+	vnet_feature_enable_disable ("ip4-unicast", "snort-enq", sw_if_index,
+				     0, &fa_data, sizeof (fa_data));
       if (snort_dir & SNORT_OUTPUT)
 	{
-	  fa_data = (1LL << 32 | index);
+	  fa_data |= SNORT_FA_DATA_OUTPUT;
 	  vnet_feature_enable_disable ("ip4-output", "snort-enq", sw_if_index,
 				       0, &fa_data, sizeof (fa_data));
 	}
     }
 
 done:
+  vec_free (indices);
   if (err)
     log_err ("%U", format_clib_error, err);
   return 0;
@@ -522,6 +553,7 @@ snort_init (vlib_main_t *vm)
   snort_main_t *sm = &snort_main;
   sm->input_mode = VLIB_NODE_STATE_INTERRUPT;
   sm->instance_by_name = hash_create_string (0, sizeof (uword));
+  sm->usec_per_cpu_clock = 1e6 * vm->clib_time.seconds_per_clock;
   vlib_buffer_pool_t *bp;
 
   vec_foreach (bp, vm->buffer_main->buffer_pools)
@@ -24,6 +24,7 @@ typedef struct
   u32 deq_fd_file_index;
   u32 *buffer_indices;
   u16 *next_indices;
+  u64 *enq_cpu_time;
   u32 *freelist;
   u32 ready;
 
@@ -44,6 +45,9 @@ typedef struct
   snort_qpair_t *qpairs;
   u8 *name;
   u8 drop_on_disconnect;
+
+  /* enqueue to verdict latency, per qpair (thread) and log2 usec bucket */
+  vlib_simple_counter_main_t latency;
 } snort_instance_t;
 
 typedef struct
@@ -74,10 +78,13 @@ typedef struct
   snort_instance_t *instances;
   uword *instance_by_name;
   u32 *instance_by_sw_if_index;
+  /* instances sharing an interface, selected by flow hash */
+  u32 **instances_by_sw_if_index;
   u8 **buffer_pool_base_addrs;
   snort_per_thread_data_t *per_thread_data;
   u32 input_mode;
   u8 *socket_name;
+  f64 usec_per_cpu_clock;
 } snort_main_t;
 
 extern snort_main_t snort_main;
@@ -97,6 +104,16 @@ typedef enum
   SNORT_INOUT = 3
 } snort_attach_dir_t;
 
+/* feature arc data: bits 0-30 instance index, or sw_if_index of an interface
+ * shared by multiple instances if bit 31 is set; bit 32 selects output */
+#define SNORT_FA_DATA_INDEX_MASK 0x7fffffff
+#define SNORT_FA_DATA_FLOW_HASH	 (1ULL << 31)
+#define SNORT_FA_DATA_OUTPUT	 (1ULL << 32)
+
+/* latency histogram bucket 0 is < 1 usec, bucket n is [2^(n-1), 2^n) usec,
+ * last bucket collects everything above */
+#define SNORT_LATENCY_N_BUCKETS 24
+
 #define SNORT_ENQ_NEXT_NODES                                                  \
   {                                                                           \
     [SNORT_ENQ_NEXT_DROP] = "error-drop",                                     \
@@ -106,7 +123,7 @@ typedef enum
 clib_error_t *snort_instance_create (vlib_main_t *vm, char *name,
 				     u8 log2_queue_sz, u8 drop_on_disconnect);
 clib_error_t *snort_interface_enable_disable (vlib_main_t *vm,
-					      char *instance_name,
+					      char **instance_names,
 					      u32 sw_if_index, int is_enable,
 					      snort_attach_dir_t dir);
 clib_error_t *snort_set_node_mode (vlib_main_t *vm, u32 mode);
@@ -118,4 +135,16 @@ snort_freelist_init (u32 *fl)
     fl[j] = j;
 }
 
+always_inline u32
+snort_latency_bucket (f64 usec)
+{
+  u32 b;
+
+  if (usec < 1)
+    return 0;
+
+  b = 1 + min_log2 ((uword) usec);
+  return clib_min (b, SNORT_LATENCY_N_BUCKETS - 1);
+}
+
 #endif /* __snort_snort_h__ */
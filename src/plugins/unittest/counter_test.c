@@ -25,11 +25,14 @@ enum
 {
   type_simple = 0,
   type_combined,
+  type_histogram,
 };
 
 enum
 {
   test_expand = 0,
+  test_buckets,
+  test_add,
 };
 
 /*
@@ -162,6 +165,65 @@ test_combined_counter_expand (vlib_main_t *vm)
   return 0;
 }
 
+/*
+ * Check that every bucket starts at vlib_histogram_bucket_min and that
+ * the value just below that start lands in the previous bucket.
+ */
+static clib_error_t *
+test_histogram_buckets (vlib_main_t *vm)
+{
+  u32 s, b, n_buckets = 64;
+  u64 min;
+
+  for (s = 0; s < 4; s++)
+    for (b = 0; b < n_buckets; b++)
+      {
+	min = vlib_histogram_bucket_min (b, s);
+	if (vlib_histogram_bucket (min, s, n_buckets) != b)
+	  return clib_error_return (0, "s %u bucket %u: min %llu counted in %u",
+				    s, b, min,
+				    vlib_histogram_bucket (min, s, n_buckets));
+	if (b && vlib_histogram_bucket (min - 1, s, n_buckets) != b - 1)
+	  return clib_error_return (0, "s %u bucket %u: %llu counted in %u", s,
+				    b, min - 1,
+				    vlib_histogram_bucket (min - 1, s,
+							   n_buckets));
+      }
+
+  /* The last bucket is open ended */
+  if (vlib_histogram_bucket (~0ULL, 2, n_buckets) != n_buckets - 1)
+    return clib_error_return (0, "max value not in the last bucket");
+
+  return 0;
+}
+
+/*
+ * Count the given values on every thread in /vlib/test-histogram, for
+ * stat clients to read back. Starts from zero on every call.
+ */
+static clib_error_t *
+test_histogram_add (vlib_main_t *vm, u64 *values)
+{
+  static vlib_histogram_main_t hm = {
+    .name = "test-histogram",
+    .stat_segment_name = "/vlib/test-histogram",
+    .n_buckets = 32,
+    .log2_sub_buckets = 2,
+  };
+  u64 *v;
+  u32 i;
+
+  vlib_validate_histogram (&hm, 0);
+  vlib_clear_histograms (&hm);
+
+  for (i = 0; i < vlib_get_n_threads (); i++)
+    vec_foreach (v, values)
+      vlib_histogram_add (&hm, i, 0, v[0]);
+
+  vlib_cli_output (vm, "%U", format_vlib_histogram, &hm, 0);
+  return 0;
+}
+
 static clib_error_t *
 test_simple_counter (vlib_main_t *vm, int test_case)
 {
@@ -205,6 +267,7 @@ test_counter_command_fn (vlib_main_t *vm, unformat_input_t *input,
   clib_error_t *error;
   int counter_type = -1;
   int test_case = -1;
+  u64 *values = 0, value;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
@@ -212,11 +275,22 @@ test_counter_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	counter_type = type_simple;
       else if (unformat (input, "combined"))
 	counter_type = type_combined;
+      else if (unformat (input, "histogram"))
+	counter_type = type_histogram;
       else if (unformat (input, "expand"))
 	test_case = test_expand;
+      else if (unformat (input, "buckets"))
+	test_case = test_buckets;
+      else if (unformat (input, "add"))
+	test_case = test_add;
+      else if (test_case == test_add && unformat (input, "%llu", &value))
+	vec_add1 (values, value);
       else
-	return clib_error_return (0, "unknown input '%U'",
-				  format_unformat_error, input);
+	{
+	  vec_free (values);
+	  return clib_error_return (0, "unknown input '%U'",
+				    format_unformat_error, input);
+	}
     }
 
   if (test_case == -1)
@@ -232,16 +306,27 @@ test_counter_command_fn (vlib_main_t *vm, unformat_input_t *input,
       error = test_combined_counter (vm, test_case);
       break;
 
+    case type_histogram:
+      if (test_case == test_buckets)
+	error = test_histogram_buckets (vm);
+      else if (test_case == test_add)
+	error = test_histogram_add (vm, values);
+      else
+	error = clib_error_return (0, "no such test");
+      break;
+
     default:
-      return clib_error_return (0, "no such test");
+      error = clib_error_return (0, "no such test");
     }
 
+  vec_free (values);
   return error;
 }
 
 VLIB_CLI_COMMAND (test_counter_command, static) = {
   .path = "test counter",
-  .short_help = "test counter [simple | combined] expand",
+  .short_help = "test counter [simple | combined] expand | "
+		"histogram [buckets | add <value>...]",
   .function = test_counter_command_fn,
 };
 
@@ -663,6 +663,296 @@ test_crypto_static (vlib_main_t * vm, crypto_test_main_t * tm,
   return 0;
 }
 
+/* more ops than any engine has lanes, so that lanes are refilled */
+#define CRYPTO_TEST_BATCH_N_OPS 67
+
+static const struct
+{
+  vnet_crypto_alg_t alg;
+  u32 digest_len;
+} test_crypto_batch_hmacs[] = {
+  { VNET_CRYPTO_ALG_HMAC_SHA1, 20 },   { VNET_CRYPTO_ALG_HMAC_SHA224, 28 },
+  { VNET_CRYPTO_ALG_HMAC_SHA256, 32 }, { VNET_CRYPTO_ALG_HMAC_SHA384, 48 },
+  { VNET_CRYPTO_ALG_HMAC_SHA512, 64 },
+};
+
+static const struct
+{
+  vnet_crypto_alg_t alg;
+  u32 key_len;
+} test_crypto_batch_ciphers[] = {
+  { VNET_CRYPTO_ALG_AES_128_CBC, 16 },
+  { VNET_CRYPTO_ALG_AES_192_CBC, 24 },
+  { VNET_CRYPTO_ALG_AES_256_CBC, 32 },
+};
+
+static void
+test_crypto_batch_set_openssl (u32 *engs, int enable)
+{
+  if (enable)
+    {
+      clib_memset (engs, 0xff, VNET_CRYPTO_N_OP_IDS * sizeof (engs[0]));
+      save_current_engines (engs);
+    }
+  else
+    restore_engines (engs);
+}
+
+static u8 *
+format_test_crypto_batch_engine (u8 *s, va_list *args)
+{
+  vnet_crypto_op_id_t id = va_arg (*args, vnet_crypto_op_id_t);
+  int chained = va_arg (*args, int);
+  vnet_crypto_main_t *cm = &crypto_main;
+  vnet_crypto_op_data_t *od = cm->opt_data + id;
+  u32 ei = chained ? od->active_engine_index_chained :
+		     od->active_engine_index_simple;
+
+  if (ei == ~0)
+    return format (s, "none");
+  return format (s, "%s", vec_elt_at_index (cm->engines, ei)->name);
+}
+
+static void
+test_crypto_batch_result (vlib_main_t *vm, u8 *name, u8 *err)
+{
+  vlib_cli_output (vm, "%-60v%s%v", name, vec_len (err) ? "FAIL: " : "OK",
+		   err);
+}
+
+/*
+ * HMAC over batches of ops with different lengths, offsets and keys,
+ * including keys longer than the block size, as simple and as chained
+ * ops, compared with what openssl computes for the same ops.
+ */
+static void
+test_crypto_batch_hmac (vlib_main_t *vm, crypto_test_main_t *tm,
+			vnet_crypto_alg_t alg, u32 digest_len)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+  vnet_crypto_op_id_t id;
+  vnet_crypto_op_t *ops = 0, *op;
+  vnet_crypto_op_chunk_t *chunks = 0, ch = {};
+  u32 engs[VNET_CRYPTO_N_OP_IDS];
+  u32 key_lens[] = { digest_len, 64, 131 };
+  vnet_crypto_key_index_t keys[ARRAY_LEN (key_lens)];
+  u8 *expected = 0, *computed = 0, *src, *s = 0, *err = 0;
+  u32 i, off, len;
+  int chained;
+
+  id = cm->algs[alg].op_by_type[VNET_CRYPTO_OP_TYPE_HMAC];
+
+  for (i = 0; i < ARRAY_LEN (keys); i++)
+    keys[i] = vnet_crypto_key_add (vm, alg, tm->inc_data + 3 * i,
+				   key_lens[i]);
+
+  vec_validate (ops, CRYPTO_TEST_BATCH_N_OPS - 1);
+  vec_validate (expected, CRYPTO_TEST_BATCH_N_OPS * digest_len - 1);
+  vec_validate (computed, CRYPTO_TEST_BATCH_N_OPS * digest_len - 1);
+
+  for (chained = -1; chained <= 1; chained++)
+    {
+      /* first round computes the expected digests with openssl */
+      if (chained == -1)
+	test_crypto_batch_set_openssl (engs, 1);
+
+      vec_reset_length (chunks);
+      clib_memset (computed, 0, vec_len (computed));
+      vec_foreach_index (i, ops)
+	{
+	  src = tm->inc_data + (i * 7) % 64;
+	  len = (i * 37) % 1400;
+
+	  op = ops + i;
+	  vnet_crypto_op_init (op, id);
+	  op->key_index = keys[i % ARRAY_LEN (keys)];
+	  op->digest_len = digest_len;
+	  op->digest =
+	    (chained == -1 ? expected : computed) + i * digest_len;
+
+	  if (chained < 1)
+	    {
+	      op->src = src;
+	      op->len = len;
+	      continue;
+	    }
+
+	  /* up to three chunks, a single empty one for an empty op */
+	  op->flags |= VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS;
+	  op->chunk_index = vec_len (chunks);
+	  for (off = 0; off < len || op->n_chunks == 0; off += ch.len)
+	    {
+	      ch.src = src + off;
+	      ch.len = op->n_chunks == 2 ? len - off :
+					   clib_min (i * 5, len - off);
+	      vec_add1 (chunks, ch);
+	      if (++op->n_chunks == 3)
+		break;
+	    }
+	}
+
+      if (chained == 1)
+	vnet_crypto_process_chained_ops (vm, ops, chunks, vec_len (ops));
+      else
+	vnet_crypto_process_ops (vm, ops, vec_len (ops));
+
+      if (chained == -1)
+	{
+	  test_crypto_batch_set_openssl (engs, 0);
+	  continue;
+	}
+
+      vec_reset_length (err);
+      vec_foreach_index (i, ops)
+	{
+	  if (ops[i].status != VNET_CRYPTO_OP_STATUS_COMPLETED)
+	    err = format (err, "%sop %u: %U", vec_len (err) ? ", " : "", i,
+			  format_vnet_crypto_op_status, ops[i].status);
+	  else if (memcmp (computed + i * digest_len,
+			   expected + i * digest_len, digest_len))
+	    err = format (err, "%sop %u: digest mismatch",
+			  vec_len (err) ? ", " : "", i);
+	}
+
+      vec_reset_length (s);
+      s = format (s, "%U batch of %u%s [%U]", format_vnet_crypto_alg, alg,
+		  vec_len (ops), chained ? " chained" : "",
+		  format_test_crypto_batch_engine, id, chained);
+      test_crypto_batch_result (vm, s, err);
+    }
+
+  for (i = 0; i < ARRAY_LEN (keys); i++)
+    vnet_crypto_key_del (vm, keys[i]);
+  vec_free (ops);
+  vec_free (chunks);
+  vec_free (expected);
+  vec_free (computed);
+  vec_free (s);
+  vec_free (err);
+}
+
+/*
+ * AES-CBC encrypt linked with an HMAC of the ciphertext, the way
+ * esp-encrypt uses them, compared with openssl running the cipher ops
+ * and then the integ ops.
+ */
+static void
+test_crypto_batch_linked (vlib_main_t *vm, crypto_test_main_t *tm,
+			  vnet_crypto_alg_t calg, u32 key_len,
+			  vnet_crypto_alg_t ialg, u32 digest_len)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+  vnet_crypto_op_id_t cid, iid;
+  vnet_crypto_op_t *cops = 0, *iops = 0;
+  vnet_crypto_key_index_t ckey, ikey;
+  u32 engs[VNET_CRYPTO_N_OP_IDS];
+  u8 *ct[2] = {}, *digests[2] = {}, *s = 0, *err = 0;
+  u32 i, off;
+  int round;
+
+  cid = cm->algs[calg].op_by_type[VNET_CRYPTO_OP_TYPE_ENCRYPT];
+  iid = cm->algs[ialg].op_by_type[VNET_CRYPTO_OP_TYPE_HMAC];
+  ckey = vnet_crypto_key_add (vm, calg, tm->inc_data + 5, key_len);
+  ikey = vnet_crypto_key_add (vm, ialg, tm->inc_data + 7, digest_len);
+
+  vec_validate (cops, CRYPTO_TEST_BATCH_N_OPS - 1);
+  vec_validate (iops, CRYPTO_TEST_BATCH_N_OPS - 1);
+  for (round = 0; round < 2; round++)
+    {
+      vec_validate (ct[round], CRYPTO_TEST_BATCH_N_OPS * 640 - 1);
+      vec_validate (digests[round],
+		    CRYPTO_TEST_BATCH_N_OPS * digest_len - 1);
+    }
+
+  /* round 0 is openssl, one op type after the other */
+  for (round = 0; round < 2; round++)
+    {
+      if (round == 0)
+	test_crypto_batch_set_openssl (engs, 1);
+
+      vec_foreach_index (i, cops)
+	{
+	  off = i * 640;
+	  vnet_crypto_op_init (cops + i, cid);
+	  cops[i].key_index = ckey;
+	  cops[i].iv = tm->inc_data + i;
+	  cops[i].src = tm->inc_data + i % 32;
+	  cops[i].dst = ct[round] + off;
+	  cops[i].len = 16 * (1 + (i * 13) % 40);
+
+	  vnet_crypto_op_init (iops + i, iid);
+	  iops[i].key_index = ikey;
+	  iops[i].src = ct[round] + off;
+	  iops[i].len = cops[i].len;
+	  iops[i].digest = digests[round] + i * digest_len;
+	  iops[i].digest_len = digest_len;
+	}
+
+      if (round == 0)
+	{
+	  vnet_crypto_process_ops (vm, cops, vec_len (cops));
+	  vnet_crypto_process_ops (vm, iops, vec_len (iops));
+	  test_crypto_batch_set_openssl (engs, 0);
+	  continue;
+	}
+
+      vec_reset_length (err);
+      if (vnet_crypto_process_linked_ops (vm, cops, iops, vec_len (cops)) !=
+	  vec_len (cops))
+	err = format (err, "not all ops completed");
+      vec_foreach_index (i, cops)
+	{
+	  if (memcmp (ct[0] + i * 640, ct[1] + i * 640, cops[i].len))
+	    err = format (err, "%sop %u: ciphertext mismatch",
+			  vec_len (err) ? ", " : "", i);
+	  if (memcmp (digests[0] + i * digest_len,
+		      digests[1] + i * digest_len, digest_len))
+	    err = format (err, "%sop %u: digest mismatch",
+			  vec_len (err) ? ", " : "", i);
+	}
+
+      vec_reset_length (s);
+      s = format (s, "%U + %U linked batch of %u [%U + %U]",
+		  format_vnet_crypto_alg, calg, format_vnet_crypto_alg, ialg,
+		  vec_len (cops), format_test_crypto_batch_engine, cid, 0,
+		  format_test_crypto_batch_engine, iid, 0);
+      test_crypto_batch_result (vm, s, err);
+    }
+
+  vnet_crypto_key_del (vm, ckey);
+  vnet_crypto_key_del (vm, ikey);
+  vec_free (cops);
+  vec_free (iops);
+  for (round = 0; round < 2; round++)
+    {
+      vec_free (ct[round]);
+      vec_free (digests[round]);
+    }
+  vec_free (s);
+  vec_free (err);
+}
+
+static void
+test_crypto_batch (vlib_main_t *vm, crypto_test_main_t *tm)
+{
+  int i, j;
+
+  validate_data (&tm->inc_data, 2048);
+
+  for (i = 0; i < ARRAY_LEN (test_crypto_batch_hmacs); i++)
+    test_crypto_batch_hmac (vm, tm, test_crypto_batch_hmacs[i].alg,
+			    test_crypto_batch_hmacs[i].digest_len);
+
+  for (i = 0; i < ARRAY_LEN (test_crypto_batch_ciphers); i++)
+    for (j = 0; j < ARRAY_LEN (test_crypto_batch_hmacs); j++)
+      test_crypto_batch_linked (vm, tm, test_crypto_batch_ciphers[i].alg,
+				test_crypto_batch_ciphers[i].key_len,
+				test_crypto_batch_hmacs[j].alg,
+				test_crypto_batch_hmacs[j].digest_len);
+
+  vec_free (tm->inc_data);
+}
+
 static u32
 test_crypto_get_key_sz (vnet_crypto_alg_t alg)
 {
@@ -841,6 +1131,9 @@ test_crypto (vlib_main_t * vm, crypto_test_main_t * tm)
       r = r->next;
     }
 
+  if (!err)
+    test_crypto_batch (vm, tm);
+
 done:
   vec_free (inc_tests);
   vec_free (static_tests);
@@ -848,7 +1141,8 @@ done:
 }
 
 static clib_error_t *
-test_crypto_perf (vlib_main_t * vm, crypto_test_main_t * tm)
+test_crypto_perf_one (vlib_main_t *vm, crypto_test_main_t *tm,
+		      u32 buffer_size_arg, int is_sweep)
 {
   vnet_crypto_main_t *cm = &crypto_main;
   clib_error_t *err = 0;
@@ -863,12 +1157,12 @@ test_crypto_perf (vlib_main_t * vm, crypto_test_main_t * tm)
   u64 t0[5], t1[5], t2[5], n_bytes = 0;
   int i, j;
 
-  if (tm->buffer_size > buffer_size)
+  if (buffer_size_arg > buffer_size)
     return clib_error_return (0, "buffer size must be <= %u", buffer_size);
 
   rounds = tm->rounds ? tm->rounds : 100;
   n_buffers = tm->n_buffers ? tm->n_buffers : 256;
-  buffer_size = tm->buffer_size ? tm->buffer_size : 2048;
+  buffer_size = buffer_size_arg;
   warmup_rounds = tm->warmup_rounds ? tm->warmup_rounds : 100;
 
   if (buffer_size > vlib_buffer_get_default_data_size (vm))
@@ -887,12 +1181,16 @@ test_crypto_perf (vlib_main_t * vm, crypto_test_main_t * tm)
       goto done;
     }
 
-  vlib_cli_output (vm, "%U: n_buffers %u buffer-size %u rounds %u "
-		   "warmup-rounds %u",
-		   format_vnet_crypto_alg, tm->alg, n_buffers, buffer_size,
-		   rounds, warmup_rounds);
-  vlib_cli_output (vm, "   cpu-freq %.2f GHz",
-		   (f64) vm->clib_time.clocks_per_second * 1e-9);
+  if (!is_sweep)
+    {
+      vlib_cli_output (vm,
+		       "%U: n_buffers %u buffer-size %u rounds %u "
+		       "warmup-rounds %u",
+		       format_vnet_crypto_alg, tm->alg, n_buffers, buffer_size,
+		       rounds, warmup_rounds);
+      vlib_cli_output (vm, "   cpu-freq %.2f GHz",
+		       (f64) vm->clib_time.clocks_per_second * 1e-9);
+    }
 
   vnet_crypto_op_type_t ot = 0;
 
@@ -987,6 +1285,31 @@ test_crypto_perf (vlib_main_t * vm, crypto_test_main_t * tm)
 	}
     }
 
+  if (is_sweep)
+    {
+      /* best of 5 runs, one line per buffer size */
+      f64 clocks_per_ns = vm->clib_time.clocks_per_second * 1e-9;
+      u64 best[2] = { ~0ULL, ~0ULL };
+      u8 *s = 0;
+
+      for (i = 0; i < 5; i++)
+	{
+	  best[0] = clib_min (best[0], t1[i] - t0[i]);
+	  if (ot != VNET_CRYPTO_OP_TYPE_HMAC)
+	    best[1] = clib_min (best[1], t2[i] - t1[i]);
+	}
+
+      s = format (s, "%-6u", buffer_size);
+      for (i = 0; i < (ot == VNET_CRYPTO_OP_TYPE_HMAC ? 1 : 2); i++)
+	s = format (s, " %10.03f %8.02f %8.02f",
+		    (f64) best[i] / (n_bytes * rounds),
+		    clocks_per_ns * 8 * n_bytes * rounds / best[i],
+		    clocks_per_ns * 1e3 * n_buffers * rounds / best[i]);
+      vlib_cli_output (vm, "%v", s);
+      vec_free (s);
+      goto done;
+    }
+
   for (i = 0; i < 5; i++)
     {
       f64 tpb1 = (f64) (t1[i] - t0[i]) / (n_bytes * rounds);
@@ -1021,6 +1344,33 @@ done:
   return err;
 }
 
+static clib_error_t *
+test_crypto_perf (vlib_main_t *vm, crypto_test_main_t *tm)
+{
+  static const u32 sweep_sizes[] = { 64, 128, 256, 512, 1024, 1500, 2048 };
+  clib_error_t *err = 0;
+  int i;
+
+  if (!tm->sweep)
+    return test_crypto_perf_one (vm, tm,
+				 tm->buffer_size ? tm->buffer_size : 2048, 0);
+
+  vlib_cli_output (vm,
+		   "%U: n_buffers %u rounds %u, best of 5 runs, "
+		   "encrypt (or hash) followed by decrypt",
+		   format_vnet_crypto_alg, tm->alg,
+		   tm->n_buffers ? tm->n_buffers : 256,
+		   tm->rounds ? tm->rounds : 100);
+  vlib_cli_output (vm, "%-6s %10s %8s %8s %10s %8s %8s", "size",
+		   "ticks/byte", "Gbps", "Mpps", "ticks/byte", "Gbps", "Mpps");
+
+  for (i = 0; i < ARRAY_LEN (sweep_sizes) && err == 0; i++)
+    if (sweep_sizes[i] <= vlib_buffer_get_default_data_size (vm))
+      err = test_crypto_perf_one (vm, tm, sweep_sizes[i], 1);
+
+  return err;
+}
+
 static clib_error_t *
 test_crypto_command_fn (vlib_main_t * vm,
 			unformat_input_t * input, vlib_cli_command_t * cmd)
@@ -1051,6 +1401,8 @@ test_crypto_command_fn (vlib_main_t * vm,
 	;
       else if (unformat (input, "buffer-size %u", &tm->buffer_size))
 	;
+      else if (unformat (input, "sweep"))
+	tm->sweep = 1;
       else
 	return clib_error_return (0, "unknown input '%U'",
 				  format_unformat_error, input);
@@ -1066,7 +1418,8 @@ test_crypto_command_fn (vlib_main_t * vm,
 VLIB_CLI_COMMAND (test_crypto_command, static) =
 {
   .path = "test crypto",
-  .short_help = "test crypto",
+  .short_help = "test crypto [verbose|detail] [perf <alg> [buffers <n>] "
+		"[rounds <n>] [warmup-rounds <n>] [buffer-size <n>|sweep]]",
   .function = test_crypto_command_fn,
 };
 /* *INDENT-ON* */
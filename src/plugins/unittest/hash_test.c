@@ -9,6 +9,8 @@
 #include <vppinfra/error.h>
 #include <vnet/hash/hash.h>
 #include <vnet/ethernet/ethernet.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/tcp/tcp_packet.h>
 
 #define HASH_TEST_DATA_SIZE 2048
 
@@ -27,6 +29,8 @@ typedef struct
   int verbose;
 
   char *hash_name;
+  char *baseline_name;
+  int check_toeplitz;
   u32 warmup_rounds;
   u32 rounds;
   u32 n_buffers;
@@ -194,7 +198,7 @@ test_hash_perf (vlib_main_t *vm, hash_test_main_t *htm)
   u32 n_buffers, n_alloc = 0, warmup_rounds, rounds;
   u32 *buffer_indices = 0;
   u64 t0[5], t1[5];
-  vnet_hash_fn_t hf;
+  vnet_hash_fn_t hf, bhf;
   hash_test_data_t *hash_test_data = htm->hash_test_data;
   void **p = 0;
   int i, j;
@@ -266,6 +270,36 @@ test_hash_perf (vlib_main_t *vm, hash_test_main_t *htm)
 	  vlib_cli_output (vm, "%-2u: %.03f ticks/packet, %.02f Mpps\n", i + 1,
 			   tpp1, Mpps1);
 	}
+
+      bhf = htm->baseline_name ?
+	      vnet_hash_function_from_name (htm->baseline_name,
+					    hash_test_data->ftype) :
+	      0;
+      if (bhf)
+	{
+	  u32 h[n_buffers];
+	  u64 best = ~0ULL, bbest = ~0ULL;
+
+	  for (j = 0; j < warmup_rounds; j++)
+	    bhf (p, h, n_buffers);
+
+	  for (i = 0; i < 5; i++)
+	    {
+	      best = clib_min (best, t1[i] - t0[i]);
+	      t0[i] = clib_cpu_time_now ();
+	      for (j = 0; j < rounds; j++)
+		bhf (p, h, n_buffers);
+	      bbest = clib_min (bbest, clib_cpu_time_now () - t0[i]);
+	    }
+
+	  vlib_cli_output (vm,
+			   "best: %.03f ticks/packet, %s %.03f ticks/packet "
+			   "(%.02fx)\n",
+			   (f64) best / (n_buffers * rounds),
+			   htm->baseline_name,
+			   (f64) bbest / (n_buffers * rounds),
+			   (f64) bbest / best);
+	}
       hash_test_data = hash_test_data->next;
     }
 
@@ -278,6 +312,79 @@ done:
   return err;
 }
 
+/* RSS verification vectors, see vppinfra/vector/test/toeplitz.c */
+typedef struct
+{
+  u8 sip[4], dip[4];
+  u16 sport, dport;
+  u32 hash;
+} hash_test_toeplitz_vector_t;
+
+static const hash_test_toeplitz_vector_t hash_test_toeplitz_vectors[] = {
+  { { 66, 9, 149, 187 }, { 161, 142, 100, 80 }, 2794, 1766, 0x51ccc178 },
+  { { 199, 92, 111, 2 }, { 65, 69, 140, 83 }, 14230, 4739, 0xc626b0ea },
+  { { 24, 19, 198, 95 }, { 12, 22, 207, 184 }, 12898, 38024, 0x5c2b394a },
+  { { 38, 27, 205, 30 }, { 209, 142, 163, 6 }, 48228, 2217, 0xafc7327f },
+  { { 153, 39, 163, 191 }, { 202, 188, 127, 2 }, 44251, 1303, 0x10e828a2 },
+};
+
+static void
+hash_test_toeplitz_packet (u8 *p, const hash_test_toeplitz_vector_t *v,
+			   int swap)
+{
+  ip4_header_t *ip = (ip4_header_t *) p;
+  tcp_header_t *tcp = (tcp_header_t *) (ip + 1);
+
+  clib_memset (p, 0, sizeof (*ip) + sizeof (*tcp));
+  ip->ip_version_and_header_length = 0x45;
+  ip->protocol = IP_PROTOCOL_TCP;
+  clib_memcpy (&ip->src_address, swap ? v->dip : v->sip, 4);
+  clib_memcpy (&ip->dst_address, swap ? v->sip : v->dip, 4);
+  tcp->src_port = clib_host_to_net_u16 (swap ? v->dport : v->sport);
+  tcp->dst_port = clib_host_to_net_u16 (swap ? v->sport : v->dport);
+}
+
+static clib_error_t *
+test_hash_toeplitz (vlib_main_t *vm, hash_test_main_t *htm)
+{
+  u32 n = ARRAY_LEN (hash_test_toeplitz_vectors), n_pkts = 3 * n;
+  u8 data[n_pkts][64];
+  void *p[n_pkts];
+  u32 h[n_pkts], hs[n_pkts], i;
+  vnet_hash_fn_t hf, shf;
+
+  hf = vnet_hash_function_from_name ("toeplitz-5tuple", VNET_HASH_FN_TYPE_IP);
+  shf = vnet_hash_function_from_name ("toeplitz-5tuple-sym",
+				      VNET_HASH_FN_TYPE_IP);
+  if (!hf || !shf)
+    return clib_error_return (0, "toeplitz hash functions not registered");
+
+  /* enough packets to go through both the x4 and the single packet path */
+  for (i = 0; i < n_pkts; i++)
+    {
+      hash_test_toeplitz_packet (data[i], hash_test_toeplitz_vectors + i % n,
+				 i >= 2 * n);
+      p[i] = data[i];
+    }
+
+  hf (p, h, n_pkts);
+  for (i = 0; i < 2 * n; i++)
+    if (h[i] != hash_test_toeplitz_vectors[i % n].hash)
+      return clib_error_return (0, "toeplitz-5tuple: vector %u hash 0x%x, "
+				"expected 0x%x", i % n, h[i],
+				hash_test_toeplitz_vectors[i % n].hash);
+
+  shf (p, hs, n_pkts);
+  for (i = 0; i < n; i++)
+    if (hs[i] != hs[i + 2 * n])
+      return clib_error_return (0, "toeplitz-5tuple-sym: vector %u is not "
+				"symmetric (0x%x != 0x%x)", i, hs[i],
+				hs[i + 2 * n]);
+
+  vlib_cli_output (vm, "toeplitz hash test passed");
+  return 0;
+}
+
 static clib_error_t *
 test_hash_command_fn (vlib_main_t *vm, unformat_input_t *input,
 		      vlib_cli_command_t *cmd)
@@ -293,6 +400,10 @@ test_hash_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	tm->verbose = 2;
       else if (unformat (input, "perf %s", &tm->hash_name))
 	;
+      else if (unformat (input, "compare %s", &tm->baseline_name))
+	;
+      else if (unformat (input, "toeplitz"))
+	tm->check_toeplitz = 1;
       else if (unformat (input, "buffers %u", &tm->n_buffers))
 	;
       else if (unformat (input, "rounds %u", &tm->rounds))
@@ -307,18 +418,27 @@ test_hash_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	}
     }
 
+  if (tm->check_toeplitz)
+    {
+      tm->check_toeplitz = 0;
+      err = test_hash_toeplitz (vm, tm);
+      if (err || !tm->hash_name)
+	goto error;
+    }
+
   err = test_hash_perf (vm, tm);
 
 error:
   vec_free (tm->hash_name);
+  vec_free (tm->baseline_name);
 
   return err;
 }
 
 VLIB_CLI_COMMAND (test_hash_command, static) = {
   .path = "test hash",
-  .short_help = "test hash [perf <hash-name>] [buffers <n>] [rounds <n>] "
-		"[warmup-rounds <n>]",
+  .short_help = "test hash [toeplitz] [perf <hash-name> [compare <hash-name>]] "
+		"[buffers <n>] [rounds <n>] [warmup-rounds <n>]",
   .function = test_hash_command_fn,
 };
 
@@ -163,6 +163,84 @@ blake2s_init_key (blake2s_state_t * S, size_t outlen, const void *key,
   return 0;
 }
 
+#ifdef CLIB_HAVE_VEC128
+/*
+ * One row of the 4x4 state per u32x4, so the four G functions of a column
+ * (and, after rotating rows 2-4, of a diagonal) run in parallel.
+ */
+static_always_inline u32x4
+blake2s_rotr16 (u32x4 x)
+{
+  return (u32x4) u8x16_shuffle ((u8x16) x, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8,
+				9, 14, 15, 12, 13);
+}
+
+static_always_inline u32x4
+blake2s_rotr8 (u32x4 x)
+{
+  return (u32x4) u8x16_shuffle ((u8x16) x, 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11,
+				8, 13, 14, 15, 12);
+}
+
+#define G4(a, b, c, d, m0, m1)                                                \
+  do                                                                          \
+    {                                                                         \
+      a += b + m0;                                                            \
+      d = blake2s_rotr16 (d ^ a);                                             \
+      c += d;                                                                 \
+      b ^= c;                                                                 \
+      b = (b >> 12) | (b << 20);                                              \
+      a += b + m1;                                                            \
+      d = blake2s_rotr8 (d ^ a);                                              \
+      c += d;                                                                 \
+      b ^= c;                                                                 \
+      b = (b >> 7) | (b << 25);                                               \
+    }                                                                         \
+  while (0)
+
+#define M4(r, i0, i1, i2, i3)                                                 \
+  (u32x4)                                                                     \
+  {                                                                           \
+    m[blake2s_sigma[r][i0]], m[blake2s_sigma[r][i1]],                         \
+      m[blake2s_sigma[r][i2]], m[blake2s_sigma[r][i3]]                        \
+  }
+
+static void
+blake2s_compress (blake2s_state_t * S, const uint8_t in[BLAKE2S_BLOCK_BYTES])
+{
+  const u32x4 iv0 = { blake2s_IV[0], blake2s_IV[1], blake2s_IV[2],
+		      blake2s_IV[3] };
+  const u32x4 iv1 = { blake2s_IV[4], blake2s_IV[5], blake2s_IV[6],
+		      blake2s_IV[7] };
+  u32x4 h0 = u32x4_load_unaligned (S->h);
+  u32x4 h1 = u32x4_load_unaligned (S->h + 4);
+  u32x4 a = h0, b = h1, c = iv0;
+  u32x4 d = iv1 ^ (u32x4){ S->t[0], S->t[1], S->f[0], S->f[1] };
+  uint32_t m[16];
+  int r;
+
+  for (r = 0; r < 16; r++)
+    m[r] = load32 (in + r * sizeof (m[r]));
+
+  for (r = 0; r < 10; r++)
+    {
+      G4 (a, b, c, d, M4 (r, 0, 2, 4, 6), M4 (r, 1, 3, 5, 7));
+      b = u32x4_shuffle (b, 1, 2, 3, 0);
+      c = u32x4_shuffle (c, 2, 3, 0, 1);
+      d = u32x4_shuffle (d, 3, 0, 1, 2);
+      G4 (a, b, c, d, M4 (r, 8, 10, 12, 14), M4 (r, 9, 11, 13, 15));
+      b = u32x4_shuffle (b, 3, 0, 1, 2);
+      c = u32x4_shuffle (c, 2, 3, 0, 1);
+      d = u32x4_shuffle (d, 1, 2, 3, 0);
+    }
+
+  u32x4_store_unaligned (h0 ^ a ^ c, S->h);
+  u32x4_store_unaligned (h1 ^ b ^ d, S->h + 4);
+}
+
+#undef G4
+#undef M4
+#else
 #define G(r,i,a,b,c,d)                      \
   do {                                      \
     a = a + b + m[blake2s_sigma[r][2*i+0]]; \
@@ -232,6 +310,7 @@ blake2s_compress (blake2s_state_t * S, const uint8_t in[BLAKE2S_BLOCK_BYTES])
 
 #undef G
 #undef ROUND
+#endif /* CLIB_HAVE_VEC128 */
 
 int
 blake2s_update (blake2s_state_t * S, const void *pin, size_t inlen)
@@ -326,6 +405,39 @@ blake2s (void *out, size_t outlen, const void *in, size_t inlen,
   return 0;
 }
 
+int
+blake2s_hmac (uint8_t *out, const void *in, size_t inlen, const void *key,
+	      size_t keylen)
+{
+  uint8_t x_key[BLAKE2S_BLOCK_BYTES] = { 0 };
+  uint8_t i_hash[BLAKE2S_OUT_BYTES];
+  blake2s_state_t S[1];
+  size_t i;
+
+  if (keylen > BLAKE2S_BLOCK_BYTES)
+    blake2s (x_key, BLAKE2S_OUT_BYTES, key, keylen, NULL, 0);
+  else
+    memcpy (x_key, key, keylen);
+
+  for (i = 0; i < BLAKE2S_BLOCK_BYTES; i++)
+    x_key[i] ^= 0x36;
+  blake2s_init (S, BLAKE2S_OUT_BYTES);
+  blake2s_update (S, x_key, BLAKE2S_BLOCK_BYTES);
+  blake2s_update (S, in, inlen);
+  blake2s_final (S, i_hash, BLAKE2S_OUT_BYTES);
+
+  for (i = 0; i < BLAKE2S_BLOCK_BYTES; i++)
+    x_key[i] ^= 0x36 ^ 0x5c;
+  blake2s_init (S, BLAKE2S_OUT_BYTES);
+  blake2s_update (S, x_key, BLAKE2S_BLOCK_BYTES);
+  blake2s_update (S, i_hash, BLAKE2S_OUT_BYTES);
+  blake2s_final (S, out, BLAKE2S_OUT_BYTES);
+
+  secure_zero_memory (x_key, sizeof (x_key));
+  secure_zero_memory (i_hash, sizeof (i_hash));
+  return 0;
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
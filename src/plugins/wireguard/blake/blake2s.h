@@ -79,6 +79,10 @@ int blake2s_final (blake2s_state_t * S, void *out, size_t outlen);
 int blake2s (void *out, size_t outlen, const void *in, size_t inlen,
 	     const void *key, size_t keylen);
 
+/* HMAC (RFC 2104) with blake2s as the hash, out is BLAKE2S_OUT_BYTES */
+int blake2s_hmac (uint8_t *out, const void *in, size_t inlen, const void *key,
+		  size_t keylen);
+
 #endif /* __included_crypto_blake2s_h__ */
 
 /*
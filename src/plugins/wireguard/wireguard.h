@@ -54,8 +54,18 @@ typedef struct
 
   /* operation mode flags (e.g. async) */
   u8 op_mode_flags;
+
+  /* handshake load estimate, main thread only */
+  f64 hs_load_window_start;
+  u32 hs_load_count;
+  f64 hs_last_under_load;
 } wg_main_t;
 
+/* above this many handshakes per second initiations are rate limited per
+ * source, and we stay in that state for a second after the load drops */
+#define WG_UNDER_LOAD_HANDSHAKES_PER_SEC 1024
+#define WG_UNDER_LOAD_HOLD_TIME		 1.0
+
 typedef struct
 {
   /* wg post node index for async crypto */
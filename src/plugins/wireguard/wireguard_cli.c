@@ -411,6 +411,231 @@ VLIB_CLI_COMMAND (wg_show_modemode_command, static) = {
   .function = wg_show_mode_command_fn,
 };
 
+static noise_remote_t *wg_test_remote;
+static u32 wg_test_index;
+
+static noise_remote_t *
+wg_test_remote_get (const uint8_t public[NOISE_PUBLIC_KEY_LEN])
+{
+  return wg_test_remote;
+}
+
+static uint32_t
+wg_test_index_set (noise_remote_t *r)
+{
+  return ++wg_test_index;
+}
+
+static void
+wg_test_index_drop (uint32_t i)
+{
+}
+
+static clib_error_t *
+wg_test_handshake_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			      vlib_cli_command_t *cmd)
+{
+  struct noise_upcall upcall = {
+    .u_remote_get = wg_test_remote_get,
+    .u_index_set = wg_test_index_set,
+    .u_index_drop = wg_test_index_drop,
+  };
+  u8 key[NOISE_PUBLIC_KEY_LEN], out[NOISE_PUBLIC_KEY_LEN];
+  u8 ue[NOISE_PUBLIC_KEY_LEN], es[NOISE_PUBLIC_KEY_LEN + NOISE_AUTHTAG_LEN];
+  u8 ets[NOISE_TIMESTAMP_LEN + NOISE_AUTHTAG_LEN], en[NOISE_AUTHTAG_LEN];
+  noise_remote_t *ri, *rr, *rp;
+  noise_local_t *l;
+  u32 i, n_iter = 1000, li, lr, s_idx, r_idx;
+  clib_error_t *err = 0;
+  f64 t0, t1;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "iterations %u", &n_iter))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  /* primitives */
+  curve25519_gen_secret (key);
+  clib_memcpy (out, key, NOISE_PUBLIC_KEY_LEN);
+  t0 = vlib_time_now (vm);
+  for (i = 0; i < n_iter; i++)
+    curve25519_gen_public (out, out);
+  t1 = vlib_time_now (vm);
+  vlib_cli_output (vm, "x25519: %.0f ops/sec", n_iter / (t1 - t0));
+
+  t0 = vlib_time_now (vm);
+  for (i = 0; i < n_iter * 100; i++)
+    blake2s_hmac (out, out, BLAKE2S_HASH_SIZE + 1, key, BLAKE2S_HASH_SIZE);
+  t1 = vlib_time_now (vm);
+  vlib_cli_output (vm, "hmac-blake2s: %.0f ops/sec", n_iter * 100 / (t1 - t0));
+
+  /* full handshakes between an initiator and a responder */
+  pool_get (noise_local_pool, l);
+  li = l - noise_local_pool;
+  noise_local_init (l, &upcall);
+  curve25519_gen_secret (key);
+  noise_local_set_private (l, key);
+  pool_get (noise_local_pool, l);
+  lr = l - noise_local_pool;
+  noise_local_init (l, &upcall);
+  curve25519_gen_secret (key);
+  noise_local_set_private (l, key);
+
+  ri = clib_mem_alloc_aligned (sizeof (*ri), CLIB_CACHE_LINE_BYTES);
+  rr = clib_mem_alloc_aligned (sizeof (*rr), CLIB_CACHE_LINE_BYTES);
+  noise_remote_init (ri, ~0, noise_local_get (lr)->l_public, li);
+  noise_remote_init (rr, ~0, noise_local_get (li)->l_public, lr);
+  wg_test_remote = rr;
+
+  t0 = vlib_time_now (vm);
+  for (i = 0; i < n_iter; i++)
+    {
+      /* same timestamp and no flood interval between test handshakes */
+      clib_memset (rr->r_timestamp, 0, NOISE_TIMESTAMP_LEN);
+      rr->r_last_init = -REJECT_INTERVAL;
+
+      if (!noise_create_initiation (vm, ri, &s_idx, ue, es, ets) ||
+	  !noise_consume_initiation (vm, noise_local_get (lr), &rp, s_idx, ue,
+				     es, ets) ||
+	  !noise_create_response (vm, rp, &s_idx, &r_idx, ue, en) ||
+	  !noise_consume_response (vm, ri, s_idx, r_idx, ue, en))
+	{
+	  err = clib_error_return (0, "handshake %u failed", i);
+	  break;
+	}
+    }
+  t1 = vlib_time_now (vm);
+  if (!err)
+    vlib_cli_output (vm, "handshakes: %.0f per sec", n_iter / (t1 - t0));
+
+  noise_remote_clear (vm, ri);
+  noise_remote_clear (vm, rr);
+  clib_mem_free (ri);
+  clib_mem_free (rr);
+  wg_test_remote = 0;
+  pool_put_index (noise_local_pool, li);
+  pool_put_index (noise_local_pool, lr);
+
+  return err;
+}
+
+/*?
+ * Measure the handshake crypto: X25519, HMAC-BLAKE2s and complete
+ * initiator/responder handshakes (without sending packets).
+ ?*/
+VLIB_CLI_COMMAND (wg_test_handshake_command, static) = {
+  .path = "test wireguard handshake",
+  .short_help = "test wireguard handshake [iterations <n>]",
+  .function = wg_test_handshake_command_fn,
+};
+
+/* RFC 7748 section 5.2 and the section 6.1 key exchange */
+static const struct
+{
+  char *scalar, *point, *result;
+} wg_test_x25519_vectors[] = {
+  { "a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4",
+    "e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c",
+    "c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552" },
+  { "4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d",
+    "e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493",
+    "95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957" },
+  /* alice's private key and bob's public key */
+  { "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a",
+    "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f",
+    "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742" },
+  /* bob's private key and alice's public key */
+  { "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb",
+    "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a",
+    "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742" },
+};
+
+static void
+wg_test_hex_key (u8 key[CURVE25519_KEY_SIZE], char *hex)
+{
+  unformat_input_t input;
+  u8 *v = 0;
+
+  unformat_init_cstring (&input, hex);
+  unformat (&input, "%U", unformat_hex_string, &v);
+  unformat_free (&input);
+  ASSERT (vec_len (v) == CURVE25519_KEY_SIZE);
+  clib_memcpy (key, v, CURVE25519_KEY_SIZE);
+  vec_free (v);
+}
+
+static clib_error_t *
+wg_test_x25519_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  u8 scalar[CURVE25519_KEY_SIZE], point[CURVE25519_KEY_SIZE];
+  u8 result[CURVE25519_KEY_SIZE], out[CURVE25519_KEY_SIZE];
+  u8 k[CURVE25519_KEY_SIZE] = { 9 }, u[CURVE25519_KEY_SIZE] = { 9 };
+  u32 i;
+
+  for (i = 0; i < ARRAY_LEN (wg_test_x25519_vectors); i++)
+    {
+      wg_test_hex_key (scalar, wg_test_x25519_vectors[i].scalar);
+      wg_test_hex_key (point, wg_test_x25519_vectors[i].point);
+      wg_test_hex_key (result, wg_test_x25519_vectors[i].result);
+
+      if (!curve25519_gen_shared (out, scalar, point) ||
+	  memcmp (out, result, CURVE25519_KEY_SIZE))
+	return clib_error_return (0, "x25519 vector %u: got %U", i,
+				  format_hex_bytes, out, CURVE25519_KEY_SIZE);
+    }
+
+  /* public keys of the section 6.1 exchange */
+  wg_test_hex_key (scalar, wg_test_x25519_vectors[2].scalar);
+  wg_test_hex_key (result, wg_test_x25519_vectors[3].point);
+  if (!curve25519_gen_public (out, scalar) ||
+      memcmp (out, result, CURVE25519_KEY_SIZE))
+    return clib_error_return (0, "x25519 public key: got %U",
+			      format_hex_bytes, out, CURVE25519_KEY_SIZE);
+
+  /* section 5.2 iterations, each result is the next scalar */
+  for (i = 1; i <= 1000; i++)
+    {
+      curve25519_gen_shared (out, k, u);
+      clib_memcpy (u, k, CURVE25519_KEY_SIZE);
+      clib_memcpy (k, out, CURVE25519_KEY_SIZE);
+
+      if (i == 1)
+	wg_test_hex_key (result, "422c8e7a6227d7bca1350b3e2bb7279f"
+				 "7897b87bb6854b783c60e80311ae3079");
+      else if (i == 1000)
+	wg_test_hex_key (result, "684cf59ba83309552800ef566f2f4d3c"
+				 "1c3887c49360e3875f2eb94d99532c51");
+      else
+	continue;
+
+      if (memcmp (k, result, CURVE25519_KEY_SIZE))
+	return clib_error_return (0, "x25519 iteration %u: got %U", i,
+				  format_hex_bytes, k, CURVE25519_KEY_SIZE);
+    }
+
+  /* a low order point gives the all zero secret, which is refused */
+  clib_memset (point, 0, CURVE25519_KEY_SIZE);
+  if (curve25519_gen_shared (out, scalar, point))
+    return clib_error_return (0, "x25519 low order point accepted");
+
+  vlib_cli_output (vm, "x25519 known answer tests passed");
+  return 0;
+}
+
+/*?
+ * Check X25519 against the RFC 7748 test vectors.
+ ?*/
+VLIB_CLI_COMMAND (wg_test_x25519_command, static) = {
+  .path = "test wireguard x25519",
+  .short_help = "test wireguard x25519",
+  .function = wg_test_x25519_command_fn,
+};
+
 /* *INDENT-ON* */
 
 /*
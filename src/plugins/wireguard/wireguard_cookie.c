@@ -103,6 +103,77 @@ cookie_checker_validate_macs (vlib_main_t *vm, cookie_checker_t *cc,
   return VALID_MAC_WITH_COOKIE;
 }
 
+/*
+ * Initiation rate limit per source address (/64 for IPv6), checked when
+ * under load so that a flood from one source is dropped before any DH.
+ */
+bool
+cookie_checker_ratelimit (cookie_checker_t *cc, ip46_address_t *ip, f64 now)
+{
+  ratelimit_t *rl = &cc->cc_ratelimit;
+  ratelimit_entry_t *e;
+  u8 is_ip6 = !ip46_address_is_ip4 (ip);
+  u64 key = is_ip6 ? ip->ip6.as_u64[0] : ip->ip4.as_u32;
+  uword *p;
+
+  if (PREDICT_FALSE (rl->entry_by_key[is_ip6] == 0))
+    rl->entry_by_key[is_ip6] = hash_create (0, sizeof (uword));
+
+  if (now - rl->last_gc > ELEMENT_TIMEOUT)
+    {
+      u32 *stale = 0, *i;
+
+      pool_foreach (e, rl->entries)
+	{
+	  if (now - e->last_time > ELEMENT_TIMEOUT)
+	    vec_add1 (stale, e - rl->entries);
+	}
+      vec_foreach (i, stale)
+	{
+	  e = pool_elt_at_index (rl->entries, *i);
+	  hash_unset (rl->entry_by_key[e->is_ip6], e->key);
+	  pool_put_index (rl->entries, *i);
+	}
+      vec_free (stale);
+      rl->last_gc = now;
+    }
+
+  p = hash_get (rl->entry_by_key[is_ip6], key);
+  if (p)
+    {
+      e = pool_elt_at_index (rl->entries, p[0]);
+      e->tokens += (now - e->last_time) * NSEC_PER_SEC;
+      e->last_time = now;
+      if (e->tokens > TOKEN_MAX)
+	e->tokens = TOKEN_MAX;
+      if (e->tokens < INITIATION_COST)
+	return false;
+      e->tokens -= INITIATION_COST;
+      return true;
+    }
+
+  if (pool_elts (rl->entries) >= RATELIMIT_SIZE_MAX)
+    return false;
+
+  pool_get (rl->entries, e);
+  e->key = key;
+  e->is_ip6 = is_ip6;
+  e->tokens = TOKEN_MAX - INITIATION_COST;
+  e->last_time = now;
+  hash_set (rl->entry_by_key[is_ip6], key, e - rl->entries);
+  return true;
+}
+
+void
+cookie_checker_free (cookie_checker_t *cc)
+{
+  ratelimit_t *rl = &cc->cc_ratelimit;
+
+  pool_free (rl->entries);
+  hash_free (rl->entry_by_key[0]);
+  hash_free (rl->entry_by_key[1]);
+}
+
 /* Private functions */
 static void
 cookie_precompute_key (uint8_t * key, const uint8_t input[COOKIE_INPUT_SIZE],
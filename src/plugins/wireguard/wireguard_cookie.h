@@ -70,6 +70,22 @@ typedef struct cookie_maker
   uint8_t cp_mac1_last[COOKIE_MAC_SIZE];
 } cookie_maker_t;
 
+/* Per source address token bucket, tokens in nanoseconds */
+typedef struct ratelimit_entry
+{
+  u64 key;
+  u64 tokens;
+  f64 last_time;
+  u8 is_ip6;
+} ratelimit_entry_t;
+
+typedef struct ratelimit
+{
+  ratelimit_entry_t *entries; /* pool */
+  uword *entry_by_key[2];     /* ip4, ip6 */
+  f64 last_gc;
+} ratelimit_t;
+
 typedef struct cookie_checker
 {
   uint8_t cc_mac1_key[COOKIE_KEY_SIZE];
@@ -77,6 +93,8 @@ typedef struct cookie_checker
 
   f64 cc_secret_birthdate;
   uint8_t cc_secret[COOKIE_SECRET_SIZE];
+
+  ratelimit_t cc_ratelimit;
 } cookie_checker_t;
 
 
@@ -87,6 +105,9 @@ enum cookie_mac_state
 cookie_checker_validate_macs (vlib_main_t *vm, cookie_checker_t *,
 			      message_macs_t *, void *, size_t, bool,
 			      ip46_address_t *ip, u16 udp_port);
+bool cookie_checker_ratelimit (cookie_checker_t *cc, ip46_address_t *ip,
+			       f64 now);
+void cookie_checker_free (cookie_checker_t *cc);
 
 #endif /* __included_wg_cookie_h__ */
 
@@ -300,6 +300,7 @@ wg_if_create (u32 user_instance,
 
   wg_if->port = port;
   wg_if->local_idx = local - noise_local_pool;
+  clib_memset (&wg_if->cookie_checker, 0, sizeof (wg_if->cookie_checker));
   cookie_checker_update (&wg_if->cookie_checker, local->l_public);
 
   hw_if_index = vnet_register_interface (vnm,
@@ -363,6 +364,7 @@ wg_if_delete (u32 sw_if_index)
 
   vnet_reset_interface_l3_output_node (vnm->vlib_main, sw_if_index);
   vnet_delete_hw_interface (vnm, hw->hw_if_index);
+  cookie_checker_free (&wg_if->cookie_checker);
   pool_put_index (noise_local_pool, wg_if->local_idx);
   pool_put (wg_if_pool, wg_if);
 
@@ -31,6 +31,7 @@
   _ (KEEPALIVE_SEND, "Failed while sending Keepalive")                        \
   _ (HANDSHAKE_SEND, "Failed while sending Handshake")                        \
   _ (HANDSHAKE_RECEIVE, "Failed while receiving Handshake")                   \
+  _ (HANDSHAKE_RATELIMITED, "Handshake ratelimited")                          \
   _ (TOO_BIG, "Packet too big")                                               \
   _ (UNDEFINED, "Undefined error")                                            \
   _ (CRYPTO_ENGINE_ERROR, "crypto engine error (packet dropped)")
@@ -138,6 +139,22 @@ is_ip4_header (u8 *data)
   return (data[0] >> 4) == 0x4;
 }
 
+static_always_inline bool
+wg_handshake_under_load (wg_main_t *wmp, f64 now)
+{
+  if (now - wmp->hs_load_window_start >= 1.0)
+    {
+      wmp->hs_load_window_start = now;
+      wmp->hs_load_count = 0;
+    }
+
+  if (++wmp->hs_load_count > WG_UNDER_LOAD_HANDSHAKES_PER_SEC)
+    wmp->hs_last_under_load = now;
+
+  return wmp->hs_last_under_load != 0 &&
+	 now - wmp->hs_last_under_load < WG_UNDER_LOAD_HOLD_TIME;
+}
+
 static wg_input_error_t
 wg_handshake_process (vlib_main_t *vm, wg_main_t *wmp, vlib_buffer_t *b,
 		      u32 node_idx, u8 is_ip4)
@@ -172,7 +189,8 @@ wg_handshake_process (vlib_main_t *vm, wg_main_t *wmp, vlib_buffer_t *b,
   u16 udp_dst_port = clib_host_to_net_u16 (uhd->dst_port);;
 
   message_header_t *header = current_b_data;
-  under_load = false;
+  f64 now = vlib_time_now (vm);
+  under_load = wg_handshake_under_load (wmp, now);
 
   if (PREDICT_FALSE (header->type == MESSAGE_HANDSHAKE_COOKIE))
     {
@@ -240,6 +258,12 @@ wg_handshake_process (vlib_main_t *vm, wg_main_t *wmp, vlib_buffer_t *b,
 	  {
 	    // TODO: Add processing
 	  }
+
+	/* drop floods from a single source before the DH computations */
+	if (under_load &&
+	    !cookie_checker_ratelimit (&wg_if->cookie_checker, &src_ip, now))
+	  return WG_INPUT_ERROR_HANDSHAKE_RATELIMITED;
+
 	noise_remote_t *rp;
 	if (noise_consume_initiation
 	    (vm, noise_local_get (wg_if->local_idx), &rp,
@@ -16,67 +16,292 @@
 #include <wireguard/wireguard_key.h>
 #include <openssl/evp.h>
 
-bool
-curve25519_gen_shared (u8 shared_key[CURVE25519_KEY_SIZE],
-		       const u8 secret_key[CURVE25519_KEY_SIZE],
-		       const u8 basepoint[CURVE25519_KEY_SIZE])
+/*
+ * X25519 (RFC 7748) over GF(2^255 - 19), field elements held in 5 limbs
+ * of 51 bits so that products fit u128 without intermediate carries.
+ * Everything runs in constant time with respect to the scalar.
+ */
+
+#define FE_MASK51 0x7ffffffffffffULL
+
+typedef u64 fe_t[5];
+
+static_always_inline void
+fe_frombytes (fe_t h, const u8 *s)
 {
+  u64 t0 = clib_mem_unaligned (s, u64);
+  u64 t1 = clib_mem_unaligned (s + 8, u64);
+  u64 t2 = clib_mem_unaligned (s + 16, u64);
+  u64 t3 = clib_mem_unaligned (s + 24, u64);
 
-  bool ret;
-  EVP_PKEY_CTX *ctx;
-  size_t key_len;
+  h[0] = t0 & FE_MASK51;
+  h[1] = ((t0 >> 51) | (t1 << 13)) & FE_MASK51;
+  h[2] = ((t1 >> 38) | (t2 << 26)) & FE_MASK51;
+  h[3] = ((t2 >> 25) | (t3 << 39)) & FE_MASK51;
+  h[4] = (t3 >> 12) & FE_MASK51; /* top bit is ignored */
+}
 
-  EVP_PKEY *peerkey = NULL;
-  EVP_PKEY *pkey =
-    EVP_PKEY_new_raw_private_key (EVP_PKEY_X25519, NULL, secret_key,
-				  CURVE25519_KEY_SIZE);
+static_always_inline void
+fe_carry (fe_t h)
+{
+  h[1] += h[0] >> 51;
+  h[0] &= FE_MASK51;
+  h[2] += h[1] >> 51;
+  h[1] &= FE_MASK51;
+  h[3] += h[2] >> 51;
+  h[2] &= FE_MASK51;
+  h[4] += h[3] >> 51;
+  h[3] &= FE_MASK51;
+  h[0] += 19 * (h[4] >> 51);
+  h[4] &= FE_MASK51;
+}
 
-  ret = true;
+static_always_inline void
+fe_tobytes (u8 *s, const fe_t f)
+{
+  fe_t h = { f[0], f[1], f[2], f[3], f[4] };
 
-  ctx = EVP_PKEY_CTX_new (pkey, NULL);
-  if (EVP_PKEY_derive_init (ctx) <= 0)
-    {
-      ret = false;
-      goto out;
-    }
+  /* fully reduce: after two carries h < 2^255, adding 19 and then
+   * 2^255 - 19 with the top bit dropped subtracts p if h >= p */
+  fe_carry (h);
+  fe_carry (h);
+  h[0] += 19;
+  fe_carry (h);
+  h[0] += FE_MASK51 + 1 - 19;
+  h[1] += FE_MASK51;
+  h[2] += FE_MASK51;
+  h[3] += FE_MASK51;
+  h[4] += FE_MASK51;
+  h[1] += h[0] >> 51;
+  h[0] &= FE_MASK51;
+  h[2] += h[1] >> 51;
+  h[1] &= FE_MASK51;
+  h[3] += h[2] >> 51;
+  h[2] &= FE_MASK51;
+  h[4] += h[3] >> 51;
+  h[3] &= FE_MASK51;
+  h[4] &= FE_MASK51;
+
+  clib_mem_unaligned (s, u64) = h[0] | (h[1] << 51);
+  clib_mem_unaligned (s + 8, u64) = (h[1] >> 13) | (h[2] << 38);
+  clib_mem_unaligned (s + 16, u64) = (h[2] >> 26) | (h[3] << 25);
+  clib_mem_unaligned (s + 24, u64) = (h[3] >> 39) | (h[4] << 12);
+}
+
+static_always_inline void
+fe_add (fe_t h, const fe_t f, const fe_t g)
+{
+  for (int i = 0; i < 5; i++)
+    h[i] = f[i] + g[i];
+}
+
+/* h = f - g, 2p is added so limbs stay positive for reduced inputs */
+static_always_inline void
+fe_sub (fe_t h, const fe_t f, const fe_t g)
+{
+  h[0] = f[0] + 0xfffffffffffdaULL - g[0];
+  h[1] = f[1] + 0xffffffffffffeULL - g[1];
+  h[2] = f[2] + 0xffffffffffffeULL - g[2];
+  h[3] = f[3] + 0xffffffffffffeULL - g[3];
+  h[4] = f[4] + 0xffffffffffffeULL - g[4];
+}
+
+static_always_inline void
+fe_reduce (fe_t h, u128 r0, u128 r1, u128 r2, u128 r3, u128 r4)
+{
+  u64 c;
+
+  r1 += (u64) (r0 >> 51);
+  h[0] = (u64) r0 & FE_MASK51;
+  r2 += (u64) (r1 >> 51);
+  h[1] = (u64) r1 & FE_MASK51;
+  r3 += (u64) (r2 >> 51);
+  h[2] = (u64) r2 & FE_MASK51;
+  r4 += (u64) (r3 >> 51);
+  h[3] = (u64) r3 & FE_MASK51;
+  c = (u64) (r4 >> 51);
+  h[4] = (u64) r4 & FE_MASK51;
+  h[0] += c * 19;
+  h[1] += h[0] >> 51;
+  h[0] &= FE_MASK51;
+}
+
+static_always_inline void
+fe_mul (fe_t h, const fe_t f, const fe_t g)
+{
+  u64 f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+  u64 g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+  u64 g1_19 = g1 * 19, g2_19 = g2 * 19, g3_19 = g3 * 19, g4_19 = g4 * 19;
+  u128 r0, r1, r2, r3, r4;
+
+  r0 = (u128) f0 * g0 + (u128) f1 * g4_19 + (u128) f2 * g3_19 +
+       (u128) f3 * g2_19 + (u128) f4 * g1_19;
+  r1 = (u128) f0 * g1 + (u128) f1 * g0 + (u128) f2 * g4_19 +
+       (u128) f3 * g3_19 + (u128) f4 * g2_19;
+  r2 = (u128) f0 * g2 + (u128) f1 * g1 + (u128) f2 * g0 +
+       (u128) f3 * g4_19 + (u128) f4 * g3_19;
+  r3 = (u128) f0 * g3 + (u128) f1 * g2 + (u128) f2 * g1 + (u128) f3 * g0 +
+       (u128) f4 * g4_19;
+  r4 = (u128) f0 * g4 + (u128) f1 * g3 + (u128) f2 * g2 + (u128) f3 * g1 +
+       (u128) f4 * g0;
+
+  fe_reduce (h, r0, r1, r2, r3, r4);
+}
+
+static_always_inline void
+fe_sq (fe_t h, const fe_t f)
+{
+  u64 f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+  u64 f0_2 = f0 * 2, f1_2 = f1 * 2;
+  u64 f1_38 = f1 * 38, f2_38 = f2 * 38, f3_38 = f3 * 38;
+  u64 f3_19 = f3 * 19, f4_19 = f4 * 19;
+  u128 r0, r1, r2, r3, r4;
+
+  r0 = (u128) f0 * f0 + (u128) f1_38 * f4 + (u128) f2_38 * f3;
+  r1 = (u128) f0_2 * f1 + (u128) f2_38 * f4 + (u128) f3_19 * f3;
+  r2 = (u128) f0_2 * f2 + (u128) f1 * f1 + (u128) f3_38 * f4;
+  r3 = (u128) f0_2 * f3 + (u128) f1_2 * f2 + (u128) f4_19 * f4;
+  r4 = (u128) f0_2 * f4 + (u128) f1_2 * f3 + (u128) f2 * f2;
+
+  fe_reduce (h, r0, r1, r2, r3, r4);
+}
+
+static_always_inline void
+fe_sq_n (fe_t h, const fe_t f, int n)
+{
+  fe_sq (h, f);
+  while (--n)
+    fe_sq (h, h);
+}
+
+static_always_inline void
+fe_mul_small (fe_t h, const fe_t f, u64 n)
+{
+  fe_reduce (h, (u128) f[0] * n, (u128) f[1] * n, (u128) f[2] * n,
+	     (u128) f[3] * n, (u128) f[4] * n);
+}
+
+/* h = z^(p - 2) */
+static void
+fe_invert (fe_t h, const fe_t z)
+{
+  fe_t z2, z9, z11, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0, t;
 
-  peerkey =
-    EVP_PKEY_new_raw_public_key (EVP_PKEY_X25519, NULL, basepoint,
-				 CURVE25519_KEY_SIZE);
-  if (EVP_PKEY_derive_set_peer (ctx, peerkey) <= 0)
+  fe_sq (z2, z);
+  fe_sq_n (t, z2, 2);
+  fe_mul (z9, t, z);
+  fe_mul (z11, z9, z2);
+  fe_sq (t, z11);
+  fe_mul (z2_5_0, t, z9);
+  fe_sq_n (t, z2_5_0, 5);
+  fe_mul (z2_10_0, t, z2_5_0);
+  fe_sq_n (t, z2_10_0, 10);
+  fe_mul (z2_20_0, t, z2_10_0);
+  fe_sq_n (t, z2_20_0, 20);
+  fe_mul (t, t, z2_20_0);
+  fe_sq_n (t, t, 10);
+  fe_mul (z2_50_0, t, z2_10_0);
+  fe_sq_n (t, z2_50_0, 50);
+  fe_mul (z2_100_0, t, z2_50_0);
+  fe_sq_n (t, z2_100_0, 100);
+  fe_mul (t, t, z2_100_0);
+  fe_sq_n (t, t, 50);
+  fe_mul (t, t, z2_50_0);
+  fe_sq_n (t, t, 5);
+  fe_mul (h, t, z11);
+}
+
+static_always_inline void
+fe_cswap (fe_t f, fe_t g, u64 swap)
+{
+  u64 mask = -swap, x;
+
+  for (int i = 0; i < 5; i++)
     {
-      ret = false;
-      goto out;
+      x = mask & (f[i] ^ g[i]);
+      f[i] ^= x;
+      g[i] ^= x;
     }
+}
+
+static void
+x25519_scalarmult (u8 out[CURVE25519_KEY_SIZE],
+		   const u8 scalar[CURVE25519_KEY_SIZE],
+		   const u8 point[CURVE25519_KEY_SIZE])
+{
+  fe_t x1, x2 = { 1 }, z2 = { 0 }, x3, z3 = { 1 };
+  fe_t a, aa, b, bb, e, c, d, da, cb;
+  u8 k[CURVE25519_KEY_SIZE];
+  u64 swap = 0, bit;
+
+  clib_memcpy_fast (k, scalar, CURVE25519_KEY_SIZE);
+  k[0] &= 248;
+  k[31] &= 127;
+  k[31] |= 64;
+
+  fe_frombytes (x1, point);
+  clib_memcpy_fast (x3, x1, sizeof (fe_t));
 
-  key_len = CURVE25519_KEY_SIZE;
-  if (EVP_PKEY_derive (ctx, shared_key, &key_len) <= 0)
+  /* Montgomery ladder, RFC 7748 section 5 */
+  for (int t = 254; t >= 0; t--)
     {
-      ret = false;
+      bit = (k[t >> 3] >> (t & 7)) & 1;
+      swap ^= bit;
+      fe_cswap (x2, x3, swap);
+      fe_cswap (z2, z3, swap);
+      swap = bit;
+
+      fe_add (a, x2, z2);
+      fe_sq (aa, a);
+      fe_sub (b, x2, z2);
+      fe_sq (bb, b);
+      fe_sub (e, aa, bb);
+      fe_add (c, x3, z3);
+      fe_sub (d, x3, z3);
+      fe_mul (da, d, a);
+      fe_mul (cb, c, b);
+      fe_add (x3, da, cb);
+      fe_sq (x3, x3);
+      fe_sub (z3, da, cb);
+      fe_sq (z3, z3);
+      fe_mul (z3, z3, x1);
+      fe_mul (x2, aa, bb);
+      fe_mul_small (z2, e, 121665);
+      fe_add (z2, z2, aa);
+      fe_mul (z2, z2, e);
     }
+  fe_cswap (x2, x3, swap);
+  fe_cswap (z2, z3, swap);
 
-out:
-  EVP_PKEY_CTX_free (ctx);
-  EVP_PKEY_free (pkey);
-  EVP_PKEY_free (peerkey);
-  return ret;
+  fe_invert (z2, z2);
+  fe_mul (x2, x2, z2);
+  fe_tobytes (out, x2);
+
+  clib_memset (k, 0, sizeof (k));
+}
+
+bool
+curve25519_gen_shared (u8 shared_key[CURVE25519_KEY_SIZE],
+		       const u8 secret_key[CURVE25519_KEY_SIZE],
+		       const u8 basepoint[CURVE25519_KEY_SIZE])
+{
+  u8 acc = 0;
+
+  x25519_scalarmult (shared_key, secret_key, basepoint);
+
+  /* reject low order points, the result is then all zeros */
+  for (int i = 0; i < CURVE25519_KEY_SIZE; i++)
+    acc |= shared_key[i];
+  return acc != 0;
 }
 
 bool
 curve25519_gen_public (u8 public_key[CURVE25519_KEY_SIZE],
 		       const u8 secret_key[CURVE25519_KEY_SIZE])
 {
-  size_t pub_len;
-  EVP_PKEY *pkey =
-    EVP_PKEY_new_raw_private_key (EVP_PKEY_X25519, NULL, secret_key,
-				  CURVE25519_KEY_SIZE);
-  pub_len = CURVE25519_KEY_SIZE;
-  if (!EVP_PKEY_get_raw_public_key (pkey, public_key, &pub_len))
-    {
-      EVP_PKEY_free (pkey);
-      return false;
-    }
-  EVP_PKEY_free (pkey);
+  static const u8 basepoint[CURVE25519_KEY_SIZE] = { 9 };
+
+  x25519_scalarmult (public_key, secret_key, basepoint);
   return true;
 }
 
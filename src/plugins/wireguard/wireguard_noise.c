@@ -15,7 +15,6 @@
  * limitations under the License.
  */
 
-#include <openssl/hmac.h>
 #include <wireguard/wireguard.h>
 
 /* This implements Noise_IKpsk2:
@@ -631,16 +630,13 @@ noise_kdf (uint8_t * a, uint8_t * b, uint8_t * c, const uint8_t * x,
   uint8_t sec[BLAKE2S_HASH_SIZE];
 
   /* Extract entropy from "x" into sec */
-  u32 l = 0;
-  HMAC (EVP_blake2s256 (), ck, NOISE_HASH_LEN, x, x_len, sec, &l);
-  ASSERT (l == BLAKE2S_HASH_SIZE);
+  blake2s_hmac (sec, x, x_len, ck, NOISE_HASH_LEN);
   if (a == NULL || a_len == 0)
     goto out;
 
   /* Expand first key: key = sec, data = 0x1 */
   out[0] = 1;
-  HMAC (EVP_blake2s256 (), sec, BLAKE2S_HASH_SIZE, out, 1, out, &l);
-  ASSERT (l == BLAKE2S_HASH_SIZE);
+  blake2s_hmac (out, out, 1, sec, BLAKE2S_HASH_SIZE);
   clib_memcpy (a, out, a_len);
 
   if (b == NULL || b_len == 0)
@@ -648,9 +644,7 @@ noise_kdf (uint8_t * a, uint8_t * b, uint8_t * c, const uint8_t * x,
 
   /* Expand second key: key = sec, data = "a" || 0x2 */
   out[BLAKE2S_HASH_SIZE] = 2;
-  HMAC (EVP_blake2s256 (), sec, BLAKE2S_HASH_SIZE, out, BLAKE2S_HASH_SIZE + 1,
-	out, &l);
-  ASSERT (l == BLAKE2S_HASH_SIZE);
+  blake2s_hmac (out, out, BLAKE2S_HASH_SIZE + 1, sec, BLAKE2S_HASH_SIZE);
   clib_memcpy (b, out, b_len);
 
   if (c == NULL || c_len == 0)
@@ -658,9 +652,7 @@ noise_kdf (uint8_t * a, uint8_t * b, uint8_t * c, const uint8_t * x,
 
   /* Expand third key: key = sec, data = "b" || 0x3 */
   out[BLAKE2S_HASH_SIZE] = 3;
-  HMAC (EVP_blake2s256 (), sec, BLAKE2S_HASH_SIZE, out, BLAKE2S_HASH_SIZE + 1,
-	out, &l);
-  ASSERT (l == BLAKE2S_HASH_SIZE);
+  blake2s_hmac (out, out, BLAKE2S_HASH_SIZE + 1, sec, BLAKE2S_HASH_SIZE);
 
   clib_memcpy (c, out, c_len);
 
@@ -139,9 +139,8 @@ noise_local_get (uint32_t locali)
 static_always_inline uint64_t
 noise_counter_send (noise_counter_t *ctr)
 {
-  uint64_t ret;
-  ret = ctr->c_send++;
-  return ret;
+  /* in async mode several workers may encrypt for the same peer */
+  return clib_atomic_fetch_add (&ctr->c_send, 1);
 }
 
 void noise_local_init (noise_local_t *, struct noise_upcall *);
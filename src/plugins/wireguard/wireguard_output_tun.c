@@ -379,7 +379,12 @@ wg_output_tun_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  b[0]->error = node->errors[WG_OUTPUT_ERROR_PEER];
 	  goto out;
 	}
-      if (PREDICT_FALSE (~0 == peer->output_thread_index))
+      /* In async mode each worker encrypts the packets it received: the
+       * nonce is reserved atomically and the crypto frames of a thread
+       * complete in order, so flows (which stay on one worker) are not
+       * reordered and handing off to the peer's thread buys nothing.
+       */
+      if (PREDICT_FALSE (!is_async && ~0 == peer->output_thread_index))
 	{
 	  /* this is the first packet to use this peer, claim the peer
 	   * for this thread.
@@ -388,7 +393,8 @@ wg_output_tun_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 				    wg_peer_assign_thread (thread_index));
 	}
 
-      if (PREDICT_FALSE (thread_index != peer->output_thread_index))
+      if (PREDICT_FALSE (!is_async &&
+			 thread_index != peer->output_thread_index))
 	{
 	  noop_next[0] = WG_OUTPUT_NEXT_HANDOFF;
 	  err = WG_OUTPUT_NEXT_HANDOFF;
@@ -390,6 +390,13 @@ svm_msg_q_add (svm_msg_q_t * mq, svm_msg_q_msg_t * msg, int nowait)
   return 0;
 }
 
+void
+svm_msg_q_add_w_lock (svm_msg_q_t *mq, svm_msg_q_msg_t *msg)
+{
+  ASSERT (svm_msq_q_msg_is_valid (mq, msg));
+  svm_msg_q_add_raw (mq, (u8 *) msg);
+}
+
 void
 svm_msg_q_add_and_unlock (svm_msg_q_t * mq, svm_msg_q_msg_t * msg)
 {
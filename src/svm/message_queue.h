@@ -216,6 +216,17 @@ int svm_msg_q_add (svm_msg_q_t * mq, svm_msg_q_msg_t * msg, int nowait);
  */
 void svm_msg_q_add_and_unlock (svm_msg_q_t * mq, svm_msg_q_msg_t * msg);
 
+/**
+ * Producer enqueue one message to queue with mutex held and keep it held
+ *
+ * Lets producers enqueue a batch of messages under a single lock
+ * acquisition. Consumer is only signaled if the queue was empty.
+ *
+ * @param mq		message queue
+ * @param msg		message (pointer to ring position) to be enqueued
+ */
+void svm_msg_q_add_w_lock (svm_msg_q_t *mq, svm_msg_q_msg_t *msg);
+
 /**
  * Consumer dequeue one message from queue
  *
@@ -440,6 +440,12 @@ vppcom_cfg_read_file (char *conf_fname)
 	      VCFG_DBG (0, "VCL<%d>: configured namespace_id %s",
 			getpid (), (char *) vcl_cfg->namespace_id);
 	    }
+	  else if (unformat (line_input, "epoll-busy-poll %u",
+			     &vcl_cfg->epoll_busy_poll_us))
+	    {
+	      VCFG_DBG (0, "VCL<%d>: configured epoll busy-poll %u us",
+			getpid (), vcl_cfg->epoll_busy_poll_us);
+	    }
 	  else if (unformat (line_input, "use-mq-eventfd"))
 	    {
 	      vcl_cfg->use_mq_eventfd = 1;
@@ -598,6 +604,24 @@ vppcom_cfg (vppcom_cfg_t * vcl_cfg)
       VCFG_DBG (0, "VCL<%d>: configured " VPPCOM_ENV_APP_USE_MQ_EVENTFD,
 		getpid ());
     }
+  env_var_str = getenv (VPPCOM_ENV_EPOLL_BUSY_POLL);
+  if (env_var_str)
+    {
+      u32 tmp;
+      if (sscanf (env_var_str, "%u", &tmp) != 1)
+	{
+	  VCFG_DBG (0, "VCL<%d>: WARNING: Invalid epoll busy-poll specified"
+		    " in the environment variable "
+		    VPPCOM_ENV_EPOLL_BUSY_POLL " (%s)!\n", getpid (),
+		    env_var_str);
+	}
+      else
+	{
+	  vcm->cfg.epoll_busy_poll_us = tmp;
+	  VCFG_DBG (0, "VCL<%d>: configured epoll busy-poll %u us from "
+		    VPPCOM_ENV_EPOLL_BUSY_POLL "!", getpid (), tmp);
+	}
+    }
 }
 
 /*
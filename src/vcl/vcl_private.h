@@ -141,6 +141,7 @@ typedef enum vcl_session_flags_
   VCL_SESSION_F_WR_SHUTDOWN = 1 << 5,
   VCL_SESSION_F_PENDING_DISCONNECT = 1 << 6,
   VCL_SESSION_F_PENDING_FREE = 1 << 7,
+  VCL_SESSION_F_PENDING_TX = 1 << 8,
 } __clib_packed vcl_session_flags_t;
 
 typedef struct vcl_session_
@@ -202,6 +203,7 @@ typedef struct vppcom_cfg_t_
   u8 *vpp_bapi_socket_name;	/**< bapi socket transport socket name */
   u32 tls_engine;
   u8 mt_wrk_supported;
+  u32 epoll_busy_poll_us;	/**< max busy-poll before epoll blocks */
 } vppcom_cfg_t;
 
 void vppcom_cfg (vppcom_cfg_t * vcl_cfg);
@@ -258,6 +260,12 @@ typedef struct vcl_worker_
   /** Next session to be lt polled */
   u32 ep_lt_current;
 
+  /** Adaptive epoll busy-poll budget, in cpu clocks */
+  u64 ep_busy_poll_budget;
+
+  /** Epoll wait wake stats */
+  vppcom_epoll_stats_t ep_stats;
+
   /** Hash table for disconnect processing */
   uword *session_index_by_vpp_handles;
 
@@ -280,6 +288,15 @@ typedef struct vcl_worker_
 
   u32 *pending_session_wrk_updates;
 
+  /** Sessions with tx not yet signaled to vpp */
+  u32 *pending_tx_sessions;
+
+  /** Submitted io ops that would have blocked */
+  vppcom_io_op_t *io_pending;
+
+  /** Io ops completed but not yet retrieved by app */
+  vppcom_io_op_t *io_completed;
+
   /** Used also as a thread stop key buffer */
   pthread_t thread_id;
 
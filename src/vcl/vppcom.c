@@ -2136,9 +2136,85 @@ vcl_fifo_is_writeable (svm_fifo_t * f, u32 len, u8 is_dgram)
     return max_enq > 0;
 }
 
+/**
+ * Notify vpp of new data in session's tx fifo. If notification is deferred,
+ * session is only added to the worker's pending tx list and vpp is notified
+ * on the next @ref vcl_worker_flush_pending_tx
+ */
+static inline void
+vcl_session_tx_notify (vcl_worker_t *wrk, vcl_session_t *s,
+		       session_evt_type_t et, u8 defer)
+{
+  if (defer)
+    {
+      if (!(s->flags & VCL_SESSION_F_PENDING_TX))
+	{
+	  s->flags |= VCL_SESSION_F_PENDING_TX;
+	  vec_add1 (wrk->pending_tx_sessions, s->session_index);
+	}
+      return;
+    }
+
+  if (svm_fifo_set_event (s->tx_fifo))
+    app_send_io_evt_to_vpp (
+      s->vpp_evt_q, s->tx_fifo->shr->master_session_index, et, SVM_Q_WAIT);
+}
+
+/**
+ * Send tx events for all sessions with deferred notifications. Consecutive
+ * sessions that share a vpp message queue, typically all sessions of a
+ * worker, are notified with only one lock acquisition.
+ */
+static int
+vcl_worker_flush_pending_tx (vcl_worker_t *wrk)
+{
+  svm_msg_q_t *mq = 0;
+  session_event_t *evt;
+  svm_msg_q_msg_t msg;
+  u32 *si, n_evts = 0;
+  vcl_session_t *s;
+
+  vec_foreach (si, wrk->pending_tx_sessions)
+    {
+      s = vcl_session_get (wrk, *si);
+      if (!s || !(s->flags & VCL_SESSION_F_PENDING_TX))
+	continue;
+
+      s->flags &= ~VCL_SESSION_F_PENDING_TX;
+      if (!vcl_session_is_open (s) || !svm_fifo_set_event (s->tx_fifo))
+	continue;
+
+      if (s->vpp_evt_q != mq)
+	{
+	  if (mq)
+	    svm_msg_q_unlock (mq);
+	  mq = s->vpp_evt_q;
+	  svm_msg_q_lock (mq);
+	}
+
+      while (svm_msg_q_ring_is_full (mq, SESSION_MQ_IO_EVT_RING) ||
+	     svm_msg_q_is_full (mq))
+	svm_msg_q_wait_prod (mq);
+
+      msg = svm_msg_q_alloc_msg_w_ring (mq, SESSION_MQ_IO_EVT_RING);
+      evt = (session_event_t *) svm_msg_q_msg_data (mq, &msg);
+      evt->session_index = s->tx_fifo->shr->master_session_index;
+      evt->event_type = SESSION_IO_EVT_TX;
+      svm_msg_q_add_w_lock (mq, &msg);
+      n_evts += 1;
+    }
+
+  if (mq)
+    svm_msg_q_unlock (mq);
+
+  vec_reset_length (wrk->pending_tx_sessions);
+
+  return n_evts;
+}
+
 always_inline int
-vppcom_session_write_inline (vcl_worker_t * wrk, vcl_session_t * s, void *buf,
-			     size_t n, u8 is_flush, u8 is_dgram)
+vppcom_session_write_inline (vcl_worker_t *wrk, vcl_session_t *s, void *buf,
+			     size_t n, u8 is_flush, u8 is_dgram, u8 defer_evt)
 {
   int n_write, is_nonblocking;
   session_evt_type_t et;
@@ -2210,9 +2286,7 @@ vppcom_session_write_inline (vcl_worker_t * wrk, vcl_session_t * s, void *buf,
     n_write = app_send_stream_raw (tx_fifo, s->vpp_evt_q, buf, n, et,
 				   0 /* do_evt */ , SVM_Q_WAIT);
 
-  if (svm_fifo_set_event (s->tx_fifo))
-    app_send_io_evt_to_vpp (
-      s->vpp_evt_q, s->tx_fifo->shr->master_session_index, et, SVM_Q_WAIT);
+  vcl_session_tx_notify (wrk, s, et, defer_evt);
 
   /* The underlying fifo segment can run out of memory */
   if (PREDICT_FALSE (n_write < 0))
@@ -2234,8 +2308,8 @@ vppcom_session_write (uint32_t session_handle, void *buf, size_t n)
   if (PREDICT_FALSE (!s))
     return VPPCOM_EBADFD;
 
-  return vppcom_session_write_inline (wrk, s, buf, n,
-				      0 /* is_flush */ , s->is_dgram ? 1 : 0);
+  return vppcom_session_write_inline (wrk, s, buf, n, 0 /* is_flush */,
+				      s->is_dgram ? 1 : 0, 0 /* defer_evt */);
 }
 
 int
@@ -2248,8 +2322,306 @@ vppcom_session_write_msg (uint32_t session_handle, void *buf, size_t n)
   if (PREDICT_FALSE (!s))
     return VPPCOM_EBADFD;
 
-  return vppcom_session_write_inline (wrk, s, buf, n,
-				      1 /* is_flush */ , s->is_dgram ? 1 : 0);
+  return vppcom_session_write_inline (wrk, s, buf, n, 1 /* is_flush */,
+				      s->is_dgram ? 1 : 0, 0 /* defer_evt */);
+}
+
+int
+vppcom_session_reserve_segments (uint32_t session_handle,
+				 vppcom_data_segment_t *ds,
+				 uint32_t n_segments, uint32_t max_bytes)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  int n_segs, is_nonblocking, i;
+  u32 max_enq, n_bytes = 0;
+  svm_fifo_t *tx_fifo;
+  vcl_session_t *s;
+
+  s = vcl_session_get_w_handle (wrk, session_handle);
+  if (PREDICT_FALSE (!s || (s->flags & VCL_SESSION_F_IS_VEP)))
+    return VPPCOM_EBADFD;
+
+  if (PREDICT_FALSE (!ds || !n_segments))
+    return VPPCOM_EFAULT;
+
+  /* Datagrams are prefixed by a header vcl must write, so streams only */
+  if (PREDICT_FALSE (s->is_dgram))
+    return VPPCOM_EINVAL;
+
+  if (PREDICT_FALSE (!vcl_session_is_open (s)))
+    return vcl_session_closed_error (s);
+
+  if (PREDICT_FALSE (s->flags & VCL_SESSION_F_WR_SHUTDOWN))
+    return VPPCOM_EPIPE;
+
+  if (PREDICT_FALSE (!max_bytes))
+    return 0;
+
+  tx_fifo = vcl_session_is_ct (s) ? s->ct_tx_fifo : s->tx_fifo;
+  is_nonblocking = vcl_session_has_attr (s, VCL_SESS_ATTR_NONBLOCK);
+
+  while (!(max_enq = svm_fifo_max_enqueue_prod (tx_fifo)))
+    {
+      if (is_nonblocking)
+	return VPPCOM_EWOULDBLOCK;
+
+      svm_fifo_add_want_deq_ntf (tx_fifo, SVM_FIFO_WANT_DEQ_NOTIF);
+      if (vcl_session_is_closing (s))
+	return vcl_session_closing_error (s);
+
+      svm_msg_q_wait (wrk->app_event_queue, SVM_MQ_WAIT_EMPTY);
+      vcl_worker_flush_mq_events (wrk);
+    }
+
+  /* The underlying fifo segment can run out of memory */
+  max_bytes = clib_min (max_enq, max_bytes);
+  n_segs = svm_fifo_provision_chunks (tx_fifo, (svm_fifo_seg_t *) ds,
+				      n_segments, max_bytes);
+  if (PREDICT_FALSE (n_segs <= 0))
+    return VPPCOM_EAGAIN;
+
+  for (i = 0; i < n_segs; i++)
+    n_bytes += ds[i].len;
+
+  VDBG (2, "session %u [0x%llx]: reserved %u bytes in %d segments",
+	s->session_index, s->vpp_handle, n_bytes, n_segs);
+
+  return n_bytes;
+}
+
+int
+vppcom_session_commit_segments (uint32_t session_handle, uint32_t n_bytes,
+				uint8_t more)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  svm_fifo_t *tx_fifo;
+  vcl_session_t *s;
+
+  s = vcl_session_get_w_handle (wrk, session_handle);
+  if (PREDICT_FALSE (!s || (s->flags & VCL_SESSION_F_IS_VEP)))
+    return VPPCOM_EBADFD;
+
+  if (PREDICT_FALSE (s->is_dgram))
+    return VPPCOM_EINVAL;
+
+  if (PREDICT_FALSE (!vcl_session_is_open (s)))
+    return vcl_session_closed_error (s);
+
+  if (PREDICT_FALSE (!n_bytes))
+    return 0;
+
+  tx_fifo = vcl_session_is_ct (s) ? s->ct_tx_fifo : s->tx_fifo;
+  if (PREDICT_FALSE (n_bytes > svm_fifo_max_enqueue_prod (tx_fifo)))
+    return VPPCOM_EINVAL;
+
+  svm_fifo_enqueue_nocopy (tx_fifo, n_bytes);
+  vcl_session_tx_notify (wrk, s, SESSION_IO_EVT_TX, more);
+
+  VDBG (2, "session %u [0x%llx]: committed %u bytes", s->session_index,
+	s->vpp_handle, n_bytes);
+
+  return n_bytes;
+}
+
+int
+vppcom_worker_flush_tx (void)
+{
+  return vcl_worker_flush_pending_tx (vcl_worker_get_current ());
+}
+
+/**
+ * Try to execute io op without blocking. Returns 1 if op completed, in
+ * which case result is stored in op->rv, or 0 if op would block.
+ */
+static int
+vcl_io_op_try (vcl_worker_t *wrk, vppcom_io_op_t *op)
+{
+  vcl_session_t *s;
+  svm_fifo_t *f;
+  u8 is_ct;
+
+  s = vcl_session_get_w_handle (wrk, op->sh);
+  if (PREDICT_FALSE (!s || (s->flags & VCL_SESSION_F_IS_VEP)))
+    {
+      op->rv = VPPCOM_EBADFD;
+      return 1;
+    }
+
+  is_ct = vcl_session_is_ct (s);
+
+  switch (op->op)
+    {
+    case VPPCOM_IO_OP_READ:
+      if (!op->len)
+	{
+	  op->rv = 0;
+	  break;
+	}
+      /* Let read report errors and shutdowns, only defer on empty fifo */
+      f = is_ct ? s->ct_rx_fifo : s->rx_fifo;
+      if (vcl_session_is_open (s) && !vcl_session_is_closing (s) &&
+	  !(s->flags & VCL_SESSION_F_RD_SHUTDOWN) &&
+	  svm_fifo_is_empty_cons (f))
+	{
+	  if (is_ct)
+	    svm_fifo_unset_event (s->rx_fifo);
+	  svm_fifo_unset_event (f);
+	  return 0;
+	}
+      op->rv = vppcom_session_read_internal (op->sh, op->buf, op->len, 0);
+      break;
+    case VPPCOM_IO_OP_WRITE:
+      if (!op->len)
+	{
+	  op->rv = 0;
+	  break;
+	}
+      f = is_ct ? s->ct_tx_fifo : s->tx_fifo;
+      if (vcl_session_is_open (s) && !(s->flags & VCL_SESSION_F_WR_SHUTDOWN) &&
+	  !vcl_fifo_is_writeable (f, op->len, s->is_dgram))
+	{
+	  if (vcl_session_is_closing (s))
+	    {
+	      op->rv = vcl_session_closing_error (s);
+	      break;
+	    }
+	  svm_fifo_add_want_deq_ntf (f, SVM_FIFO_WANT_DEQ_NOTIF);
+	  return 0;
+	}
+      op->rv = vppcom_session_write_inline (wrk, s, op->buf, op->len,
+					    0 /* is_flush */, s->is_dgram,
+					    1 /* defer_evt */);
+      break;
+    case VPPCOM_IO_OP_COMMIT:
+      op->rv = vppcom_session_commit_segments (op->sh, op->len, 1 /* more */);
+      break;
+    case VPPCOM_IO_OP_FREE:
+      if (PREDICT_FALSE (op->len > s->rx_bytes_pending))
+	{
+	  op->rv = VPPCOM_EINVAL;
+	  break;
+	}
+      vppcom_session_free_segments (op->sh, op->len);
+      op->rv = op->len;
+      break;
+    default:
+      op->rv = VPPCOM_EINVAL;
+      break;
+    }
+
+  return 1;
+}
+
+/**
+ * Ops on a session must complete in submission order, so an op is blocked
+ * if one of the first n_ops ops in pending vector targets the same session
+ */
+static inline int
+vcl_io_op_is_blocked (vppcom_io_op_t *pending, u32 n_ops,
+		      vcl_session_handle_t sh)
+{
+  u32 i;
+
+  for (i = 0; i < n_ops; i++)
+    if (pending[i].sh == sh)
+      return 1;
+  return 0;
+}
+
+static void
+vcl_io_retry_pending (vcl_worker_t *wrk)
+{
+  vppcom_io_op_t *op;
+  u32 i, n_left = 0;
+
+  for (i = 0; i < vec_len (wrk->io_pending); i++)
+    {
+      op = vec_elt_at_index (wrk->io_pending, i);
+      if (vcl_io_op_is_blocked (wrk->io_pending, n_left, op->sh) ||
+	  !vcl_io_op_try (wrk, op))
+	{
+	  /* Compact still pending ops at the start of the vector */
+	  wrk->io_pending[n_left++] = *op;
+	  continue;
+	}
+      vec_add1 (wrk->io_completed, *op);
+    }
+  vec_set_len (wrk->io_pending, n_left);
+}
+
+int
+vppcom_io_submit (vppcom_io_op_t *ops, uint32_t n_ops)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  u32 i;
+
+  if (PREDICT_FALSE (!ops && n_ops))
+    return VPPCOM_EFAULT;
+
+  for (i = 0; i < n_ops; i++)
+    {
+      if (vcl_io_op_is_blocked (wrk->io_pending, vec_len (wrk->io_pending),
+				ops[i].sh) ||
+	  !vcl_io_op_try (wrk, &ops[i]))
+	vec_add1 (wrk->io_pending, ops[i]);
+      else
+	vec_add1 (wrk->io_completed, ops[i]);
+    }
+
+  vcl_worker_flush_pending_tx (wrk);
+
+  return n_ops;
+}
+
+int
+vppcom_io_complete (vppcom_io_op_t *ops, uint32_t max_ops,
+		    double wait_for_time)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  f64 timeout = 0, now;
+  u32 n_ops;
+
+  if (PREDICT_FALSE (!ops && max_ops))
+    return VPPCOM_EFAULT;
+
+  if (wait_for_time > 0)
+    timeout = clib_time_now (&wrk->clib_time) + wait_for_time;
+
+  while (1)
+    {
+      /* Refresh session states and fifo notification requests */
+      vcl_worker_flush_mq_events (wrk);
+      if (vec_len (wrk->io_pending))
+	{
+	  vcl_io_retry_pending (wrk);
+	  vcl_worker_flush_pending_tx (wrk);
+	}
+
+      if (vec_len (wrk->io_completed) || !vec_len (wrk->io_pending) ||
+	  !wait_for_time)
+	break;
+
+      if (wait_for_time < 0)
+	{
+	  svm_msg_q_wait (wrk->app_event_queue, SVM_MQ_WAIT_EMPTY);
+	  continue;
+	}
+
+      now = clib_time_now (&wrk->clib_time);
+      if (now >= timeout)
+	break;
+      if (svm_msg_q_is_empty (wrk->app_event_queue))
+	svm_msg_q_timedwait (wrk->app_event_queue, timeout - now);
+    }
+
+  n_ops = clib_min (max_ops, vec_len (wrk->io_completed));
+  if (!n_ops)
+    return 0;
+
+  clib_memcpy_fast (ops, wrk->io_completed, n_ops * sizeof (*ops));
+  vec_delete (wrk->io_completed, n_ops, 0);
+
+  return n_ops;
 }
 
 #define vcl_fifo_rx_evt_valid_or_break(_s)				\
@@ -3222,6 +3594,88 @@ vppcom_epoll_wait_eventfd (vcl_worker_t *wrk, struct epoll_event *events,
   return 0;
 }
 
+/**
+ * Busy-poll worker's message queues instead of blocking on them, to avoid
+ * the wakeup latency of eventfds or condvars. First quarter of the budget
+ * is spent spinning, the rest polling with cpu pause hints. The budget
+ * adapts to traffic: it is halved every time polling ends with no events,
+ * down to 1/16 of the configured value, and restored as soon as polling
+ * finds events again.
+ */
+static int
+vppcom_epoll_wait_busy_poll (vcl_worker_t *wrk, struct epoll_event *events,
+			     int maxevents, double *timeout_ms)
+{
+  u64 start, now, end, spin_end, max_budget;
+  vppcom_epoll_stats_t *stats = &wrk->ep_stats;
+  f64 clocks_per_ms, wait_time;
+  vcl_mq_evt_conn_t *mqc;
+  u32 n_evts = 0;
+
+  max_budget = (u64) vcm->cfg.epoll_busy_poll_us *
+	       wrk->clib_time.clocks_per_second / 1e6;
+  if (!wrk->ep_busy_poll_budget)
+    wrk->ep_busy_poll_budget = max_budget;
+
+  clocks_per_ms = wrk->clib_time.clocks_per_second / 1e3;
+  start = now = clib_cpu_time_now ();
+  end = start + wrk->ep_busy_poll_budget;
+  if (*timeout_ms > 0)
+    end = clib_min (end, start + (u64) (*timeout_ms * clocks_per_ms));
+  spin_end = start + (end - start) / 4;
+
+  while (now < end)
+    {
+      if (vcm->cfg.use_mq_eventfd)
+	{
+	  pool_foreach (mqc, wrk->mq_evt_conns)
+	    {
+	      if (!svm_msg_q_is_empty (mqc->mq))
+		vcl_epoll_wait_handle_mq (wrk, mqc->mq, events, maxevents, 0,
+					  &n_evts);
+	    }
+	}
+      else if (!svm_msg_q_is_empty (wrk->app_event_queue))
+	vcl_epoll_wait_handle_mq (wrk, wrk->app_event_queue, events,
+				  maxevents, 0, &n_evts);
+
+      if (n_evts)
+	break;
+
+      now = clib_cpu_time_now ();
+      if (now >= spin_end)
+	CLIB_PAUSE ();
+    }
+
+  if (n_evts)
+    {
+      wait_time = (clib_cpu_time_now () - start) *
+		  wrk->clib_time.seconds_per_clock;
+      if (now < spin_end)
+	{
+	  stats->n_spin_wakes += 1;
+	  stats->spin_wait_time += wait_time;
+	}
+      else
+	{
+	  stats->n_pause_wakes += 1;
+	  stats->pause_wait_time += wait_time;
+	}
+      wrk->ep_busy_poll_budget = max_budget;
+      return n_evts;
+    }
+
+  wrk->ep_busy_poll_budget =
+    clib_max (wrk->ep_busy_poll_budget / 2, max_budget / 16);
+
+  /* Consume busy-polled time out of the caller's timeout. Zero means only
+   * check for events without blocking */
+  if (*timeout_ms > 0)
+    *timeout_ms = clib_max (*timeout_ms - (now - start) / clocks_per_ms, 0);
+
+  return 0;
+}
+
 static void
 vcl_epoll_wait_handle_lt (vcl_worker_t *wrk, struct epoll_event *events,
 			  int maxevents, u32 *n_evts)
@@ -3289,6 +3743,7 @@ vppcom_epoll_wait (uint32_t vep_handle, struct epoll_event *events,
   vcl_worker_t *wrk = vcl_worker_get_current ();
   vcl_session_t *vep_session;
   u32 n_evts = 0;
+  u64 start = 0;
   int i;
 
   if (PREDICT_FALSE (maxevents <= 0))
@@ -3329,6 +3784,18 @@ vppcom_epoll_wait (uint32_t vep_handle, struct epoll_event *events,
   if ((int) wait_for_time == -2)
     return n_evts;
 
+  /* Only account waits, i.e., no events ready and caller willing to wait */
+  if (!n_evts && wait_for_time)
+    {
+      start = clib_cpu_time_now ();
+      if (vcm->cfg.epoll_busy_poll_us)
+	{
+	  n_evts = vppcom_epoll_wait_busy_poll (wrk, events, maxevents,
+						&wait_for_time);
+	  if (n_evts)
+	    return n_evts;
+	}
+    }
 
   if (vcm->cfg.use_mq_eventfd)
     n_evts = vppcom_epoll_wait_eventfd (wrk, events, maxevents, n_evts,
@@ -3337,9 +3804,38 @@ vppcom_epoll_wait (uint32_t vep_handle, struct epoll_event *events,
     n_evts = vppcom_epoll_wait_condvar (wrk, events, maxevents, n_evts,
 					wait_for_time);
 
+  if (start)
+    {
+      if (n_evts)
+	{
+	  wrk->ep_stats.n_sleep_wakes += 1;
+	  wrk->ep_stats.sleep_wait_time +=
+	    (clib_cpu_time_now () - start) * wrk->clib_time.seconds_per_clock;
+	}
+      else
+	wrk->ep_stats.n_timeouts += 1;
+    }
+
   return n_evts;
 }
 
+int
+vppcom_worker_epoll_stats (vppcom_epoll_stats_t *stats, uint8_t clear)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+
+  if (PREDICT_FALSE (!stats))
+    return VPPCOM_EFAULT;
+
+  *stats = wrk->ep_stats;
+  stats->busy_poll_budget_us = wrk->ep_busy_poll_budget *
+			       wrk->clib_time.seconds_per_clock * 1e6;
+  if (clear)
+    clib_memset (&wrk->ep_stats, 0, sizeof (wrk->ep_stats));
+
+  return VPPCOM_OK;
+}
+
 int
 vppcom_session_attr (uint32_t session_handle, uint32_t op,
 		     void *buffer, uint32_t * buflen)
@@ -4065,7 +4561,7 @@ vppcom_session_sendto (uint32_t session_handle, void *buffer,
     }
 
   return (vppcom_session_write_inline (wrk, s, buffer, buflen, 1,
-				       s->is_dgram ? 1 : 0));
+				       s->is_dgram ? 1 : 0, 0));
 }
 
 int
@@ -45,6 +45,7 @@ extern "C"
 #define VPPCOM_ENV_APP_USE_MQ_EVENTFD		"VCL_APP_USE_MQ_EVENTFD"
 #define VPPCOM_ENV_VPP_API_SOCKET           	"VCL_VPP_API_SOCKET"
 #define VPPCOM_ENV_VPP_SAPI_SOCKET		"VCL_VPP_SAPI_SOCKET"
+#define VPPCOM_ENV_EPOLL_BUSY_POLL		"VCL_EPOLL_BUSY_POLL"
 
   typedef enum
   {
@@ -167,6 +168,36 @@ typedef vppcom_data_segment_t vppcom_data_segments_t[2];
 
 typedef unsigned long vcl_si_set;
 
+typedef struct vppcom_epoll_stats_
+{
+  uint64_t n_spin_wakes;	/**< waits ended by events while spinning */
+  uint64_t n_pause_wakes;	/**< waits ended by events while pausing */
+  uint64_t n_sleep_wakes;	/**< waits ended by events after blocking */
+  uint64_t n_timeouts;		/**< waits that ended with no events */
+  double spin_wait_time;	/**< seconds waited, summed over spin wakes */
+  double pause_wait_time;	/**< seconds waited, summed over pause wakes */
+  double sleep_wait_time;	/**< seconds waited, summed over sleep wakes */
+  uint32_t busy_poll_budget_us; /**< current adaptive busy-poll budget */
+} vppcom_epoll_stats_t;
+
+typedef enum vppcom_io_op_type_
+{
+  VPPCOM_IO_OP_READ,		/**< copy up to len bytes into buf */
+  VPPCOM_IO_OP_WRITE,		/**< copy len bytes from buf */
+  VPPCOM_IO_OP_COMMIT,		/**< commit len reserved tx bytes */
+  VPPCOM_IO_OP_FREE,		/**< free len rx bytes read as segments */
+} vppcom_io_op_type_t;
+
+typedef struct vppcom_io_op_
+{
+  vcl_session_handle_t sh;	/**< session the op applies to */
+  uint32_t op;			/**< see @ref vppcom_io_op_type_t */
+  void *buf;			/**< app buffer for read/write ops */
+  uint32_t len;			/**< bytes to read/write/commit/free */
+  int rv;			/**< result, filled in on completion */
+  uint64_t opaque;		/**< app data, returned untouched */
+} vppcom_io_op_t;
+
 /*
  * VPPCOM Public API Functions
  */
@@ -223,6 +254,12 @@ extern int vppcom_session_read_segments (uint32_t session_handle,
 					 uint32_t max_bytes);
 extern void vppcom_session_free_segments (uint32_t session_handle,
 					  uint32_t n_bytes);
+extern int vppcom_session_reserve_segments (uint32_t session_handle,
+					    vppcom_data_segment_t *ds,
+					    uint32_t n_segments,
+					    uint32_t max_bytes);
+extern int vppcom_session_commit_segments (uint32_t session_handle,
+					   uint32_t n_bytes, uint8_t more);
 extern int vppcom_add_cert_key_pair (vppcom_cert_key_pair_t *ckpair);
 extern int vppcom_del_cert_key_pair (uint32_t ckpair_index);
 extern int vppcom_unformat_proto (uint8_t * proto, char *proto_str);
@@ -264,6 +301,45 @@ extern void vppcom_worker_index_set (int);
  */
 extern int vppcom_worker_mqs_epfd (void);
 
+/**
+ * Retrieve current worker's epoll wait stats
+ *
+ * Waits are only accounted if vppcom_epoll_wait found no events ready on
+ * entry and was asked to wait. If clear is set, stats are reset after
+ * being copied.
+ */
+extern int vppcom_worker_epoll_stats (vppcom_epoll_stats_t *stats,
+				      uint8_t clear);
+
+/**
+ * Notify vpp of all tx committed with the more flag set
+ *
+ * Sessions that share a vpp message queue are notified under one lock
+ * acquisition. Returns the number of events sent to vpp.
+ */
+extern int vppcom_worker_flush_tx (void);
+
+/**
+ * Submit a batch of io operations on the current worker's sessions
+ *
+ * Ops are executed without blocking, regardless of session attributes.
+ * Those that complete, successfully or not, are queued for retrieval with
+ * @ref vppcom_io_complete. Those that would block are retried on the next
+ * call to @ref vppcom_io_complete. Tx notifications for all ops are sent
+ * to vpp in one batch, before returning. Returns number of ops accepted.
+ */
+extern int vppcom_io_submit (vppcom_io_op_t *ops, uint32_t n_ops);
+
+/**
+ * Retrieve completed io operations
+ *
+ * Retries pending ops and copies up to max_ops completed ones into ops.
+ * If none completed, waits for up to wait_for_time seconds for session
+ * events that may unblock pending ops. Returns number of ops copied.
+ */
+extern int vppcom_io_complete (vppcom_io_op_t *ops, uint32_t max_ops,
+			       double wait_for_time);
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
 }
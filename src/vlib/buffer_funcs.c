@@ -205,7 +205,8 @@ vlib_buffer_enqueue_to_thread_inline (vlib_main_t *vm,
 				      vlib_node_runtime_t *node,
 				      vlib_frame_queue_main_t *fqm,
 				      u32 *buffer_indices, u16 *thread_indices,
-				      u32 n_packets, int drop_on_congestion)
+				      u32 n_packets, int drop_on_congestion,
+				      u64 enqueue_clocks)
 {
   u32 drop_list[VLIB_FRAME_SIZE], n_drop = 0;
   u64 used_elts[VLIB_FRAME_SIZE / 64] = {};
@@ -228,6 +229,7 @@ more:
       if (node->flags & VLIB_NODE_FLAG_TRACE)
 	hf->maybe_trace = 1;
       hf->n_vectors = n_comp;
+      hf->enqueue_clocks = enqueue_clocks;
       __atomic_store_n (&hf->valid, 1, __ATOMIC_RELEASE);
       vlib_get_main_by_index (thread_index)->check_frame_queues = 1;
     }
@@ -267,14 +269,18 @@ CLIB_MULTIARCH_FN (vlib_buffer_enqueue_to_thread_fn)
   vlib_thread_main_t *tm = vlib_get_thread_main ();
   vlib_frame_queue_main_t *fqm;
   u32 n_enq = 0;
+  u64 enqueue_clocks = 0;
 
   fqm = vec_elt_at_index (tm->frame_queue_mains, frame_queue_index);
 
+  if (PREDICT_FALSE (tm->frame_queue_wait_fn != 0))
+    enqueue_clocks = clib_cpu_time_now ();
+
   while (n_packets >= VLIB_FRAME_SIZE)
     {
       n_enq += vlib_buffer_enqueue_to_thread_inline (
 	vm, node, fqm, buffer_indices, thread_indices, VLIB_FRAME_SIZE,
-	drop_on_congestion);
+	drop_on_congestion, enqueue_clocks);
       buffer_indices += VLIB_FRAME_SIZE;
       thread_indices += VLIB_FRAME_SIZE;
       n_packets -= VLIB_FRAME_SIZE;
@@ -283,9 +289,9 @@ CLIB_MULTIARCH_FN (vlib_buffer_enqueue_to_thread_fn)
   if (n_packets == 0)
     return n_enq;
 
-  n_enq += vlib_buffer_enqueue_to_thread_inline (vm, node, fqm, buffer_indices,
-						 thread_indices, n_packets,
-						 drop_on_congestion);
+  n_enq += vlib_buffer_enqueue_to_thread_inline (
+    vm, node, fqm, buffer_indices, thread_indices, n_packets,
+    drop_on_congestion, enqueue_clocks);
 
   return n_enq;
 }
@@ -372,6 +378,15 @@ CLIB_MULTIARCH_FN (vlib_frame_queue_dequeue_fn)
 
       n_copy = clib_min (n_free, elt->n_vectors);
 
+      if (PREDICT_FALSE (elt->enqueue_clocks != 0))
+	{
+	  vlib_thread_main_t *tm = vlib_get_thread_main ();
+	  u64 now = clib_cpu_time_now ();
+	  if (tm->frame_queue_wait_fn && now > elt->enqueue_clocks)
+	    tm->frame_queue_wait_fn (vm, from, n_copy,
+				     now - elt->enqueue_clocks);
+	}
+
       vlib_buffer_copy_indices (to, from, n_copy);
       to += n_copy;
       n_free -= n_copy;
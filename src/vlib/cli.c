@@ -1554,8 +1554,7 @@ event_logger_trace_command_fn (vlib_main_t * vm,
     {
       elog_main_t *em = &vlib_global_main.elog_main;
 
-      em->n_total_events_disable_limit =
-	em->n_total_events + vec_len (em->event_ring);
+      elog_disable_after_events (em, em->event_ring_size);
     }
 
 
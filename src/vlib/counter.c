@@ -96,7 +96,9 @@ vlib_validate_simple_counter (vlib_simple_counter_main_t * cm, u32 index)
   /* Avoid the epoch increase when there was no counter vector resize. */
   if (resized)
     vlib_stats_pop_heap (cm, oldheap, index,
-			 2 /* STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE */);
+			 cm->is_gauge ?
+			   8 /* STAT_DIR_TYPE_GAUGE_VECTOR */ :
+			   2 /* STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE */);
   else
     clib_mem_set_heap (oldheap);
 }
@@ -201,6 +203,147 @@ vlib_simple_counter_n_counters (const vlib_simple_counter_main_t * cm)
   return (vec_len (cm->counters[0]));
 }
 
+void
+vlib_validate_histogram (vlib_histogram_main_t *hm, u32 index)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  counter_t layout;
+  uword j, old_len, new_len;
+  int i, resized = 0;
+  void *oldheap;
+
+  ASSERT (hm->n_buckets > 0 && hm->log2_sub_buckets < 8);
+  hm->stride = round_pow2 (VLIB_HISTOGRAM_BUCKETS + hm->n_buckets,
+			   CLIB_CACHE_LINE_BYTES / sizeof (counter_t));
+  layout = vlib_histogram_layout (hm->stride, hm->n_buckets,
+				  hm->log2_sub_buckets);
+  new_len = (index + 1) * hm->stride;
+
+  oldheap = vlib_stats_push_heap (hm->counters);
+
+  vec_validate (hm->counters, tm->n_vlib_mains - 1);
+  for (i = 0; i < tm->n_vlib_mains; i++)
+    if (new_len > vec_len (hm->counters[i]))
+      {
+	old_len = vec_len (hm->counters[i]);
+	if (vec_resize_will_expand (hm->counters[i], new_len - old_len))
+	  resized++;
+	vec_validate_aligned (hm->counters[i], new_len - 1,
+			      CLIB_CACHE_LINE_BYTES);
+	for (j = old_len; j < new_len; j += hm->stride)
+	  hm->counters[i][j + VLIB_HISTOGRAM_LAYOUT] = layout;
+      }
+
+  /* Avoid the epoch increase when there was no counter vector resize. */
+  if (resized)
+    vlib_stats_pop_heap (hm, oldheap, index,
+			 9 /* STAT_DIR_TYPE_HISTOGRAM_VECTOR */);
+  else
+    clib_mem_set_heap (oldheap);
+}
+
+void
+vlib_zero_histogram (vlib_histogram_main_t *hm, u32 index)
+{
+  counter_t *h;
+  uword i;
+
+  for (i = 0; i < vec_len (hm->counters); i++)
+    {
+      /* Keep the layout word, clients rely on it */
+      h = vec_elt_at_index (hm->counters[i], index * hm->stride);
+      clib_memset (h + VLIB_HISTOGRAM_SUM, 0,
+		   (hm->stride - VLIB_HISTOGRAM_SUM) * sizeof (counter_t));
+    }
+}
+
+void
+vlib_clear_histograms (vlib_histogram_main_t *hm)
+{
+  uword j;
+
+  if (hm->stride == 0)
+    return;
+
+  for (j = 0; j < vec_len (hm->counters[0]); j += hm->stride)
+    vlib_zero_histogram (hm, j / hm->stride);
+}
+
+void
+vlib_free_histogram (vlib_histogram_main_t *hm)
+{
+  int i;
+
+  vlib_stats_delete_cm (hm);
+
+  void *oldheap = vlib_stats_push_heap (hm->counters);
+  for (i = 0; i < vec_len (hm->counters); i++)
+    vec_free (hm->counters[i]);
+  vec_free (hm->counters);
+  clib_mem_set_heap (oldheap);
+}
+
+counter_t
+vlib_get_histogram (vlib_histogram_main_t *hm, u32 index, counter_t *sum,
+		    counter_t *buckets)
+{
+  counter_t *h, count = 0;
+  int i, b;
+
+  *sum = 0;
+  if (buckets)
+    clib_memset (buckets, 0, hm->n_buckets * sizeof (counter_t));
+
+  for (i = 0; i < vec_len (hm->counters); i++)
+    {
+      h = vec_elt_at_index (hm->counters[i], index * hm->stride);
+      *sum += h[VLIB_HISTOGRAM_SUM];
+      for (b = 0; b < hm->n_buckets; b++)
+	{
+	  count += h[VLIB_HISTOGRAM_BUCKETS + b];
+	  if (buckets)
+	    buckets[b] += h[VLIB_HISTOGRAM_BUCKETS + b];
+	}
+    }
+
+  return count;
+}
+
+u8 *
+format_vlib_histogram (u8 *s, va_list *args)
+{
+  vlib_histogram_main_t *hm = va_arg (*args, vlib_histogram_main_t *);
+  u32 index = va_arg (*args, u32);
+  static const u32 percentiles[] = { 50, 90, 99 };
+  counter_t *buckets = 0, count, sum, seen = 0;
+  u32 b, p = 0;
+
+  vec_validate (buckets, hm->n_buckets - 1);
+  count = vlib_get_histogram (hm, index, &sum, buckets);
+
+  s = format (s, "count %llu", count);
+  if (count)
+    s = format (s, " mean %.1f", (f64) sum / count);
+
+  /* Report the largest value a percentile's bucket may hold */
+  for (b = 0; count && b < hm->n_buckets; b++)
+    for (seen += buckets[b];
+	 p < ARRAY_LEN (percentiles) && seen * 100 >= percentiles[p] * count;
+	 p++)
+      {
+	if (b == hm->n_buckets - 1)
+	  s = format (s, " p%u >=%llu", percentiles[p],
+		      vlib_histogram_bucket_min (b, hm->log2_sub_buckets));
+	else
+	  s = format (s, " p%u <=%llu", percentiles[p],
+		      vlib_histogram_bucket_min (b + 1, hm->log2_sub_buckets) -
+			1);
+      }
+
+  vec_free (buckets);
+  return s;
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -47,7 +47,8 @@
     Optimized thread-safe counters.
 
     Each vlib_[simple|combined]_counter_main_t consists of a per-thread
-    vector of per-object counters.
+    vector of per-object counters, each vlib_histogram_main_t of a
+    per-thread vector of per-object histograms.
 
     The idea is to drastically eliminate atomic operations.
 */
@@ -59,6 +60,7 @@ typedef struct
   counter_t **counters;	 /**< Per-thread u64 non-atomic counters */
   char *name;			/**< The counter collection's name. */
   char *stat_segment_name;    /**< Name in stat segment directory */
+  u8 is_gauge;		      /**< Levels, rather than running totals */
 } vlib_simple_counter_main_t;
 
 /** The number of counters (not the number of per-thread counters) */
@@ -346,6 +348,61 @@ int vlib_validate_combined_counter_will_expand
 
 void vlib_free_combined_counter (vlib_combined_counter_main_t * cm);
 
+/** A collection of log-linear histograms, see vlib_histogram_bucket ()
+    Set n_buckets and log2_sub_buckets before the first validate.
+*/
+typedef struct
+{
+  counter_t **counters;	  /**< Per-thread histograms, stride apart */
+  char *name;		  /**< The histogram collection's name. */
+  char *stat_segment_name; /**< Name in stat segment directory */
+  u32 n_buckets;	  /**< Buckets per histogram, the last open ended */
+  u32 log2_sub_buckets;	  /**< Linear buckets per power of two, log2 */
+  u32 stride;		  /**< Counters per histogram, set on validate */
+} vlib_histogram_main_t;
+
+/** Count a value in a per-thread histogram
+    @param hm - (vlib_histogram_main_t *) histogram main pointer
+    @param thread_index - (u32) the current cpu index
+    @param index - (u32) index of the histogram
+    @param value - (u64) value to count
+*/
+always_inline void
+vlib_histogram_add (vlib_histogram_main_t *hm, u32 thread_index, u32 index,
+		    u64 value)
+{
+  counter_t *h = hm->counters[thread_index] + index * hm->stride;
+  u32 b = vlib_histogram_bucket (value, hm->log2_sub_buckets, hm->n_buckets);
+
+  h[VLIB_HISTOGRAM_SUM] += value;
+  h[VLIB_HISTOGRAM_BUCKETS + b] += 1;
+}
+
+/** Get a histogram, merged across threads, never called in the speed path
+    @param hm - (vlib_histogram_main_t *) histogram main pointer
+    @param index - (u32) index of the histogram
+    @param sum [out] - (counter_t *) sum of the values counted
+    @param buckets [out] - (counter_t *) n_buckets counters, or 0
+    @returns - (u64) number of values counted
+*/
+counter_t vlib_get_histogram (vlib_histogram_main_t *hm, u32 index,
+			      counter_t *sum, counter_t *buckets);
+
+/** Format a histogram as count, mean and a few percentiles
+    Arguments: (vlib_histogram_main_t *) hm, (u32) index
+*/
+format_function_t format_vlib_histogram;
+
+/** validate a histogram
+    @param hm - (vlib_histogram_main_t *) pointer to the histogram
+    collection
+    @param index - (u32) index of the histogram to validate
+*/
+void vlib_validate_histogram (vlib_histogram_main_t *hm, u32 index);
+void vlib_zero_histogram (vlib_histogram_main_t *hm, u32 index);
+void vlib_clear_histograms (vlib_histogram_main_t *hm);
+void vlib_free_histogram (vlib_histogram_main_t *hm);
+
 /** Obtain the number of simple or combined counters allocated.
     A macro which reduces to to vec_len(cm->maxi), the answer in either
     case.
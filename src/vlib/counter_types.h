@@ -29,4 +29,75 @@ typedef struct
   counter_t bytes;			/**< byte counter  */
 } vlib_counter_t;
 
+/** Log-linear histograms
+
+    Values below 2^log2_sub_buckets each get a bucket of their own, every
+    power of two above that is split in 2^log2_sub_buckets linear buckets,
+    so the relative error is bounded by 2^-log2_sub_buckets across the
+    whole range. The last bucket also counts all the larger values.
+
+    Each histogram is laid out as a run of counters: a layout word, the
+    sum of the values counted and the buckets, padded to whole cache lines
+    so threads don't share them. The layout word describes the run, which
+    lets stat segment clients walk and merge histograms on their own.
+*/
+#define VLIB_HISTOGRAM_LAYOUT  0
+#define VLIB_HISTOGRAM_SUM     1
+#define VLIB_HISTOGRAM_BUCKETS 2
+
+#define vlib_histogram_layout(stride, n_buckets, log2_sub_buckets)           \
+  ((counter_t) (stride) << 32 | (counter_t) (n_buckets) << 8 |                \
+   (log2_sub_buckets))
+
+/** Counters per histogram, buckets included */
+static inline uint32_t
+vlib_histogram_layout_stride (counter_t layout)
+{
+  return layout >> 32;
+}
+
+static inline uint32_t
+vlib_histogram_layout_n_buckets (counter_t layout)
+{
+  return (layout >> 8) & 0xffffff;
+}
+
+static inline uint32_t
+vlib_histogram_layout_log2_sub_buckets (counter_t layout)
+{
+  return layout & 0xff;
+}
+
+/** Bucket counting @a value */
+static inline uint32_t
+vlib_histogram_bucket (uint64_t value, uint32_t log2_sub_buckets,
+		       uint32_t n_buckets)
+{
+  uint32_t msb, b;
+
+  if (value < (1ULL << log2_sub_buckets))
+    b = value;
+  else
+    {
+      msb = 63 - __builtin_clzll (value);
+      b = (msb - log2_sub_buckets + 1) << log2_sub_buckets;
+      b |= (value >> (msb - log2_sub_buckets)) &
+	   ((1 << log2_sub_buckets) - 1);
+    }
+
+  return b < n_buckets ? b : n_buckets - 1;
+}
+
+/** Smallest value counted in bucket @a b */
+static inline uint64_t
+vlib_histogram_bucket_min (uint32_t b, uint32_t log2_sub_buckets)
+{
+  uint32_t octave = b >> log2_sub_buckets;
+  uint64_t sub = b & ((1 << log2_sub_buckets) - 1);
+
+  if (octave == 0)
+    return b;
+  return ((1ULL << log2_sub_buckets) | sub) << (octave - 1);
+}
+
 #endif
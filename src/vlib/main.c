@@ -718,7 +718,7 @@ elog_stop (vlib_main_t * vm,
 {
   elog_main_t *em = &vlib_global_main.elog_main;
 
-  em->n_total_events_disable_limit = em->n_total_events;
+  elog_disable_after_events (em, 0);
 
   vlib_cli_output (vm, "Stopped the event logger...");
   return 0;
@@ -738,7 +738,7 @@ elog_restart (vlib_main_t * vm,
 {
   elog_main_t *em = &vlib_global_main.elog_main;
 
-  em->n_total_events_disable_limit = ~0;
+  elog_resume (em);
 
   vlib_cli_output (vm, "Restarted the event logger...");
   return 0;
@@ -765,7 +765,7 @@ elog_resize_command_fn (vlib_main_t * vm,
   if (unformat (input, "%d", &tmp))
     {
       elog_alloc (em, tmp);
-      em->n_total_events_disable_limit = ~0;
+      elog_resume (em);
     }
   else
     return clib_error_return (0, "Must specify how many events in the ring");
@@ -782,6 +782,121 @@ VLIB_CLI_COMMAND (elog_resize_cli, static) = {
 };
 /* *INDENT-ON* */
 
+static f64 elog_stream_interval = 1.0;
+
+static uword
+elog_stream_process (vlib_main_t * vm, vlib_node_runtime_t * rt,
+		     vlib_frame_t * f)
+{
+  elog_main_t *em = vlib_get_elog_main ();
+
+  while (1)
+    {
+      if (em->stream_file_name)
+	vlib_process_wait_for_event_or_clock (vm, elog_stream_interval);
+      else
+	vlib_process_wait_for_event (vm);
+
+      vlib_process_get_events (vm, 0);
+      elog_stream_flush (em);
+    }
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (elog_stream_process_node, static) = {
+  .function = elog_stream_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "elog-stream-process",
+  .process_log2_n_stack_bytes = 18,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+elog_stream_command_fn (vlib_main_t * vm,
+			unformat_input_t * input, vlib_cli_command_t * cmd)
+{
+  elog_main_t *em = vlib_get_elog_main ();
+  char *file = 0, *chroot_file;
+  f64 interval = elog_stream_interval;
+  clib_error_t *error = 0;
+  int off = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "off"))
+	off = 1;
+      else if (unformat (input, "interval %f", &interval))
+	;
+      else if (!file && unformat (input, "%s", &file))
+	;
+      else
+	{
+	  error = unformat_parse_error (input);
+	  goto done;
+	}
+    }
+
+  if (off)
+    {
+      if (!em->stream_file_name)
+	{
+	  error = clib_error_return (0, "event-logger is not streaming");
+	  goto done;
+	}
+      elog_stream_flush (em);
+      vlib_cli_output (vm, "Stopped streaming to %s, %lld events, "
+		       "%lld dropped", em->stream_file_name,
+		       em->n_stream_events, em->n_stream_events_dropped);
+      elog_stream_stop (em);
+      goto done;
+    }
+
+  if (!file)
+    {
+      error = clib_error_return (0, "expected file name");
+      goto done;
+    }
+
+  /* Same rules as event-logger save */
+  if (strstr (file, "..") || index (file, '/'))
+    {
+      error = clib_error_return (0, "illegal characters in filename '%s'",
+				 file);
+      goto done;
+    }
+
+  if (interval < 1e-3)
+    {
+      error = clib_error_return (0, "interval must be at least 1ms");
+      goto done;
+    }
+
+  chroot_file = (char *) format (0, "/tmp/%s%c", file, 0);
+  error = elog_stream_start (em, chroot_file);
+  vec_free (chroot_file);
+  if (error)
+    goto done;
+
+  elog_stream_interval = interval;
+  vlib_process_signal_event (vm, elog_stream_process_node.index, 0, 0);
+  vlib_cli_output (vm, "Streaming events to %s every %.3f sec",
+		   em->stream_file_name, interval);
+
+done:
+  vec_free (file);
+  return error;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (elog_stream_cli, static) = {
+  .path = "event-logger stream",
+  .short_help = "event-logger stream <filename> [interval <sec>] | off "
+    "(appends events to /tmp/<filename>)",
+  .function = elog_stream_command_fn,
+};
+/* *INDENT-ON* */
+
 #endif /* CLIB_UNIX */
 
 static void
@@ -797,9 +912,12 @@ elog_show_buffer_internal (vlib_main_t * vm, u32 n_events_to_show)
 
   es = elog_peek_events (em);
   vlib_cli_output (vm, "%d of %d events in buffer, logger %s", vec_len (es),
-		   em->event_ring_size,
-		   em->n_total_events < em->n_total_events_disable_limit ?
-		   "running" : "stopped");
+		   elog_buffer_capacity (em),
+		   elog_is_enabled (em) ? "running" : "stopped");
+  if (em->stream_file_name)
+    vlib_cli_output (vm, "streaming to %s, %lld events, %lld dropped",
+		     em->stream_file_name, em->n_stream_events,
+		     em->n_stream_events_dropped);
   vec_foreach (e, es)
   {
     vlib_cli_output (vm, "%18.9f: %U",
@@ -885,6 +1003,42 @@ vlib_elog_main_loop_event (vlib_main_t * vm,
     }
 }
 
+/* Always-on dispatch profiler: worst dispatch on every call, sampled
+   clocks per vector histogram. Cache line aligned per node and thread,
+   max_clocks comes first so unsampled calls touch a single line. */
+static_always_inline void
+vlib_node_profile_dispatch (vlib_main_t * vm, vlib_node_runtime_t * node,
+			    uword n_vectors, u64 n_clocks)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  vlib_node_profile_t *p;
+  u32 clocks, cpv;
+
+  if (PREDICT_FALSE (nm->profile_sample_interval == 0 ||
+		     node->node_index >= vec_len (nm->node_profiles)))
+    return;
+
+  p = vec_elt_at_index (nm->node_profiles, node->node_index);
+  clocks = clib_min (n_clocks, (u64) ~0U);
+
+  if (PREDICT_FALSE (clocks > p->max_clocks))
+    p->max_clocks = clocks;
+
+  if (n_vectors == 0 || --nm->profile_sample_countdown)
+    return;
+
+  /* The countdown is per thread; jitter it so sampling does not lock
+     onto a node in a repeating dispatch pattern. Mean stays at the
+     configured interval. */
+  nm->profile_sample_countdown =
+    1 + clocks % (2 * nm->profile_sample_interval - 1);
+
+  cpv = clocks / n_vectors;
+  p->clocks_per_vector[vlib_histogram_bucket (
+    cpv, VLIB_NODE_PROFILE_LOG2_SUB_BUCKETS, VLIB_NODE_PROFILE_N_BUCKETS)]++;
+  p->clocks_per_vector_sum += cpv;
+}
+
 static inline void
 add_trajectory_trace (vlib_buffer_t * b, u32 node_index)
 {
@@ -992,6 +1146,8 @@ dispatch_node (vlib_main_t * vm,
 				      /* n_vectors */ n,
 				      /* n_clocks */ t - last_time_stamp);
 
+  vlib_node_profile_dispatch (vm, node, n, t - last_time_stamp);
+
   /* When in adaptive mode and vector rate crosses threshold switch to
      polling mode and vice versa. */
   if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_ADAPTIVE_MODE))
@@ -1516,6 +1672,8 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
 					 cpu_time_now);
     }
 
+  clib_qsbr_thread_online (&clib_qsbr_main, vm->thread_index);
+
   while (1)
     {
       vlib_node_runtime_t *n;
@@ -1529,6 +1687,11 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
       if (!is_main)
 	vlib_worker_thread_barrier_check ();
 
+      /* No references to shared data are held between loop iterations */
+      clib_qsbr_quiescent (&clib_qsbr_main, vm->thread_index);
+      if (is_main && PREDICT_FALSE (clib_qsbr_n_pending (&clib_qsbr_main)))
+	clib_qsbr_poll (&clib_qsbr_main);
+
       if (PREDICT_FALSE (vm->check_frame_queues + frame_queue_check_counter))
 	{
 	  u32 processed = 0;
@@ -1778,12 +1941,19 @@ vlib_main_configure (vlib_main_t * vm, unformat_input_t * input)
 {
   vlib_global_main_t *vgm = vlib_get_global_main ();
   int turn_on_mem_trace = 0;
+  u32 profile_sample_interval = VLIB_NODE_PROFILE_DEFAULT_SAMPLE_INTERVAL;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
       if (unformat (input, "memory-trace"))
 	turn_on_mem_trace = 1;
 
+      else if (unformat (input, "node-profile-sample-interval %u",
+			 &profile_sample_interval))
+	;
+      else if (unformat (input, "node-profile-disable"))
+	profile_sample_interval = 0;
+
       else if (unformat (input, "elog-events %d",
 			 &vgm->configured_elog_ring_size))
 	vgm->configured_elog_ring_size =
@@ -1811,6 +1981,10 @@ vlib_main_configure (vlib_main_t * vm, unformat_input_t * input)
 
   unformat_free (input);
 
+  /* Worker threads inherit this when they clone the node main. */
+  vm->node_main.profile_sample_interval = profile_sample_interval;
+  vm->node_main.profile_sample_countdown = profile_sample_interval;
+
   /* Enable memory trace as early as possible. */
   if (turn_on_mem_trace)
     clib_mem_trace (1);
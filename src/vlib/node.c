@@ -362,6 +362,7 @@ register_node (vlib_main_t * vm, vlib_node_registration_t * r)
   n->protocol_hint = r->protocol_hint;
 
   vec_add1 (nm->nodes, n);
+  vec_validate_aligned (nm->node_profiles, n->index, CLIB_CACHE_LINE_BYTES);
 
   /* Name is always a vector so it can be formatted with %v. */
   if (clib_mem_is_heap_object (vec_header (r->name, 0)))
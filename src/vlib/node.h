@@ -670,6 +670,26 @@ typedef struct
   char *desc;
 } vlib_node_fn_variant_t;
 
+/* Dispatch profiler histogram of clocks per vector, in power of two
+   buckets as counted by vlib_histogram_bucket (); the last bucket, from
+   2^(VLIB_NODE_PROFILE_N_BUCKETS - 2) clocks, is open ended. */
+#define VLIB_NODE_PROFILE_N_BUCKETS 19
+#define VLIB_NODE_PROFILE_LOG2_SUB_BUCKETS 0
+#define VLIB_NODE_PROFILE_DEFAULT_SAMPLE_INTERVAL 16
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /* Longest dispatch, in clocks, since the stats collector last
+     looked. */
+  u32 max_clocks;
+
+  /* Sampled non-empty dispatches by clocks per vector. */
+  u32 clocks_per_vector[VLIB_NODE_PROFILE_N_BUCKETS];
+  u64 clocks_per_vector_sum;
+} vlib_node_profile_t;
+
 typedef struct
 {
   /* Public nodes. */
@@ -745,6 +765,13 @@ typedef struct
 
   /* Node Function march Variant by Suffix Hash */
   uword *node_fn_march_variant_by_suffix;
+
+  /* Dispatch profiler, indexed by node index. Histograms sample one
+     non-empty dispatch in profile_sample_interval; zero disables the
+     profiler. */
+  vlib_node_profile_t *node_profiles;
+  u32 profile_sample_interval;
+  u32 profile_sample_countdown;
 } vlib_node_main_t;
 
 typedef u16 vlib_error_t;
@@ -319,6 +319,7 @@ vlib_thread_init (vlib_main_t * vm)
   clib_bitmap_free (avail_cpu);
 
   tm->n_vlib_mains = n_vlib_mains;
+  clib_qsbr_init (&clib_qsbr_main, n_vlib_mains);
 
   /*
    * Allocate the remaining worker threads, and thread stack vector slots
@@ -528,6 +529,7 @@ start_workers (vlib_main_t * vm)
   vgm->elog_main.lock =
     clib_mem_alloc_aligned (CLIB_CACHE_LINE_BYTES, CLIB_CACHE_LINE_BYTES);
   vgm->elog_main.lock[0] = 0;
+  elog_alloc_threads (&vgm->elog_main, n_vlib_mains);
 
   clib_callback_data_init (&vm->vlib_node_runtime_perf_callbacks,
 			   &vm->worker_thread_main_loop_callback_lock);
@@ -668,6 +670,12 @@ start_workers (vlib_main_t * vm)
 		  vec_add1 (nm_clone->nodes, n);
 		  n++;
 		}
+
+	      /* per-thread dispatch profiler */
+	      nm_clone->node_profiles = 0;
+	      vec_validate_aligned (nm_clone->node_profiles,
+				    vec_len (nm_clone->nodes) - 1,
+				    CLIB_CACHE_LINE_BYTES);
 	      nm_clone->nodes_by_type[VLIB_NODE_TYPE_INTERNAL] =
 		vec_dup_aligned (nm->nodes_by_type[VLIB_NODE_TYPE_INTERNAL],
 				 CLIB_CACHE_LINE_BYTES);
@@ -966,6 +974,8 @@ vlib_worker_thread_node_refork (void)
 
   vec_free (old_nodes_clone);
 
+  vec_validate_aligned (nm_clone->node_profiles, vec_len (nm_clone->nodes) - 1,
+			CLIB_CACHE_LINE_BYTES);
 
   /* re-clone internal nodes */
   old_rt = nm_clone->nodes_by_type[VLIB_NODE_TYPE_INTERNAL];
@@ -17,6 +17,7 @@
 
 #include <vlib/main.h>
 #include <vppinfra/callback.h>
+#include <vppinfra/qsbr.h>
 #include <linux/sched.h>
 
 void vlib_set_thread_name (char *name);
@@ -71,6 +72,8 @@ typedef struct
   u32 maybe_trace : 1;
   u32 n_vectors;
   u32 offset;
+  /* CPU clock at enqueue, only set while frame_queue_wait_fn is set */
+  u64 enqueue_clocks;
   STRUCT_MARK (end_of_reset);
 
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
@@ -277,6 +280,12 @@ typedef struct
   /* Worker handoff queues */
   vlib_frame_queue_main_t *frame_queue_mains;
 
+  /* When set, handoff elements are timestamped at enqueue and this is
+     called with the buffers of each dequeued element and the clocks
+     they spent on the frame queue */
+  void (*frame_queue_wait_fn) (vlib_main_t *vm, u32 *buffers, u32 n_buffers,
+			       u64 wait_clocks);
+
   /* worker thread initialization barrier */
   volatile u32 worker_thread_release;
 
@@ -376,9 +385,12 @@ vlib_worker_thread_barrier_check (void)
 	  vm = vlib_get_main ();
 	  vm->parked_at_barrier = 1;
 	}
+      /* parked workers must not hold up grace periods */
+      clib_qsbr_thread_offline (&clib_qsbr_main, thread_index);
       clib_atomic_fetch_add (vlib_worker_threads->workers_at_barrier, 1);
       while (*vlib_worker_threads->wait_at_barrier)
 	;
+      clib_qsbr_thread_online (&clib_qsbr_main, thread_index);
 
       /*
        * Recompute the offset from thread-0 time.
@@ -92,6 +92,20 @@ VLIB_CLI_COMMAND (show_threads_command, static) = {
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+show_qsbr_fn (vlib_main_t *vm, unformat_input_t *input,
+	      vlib_cli_command_t *cmd)
+{
+  vlib_cli_output (vm, "%U", format_clib_qsbr, &clib_qsbr_main);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_qsbr_command, static) = {
+  .path = "show qsbr",
+  .short_help = "Show quiescent-state-based reclamation state",
+  .function = show_qsbr_fn,
+};
+
 /*
  * Trigger threads to grab frame queue trace data
  */
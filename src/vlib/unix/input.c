@@ -212,6 +212,11 @@ linux_epoll_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	node->input_main_loops_per_call = 1024;
       }
 
+    /* A sleeping thread holds no references to shared data, don't let
+       it hold up QSBR grace periods */
+    if (timeout_ms)
+      clib_qsbr_thread_offline (&clib_qsbr_main, vm->thread_index);
+
     /* Allow any signal to wakeup our sleep. */
     if (is_main || em->epoll_fd != -1)
       {
@@ -229,6 +234,8 @@ linux_epoll_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 				      vec_len (em->epoll_events), timeout_ms);
 	  }
 
+	if (timeout_ms)
+	  clib_qsbr_thread_online (&clib_qsbr_main, vm->thread_index);
       }
     else
       {
@@ -251,8 +258,9 @@ linux_epoll_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 		  ts = tsrem;
 		if (*vlib_worker_threads->wait_at_barrier ||
 		    *nm->pending_interrupts)
-		  goto done;
+		  break;
 	      }
+	    clib_qsbr_thread_online (&clib_qsbr_main, vm->thread_index);
 	  }
 	goto done;
       }
@@ -65,15 +65,15 @@
   _ (16, IS_DVR, "dvr", 1)                                                    \
   _ (17, QOS_DATA_VALID, "qos-data-valid", 0)                                 \
   _ (18, GSO, "gso", 0)                                                       \
-  _ (19, AVAIL1, "avail1", 1)                                                 \
-  _ (20, AVAIL2, "avail2", 1)                                                 \
-  _ (21, AVAIL3, "avail3", 1)                                                 \
-  _ (22, AVAIL4, "avail4", 1)                                                 \
-  _ (23, AVAIL5, "avail5", 1)                                                 \
-  _ (24, AVAIL6, "avail6", 1)                                                 \
-  _ (25, AVAIL7, "avail7", 1)                                                 \
-  _ (26, AVAIL8, "avail8", 1)                                                 \
-  _ (27, AVAIL9, "avail9", 1)
+  _ (19, LATENCY_SAMPLED, "latency-sampled", 1)                               \
+  _ (20, AVAIL1, "avail1", 1)                                                 \
+  _ (21, AVAIL2, "avail2", 1)                                                 \
+  _ (22, AVAIL3, "avail3", 1)                                                 \
+  _ (23, AVAIL4, "avail4", 1)                                                 \
+  _ (24, AVAIL5, "avail5", 1)                                                 \
+  _ (25, AVAIL6, "avail6", 1)                                                 \
+  _ (26, AVAIL7, "avail7", 1)                                                 \
+  _ (27, AVAIL8, "avail8", 1)
 
 /*
  * Please allocate the FIRST available bit, redefine
@@ -84,7 +84,7 @@
 #define VNET_BUFFER_FLAGS_ALL_AVAIL                                           \
   (VNET_BUFFER_F_AVAIL1 | VNET_BUFFER_F_AVAIL2 | VNET_BUFFER_F_AVAIL3 |       \
    VNET_BUFFER_F_AVAIL4 | VNET_BUFFER_F_AVAIL5 | VNET_BUFFER_F_AVAIL6 |       \
-   VNET_BUFFER_F_AVAIL7 | VNET_BUFFER_F_AVAIL8 | VNET_BUFFER_F_AVAIL9)
+   VNET_BUFFER_F_AVAIL7 | VNET_BUFFER_F_AVAIL8)
 
 #define VNET_BUFFER_FLAGS_VLAN_BITS \
   (VNET_BUFFER_F_VLAN_1_DEEP | VNET_BUFFER_F_VLAN_2_DEEP)
@@ -502,6 +502,16 @@ typedef struct
       u64 pad[1];
       u64 pg_replay_timestamp;
     };
+
+    /* Set on packets with VNET_BUFFER_F_LATENCY_SAMPLED, see
+       interface/latency.c */
+    struct
+    {
+      u64 pad[2];
+      u64 rx_clocks;
+      u32 handoff_clocks;
+      u32 rx_sw_if_index;
+    } latency;
     u32 unused[8];
   };
 } vnet_buffer_opaque2_t;
@@ -340,6 +340,16 @@ show_crypto_async_status_command_fn (vlib_main_t * vm,
       if (state == VLIB_NODE_STATE_DISABLED)
 	vlib_cli_output (vm, "threadId: %-6d DISABLED", i);
     }
+
+  /* Clocks from submit to dequeue, of the ops which saw any frame */
+  for (i = 1; i < VNET_CRYPTO_ASYNC_OP_N_IDS; i++)
+    {
+      counter_t sum;
+
+      if (vlib_get_histogram (&cm->async_frame_clocks, i, &sum, 0))
+	vlib_cli_output (vm, "%-36U clocks %U", format_vnet_crypto_async_op,
+			 i, format_vlib_histogram, &cm->async_frame_clocks, i);
+    }
   return 0;
 }
 
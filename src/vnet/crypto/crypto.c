@@ -108,6 +108,95 @@ vnet_crypto_process_chained_ops (vlib_main_t * vm, vnet_crypto_op_t ops[],
   return vnet_crypto_process_ops_inline (vm, ops, chunks, n_ops);
 }
 
+static_always_inline u32
+crypto_linked_ops_key (vnet_crypto_op_id_t crypto_op,
+		       vnet_crypto_op_id_t integ_op)
+{
+  return crypto_op << 16 | integ_op;
+}
+
+/* linked handler of the engine active for both ops, if it has one */
+static_always_inline vnet_crypto_linked_ops_handler_t *
+crypto_get_linked_ops_handler (vnet_crypto_main_t *cm,
+			       vnet_crypto_op_id_t crypto_op,
+			       vnet_crypto_op_id_t integ_op)
+{
+  u32 ei = cm->opt_data[crypto_op].active_engine_index_simple;
+  vnet_crypto_engine_t *e;
+  uword *p;
+
+  if (ei == ~0 || ei != cm->opt_data[integ_op].active_engine_index_simple)
+    return 0;
+
+  e = vec_elt_at_index (cm->engines, ei);
+  p = hash_get (e->linked_ops_handler_by_ops,
+		crypto_linked_ops_key (crypto_op, integ_op));
+  return p ? (vnet_crypto_linked_ops_handler_t *) p[0] : 0;
+}
+
+static_always_inline u32
+vnet_crypto_process_linked_ops_call_handler (vlib_main_t *vm,
+					     vnet_crypto_main_t *cm,
+					     vnet_crypto_op_t *crypto_ops[],
+					     vnet_crypto_op_t *integ_ops[],
+					     u32 n_ops)
+{
+  vnet_crypto_linked_ops_handler_t *fn;
+  vnet_crypto_op_id_t cop, iop;
+  u32 rv = 0, i;
+
+  if (n_ops == 0)
+    return 0;
+
+  cop = crypto_ops[0]->op;
+  iop = integ_ops[0]->op;
+
+  if ((fn = crypto_get_linked_ops_handler (cm, cop, iop)))
+    return fn (vm, crypto_ops, integ_ops, n_ops);
+
+  /* no engine can do both in one go, run them one after the other */
+  vnet_crypto_process_ops_call_handler (vm, cm, cop, crypto_ops, 0, n_ops);
+  vnet_crypto_process_ops_call_handler (vm, cm, iop, integ_ops, 0, n_ops);
+
+  for (i = 0; i < n_ops; i++)
+    rv += crypto_ops[i]->status == VNET_CRYPTO_OP_STATUS_COMPLETED &&
+	  integ_ops[i]->status == VNET_CRYPTO_OP_STATUS_COMPLETED;
+
+  return rv;
+}
+
+u32
+vnet_crypto_process_linked_ops (vlib_main_t *vm, vnet_crypto_op_t crypto_ops[],
+				vnet_crypto_op_t integ_ops[], u32 n_ops)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+  const int op_q_size = VLIB_FRAME_SIZE;
+  vnet_crypto_op_t *crypto_queue[op_q_size], *integ_queue[op_q_size];
+  vnet_crypto_op_id_t current_cop = ~0, current_iop = ~0;
+  u32 n_op_queue = 0;
+  u32 rv = 0, i;
+
+  for (i = 0; i < n_ops; i++)
+    {
+      if (current_cop != crypto_ops[i].op || current_iop != integ_ops[i].op ||
+	  n_op_queue >= op_q_size)
+	{
+	  rv += vnet_crypto_process_linked_ops_call_handler (
+	    vm, cm, crypto_queue, integ_queue, n_op_queue);
+	  n_op_queue = 0;
+	  current_cop = crypto_ops[i].op;
+	  current_iop = integ_ops[i].op;
+	}
+
+      crypto_queue[n_op_queue] = &crypto_ops[i];
+      integ_queue[n_op_queue++] = &integ_ops[i];
+    }
+
+  rv += vnet_crypto_process_linked_ops_call_handler (vm, cm, crypto_queue,
+						     integ_queue, n_op_queue);
+  return rv;
+}
+
 u32
 vnet_crypto_register_engine (vlib_main_t * vm, char *name, int prio,
 			     char *desc)
@@ -274,6 +363,19 @@ vnet_crypto_register_ops_handlers (vlib_main_t * vm, u32 engine_index,
   vnet_crypto_register_ops_handler_inline (vm, engine_index, opt, fn, cfn);
 }
 
+void
+vnet_crypto_register_linked_ops_handler (vlib_main_t *vm, u32 engine_index,
+					 vnet_crypto_op_id_t crypto_op,
+					 vnet_crypto_op_id_t integ_op,
+					 vnet_crypto_linked_ops_handler_t *fn)
+{
+  vnet_crypto_main_t *cm = &crypto_main;
+  vnet_crypto_engine_t *e = vec_elt_at_index (cm->engines, engine_index);
+
+  hash_set (e->linked_ops_handler_by_ops,
+	    crypto_linked_ops_key (crypto_op, integ_op), pointer_to_uword (fn));
+}
+
 void
 vnet_crypto_register_enqueue_handler (vlib_main_t *vm, u32 engine_index,
 				      vnet_crypto_async_op_id_t opt,
@@ -422,21 +524,12 @@ vnet_crypto_key_add (vlib_main_t * vm, vnet_crypto_alg_t alg, u8 * data,
   vnet_crypto_engine_t *engine;
   vnet_crypto_key_t *key;
 
-  u8 need_barrier_sync = 0;
-
   if (!vnet_crypto_key_len_check (alg, length))
     return ~0;
 
-  pool_get_aligned_will_expand (cm->keys, need_barrier_sync,
-				CLIB_CACHE_LINE_BYTES);
-  /* If the cm->keys will expand, stop the parade. */
-  if (need_barrier_sync)
-    vlib_worker_thread_barrier_sync (vm);
-
-  pool_get_zero (cm->keys, key);
-
-  if (need_barrier_sync)
-    vlib_worker_thread_barrier_release (vm);
+  /* Workers keep using the old cm->keys until their next quiescent state,
+     no need to stop the parade when it grows */
+  pool_get_zero_qsbr (&clib_qsbr_main, cm->keys, key);
 
   index = key - cm->keys;
   key->type = VNET_CRYPTO_KEY_TYPE_DATA;
@@ -508,7 +601,7 @@ vnet_crypto_key_add_linked (vlib_main_t * vm,
   if (linked_alg == ~0)
     return ~0;
 
-  pool_get_zero (cm->keys, key);
+  pool_get_zero_qsbr (&clib_qsbr_main, cm->keys, key);
   index = key - cm->keys;
   key->type = VNET_CRYPTO_KEY_TYPE_LINK;
   key->index_crypto = index_crypto;
@@ -861,6 +954,14 @@ vnet_crypto_init (vlib_main_t * vm)
     cm->crypto_node_index =
     vlib_get_node_by_name (vm, (u8 *) "crypto-dispatch")->index;
 
+  cm->async_frame_clocks.name = "crypto async frame clocks";
+  cm->async_frame_clocks.stat_segment_name = "/net/crypto/async/frame_clocks";
+  cm->async_frame_clocks.n_buckets = VNET_CRYPTO_ASYNC_HIST_N_BUCKETS;
+  cm->async_frame_clocks.log2_sub_buckets =
+    VNET_CRYPTO_ASYNC_HIST_LOG2_SUB_BUCKETS;
+  vlib_validate_histogram (&cm->async_frame_clocks,
+			   VNET_CRYPTO_ASYNC_OP_N_IDS - 1);
+
   return 0;
 }
 
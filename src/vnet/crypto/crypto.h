@@ -366,6 +366,7 @@ typedef struct
   u32 buffer_indices[VNET_CRYPTO_FRAME_SIZE];
   u16 next_node_index[VNET_CRYPTO_FRAME_SIZE];
   u32 enqueue_thread_index;
+  u64 enqueue_time; /**< cpu clocks at submit */
 } vnet_crypto_async_frame_t;
 
 typedef struct
@@ -386,6 +387,13 @@ typedef u32 (vnet_crypto_chained_ops_handler_t) (vlib_main_t * vm,
 typedef u32 (vnet_crypto_ops_handler_t) (vlib_main_t * vm,
 					 vnet_crypto_op_t * ops[], u32 n_ops);
 
+/* crypto_ops[i] and integ_ops[i] belong to the same packet, the cipher op
+ * runs first (encrypt-then-MAC) */
+typedef u32 (vnet_crypto_linked_ops_handler_t) (vlib_main_t *vm,
+						vnet_crypto_op_t *crypto_ops[],
+						vnet_crypto_op_t *integ_ops[],
+						u32 n_ops);
+
 typedef void (vnet_crypto_key_handler_t) (vlib_main_t * vm,
 					  vnet_crypto_key_op_t kop,
 					  vnet_crypto_key_index_t idx);
@@ -418,6 +426,10 @@ void vnet_crypto_register_ops_handlers (vlib_main_t * vm, u32 engine_index,
 					vnet_crypto_chained_ops_handler_t *
 					cfn);
 
+void vnet_crypto_register_linked_ops_handler (
+  vlib_main_t *vm, u32 engine_index, vnet_crypto_op_id_t crypto_op,
+  vnet_crypto_op_id_t integ_op, vnet_crypto_linked_ops_handler_t *fn);
+
 void vnet_crypto_register_key_handler (vlib_main_t * vm, u32 engine_index,
 				       vnet_crypto_key_handler_t * keyh);
 
@@ -444,6 +456,7 @@ typedef struct
     * chained_ops_handlers[VNET_CRYPTO_N_OP_IDS];
   vnet_crypto_frame_enqueue_t *enqueue_handlers[VNET_CRYPTO_ASYNC_OP_N_IDS];
   vnet_crypto_frame_dequeue_t *dequeue_handler;
+  uword *linked_ops_handler_by_ops; /**< (crypto op, integ op) -> handler */
 } vnet_crypto_engine_t;
 
 typedef struct
@@ -474,8 +487,14 @@ typedef struct
 #define VNET_CRYPTO_ASYNC_DISPATCH_POLLING 0
 #define VNET_CRYPTO_ASYNC_DISPATCH_INTERRUPT 1
   u8 dispatch_mode;
+
+  /* cpu clocks from submit to dequeue of async frames, per async op */
+  vlib_histogram_main_t async_frame_clocks;
 } vnet_crypto_main_t;
 
+#define VNET_CRYPTO_ASYNC_HIST_LOG2_SUB_BUCKETS 2
+#define VNET_CRYPTO_ASYNC_HIST_N_BUCKETS	128
+
 extern vnet_crypto_main_t crypto_main;
 
 u32 vnet_crypto_process_chained_ops (vlib_main_t * vm, vnet_crypto_op_t ops[],
@@ -483,6 +502,9 @@ u32 vnet_crypto_process_chained_ops (vlib_main_t * vm, vnet_crypto_op_t ops[],
 				     u32 n_ops);
 u32 vnet_crypto_process_ops (vlib_main_t * vm, vnet_crypto_op_t ops[],
 			     u32 n_ops);
+u32 vnet_crypto_process_linked_ops (vlib_main_t *vm,
+				    vnet_crypto_op_t crypto_ops[],
+				    vnet_crypto_op_t integ_ops[], u32 n_ops);
 
 
 int vnet_crypto_set_handler2 (char *ops_handler_name, char *engine,
@@ -598,6 +620,7 @@ vnet_crypto_async_submit_open_frame (vlib_main_t * vm,
 
   frame->state = VNET_CRYPTO_FRAME_STATE_PENDING;
   frame->enqueue_thread_index = vm->thread_index;
+  frame->enqueue_time = clib_cpu_time_now ();
 
   int ret = (cm->enqueue_handlers[frame->op]) (vm, frame);
 
@@ -87,6 +87,13 @@ crypto_dequeue_frame (vlib_main_t * vm, vlib_node_runtime_t * node,
     {
       if (cf)
 	{
+	  u64 now = clib_cpu_time_now ();
+
+	  /* Skip clocks of cores out of sync */
+	  if (PREDICT_TRUE (now >= cf->enqueue_time))
+	    vlib_histogram_add (&cm->async_frame_clocks, vm->thread_index,
+				cf->op, now - cf->enqueue_time);
+
 	  vec_validate (ct->buffer_indices, n_cache + cf->n_elts);
 	  vec_validate (ct->nexts, n_cache + cf->n_elts);
 	  clib_memcpy_fast (ct->buffer_indices + n_cache, cf->buffer_indices,
@@ -113,6 +113,8 @@ unmap_all_mem_regions (vhost_user_intf_t * vui)
     vq->avail = 0;
     vq->used = 0;
     vq->desc = 0;
+    /* the region it points to is gone, or will be replaced */
+    vq->map_hint = 0;
   }
 }
 
@@ -206,6 +206,7 @@ typedef struct
   u8 started;
   u8 enabled;
   u8 log_used;
+  u32 map_hint;			/* last guest memory region hit */
   clib_spinlock_t vring_lock;
 
   //Put non-runtime in a different cache line
@@ -407,6 +407,63 @@ vhost_user_packed_desc_available (vhost_user_vring_t * vring, u16 idx)
 	   vring->avail_wrap_counter));
 }
 
+#define VHOST_USER_PACKED_BATCH 4
+
+/*
+ * Check VHOST_USER_PACKED_BATCH consecutive packed descriptors in one go.
+ * Each descriptor must have (flags & flags_mask) == flags_val and a length
+ * within [min_len[i], max_len]. Addresses and lengths are returned from
+ * the same read, so they cannot change under us after the check.
+ */
+static_always_inline int
+vhost_user_packed_desc_batch_check (vring_packed_desc_t *d, u16 flags_mask,
+				    u16 flags_val, u32 *min_len, u32 max_len,
+				    u64 *addr, u32 *len)
+{
+#ifdef CLIB_HAVE_VEC256
+  /* two descriptors per vector, { addr, len | id << 32 | flags << 48 } */
+  u64x4 fm = { 0, (u64) flags_mask << 48, 0, (u64) flags_mask << 48 };
+  u64x4 fv = { 0, (u64) flags_val << 48, 0, (u64) flags_val << 48 };
+  u64x4 lm = { 0, 0xffffffff, 0, 0xffffffff };
+  u64x4 max = { 0, max_len, 0, max_len };
+  u64x4 min0 = { 0, min_len[0], 0, min_len[1] };
+  u64x4 min1 = { 0, min_len[2], 0, min_len[3] };
+  u64x4 d0 = u64x4_load_unaligned (d);
+  u64x4 d1 = u64x4_load_unaligned (d + 2);
+  u64x4 l0 = d0 & lm, l1 = d1 & lm;
+  u64x4 bad;
+
+  bad = ((d0 & fm) ^ fv) | ((d1 & fm) ^ fv);
+  bad |= (u64x4) (l0 < min0) | (u64x4) (l1 < min1);
+  bad |= (u64x4) (l0 > max) | (u64x4) (l1 > max);
+  if (!u64x4_is_all_zero (bad))
+    return 0;
+
+  addr[0] = d0[0];
+  addr[1] = d0[2];
+  addr[2] = d1[0];
+  addr[3] = d1[2];
+  len[0] = l0[1];
+  len[1] = l0[3];
+  len[2] = l1[1];
+  len[3] = l1[3];
+#else
+  vring_packed_desc_t t;
+  int i;
+
+  for (i = 0; i < VHOST_USER_PACKED_BATCH; i++)
+    {
+      t = d[i];
+      if ((t.flags & flags_mask) != flags_val || t.len < min_len[i] ||
+	  t.len > max_len)
+	return 0;
+      addr[i] = t.addr;
+      len[i] = t.len;
+    }
+#endif
+  return 1;
+}
+
 static_always_inline void
 vhost_user_advance_last_avail_idx (vhost_user_vring_t * vring)
 {
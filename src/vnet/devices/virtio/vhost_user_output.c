@@ -384,7 +384,7 @@ vhost_user_device_class_packed (vlib_main_t *vm, vlib_node_runtime_t *node,
   u8 error;
   u32 thread_index = vm->thread_index;
   vhost_cpu_t *cpu = &vum->cpus[thread_index];
-  u32 map_hint = 0;
+  u32 map_hint = rxvq->map_hint;
   u8 retry = 8;
   u16 copy_len;
   u16 tx_headers_len;
@@ -393,6 +393,11 @@ vhost_user_device_class_packed (vlib_main_t *vm, vlib_node_runtime_t *node,
   u16 desc_head, desc_index, desc_len;
   u16 n_descs_processed;
   u8 indirect, chained;
+  u16 hdr_sz = vui->virtio_net_hdr_sz;
+  vlib_buffer_t *bufs[VHOST_USER_PACKED_BATCH];
+  u64 batch_addr[VHOST_USER_PACKED_BATCH];
+  u32 batch_len[VHOST_USER_PACKED_BATCH];
+  u32 batch_min_len[VHOST_USER_PACKED_BATCH];
 
 retry:
   error = VHOST_USER_TX_FUNC_ERROR_NONE;
@@ -411,6 +416,82 @@ retry:
 
       indirect = 0;
       chained = 0;
+
+      /*
+       * Fast path, a batch of single buffer packets without offloads
+       * going into plain guest descriptors big enough to hold them.
+       * Descriptors are checked with one read of the descriptor cache
+       * line, and each packet becomes a header and a data copy.
+       */
+      desc_head = rxvq->last_avail_idx & rxvq->qsz_mask;
+      if (n_left >= VHOST_USER_PACKED_BATCH &&
+	  desc_head + VHOST_USER_PACKED_BATCH <= rxvq->qsz_mask + 1)
+	{
+	  vlib_get_buffers (vm, buffers, bufs, VHOST_USER_PACKED_BATCH);
+	  or_flags = bufs[0]->flags | bufs[1]->flags | bufs[2]->flags |
+		     bufs[3]->flags;
+	  for (int i = 0; i < VHOST_USER_PACKED_BATCH; i++)
+	    batch_min_len[i] = hdr_sz + bufs[i]->current_length;
+
+	  if ((or_flags & (VLIB_BUFFER_NEXT_PRESENT | VLIB_BUFFER_IS_TRACED |
+			   VNET_BUFFER_F_OFFLOAD)) == 0 &&
+	      vhost_user_packed_desc_batch_check (
+		rxvq->packed_desc + desc_head,
+		VRING_DESC_F_AVAIL | VRING_DESC_F_NEXT | VRING_DESC_F_INDIRECT,
+		rxvq->avail_wrap_counter, batch_min_len, ~0, batch_addr,
+		batch_len))
+	    {
+	      if (PREDICT_TRUE (n_left >= 2 * VHOST_USER_PACKED_BATCH))
+		{
+		  vlib_prefetch_buffer_with_index (vm, buffers[4], LOAD);
+		  vlib_prefetch_buffer_with_index (vm, buffers[5], LOAD);
+		  vlib_prefetch_buffer_with_index (vm, buffers[6], LOAD);
+		  vlib_prefetch_buffer_with_index (vm, buffers[7], LOAD);
+		}
+
+	      for (int i = 0; i < VHOST_USER_PACKED_BATCH; i++)
+		{
+		  virtio_net_hdr_mrg_rxbuf_t *hdr =
+		    &cpu->tx_headers[tx_headers_len++];
+		  vhost_copy_t *cpy = &cpu->copy[copy_len];
+
+		  hdr->hdr.flags = 0;
+		  hdr->hdr.gso_type = VIRTIO_NET_HDR_GSO_NONE;
+		  hdr->num_buffers = 1;
+
+		  cpy[0].len = hdr_sz;
+		  cpy[0].dst = batch_addr[i];
+		  cpy[0].src = (uword) hdr;
+		  cpy[1].len = bufs[i]->current_length;
+		  cpy[1].dst = batch_addr[i] + hdr_sz;
+		  cpy[1].src = (uword) vlib_buffer_get_current (bufs[i]);
+		  copy_len += 2;
+
+		  rxvq->packed_desc[desc_head + i].len = batch_min_len[i];
+		  vhost_user_advance_last_avail_idx (rxvq);
+		}
+
+	      n_descs_processed += VHOST_USER_PACKED_BATCH;
+	      n_left -= VHOST_USER_PACKED_BATCH;
+	      buffers += VHOST_USER_PACKED_BATCH;
+
+	      if (PREDICT_FALSE (copy_len >= VHOST_USER_TX_COPY_THRESHOLD))
+		{
+		  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy,
+							 copy_len, &map_hint)))
+		    vlib_error_count (vm, node->node_index,
+				      VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
+		  copy_len = 0;
+
+		  /* give buffers back to driver */
+		  vhost_user_mark_desc_available (vm, vui, rxvq,
+						  &n_descs_processed, chained,
+						  frame, n_left);
+		}
+	      continue;
+	    }
+	}
+
       if (PREDICT_TRUE (n_left > 1))
 	vlib_prefetch_buffer_with_index (vm, buffers[1], LOAD);
 
@@ -671,6 +752,7 @@ done:
       goto retry;
     }
 
+  rxvq->map_hint = map_hint;
   clib_spinlock_unlock (&rxvq->vring_lock);
 
   if (PREDICT_FALSE (n_left && error != VHOST_USER_TX_FUNC_ERROR_NONE))
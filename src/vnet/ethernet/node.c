@@ -1175,9 +1175,15 @@ ethernet_input_trace (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  n_left--;
 	  b0 = vlib_get_buffer (vm, bi0);
 	  if (vnet_is_packet_pcaped (pp, b0, ~0))
-	    pcap_add_buffer (&pp->pcap_main, vm, bi0, pp->max_bytes_per_pkt);
+	    vnet_pcap_add_buffer (pp, vm, bi0,
+				  vnet_buffer (b0)->sw_if_index[VLIB_RX],
+				  VNET_PCAP_DIR_RX);
 	}
     }
+
+  /* rx latency sampling if enabled */
+  vnet_latency_rx (vnm, vm, vlib_frame_vector_args (from_frame),
+		   from_frame->n_vectors);
 }
 
 static_always_inline void
@@ -185,7 +185,7 @@ VLIB_REGISTER_NODE (worker_handoff_node) = {
 int
 interface_handoff_enable_disable (vlib_main_t *vm, u32 sw_if_index,
 				  uword *bitmap, u8 is_sym, int is_l4,
-				  int enable_disable)
+				  char *hash_name, int enable_disable)
 {
   handoff_main_t *hm = &handoff_main;
   vnet_sw_interface_t *sw;
@@ -212,6 +212,10 @@ interface_handoff_enable_disable (vlib_main_t *vm, u32 sw_if_index,
   vec_validate (hm->if_data, sw_if_index);
   d = vec_elt_at_index (hm->if_data, sw_if_index);
 
+  if (enable_disable && hash_name &&
+      !vnet_hash_function_from_name (hash_name, VNET_HASH_FN_TYPE_ETHERNET))
+    return VNET_API_ERROR_INVALID_VALUE;
+
   vec_free (d->workers);
   vec_free (d->workers_bitmap);
 
@@ -223,7 +227,11 @@ interface_handoff_enable_disable (vlib_main_t *vm, u32 sw_if_index,
 	  vec_add1(d->workers, i);
 	}
 
-      if (is_sym)
+      /* e.g. toeplitz-5tuple to follow the same flow placement as NIC RSS */
+      if (hash_name)
+	d->hash_fn = vnet_hash_function_from_name (hash_name,
+						   VNET_HASH_FN_TYPE_ETHERNET);
+      else if (is_sym)
 	{
 	  if (is_l4)
 	    return VNET_API_ERROR_UNIMPLEMENTED;
@@ -255,6 +263,7 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
   u32 sw_if_index = ~0, is_sym = 0, is_l4 = 0;
   int enable_disable = 1;
   uword *bitmap = 0;
+  u8 *hash_name = 0;
   int rv = 0;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
@@ -272,6 +281,8 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 	is_sym = 0;
       else if (unformat (input, "l4"))
 	is_l4 = 1;
+      else if (unformat (input, "hash %s", &hash_name))
+	;
       else
 	break;
     }
@@ -283,7 +294,9 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
     return clib_error_return (0, "Please specify list of workers...");
 
   rv = interface_handoff_enable_disable (vm, sw_if_index, bitmap, is_sym,
-					 is_l4, enable_disable);
+					 is_l4, (char *) hash_name,
+					 enable_disable);
+  vec_free (hash_name);
 
   switch (rv)
     {
@@ -298,6 +311,10 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
       return clib_error_return (0, "Invalid worker(s)");
       break;
 
+    case VNET_API_ERROR_INVALID_VALUE:
+      return clib_error_return (0, "Unknown hash function");
+      break;
+
     case VNET_API_ERROR_UNIMPLEMENTED:
       return clib_error_return (0,
 				"Device driver doesn't support redirection");
@@ -314,7 +331,7 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 VLIB_CLI_COMMAND (set_interface_handoff_command, static) = {
   .path = "set interface handoff",
   .short_help = "set interface handoff <interface-name> workers <workers-list>"
-		" [symmetrical|asymmetrical]",
+		" [symmetrical|asymmetrical] [hash <hash-name>]",
   .function = set_interface_handoff_command_fn,
 };
 /* *INDENT-ON* */
@@ -56,4 +56,7 @@ vnet_hash_function_registration_t *
 vnet_hash_function_from_func (vnet_hash_fn_t fn, vnet_hash_fn_type_t ftype);
 format_function_t format_vnet_hash;
 
+/* toeplitz-5tuple key, 0 selects the default RSS key */
+int vnet_toeplitz_5tuple_set_key (u8 *key, u32 key_len);
+
 #endif
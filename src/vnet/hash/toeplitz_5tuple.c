@@ -0,0 +1,281 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright(c) 2026 Cisco Systems, Inc.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/ip/ip6_packet.h>
+#include <vnet/hash/hash.h>
+#include <vppinfra/vector/toeplitz.h>
+
+/*
+ * Toeplitz hash over the same input NICs use for RSS: source and
+ * destination address, followed by source and destination port for
+ * TCP and UDP. With the same key, software handoff sends a flow to the
+ * same queue index as hardware RSS would.
+ *
+ * The symmetric variant uses a key with 16-bit period, so swapping
+ * addresses and ports yields the same hash.
+ */
+
+#define TOEPLITZ_5TUPLE_MAX_LEN 36 /* ip6 addresses + ports */
+
+/* clib_toeplitz_hash may load a few bytes in front of the data */
+#define TOEPLITZ_5TUPLE_HEADROOM 8
+
+#ifndef CLIB_MARCH_VARIANT
+clib_toeplitz_hash_key_t *vnet_toeplitz_5tuple_key;
+clib_toeplitz_hash_key_t *vnet_toeplitz_5tuple_sym_key;
+#else
+extern clib_toeplitz_hash_key_t *vnet_toeplitz_5tuple_key;
+extern clib_toeplitz_hash_key_t *vnet_toeplitz_5tuple_sym_key;
+#endif
+
+static_always_inline u32
+toeplitz_5tuple_ip4 (ip4_header_t *ip, u8 *t)
+{
+  *(u64u *) t = *(u64u *) &ip->src_address;
+
+  if ((ip->protocol == IP_PROTOCOL_TCP || ip->protocol == IP_PROTOCOL_UDP) &&
+      !ip4_is_fragment (ip))
+    {
+      *(u32u *) (t + 8) = *(u32u *) ip4_next_header (ip);
+      return 12;
+    }
+  return 8;
+}
+
+static_always_inline u32
+toeplitz_5tuple_ip6 (ip6_header_t *ip, u8 *t)
+{
+  clib_memcpy_fast (t, &ip->src_address, 32);
+
+  if (ip->protocol == IP_PROTOCOL_TCP || ip->protocol == IP_PROTOCOL_UDP)
+    {
+      *(u32u *) (t + 32) = *(u32u *) ip6_next_header (ip);
+      return 36;
+    }
+  return 32;
+}
+
+static_always_inline u32
+toeplitz_5tuple_ip (void *p, u8 *t)
+{
+  if ((((u8 *) p)[0] & 0xf0) == 0x40)
+    return toeplitz_5tuple_ip4 (p, t);
+  else if ((((u8 *) p)[0] & 0xf0) == 0x60)
+    return toeplitz_5tuple_ip6 (p, t);
+  return 0;
+}
+
+static_always_inline u32
+toeplitz_5tuple_ethernet (void *p, u8 *t)
+{
+  ethernet_header_t *eh = (ethernet_header_t *) p;
+  u16 ethertype = clib_net_to_host_u16 (eh->type);
+  u16 l2hdr_sz = sizeof (ethernet_header_t);
+
+  if (ethernet_frame_is_tagged (ethertype))
+    {
+      ethernet_vlan_header_t *vlan = (ethernet_vlan_header_t *) (eh + 1);
+
+      ethertype = clib_net_to_host_u16 (vlan->type);
+      l2hdr_sz += sizeof (*vlan);
+      while (ethernet_frame_is_tagged (ethertype))
+	{
+	  vlan++;
+	  ethertype = clib_net_to_host_u16 (vlan->type);
+	  l2hdr_sz += sizeof (*vlan);
+	}
+    }
+
+  if (ethertype == ETHERNET_TYPE_IP4)
+    return toeplitz_5tuple_ip4 ((ip4_header_t *) (p + l2hdr_sz), t);
+  else if (ethertype == ETHERNET_TYPE_IP6)
+    return toeplitz_5tuple_ip6 ((ip6_header_t *) (p + l2hdr_sz), t);
+  return 0;
+}
+
+static_always_inline u32
+toeplitz_5tuple_extract (void *p, u8 *t, int is_ip)
+{
+  return is_ip ? toeplitz_5tuple_ip (p, t) : toeplitz_5tuple_ethernet (p, t);
+}
+
+static_always_inline u32
+toeplitz_5tuple_one (clib_toeplitz_hash_key_t *k, u8 *t, u32 len)
+{
+  return len ? clib_toeplitz_hash (k, t, len) : 0;
+}
+
+CLIB_MARCH_FN (vnet_toeplitz_5tuple, void, void **p, u32 *hash,
+	       u32 n_packets, int is_ip, int is_sym)
+{
+  clib_toeplitz_hash_key_t *k =
+    is_sym ? vnet_toeplitz_5tuple_sym_key : vnet_toeplitz_5tuple_key;
+  u8 buf[4][TOEPLITZ_5TUPLE_HEADROOM + TOEPLITZ_5TUPLE_MAX_LEN];
+  u8 *t[4] = { buf[0] + TOEPLITZ_5TUPLE_HEADROOM,
+	       buf[1] + TOEPLITZ_5TUPLE_HEADROOM,
+	       buf[2] + TOEPLITZ_5TUPLE_HEADROOM,
+	       buf[3] + TOEPLITZ_5TUPLE_HEADROOM };
+  u32 n_left = n_packets, l0, l1, l2, l3;
+
+  while (n_left >= 8)
+    {
+      clib_prefetch_load (p[4]);
+      clib_prefetch_load (p[5]);
+      clib_prefetch_load (p[6]);
+      clib_prefetch_load (p[7]);
+
+      l0 = toeplitz_5tuple_extract (p[0], t[0], is_ip);
+      l1 = toeplitz_5tuple_extract (p[1], t[1], is_ip);
+      l2 = toeplitz_5tuple_extract (p[2], t[2], is_ip);
+      l3 = toeplitz_5tuple_extract (p[3], t[3], is_ip);
+
+      /* common case, all four packets of the same kind */
+      if (PREDICT_TRUE (l0 && l0 == l1 && l0 == l2 && l0 == l3))
+	clib_toeplitz_hash_x4 (k, t[0], t[1], t[2], t[3], hash, hash + 1,
+			       hash + 2, hash + 3, l0);
+      else
+	{
+	  hash[0] = toeplitz_5tuple_one (k, t[0], l0);
+	  hash[1] = toeplitz_5tuple_one (k, t[1], l1);
+	  hash[2] = toeplitz_5tuple_one (k, t[2], l2);
+	  hash[3] = toeplitz_5tuple_one (k, t[3], l3);
+	}
+
+      hash += 4;
+      n_left -= 4;
+      p += 4;
+    }
+
+  while (n_left > 0)
+    {
+      l0 = toeplitz_5tuple_extract (p[0], t[0], is_ip);
+      hash[0] = toeplitz_5tuple_one (k, t[0], l0);
+
+      hash += 1;
+      n_left -= 1;
+      p += 1;
+    }
+}
+
+#ifndef CLIB_MARCH_VARIANT
+
+static u8 toeplitz_5tuple_sym_key_data[40] = {
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+};
+
+void
+vnet_toeplitz_5tuple_ip_func (void **p, u32 *hash, u32 n_packets)
+{
+  CLIB_MARCH_FN_SELECT (vnet_toeplitz_5tuple) (p, hash, n_packets, 1, 0);
+}
+
+void
+vnet_toeplitz_5tuple_ethernet_func (void **p, u32 *hash, u32 n_packets)
+{
+  CLIB_MARCH_FN_SELECT (vnet_toeplitz_5tuple) (p, hash, n_packets, 0, 0);
+}
+
+void
+vnet_toeplitz_5tuple_sym_ip_func (void **p, u32 *hash, u32 n_packets)
+{
+  CLIB_MARCH_FN_SELECT (vnet_toeplitz_5tuple) (p, hash, n_packets, 1, 1);
+}
+
+void
+vnet_toeplitz_5tuple_sym_ethernet_func (void **p, u32 *hash, u32 n_packets)
+{
+  CLIB_MARCH_FN_SELECT (vnet_toeplitz_5tuple) (p, hash, n_packets, 0, 1);
+}
+
+VNET_REGISTER_HASH_FUNCTION (toeplitz_5tuple, static) = {
+  .name = "toeplitz-5tuple",
+  .description = "Toeplitz (RSS) over IPv4/IPv6 addresses and TCP/UDP ports",
+  .priority = 40,
+  .function[VNET_HASH_FN_TYPE_ETHERNET] = vnet_toeplitz_5tuple_ethernet_func,
+  .function[VNET_HASH_FN_TYPE_IP] = vnet_toeplitz_5tuple_ip_func,
+};
+
+VNET_REGISTER_HASH_FUNCTION (toeplitz_5tuple_sym, static) = {
+  .name = "toeplitz-5tuple-sym",
+  .description = "Toeplitz (RSS) over IPv4/IPv6 addresses and TCP/UDP ports "
+		 "Symmetric",
+  .priority = 39,
+  .function[VNET_HASH_FN_TYPE_ETHERNET] =
+    vnet_toeplitz_5tuple_sym_ethernet_func,
+  .function[VNET_HASH_FN_TYPE_IP] = vnet_toeplitz_5tuple_sym_ip_func,
+};
+
+/* key must be at least 4 bytes longer than the longest input */
+#define TOEPLITZ_5TUPLE_MIN_KEY_LEN (TOEPLITZ_5TUPLE_MAX_LEN + 4)
+
+int
+vnet_toeplitz_5tuple_set_key (u8 *key, u32 key_len)
+{
+  clib_toeplitz_hash_key_t *old = vnet_toeplitz_5tuple_key;
+
+  if (key && key_len < TOEPLITZ_5TUPLE_MIN_KEY_LEN)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  /* 0 restores the default (Microsoft RSS) key */
+  vnet_toeplitz_5tuple_key = clib_toeplitz_hash_key_init (key, key_len);
+  if (old)
+    clib_toeplitz_hash_key_free (old);
+  return 0;
+}
+
+static clib_error_t *
+set_hash_toeplitz_key_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				  vlib_cli_command_t *cmd)
+{
+  u8 *key = 0;
+  int is_default = 0, rv;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "default"))
+	is_default = 1;
+      else if (unformat (input, "%U", unformat_hex_string, &key))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (!key && !is_default)
+    return clib_error_return (0, "please specify key");
+
+  rv = vnet_toeplitz_5tuple_set_key (key, vec_len (key));
+  vec_free (key);
+
+  if (rv)
+    return clib_error_return (0, "key must be at least %u bytes long",
+			      TOEPLITZ_5TUPLE_MIN_KEY_LEN);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (set_hash_toeplitz_key_command, static) = {
+  .path = "set hash toeplitz-key",
+  .short_help = "set hash toeplitz-key <hex-key>|default",
+  .function = set_hash_toeplitz_key_command_fn,
+};
+
+static clib_error_t *
+vnet_toeplitz_5tuple_init (vlib_main_t *vm)
+{
+  vnet_toeplitz_5tuple_set_key (0, 0);
+  vnet_toeplitz_5tuple_sym_key = clib_toeplitz_hash_key_init (
+    toeplitz_5tuple_sym_key_data, sizeof (toeplitz_5tuple_sym_key_data));
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (vnet_toeplitz_5tuple_init);
+
+#endif /* CLIB_MARCH_VARIANT */
@@ -1095,10 +1095,23 @@ typedef struct
   u32 sw_if_index;
   int filter;
   vlib_error_t drop_err;
+  u8 stream;
+  u32 ring_size;
+  u32 rotate_files;
+  u64 rotate_size;
 } vnet_pcap_dispatch_trace_args_t;
 
 int vnet_pcap_dispatch_trace_configure (vnet_pcap_dispatch_trace_args_t *);
 
+/* Streaming capture to rotating pcapng files, see interface/pcap_stream.c */
+#define VNET_PCAP_STREAM_MAX_RING_SIZE (64 << 10)
+int vnet_pcap_stream_start (vnet_pcap_dispatch_trace_args_t *a);
+void vnet_pcap_stream_stop (int join);
+format_function_t format_vnet_pcap_stream;
+
+/* Sampled rx to tx latency tracking, see interface/latency.c */
+void vnet_latency_enable_disable (vlib_main_t *vm, u32 sample_interval);
+
 extern vlib_node_registration_t vnet_interface_output_node;
 extern vlib_node_registration_t vnet_interface_output_arc_end_node;
 
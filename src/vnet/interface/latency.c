@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2021 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Sampled rx to tx latency tracking
+ *
+ * ethernet-input stamps one in every N received packets with the CPU
+ * clock and the receiving interface, kept in the second buffer opaque.
+ * When a stamped packet is handed off between threads, the time its
+ * frame queue element waited is added to the stamp. interface-output
+ * records the rx to tx time, and the handoff time if any, into nanosecond
+ * histograms per receiving interface, which live in the stat segment as
+ * /if/latency/rx-tx and /if/latency/handoff.
+ */
+
+#include <vnet/vnet.h>
+#include <vlib/vlib.h>
+#include <vppinfra/random.h>
+
+/* Packets between two samples, random so that sampling does not lock
+   onto a repeating frame pattern, sample_interval on average */
+static_always_inline u32
+vnet_latency_next_gap (vnet_latency_t *lt, vnet_latency_per_thread_t *ptd)
+{
+  u64 r = random_u32 (&ptd->seed);
+  return 1 + ((r * (2 * (u64) lt->sample_interval - 1)) >> 32);
+}
+
+void
+vnet_latency_rx_stamp (vlib_main_t *vm, u32 *buffers, u32 n_buffers)
+{
+  vnet_latency_t *lt = &vnet_get_main ()->latency;
+  vnet_latency_per_thread_t *ptd;
+  u64 now = clib_cpu_time_now ();
+  u32 i;
+
+  ptd = vec_elt_at_index (lt->per_thread, vm->thread_index);
+
+  for (i = ptd->countdown; i < n_buffers; i += vnet_latency_next_gap (lt, ptd))
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, buffers[i]);
+
+      b->flags |= VNET_BUFFER_F_LATENCY_SAMPLED;
+      vnet_buffer2 (b)->latency.rx_clocks = now;
+      vnet_buffer2 (b)->latency.handoff_clocks = 0;
+      vnet_buffer2 (b)->latency.rx_sw_if_index =
+	vnet_buffer (b)->sw_if_index[VLIB_RX];
+    }
+
+  ptd->countdown = i - n_buffers;
+}
+
+void
+vnet_latency_tx_record (vlib_main_t *vm, u32 *buffers, u32 n_buffers)
+{
+  vnet_latency_t *lt = &vnet_get_main ()->latency;
+  u32 thread_index = vm->thread_index;
+  u64 now = 0, rx_tx;
+  u32 i;
+
+  for (i = 0; i < n_buffers; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, buffers[i]);
+      typeof (vnet_buffer2 (b)->latency) *l = &vnet_buffer2 (b)->latency;
+
+      if (PREDICT_TRUE (!(b->flags & VNET_BUFFER_F_LATENCY_SAMPLED)))
+	continue;
+
+      b->flags &= ~VNET_BUFFER_F_LATENCY_SAMPLED;
+
+      if (l->rx_sw_if_index >= lt->n_validated_sw_if_index)
+	continue;
+
+      if (now == 0)
+	now = clib_cpu_time_now ();
+
+      /* clocks of different cores may be slightly apart */
+      rx_tx = now > l->rx_clocks ? now - l->rx_clocks : 0;
+
+      vlib_histogram_add (&lt->rx_tx_hist, thread_index, l->rx_sw_if_index,
+			  rx_tx * lt->ns_per_clock);
+      if (l->handoff_clocks)
+	vlib_histogram_add (&lt->handoff_hist, thread_index,
+			    l->rx_sw_if_index,
+			    l->handoff_clocks * lt->ns_per_clock);
+    }
+}
+
+static void
+vnet_latency_frame_queue_wait (vlib_main_t *vm, u32 *buffers, u32 n_buffers,
+			       u64 wait_clocks)
+{
+  u32 i;
+
+  for (i = 0; i < n_buffers; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, buffers[i]);
+      u64 sum;
+
+      if (PREDICT_TRUE (!(b->flags & VNET_BUFFER_F_LATENCY_SAMPLED)))
+	continue;
+
+      sum = vnet_buffer2 (b)->latency.handoff_clocks + wait_clocks;
+      vnet_buffer2 (b)->latency.handoff_clocks = clib_min (sum, (u64) ~0U);
+    }
+}
+
+static void
+vnet_latency_validate (vnet_latency_t *lt, u32 n_sw_if_index)
+{
+  if (n_sw_if_index <= lt->n_validated_sw_if_index)
+    return;
+
+  vlib_validate_histogram (&lt->rx_tx_hist, n_sw_if_index - 1);
+  vlib_validate_histogram (&lt->handoff_hist, n_sw_if_index - 1);
+  lt->n_validated_sw_if_index = n_sw_if_index;
+}
+
+/**
+ * @brief Turn latency tracking on or off
+ *
+ * @param sample_interval stamp one in this many received packets, 0 to
+ * turn tracking off
+ */
+void
+vnet_latency_enable_disable (vlib_main_t *vm, u32 sample_interval)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_latency_t *lt = &vnm->latency;
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  u32 i;
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  if (sample_interval)
+    {
+      vec_validate_aligned (lt->per_thread, vlib_get_n_threads () - 1,
+			    CLIB_CACHE_LINE_BYTES);
+      for (i = 0; i < vec_len (lt->per_thread); i++)
+	{
+	  lt->per_thread[i].seed = clib_cpu_time_now () + i;
+	  lt->per_thread[i].countdown = 0;
+	}
+
+      vnet_latency_validate (lt,
+			     pool_len (vnm->interface_main.sw_interfaces));
+      lt->ns_per_clock = 1e9 / vm->clib_time.clocks_per_second;
+      tm->frame_queue_wait_fn = vnet_latency_frame_queue_wait;
+    }
+  else
+    tm->frame_queue_wait_fn = 0;
+
+  lt->sample_interval = sample_interval;
+
+  vlib_worker_thread_barrier_release (vm);
+}
+
+static clib_error_t *
+vnet_latency_sw_interface_add_del (vnet_main_t *vnm, u32 sw_if_index,
+				   u32 is_add)
+{
+  vnet_latency_t *lt = &vnm->latency;
+
+  if (is_add)
+    {
+      if (lt->sample_interval)
+	vnet_latency_validate (lt, sw_if_index + 1);
+    }
+  else if (sw_if_index < lt->n_validated_sw_if_index)
+    {
+      /* the index gets reused, start the next interface from zero */
+      vlib_zero_histogram (&lt->rx_tx_hist, sw_if_index);
+      vlib_zero_histogram (&lt->handoff_hist, sw_if_index);
+    }
+
+  return 0;
+}
+
+VNET_SW_INTERFACE_ADD_DEL_FUNCTION (vnet_latency_sw_interface_add_del);
+
+static u8 *
+format_vnet_latency_bucket_bound (u8 *s, va_list *args)
+{
+  u32 bucket = va_arg (*args, u32);
+  u64 ns;
+
+  if (bucket == VNET_LATENCY_N_BUCKETS - 1)
+    return format (s, "inf");
+
+  ns = vlib_histogram_bucket_min (bucket + 1, VNET_LATENCY_LOG2_SUB_BUCKETS);
+  if (ns < 1000)
+    return format (s, "%lluns", ns);
+  if (ns < 1000000)
+    return format (s, "%.1fus", ns * 1e-3);
+  return format (s, "%.1fms", ns * 1e-6);
+}
+
+/* Upper bound of the bucket holding the given percentile */
+static u32
+vnet_latency_percentile (u64 *hist, u64 total, f64 pct)
+{
+  u64 sum = 0, target = total * pct / 100;
+  u32 b;
+
+  for (b = 0; b < VNET_LATENCY_N_BUCKETS - 1; b++)
+    {
+      sum += hist[b];
+      if (sum > target)
+	break;
+    }
+  return b;
+}
+
+static u8 *
+format_vnet_latency_hist (u8 *s, va_list *args)
+{
+  vlib_histogram_main_t *hm = va_arg (*args, vlib_histogram_main_t *);
+  u32 sw_if_index = va_arg (*args, u32);
+  int verbose = va_arg (*args, int);
+  counter_t hist[VNET_LATENCY_N_BUCKETS], total, sum;
+  f64 pcts[] = { 50, 90, 99, 99.9 };
+  char *labels[] = { "p50", "p90", "p99", "p99.9" };
+  u32 b, i;
+
+  total = vlib_get_histogram (hm, sw_if_index, &sum, hist);
+
+  s = format (s, "%-10s%12llu", hm->name, total);
+  if (total == 0)
+    return s;
+
+  s = format (s, "  mean %.1fus", sum * 1e-3 / total);
+
+  for (i = 0; i < ARRAY_LEN (pcts); i++)
+    s = format (s, "  %s<%U", labels[i], format_vnet_latency_bucket_bound,
+		vnet_latency_percentile (hist, total, pcts[i]));
+
+  for (b = VNET_LATENCY_N_BUCKETS - 1; b > 0 && hist[b] == 0; b--)
+    ;
+  s = format (s, "  max<%U", format_vnet_latency_bucket_bound, b);
+
+  if (verbose)
+    for (b = 0; b < VNET_LATENCY_N_BUCKETS; b++)
+      if (hist[b])
+	s = format (s, "\n%U<%-10U%llu", format_white_space, 12,
+		    format_vnet_latency_bucket_bound, b, hist[b]);
+
+  return s;
+}
+
+static clib_error_t *
+set_latency_tracking_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				 vlib_cli_command_t *cmd)
+{
+  u32 sample_interval = 1024;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "sample %u", &sample_interval))
+	;
+      else if (unformat (input, "disable"))
+	sample_interval = 0;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  vnet_latency_enable_disable (vm, sample_interval);
+  return 0;
+}
+
+/*?
+ * Sample received packets and record how long they take to leave VPP,
+ * per receiving interface. One in every <n> packets seen by
+ * ethernet-input is stamped, 1024 by default. The results are shown by
+ * 'show latency-tracking' and exported to the stat segment.
+ *
+ * @cliexpar
+ * @cliexcmd{set latency-tracking sample 256}
+ * @cliexcmd{set latency-tracking disable}
+?*/
+VLIB_CLI_COMMAND (set_latency_tracking_command, static) = {
+  .path = "set latency-tracking",
+  .short_help = "set latency-tracking [sample <n>] [disable]",
+  .function = set_latency_tracking_command_fn,
+};
+
+static clib_error_t *
+show_latency_tracking_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				  vlib_cli_command_t *cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_latency_t *lt = &vnm->latency;
+  vnet_sw_interface_t *si;
+  int verbose = 0;
+
+  if (unformat (input, "verbose"))
+    verbose = 1;
+
+  if (lt->sample_interval)
+    vlib_cli_output (vm, "Sampling 1 in %u received packets",
+		     lt->sample_interval);
+  else
+    vlib_cli_output (vm, "Latency tracking is off");
+
+  pool_foreach (si, vnm->interface_main.sw_interfaces)
+    {
+      counter_t sum;
+
+      if (si->sw_if_index >= lt->n_validated_sw_if_index)
+	continue;
+      if (vlib_get_histogram (&lt->rx_tx_hist, si->sw_if_index, &sum, 0) ==
+	  0)
+	continue;
+
+      vlib_cli_output (vm, "%U", format_vnet_sw_if_index_name, vnm,
+		       si->sw_if_index);
+      vlib_cli_output (vm, "  %U", format_vnet_latency_hist, &lt->rx_tx_hist,
+		       si->sw_if_index, verbose);
+      vlib_cli_output (vm, "  %U", format_vnet_latency_hist,
+		       &lt->handoff_hist, si->sw_if_index, verbose);
+    }
+
+  return 0;
+}
+
+/*?
+ * Show the sampled rx to tx and handoff latency of each receiving
+ * interface as percentile upper bounds, or as the full histogram with
+ * 'verbose'.
+ ?*/
+VLIB_CLI_COMMAND (show_latency_tracking_command, static) = {
+  .path = "show latency-tracking",
+  .short_help = "show latency-tracking [verbose]",
+  .function = show_latency_tracking_command_fn,
+};
+
+static clib_error_t *
+clear_latency_tracking_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				   vlib_cli_command_t *cmd)
+{
+  vnet_latency_t *lt = &vnet_get_main ()->latency;
+
+  vlib_clear_histograms (&lt->rx_tx_hist);
+  vlib_clear_histograms (&lt->handoff_hist);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (clear_latency_tracking_command, static) = {
+  .path = "clear latency-tracking",
+  .short_help = "clear latency-tracking",
+  .function = clear_latency_tracking_command_fn,
+};
+
+static clib_error_t *
+vnet_latency_init (vlib_main_t *vm)
+{
+  vnet_latency_t *lt = &vnet_get_main ()->latency;
+
+  lt->rx_tx_hist.name = "rx-tx";
+  lt->rx_tx_hist.stat_segment_name = "/if/latency/rx-tx";
+  lt->rx_tx_hist.n_buckets = VNET_LATENCY_N_BUCKETS;
+  lt->rx_tx_hist.log2_sub_buckets = VNET_LATENCY_LOG2_SUB_BUCKETS;
+  lt->handoff_hist.name = "handoff";
+  lt->handoff_hist.stat_segment_name = "/if/latency/handoff";
+  lt->handoff_hist.n_buckets = VNET_LATENCY_N_BUCKETS;
+  lt->handoff_hist.log2_sub_buckets = VNET_LATENCY_LOG2_SUB_BUCKETS;
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (vnet_latency_init);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2021 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Streaming pcapng capture
+ *
+ * Packets selected by the pcap trace filters are copied, truncated to the
+ * snap length, into a single-producer / single-consumer ring owned by the
+ * capturing thread. A writer pthread drains all rings into pcapng files
+ * which are rotated by size, so a capture can stay on indefinitely
+ * without growing memory or sharing a lock between workers. When a ring
+ * is full the capture is skipped, the packet itself is never held up.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <vnet/vnet.h>
+#include <vlib/vlib.h>
+
+/* Writer flushes once this much pcapng data is pending */
+#define VNET_PCAP_STREAM_WRITE_SIZE (256 << 10)
+
+typedef struct
+{
+  f64 timestamp;
+  u32 sw_if_index;
+  u32 n_bytes_in_packet;
+  u16 n_bytes_stored;
+  u8 dir;
+  u8 pad;
+  u8 data[0];
+} vnet_pcap_stream_record_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /** Written by the capturing thread */
+  u32 head;
+  u64 n_captured;
+  u64 n_ring_full;
+
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  /** Written by the writer thread */
+  u32 tail;
+  u8 *slots;
+} vnet_pcap_stream_ring_t;
+
+typedef struct
+{
+  /** Per thread rings */
+  vnet_pcap_stream_ring_t *rings;
+  u32 ring_size;
+  u32 slot_size;
+  u32 snap_len;
+
+  /** Files are named <file_name>.<seq> */
+  u8 *file_name;
+  u64 rotate_size;
+  u32 rotate_files;
+
+  /** Interface names when the capture started, by sw_if_index */
+  u8 **if_names;
+  /** Unix time minus vlib time */
+  f64 time_offset;
+
+  pthread_t writer;
+  volatile u32 stop;
+
+  /* Writer thread state */
+  int fd;
+  u32 file_seq;
+  u64 file_bytes;
+  u32 *if_id_by_sw_if_index;
+  u32 n_if_ids;
+  u8 *buf;
+  u8 *comment;
+
+  /* Stats, updated by the writer thread */
+  u64 n_packets_written;
+  u64 n_bytes_written;
+  u64 n_write_errors;
+} vnet_pcap_stream_main_t;
+
+static vnet_pcap_stream_main_t vnet_pcap_stream_main;
+
+void
+vnet_pcap_stream_add_buffer (vlib_main_t *vm, u32 buffer_index,
+			     u32 sw_if_index, vnet_pcap_dir_t dir)
+{
+  vnet_pcap_stream_main_t *sm = &vnet_pcap_stream_main;
+  vnet_pcap_stream_ring_t *r = vec_elt_at_index (sm->rings, vm->thread_index);
+  vlib_buffer_t *b = vlib_get_buffer (vm, buffer_index);
+  vnet_pcap_stream_record_t *rec;
+  u32 head = r->head, n_left;
+  u8 *d;
+
+  if (head - clib_atomic_load_acq_n (&r->tail) >= sm->ring_size)
+    {
+      r->n_ring_full++;
+      return;
+    }
+
+  rec = (vnet_pcap_stream_record_t *) (r->slots +
+					(uword) (head & (sm->ring_size - 1)) *
+					  sm->slot_size);
+  rec->timestamp = vlib_time_now (vm);
+  rec->sw_if_index = sw_if_index;
+  rec->dir = dir;
+  rec->n_bytes_in_packet = vlib_buffer_length_in_chain (vm, b);
+  n_left = clib_min (rec->n_bytes_in_packet, sm->snap_len);
+  rec->n_bytes_stored = n_left;
+
+  d = rec->data;
+  while (1)
+    {
+      u32 n = clib_min (n_left, (u32) b->current_length);
+      clib_memcpy_fast (d, vlib_buffer_get_current (b), n);
+      n_left -= n;
+      d += n;
+      if (n_left == 0 || !(b->flags & VLIB_BUFFER_NEXT_PRESENT))
+	break;
+      b = vlib_get_buffer (vm, b->next_buffer);
+    }
+  rec->n_bytes_stored -= n_left;
+
+  r->n_captured++;
+  clib_atomic_store_rel_n (&r->head, head + 1);
+}
+
+static void
+vnet_pcap_stream_flush (vnet_pcap_stream_main_t *sm)
+{
+  u8 *p = sm->buf;
+  word n_left = vec_len (sm->buf);
+
+  while (n_left > 0)
+    {
+      word n = write (sm->fd, p, n_left);
+      if (n < 0)
+	{
+	  if (errno == EINTR || errno == EAGAIN)
+	    continue;
+	  sm->n_write_errors++;
+	  break;
+	}
+      p += n;
+      n_left -= n;
+    }
+
+  sm->file_bytes += p - sm->buf;
+  sm->n_bytes_written += p - sm->buf;
+  vec_reset_length (sm->buf);
+}
+
+static int
+vnet_pcap_stream_open (vnet_pcap_stream_main_t *sm)
+{
+  u8 *name;
+
+  if (sm->fd >= 0)
+    close (sm->fd);
+
+  /* Keep the last rotate_files files */
+  if (sm->rotate_files && sm->file_seq >= sm->rotate_files)
+    {
+      name = format (0, "%s.%u%c", sm->file_name,
+		     sm->file_seq - sm->rotate_files, 0);
+      unlink ((char *) name);
+      vec_free (name);
+    }
+
+  name = format (0, "%s.%u%c", sm->file_name, sm->file_seq, 0);
+  sm->fd = open ((char *) name, O_CREAT | O_TRUNC | O_WRONLY, 0664);
+  vec_free (name);
+  if (sm->fd < 0)
+    return -1;
+
+  sm->file_seq++;
+  sm->file_bytes = 0;
+
+  /* Interface ids are per section, describe them again as they show up */
+  vec_reset_length (sm->if_id_by_sw_if_index);
+  sm->n_if_ids = 0;
+  pcapng_add_section_header (&sm->buf, "vpp");
+  return 0;
+}
+
+static u32
+vnet_pcap_stream_if_id (vnet_pcap_stream_main_t *sm, u32 sw_if_index)
+{
+  u8 *name = 0;
+
+  vec_validate_init_empty (sm->if_id_by_sw_if_index, sw_if_index, ~0);
+  if (sm->if_id_by_sw_if_index[sw_if_index] != ~0)
+    return sm->if_id_by_sw_if_index[sw_if_index];
+
+  if (sw_if_index < vec_len (sm->if_names))
+    name = vec_dup (sm->if_names[sw_if_index]);
+  if (name == 0)
+    name = format (0, "sw_if_index %u", sw_if_index);
+  pcapng_add_interface (&sm->buf, PCAP_PACKET_TYPE_ethernet, sm->snap_len,
+			name);
+  vec_free (name);
+
+  sm->if_id_by_sw_if_index[sw_if_index] = sm->n_if_ids;
+  return sm->n_if_ids++;
+}
+
+static u32
+vnet_pcap_stream_drain (vnet_pcap_stream_main_t *sm, u32 thread_index)
+{
+  vnet_pcap_stream_ring_t *r = vec_elt_at_index (sm->rings, thread_index);
+  u32 head = clib_atomic_load_acq_n (&r->head);
+  u32 tail = r->tail, n = 0;
+
+  while (tail != head && vec_len (sm->buf) < VNET_PCAP_STREAM_WRITE_SIZE)
+    {
+      vnet_pcap_stream_record_t *rec;
+      u32 flags = 0;
+      u32 if_id;
+      u64 ts;
+
+      rec = (vnet_pcap_stream_record_t *) (r->slots +
+					    (uword) (tail & (sm->ring_size - 1)) *
+					      sm->slot_size);
+      if_id = vnet_pcap_stream_if_id (sm, rec->sw_if_index);
+      ts = (rec->timestamp + sm->time_offset) * 1e9;
+
+      if (rec->dir == VNET_PCAP_DIR_RX)
+	flags = PCAPNG_EPB_FLAG_INBOUND;
+      else if (rec->dir == VNET_PCAP_DIR_TX)
+	flags = PCAPNG_EPB_FLAG_OUTBOUND;
+
+      vec_reset_length (sm->comment);
+      sm->comment = format (sm->comment, "thread %u%s", thread_index,
+			    rec->dir == VNET_PCAP_DIR_DROP ? " drop" : "");
+
+      pcapng_add_packet (&sm->buf, if_id, ts, rec->data, rec->n_bytes_stored,
+			 rec->n_bytes_in_packet, flags, sm->comment);
+      tail++;
+      n++;
+    }
+
+  clib_atomic_store_rel_n (&r->tail, tail);
+  sm->n_packets_written += n;
+  return n;
+}
+
+static void *
+vnet_pcap_stream_writer_fn (void *arg)
+{
+  vnet_pcap_stream_main_t *sm = arg;
+  u32 i, n;
+
+  while (1)
+    {
+      u32 stop = clib_atomic_load_acq_n (&sm->stop);
+
+      n = 0;
+      for (i = 0; i < vec_len (sm->rings); i++)
+	n += vnet_pcap_stream_drain (sm, i);
+
+      if (vec_len (sm->buf) >= VNET_PCAP_STREAM_WRITE_SIZE ||
+	  (n == 0 && vec_len (sm->buf)))
+	vnet_pcap_stream_flush (sm);
+
+      /* rotate_size 0 keeps writing the same file */
+      if (sm->rotate_size && sm->file_bytes >= sm->rotate_size &&
+	  vnet_pcap_stream_open (sm))
+	sm->n_write_errors++;
+
+      /* Producers are stopped before stop is set, exit once drained */
+      if (n == 0 && stop)
+	break;
+
+      if (n == 0)
+	usleep (1000);
+    }
+
+  vnet_pcap_stream_flush (sm);
+  return 0;
+}
+
+int
+vnet_pcap_stream_start (vnet_pcap_dispatch_trace_args_t *a)
+{
+  vnet_pcap_stream_main_t *sm = &vnet_pcap_stream_main;
+  vlib_main_t *vm = vlib_get_main ();
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_sw_interface_t *si;
+  u32 i;
+
+  if (sm->rings || a->ring_size > VNET_PCAP_STREAM_MAX_RING_SIZE)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  sm->snap_len = a->max_bytes_per_pkt;
+  sm->ring_size = 1 << max_log2 (clib_max (a->ring_size, 2));
+  sm->slot_size = round_pow2 (sizeof (vnet_pcap_stream_record_t) +
+				sm->snap_len,
+			      CLIB_CACHE_LINE_BYTES);
+  sm->rotate_size = a->rotate_size;
+  sm->rotate_files = a->rotate_files;
+  /* the caller keeps a->filename as pcap_main_t file_name */
+  sm->file_name = vec_dup (a->filename);
+  sm->time_offset = unix_time_now () - vlib_time_now (vm);
+
+  vec_validate_aligned (sm->rings, vlib_get_n_threads () - 1,
+			CLIB_CACHE_LINE_BYTES);
+  for (i = 0; i < vec_len (sm->rings); i++)
+    vec_validate_aligned (sm->rings[i].slots,
+			  (uword) sm->ring_size * sm->slot_size - 1,
+			  CLIB_CACHE_LINE_BYTES);
+
+  pool_foreach (si, vnm->interface_main.sw_interfaces)
+    {
+      vec_validate (sm->if_names, si->sw_if_index);
+      sm->if_names[si->sw_if_index] =
+	format (0, "%U", format_vnet_sw_if_index_name, vnm, si->sw_if_index);
+    }
+
+  sm->fd = -1;
+  sm->file_seq = 0;
+  sm->stop = 0;
+  sm->n_packets_written = sm->n_bytes_written = sm->n_write_errors = 0;
+
+  if (vnet_pcap_stream_open (sm) ||
+      pthread_create (&sm->writer, NULL, vnet_pcap_stream_writer_fn, sm))
+    {
+      vnet_pcap_stream_stop (0 /* writer not running */);
+      return VNET_API_ERROR_SYSCALL_ERROR_1;
+    }
+
+  return 0;
+}
+
+void
+vnet_pcap_stream_stop (int join)
+{
+  vnet_pcap_stream_main_t *sm = &vnet_pcap_stream_main;
+  u32 i;
+
+  if (join)
+    {
+      clib_atomic_store_rel_n (&sm->stop, 1);
+      pthread_join (sm->writer, 0);
+    }
+
+  if (sm->fd >= 0)
+    close (sm->fd);
+  sm->fd = -1;
+
+  for (i = 0; i < vec_len (sm->rings); i++)
+    vec_free (sm->rings[i].slots);
+  vec_free (sm->rings);
+  for (i = 0; i < vec_len (sm->if_names); i++)
+    vec_free (sm->if_names[i]);
+  vec_free (sm->if_names);
+  vec_free (sm->if_id_by_sw_if_index);
+  vec_free (sm->buf);
+  vec_free (sm->comment);
+  vec_free (sm->file_name);
+}
+
+u8 *
+format_vnet_pcap_stream (u8 *s, va_list *args)
+{
+  vnet_pcap_stream_main_t *sm = &vnet_pcap_stream_main;
+  u32 indent = format_get_indent (s);
+  u32 i;
+
+  s = format (s, "streaming to %s.%u, snap length %u, ring %u slots",
+	      sm->file_name, sm->file_seq ? sm->file_seq - 1 : 0,
+	      sm->snap_len, sm->ring_size);
+  if (sm->rotate_size)
+    s = format (s, "\n%Urotate at %U, keep %u files", format_white_space,
+		indent, format_memory_size, sm->rotate_size, sm->rotate_files);
+  else
+    s = format (s, "\n%Uno rotation", format_white_space, indent);
+  s = format (s, "\n%Uwritten %llu packets, %U, %llu write errors",
+	      format_white_space, indent, sm->n_packets_written,
+	      format_memory_size, sm->n_bytes_written, sm->n_write_errors);
+  for (i = 0; i < vec_len (sm->rings); i++)
+    s = format (s, "\n%Uthread %u: captured %llu, ring full %llu",
+		format_white_space, indent, i, sm->rings[i].n_captured,
+		sm->rings[i].n_ring_full);
+  return s;
+}
@@ -2073,11 +2073,18 @@ vnet_pcap_dispatch_trace_configure (vnet_pcap_dispatch_trace_args_t * a)
     {
       if (pp->pcap_rx_enable || pp->pcap_tx_enable || pp->pcap_drop_enable)
 	{
-	  vlib_cli_output
-	    (vm, "pcap %U dispatch capture enabled: %d of %d pkts...",
-	     format_vnet_pcap, pp, 0 /* print type */ ,
-	     pm->n_packets_captured, pm->n_packets_to_capture);
-	  vlib_cli_output (vm, "capture to file %s", pm->file_name);
+	  if (pp->pcap_stream_enable)
+	    vlib_cli_output (vm, "pcap %U dispatch capture enabled, %U",
+			     format_vnet_pcap, pp, 0 /* print type */,
+			     format_vnet_pcap_stream);
+	  else
+	    {
+	      vlib_cli_output (
+		vm, "pcap %U dispatch capture enabled: %d of %d pkts...",
+		format_vnet_pcap, pp, 0 /* print type */,
+		pm->n_packets_captured, pm->n_packets_to_capture);
+	      vlib_cli_output (vm, "capture to file %s", pm->file_name);
+	    }
 	}
       else
 	vlib_cli_output (vm, "pcap dispatch capture disabled");
@@ -2146,10 +2153,21 @@ vnet_pcap_dispatch_trace_configure (vnet_pcap_dispatch_trace_args_t * a)
 	    stem = format (stem, "tx");
 	  if (a->drop_enable)
 	    stem = format (stem, "drop");
-	  a->filename = format (0, "/tmp/%v.pcap%c", stem, 0);
+	  a->filename =
+	    format (0, "/tmp/%v.pcap%s%c", stem, a->stream ? "ng" : "", 0);
 	  vec_free (stem);
 	}
 
+      if (a->stream)
+	{
+	  int rv = vnet_pcap_stream_start (a);
+	  if (rv)
+	    {
+	      vec_free (a->filename);
+	      return rv;
+	    }
+	}
+
       pm->file_name = (char *) a->filename;
       pm->n_packets_captured = 0;
       pm->packet_type = PCAP_PACKET_TYPE_ethernet;
@@ -2173,6 +2191,7 @@ vnet_pcap_dispatch_trace_configure (vnet_pcap_dispatch_trace_args_t * a)
       pp->pcap_tx_enable = a->tx_enable;
       pp->pcap_drop_enable = a->drop_enable;
       pp->max_bytes_per_pkt = a->max_bytes_per_pkt;
+      pp->pcap_stream_enable = a->stream;
     }
   else
     {
@@ -2181,6 +2200,16 @@ vnet_pcap_dispatch_trace_configure (vnet_pcap_dispatch_trace_args_t * a)
       pp->pcap_drop_enable = 0;
       pp->filter_classify_table_index = ~0;
       pp->pcap_error_index = ~0;
+      if (pp->pcap_stream_enable)
+	{
+	  /* Workers are held by the barrier, nothing is capturing */
+	  pp->pcap_stream_enable = 0;
+	  vlib_cli_output (vm, "Stop streaming capture, %U",
+			   format_vnet_pcap_stream);
+	  vnet_pcap_stream_stop (1 /* join writer */);
+	  vec_free (pm->file_name);
+	  return 0;
+	}
       if (pm->n_packets_captured)
 	{
 	  clib_error_t *error;
@@ -2228,6 +2257,10 @@ pcap_trace_command_fn (vlib_main_t * vm,
   int free_data = 0;
   u32 sw_if_index = 0;		/* default: any interface */
   vlib_error_t drop_err = ~0;	/* default: any error */
+  int stream = 0;
+  u32 ring_size = 4096;
+  u32 rotate_files = 8;
+  uword rotate_size = 64 << 20;
 
   /* Get a line of input. */
   if (!unformat_user (input, unformat_line_input, line_input))
@@ -2274,6 +2307,15 @@ pcap_trace_command_fn (vlib_main_t * vm,
 	sw_if_index = 0;
       else if (unformat (line_input, "filter"))
 	filter = 1;
+      else if (unformat (line_input, "stream"))
+	stream = 1;
+      else if (unformat (line_input, "ring-size %u", &ring_size))
+	;
+      else if (unformat (line_input, "rotate-files %u", &rotate_files))
+	;
+      else if (unformat (line_input, "rotate-size %U", unformat_memory_size,
+			 &rotate_size))
+	;
       else
 	{
 	  return clib_error_return (0, "unknown input `%U'",
@@ -2283,6 +2325,13 @@ pcap_trace_command_fn (vlib_main_t * vm,
 
   unformat_free (line_input);
 
+  if (ring_size > VNET_PCAP_STREAM_MAX_RING_SIZE)
+    {
+      vec_free (filename);
+      return clib_error_return (0, "ring-size must be at most %u",
+				VNET_PCAP_STREAM_MAX_RING_SIZE);
+    }
+
   /* no need for memset (a, 0, sizeof (*a)), set all fields here. */
   a->filename = filename;
   a->rx_enable = rx_enable;
@@ -2296,6 +2345,10 @@ pcap_trace_command_fn (vlib_main_t * vm,
   a->filter = filter;
   a->max_bytes_per_pkt = max_bytes_per_pkt;
   a->drop_err = drop_err;
+  a->stream = stream;
+  a->ring_size = ring_size;
+  a->rotate_files = rotate_files;
+  a->rotate_size = rotate_size;
 
   rv = vnet_pcap_dispatch_trace_configure (a);
 
@@ -2386,6 +2439,16 @@ pcap_trace_command_fn (vlib_main_t * vm,
  *   named "/tmp/rx.pcap", "/tmp/tx.pcap", "/tmp/rxandtx.pcap", etc.
  *   Can only be updated if packet capture is off.
  *
+ * - <b>stream</b> - Capture continuously into rotating pcapng files
+ *   instead of the in-memory buffer, <b>max</b> is ignored. Each thread
+ *   copies selected packets, truncated to <b>max-bytes-per-pkt</b>, into
+ *   its own ring of <b>ring-size <nn></b> packets (default 4096, at most
+ *   65536), a writer thread drains the rings to '<em>file</em>.N'. A new
+ *   file is started every <b>rotate-size <size></b> (default 64m, 0 never
+ *   rotates) and only the last <b>rotate-files <nn></b> (default 8, 0
+ *   keeps all) are kept.
+ *   Packets carry direction flags and the capturing thread as a comment.
+ *
  * - <b>status</b> - Displays the current status and configured attributes
  *   associated with a packet capture. If packet capture is in progress,
  *   '<em>status</em>' also will return the number of packets currently in
@@ -2420,7 +2483,9 @@ VLIB_CLI_COMMAND (pcap_tx_trace_command, static) = {
     .short_help =
     "pcap trace [rx] [tx] [drop] [off] [max <nn>] [intfc <interface>|any]\n"
     "           [file <name>] [status] [max-bytes-per-pkt <nnnn>][filter]\n"
-    "           [preallocate-data][free-data]",
+    "           [preallocate-data][free-data]\n"
+    "           [stream [ring-size <nn>] [rotate-size <size>]"
+    " [rotate-files <nn>]]",
     .function = pcap_trace_command_fn,
 };
 /* *INDENT-ON* */
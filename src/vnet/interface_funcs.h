@@ -563,6 +563,74 @@ pcap_add_buffer (pcap_main_t *pm, struct vlib_main_t *vm, u32 buffer_index,
     }
 }
 
+typedef enum
+{
+  VNET_PCAP_DIR_RX,
+  VNET_PCAP_DIR_TX,
+  VNET_PCAP_DIR_DROP,
+} vnet_pcap_dir_t;
+
+void vnet_pcap_stream_add_buffer (struct vlib_main_t *vm, u32 buffer_index,
+				  u32 sw_if_index, vnet_pcap_dir_t dir);
+
+/**
+ * @brief Capture a buffer selected by vnet_is_packet_pcaped
+ *
+ * Goes to the per-thread streaming ring when streaming capture is on,
+ * to the shared pcap_main otherwise.
+ */
+static inline void
+vnet_pcap_add_buffer (vnet_pcap_t *pp, struct vlib_main_t *vm,
+		      u32 buffer_index, u32 sw_if_index, vnet_pcap_dir_t dir)
+{
+  if (pp->pcap_stream_enable)
+    vnet_pcap_stream_add_buffer (vm, buffer_index, sw_if_index, dir);
+  else
+    pcap_add_buffer (&pp->pcap_main, vm, buffer_index, pp->max_bytes_per_pkt);
+}
+
+void vnet_latency_rx_stamp (struct vlib_main_t *vm, u32 *buffers,
+			    u32 n_buffers);
+void vnet_latency_tx_record (struct vlib_main_t *vm, u32 *buffers,
+			     u32 n_buffers);
+
+/**
+ * @brief Stamp one in every sample_interval received packets
+ *
+ * Called by input nodes with the frame they were handed. Costs a
+ * countdown check per frame, buffers are only touched for the packet
+ * that is due.
+ */
+static_always_inline void
+vnet_latency_rx (vnet_main_t *vnm, struct vlib_main_t *vm, u32 *buffers,
+		 u32 n_buffers)
+{
+  vnet_latency_t *lt = &vnm->latency;
+  vnet_latency_per_thread_t *ptd;
+
+  if (PREDICT_TRUE (lt->sample_interval == 0))
+    return;
+
+  ptd = vec_elt_at_index (lt->per_thread, vm->thread_index);
+  if (ptd->countdown >= n_buffers)
+    {
+      ptd->countdown -= n_buffers;
+      return;
+    }
+  vnet_latency_rx_stamp (vm, buffers, n_buffers);
+}
+
+/**
+ * @brief Record sampled packets leaving on an interface
+ */
+static_always_inline void
+vnet_latency_tx (vnet_main_t *vnm, struct vlib_main_t *vm, u32 *buffers,
+		 u32 n_buffers)
+{
+  if (PREDICT_FALSE (vnm->latency.sample_interval != 0))
+    vnet_latency_tx_record (vm, buffers, n_buffers);
+}
+
 typedef struct
 {
   vnet_hw_if_caps_t val;
@@ -357,7 +357,7 @@ vnet_interface_pcap_tx_trace (vlib_main_t *vm, vlib_node_runtime_t *node,
 	}
 
       if (vnet_is_packet_pcaped (pp, b0, sw_if_index))
-	pcap_add_buffer (&pp->pcap_main, vm, bi0, pp->max_bytes_per_pkt);
+	vnet_pcap_add_buffer (pp, vm, bi0, sw_if_index, VNET_PCAP_DIR_TX);
     }
 }
 
@@ -603,6 +603,8 @@ VLIB_NODE_FN (vnet_interface_output_node)
 	node->node_index, VNET_INTERFACE_OUTPUT_ERROR_INTERFACE_DOWN);
     }
 
+  vnet_latency_tx (vnm, vm, from, n_buffers);
+
   if (hi->output_node_thread_runtimes)
     r = vec_elt_at_index (hi->output_node_thread_runtimes, vm->thread_index);
 
@@ -1164,7 +1166,9 @@ pcap_drop_trace (vlib_main_t * vm,
 			      error_string_len);
 	    last->current_length += drop_string_len;
 	    b0->flags &= ~(VLIB_BUFFER_TOTAL_LENGTH_VALID);
-	    pcap_add_buffer (&pp->pcap_main, vm, bi0, pp->max_bytes_per_pkt);
+	    vnet_pcap_add_buffer (pp, vm, bi0,
+				  vnet_buffer (b0)->sw_if_index[VLIB_RX],
+				  VNET_PCAP_DIR_DROP);
 	    last->current_length -= drop_string_len;
 	    b0->current_data = save_current_data;
 	    b0->current_length = save_current_length;
@@ -1176,7 +1180,9 @@ pcap_drop_trace (vlib_main_t * vm,
        * Didn't have space in the last buffer, here's the dropped
        * packet as-is
        */
-      pcap_add_buffer (&pp->pcap_main, vm, bi0, pp->max_bytes_per_pkt);
+      vnet_pcap_add_buffer (pp, vm, bi0,
+			    vnet_buffer (b0)->sw_if_index[VLIB_RX],
+			    VNET_PCAP_DIR_DROP);
 
       b0->current_data = save_current_data;
       b0->current_length = save_current_length;
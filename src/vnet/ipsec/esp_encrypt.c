@@ -294,6 +294,36 @@ esp_process_ops (vlib_main_t * vm, vlib_node_runtime_t * node,
     }
 }
 
+static_always_inline void
+esp_process_linked_ops (vlib_main_t *vm, vlib_node_runtime_t *node,
+			vnet_crypto_op_t *crypto_ops,
+			vnet_crypto_op_t *integ_ops, vlib_buffer_t *b[],
+			u16 *nexts, u16 drop_next)
+{
+  u32 n_fail, n_ops = vec_len (crypto_ops), i = 0;
+
+  if (n_ops == 0)
+    return;
+
+  n_fail = n_ops - vnet_crypto_process_linked_ops (vm, crypto_ops, integ_ops,
+						   n_ops);
+
+  while (n_fail)
+    {
+      ASSERT (i < n_ops);
+
+      if (crypto_ops[i].status != VNET_CRYPTO_OP_STATUS_COMPLETED ||
+	  integ_ops[i].status != VNET_CRYPTO_OP_STATUS_COMPLETED)
+	{
+	  u32 bi = crypto_ops[i].user_data;
+	  b[bi]->error = node->errors[ESP_ENCRYPT_ERROR_CRYPTO_ENGINE_ERROR];
+	  nexts[bi] = drop_next;
+	  n_fail--;
+	}
+      i++;
+    }
+}
+
 static_always_inline u32
 esp_encrypt_chain_crypto (vlib_main_t * vm, ipsec_per_thread_data_t * ptd,
 			  ipsec_sa_t * sa0, vlib_buffer_t * b,
@@ -607,6 +637,8 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   vec_reset_length (ptd->integ_ops);
   vec_reset_length (ptd->chained_crypto_ops);
   vec_reset_length (ptd->chained_integ_ops);
+  vec_reset_length (ptd->linked_crypto_ops);
+  vec_reset_length (ptd->linked_integ_ops);
   vec_reset_length (ptd->async_frames);
   vec_reset_length (ptd->chunks);
   clib_memset (async_frames, 0, sizeof (async_frames));
@@ -956,6 +988,11 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  crypto_ops = &ptd->chained_crypto_ops;
 	  integ_ops = &ptd->chained_integ_ops;
 	}
+      else if (sa0->crypto_enc_op_id && sa0->integ_op_id)
+	{
+	  crypto_ops = &ptd->linked_crypto_ops;
+	  integ_ops = &ptd->linked_integ_ops;
+	}
       else
 	{
 	  crypto_ops = &ptd->crypto_ops;
@@ -1051,6 +1088,9 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 
       esp_process_ops (vm, node, ptd->integ_ops, sync_bufs, sync_nexts,
 		       drop_next);
+      esp_process_linked_ops (vm, node, ptd->linked_crypto_ops,
+			      ptd->linked_integ_ops, sync_bufs, sync_nexts,
+			      drop_next);
       esp_process_chained_ops (vm, node, ptd->chained_integ_ops, sync_bufs,
 			       sync_nexts, ptd->chunks, drop_next);
 
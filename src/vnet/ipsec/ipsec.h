@@ -121,6 +121,9 @@ typedef struct
   vnet_crypto_op_t *integ_ops;
   vnet_crypto_op_t *chained_crypto_ops;
   vnet_crypto_op_t *chained_integ_ops;
+  /* cipher and integ ops of the same packet at the same index */
+  vnet_crypto_op_t *linked_crypto_ops;
+  vnet_crypto_op_t *linked_integ_ops;
   vnet_crypto_op_chunk_t *chunks;
   vnet_crypto_async_frame_t **async_frames;
 } ipsec_per_thread_data_t;
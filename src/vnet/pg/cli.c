@@ -191,10 +191,19 @@ format_pg_stream (u8 * s, va_list * va)
     return format (s, "%-16s%=12s%=16s%s",
 		   "Name", "Enabled", "Count", "Parameters");
 
+  u64 n_packets_generated = t->n_packets_generated;
+  if (pg_stream_uses_templates (t))
+    {
+      pg_stream_worker_t *w;
+      n_packets_generated = 0;
+      vec_foreach (w, t->per_worker)
+	n_packets_generated += w->n_packets_generated;
+    }
+
   s = format (s, "%-16v%=12s%=16Ld",
 	      t->name,
 	      pg_stream_is_enabled (t) ? "Yes" : "No",
-	      t->n_packets_generated);
+	      n_packets_generated);
 
   int indent = format_get_indent (s);
 
@@ -205,7 +214,12 @@ format_pg_stream (u8 * s, va_list * va)
 	      t->packet_size_edit_type == PG_EDIT_RANDOM ? '+' : '-',
 	      t->max_packet_bytes);
   s = format (s, "buffer-size %d, ", t->buffer_bytes);
-  s = format (s, "worker %d, ", t->worker_index);
+  if (clib_bitmap_count_set_bits (t->workers) > 1)
+    s = format (s, "workers %U, ", format_bitmap_list, t->workers);
+  else
+    s = format (s, "worker %d, ", t->worker_index);
+  if (pg_stream_uses_templates (t))
+    s = format (s, "templates %d, ", vec_len (pg_stream_get_templates (t)));
 
   if (verbose)
     {
@@ -330,6 +344,25 @@ validate_stream (pg_stream_t * s)
   if (s->rate_packets_per_second < 0)
     return clib_error_create ("negative rate");
 
+  if (clib_bitmap_count_set_bits (s->workers) > 1)
+    s->flags |= PG_STREAM_FLAGS_USE_TEMPLATES;
+
+  uword last_worker = clib_bitmap_last_set (s->workers);
+  if (last_worker != ~0 && last_worker >= clib_max (vlib_num_workers (), 1))
+    return clib_error_create ("no worker %wd", last_worker);
+
+  if (pg_stream_uses_templates (s))
+    {
+      u32 n_bytes = vlib_buffer_get_default_data_size (vlib_get_main ());
+
+      if (s->max_packet_bytes > n_bytes)
+	return clib_error_create ("templates need packets fitting in one "
+				  "%d byte buffer",
+				  n_bytes);
+      if (s->n_packet_templates == 0)
+	s->n_packet_templates = PG_DEFAULT_N_PACKET_TEMPLATES;
+    }
+
   return 0;
 }
 
@@ -406,6 +439,13 @@ new_stream (vlib_main_t * vm,
 	s.n_max_frame = s.n_max_frame < maxframe ? s.n_max_frame : maxframe;
       else if (unformat (input, "worker %u", &s.worker_index))
 	;
+      else if (unformat (input, "workers %U", unformat_bitmap_list,
+			 &s.workers))
+	;
+      else if (unformat (input, "templates %u", &s.n_packet_templates))
+	s.flags |= PG_STREAM_FLAGS_USE_TEMPLATES;
+      else if (unformat (input, "templates"))
+	s.flags |= PG_STREAM_FLAGS_USE_TEMPLATES;
 
       else if (unformat (input, "interface %U",
 			 unformat_vnet_sw_interface, vnm,
@@ -523,7 +563,12 @@ VLIB_CLI_COMMAND (new_stream_cli, static) = {
   "data STRING          specifies packet data\n"
   "pcap FILENAME        read packet data from pcap file\n"
   "rate PPS             rate to transfer packet data\n"
-  "maxframe NPKTS       maximum number of packets per frame\n",
+  "maxframe NPKTS       maximum number of packets per frame\n"
+  "worker N             generate packets on worker N\n"
+  "workers LIST         share rate and limit between workers, implies\n"
+  "                     templates\n"
+  "templates [N]        copy packets from N precomputed ones instead of\n"
+  "                     editing each packet, or from the pcap packets\n",
 };
 /* *INDENT-ON* */
 
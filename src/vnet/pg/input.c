@@ -860,7 +860,7 @@ done:
   return v;
 }
 
-static void
+static u64
 pg_generate_set_lengths (pg_main_t * pg,
 			 pg_stream_t * s, u32 * buffers, u32 n_buffers)
 {
@@ -898,18 +898,21 @@ pg_generate_set_lengths (pg_main_t * pg,
       length_sum = v_min * n_buffers;
     }
 
-  {
-    vnet_main_t *vnm = vnet_get_main ();
-    vnet_interface_main_t *im = &vnm->interface_main;
-    vnet_sw_interface_t *si =
-      vnet_get_sw_interface (vnm, s->sw_if_index[VLIB_RX]);
-
-    vlib_increment_combined_counter (im->combined_sw_if_counters
-				     + VNET_INTERFACE_COUNTER_RX,
-				     vlib_get_thread_index (),
-				     si->sw_if_index, n_buffers, length_sum);
-  }
+  return length_sum;
+}
+
+static void
+pg_stream_count_rx (pg_stream_t *s, u32 n_packets, u64 n_bytes)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vnet_sw_interface_t *si =
+    vnet_get_sw_interface (vnm, s->sw_if_index[VLIB_RX]);
 
+  vlib_increment_combined_counter (im->combined_sw_if_counters
+				   + VNET_INTERFACE_COUNTER_RX,
+				   vlib_get_thread_index (),
+				   si->sw_if_index, n_packets, n_bytes);
 }
 
 static void
@@ -1184,7 +1187,8 @@ pg_stream_fill_helper (pg_main_t * pg,
 
   if (is_start_of_packet)
     {
-      pg_generate_set_lengths (pg, s, buffers, n_alloc);
+      pg_stream_count_rx (s, n_alloc,
+			  pg_generate_set_lengths (pg, s, buffers, n_alloc));
       if (vec_len (s->buffer_indices) > 1)
 	pg_generate_fix_multi_buffer_lengths (pg, s, buffers, n_alloc);
 
@@ -1401,6 +1405,83 @@ pg_stream_fill (pg_main_t * pg, pg_stream_t * s, u32 n_buffers)
   return n_in_fifo + n_added;
 }
 
+/* Run the stream edits once over n_packet_templates packets and keep the
+   results, generating a packet is then a copy of the next template. */
+void
+pg_stream_build_templates (pg_main_t *pg, pg_stream_t *s)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  u32 buffers[VLIB_FRAME_SIZE];
+  u32 i, n_alloc;
+
+  ASSERT (vec_len (s->buffer_indices) == 1);
+
+  while (vec_len (s->packet_templates) < s->n_packet_templates)
+    {
+      n_alloc = clib_min (VLIB_FRAME_SIZE, s->n_packet_templates -
+					     vec_len (s->packet_templates));
+      n_alloc = vlib_buffer_alloc (vm, buffers, n_alloc);
+      if (n_alloc == 0)
+	break;
+
+      init_buffers_inline (vm, s, buffers, n_alloc, 0 /* data offset */,
+			   s->buffer_bytes, /* set_data */ 1);
+      pg_generate_set_lengths (pg, s, buffers, n_alloc);
+      pg_generate_edit (pg, s, buffers, n_alloc);
+
+      for (i = 0; i < n_alloc; i++)
+	{
+	  vlib_buffer_t *b = vlib_get_buffer (vm, buffers[i]);
+	  u8 *t = 0;
+
+	  vec_add (t, vlib_buffer_get_current (b), b->current_length);
+	  vec_add1 (s->packet_templates, t);
+	}
+
+      vlib_buffer_free_no_next (vm, buffers, n_alloc);
+    }
+}
+
+static_always_inline u32
+pg_stream_fill_from_templates (vlib_main_t *vm, pg_stream_t *s,
+			       pg_stream_worker_t *w, u32 *buffers,
+			       u32 n_buffers)
+{
+  u8 **templates = pg_stream_get_templates (s);
+  u32 n_templates = vec_len (templates);
+  u32 ti = w->template_index;
+  u32 i, n_alloc;
+  u64 n_bytes = 0;
+
+  if (PREDICT_FALSE (n_templates == 0))
+    return 0;
+
+  n_alloc = vlib_buffer_alloc (vm, buffers, n_buffers);
+
+  for (i = 0; i < n_alloc; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, buffers[i]);
+      u8 *t = templates[ti];
+      u32 len = vec_len (t);
+
+      if (i + 4 < n_alloc)
+	vlib_prefetch_buffer_with_index (vm, buffers[i + 4], STORE);
+
+      b->flags |= s->buffer_flags;
+      b->current_length = len;
+      vnet_buffer (b)->sw_if_index[VLIB_RX] = s->sw_if_index[VLIB_RX];
+      vnet_buffer (b)->sw_if_index[VLIB_TX] = s->sw_if_index[VLIB_TX];
+      clib_memcpy_fast (b->data, t, len);
+      n_bytes += len;
+
+      ti = (ti + 1 == n_templates) ? 0 : ti + 1;
+    }
+
+  w->template_index = ti;
+  pg_stream_count_rx (s, n_alloc, n_bytes);
+  return n_alloc;
+}
+
 typedef struct
 {
   u32 stream_index;
@@ -1624,7 +1705,8 @@ fill_buffer_offload_flags (vlib_main_t *vm, u32 *buffers, u32 n_buffers,
 static uword
 pg_generate_packets (vlib_node_runtime_t * node,
 		     pg_main_t * pg,
-		     pg_stream_t * s, uword n_packets_to_generate)
+		     pg_stream_t * s, pg_stream_worker_t * w,
+		     uword n_packets_to_generate)
 {
   vlib_main_t *vm = vlib_get_main ();
   u32 *to_next, n_this_frame, n_left, n_trace, n_packets_in_fifo;
@@ -1643,8 +1725,13 @@ pg_generate_packets (vlib_node_runtime_t * node,
 			  pg->if_id_by_sw_if_index[s->sw_if_index[VLIB_RX]]);
   bi0 = s->buffer_indices;
 
-  n_packets_in_fifo = pg_stream_fill (pg, s, n_packets_to_generate);
-  n_packets_to_generate = clib_min (n_packets_in_fifo, n_packets_to_generate);
+  /* streams using templates allocate straight into the frame */
+  if (w == 0)
+    {
+      n_packets_in_fifo = pg_stream_fill (pg, s, n_packets_to_generate);
+      n_packets_to_generate =
+	clib_min (n_packets_in_fifo, n_packets_to_generate);
+    }
   n_packets_generated = 0;
 
   if (PREDICT_FALSE
@@ -1689,27 +1776,41 @@ pg_generate_packets (vlib_node_runtime_t * node,
       if (n_this_frame > n_left)
 	n_this_frame = n_left;
 
-      start = bi0->buffer_fifo;
-      end = clib_fifo_end (bi0->buffer_fifo);
-      head = clib_fifo_head (bi0->buffer_fifo);
-
-      if (head + n_this_frame <= end)
-	vlib_buffer_copy_indices (to_next, head, n_this_frame);
-      else
-	{
-	  u32 n = end - head;
-	  vlib_buffer_copy_indices (to_next + 0, head, n);
-	  vlib_buffer_copy_indices (to_next + n, start, n_this_frame - n);
-	}
-
-      if (s->replay_packet_templates == 0)
+      if (w)
 	{
-	  vec_foreach (bi, s->buffer_indices)
-	    clib_fifo_advance_head (bi->buffer_fifo, n_this_frame);
+	  n_this_frame =
+	    pg_stream_fill_from_templates (vm, s, w, to_next, n_this_frame);
+	  if (PREDICT_FALSE (n_this_frame == 0))
+	    {
+	      /* out of buffers, try again next time */
+	      vlib_put_next_frame (vm, node, next_index, n_left);
+	      break;
+	    }
 	}
       else
 	{
-	  clib_fifo_advance_head (bi0->buffer_fifo, n_this_frame);
+	  start = bi0->buffer_fifo;
+	  end = clib_fifo_end (bi0->buffer_fifo);
+	  head = clib_fifo_head (bi0->buffer_fifo);
+
+	  if (head + n_this_frame <= end)
+	    vlib_buffer_copy_indices (to_next, head, n_this_frame);
+	  else
+	    {
+	      u32 n = end - head;
+	      vlib_buffer_copy_indices (to_next + 0, head, n);
+	      vlib_buffer_copy_indices (to_next + n, start, n_this_frame - n);
+	    }
+
+	  if (s->replay_packet_templates == 0)
+	    {
+	      vec_foreach (bi, s->buffer_indices)
+		clib_fifo_advance_head (bi->buffer_fifo, n_this_frame);
+	    }
+	  else
+	    {
+	      clib_fifo_advance_head (bi0->buffer_fifo, n_this_frame);
+	    }
 	}
 
       if (current_config_index != ~(u32) 0)
@@ -1798,13 +1899,60 @@ pg_input_stream (vlib_node_runtime_t * node, pg_main_t * pg, pg_stream_t * s)
     n_packets = s->n_max_frame;
 
   if (n_packets > 0)
-    n_packets = pg_generate_packets (node, pg, s, n_packets);
+    n_packets = pg_generate_packets (node, pg, s, 0, n_packets);
 
   s->n_packets_generated += n_packets;
 
   return n_packets;
 }
 
+/* Same as pg_input_stream, with rate and limit applying to this worker's
+   share of the stream. */
+static uword
+pg_input_stream_templates (vlib_node_runtime_t *node, pg_main_t *pg,
+			   pg_stream_t *s, u32 worker_index)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  pg_stream_worker_t *w = vec_elt_at_index (s->per_worker, worker_index);
+  uword n_packets;
+  f64 time_now, dt;
+
+  if (w->n_packets_limit > 0 && w->n_packets_generated >= w->n_packets_limit)
+    {
+      pg_stream_worker_done (pg, s, worker_index);
+      return 0;
+    }
+
+  time_now = vlib_time_now (vm);
+  if (w->time_last_generate == 0)
+    w->time_last_generate = time_now;
+
+  dt = time_now - w->time_last_generate;
+  w->time_last_generate = time_now;
+
+  n_packets = VLIB_FRAME_SIZE;
+  if (w->rate_packets_per_second > 0)
+    {
+      w->packet_accumulator += dt * w->rate_packets_per_second;
+      n_packets = w->packet_accumulator;
+      w->packet_accumulator -= n_packets;
+    }
+
+  if (w->n_packets_limit > 0
+      && w->n_packets_generated + n_packets > w->n_packets_limit)
+    n_packets = w->n_packets_limit - w->n_packets_generated;
+
+  if (n_packets > s->n_max_frame)
+    n_packets = s->n_max_frame;
+
+  if (n_packets > 0)
+    n_packets = pg_generate_packets (node, pg, s, w, n_packets);
+
+  w->n_packets_generated += n_packets;
+
+  return n_packets;
+}
+
 uword
 pg_input (vlib_main_t * vm, vlib_node_runtime_t * node, vlib_frame_t * frame)
 {
@@ -1819,7 +1967,10 @@ pg_input (vlib_main_t * vm, vlib_node_runtime_t * node, vlib_frame_t * frame)
   /* *INDENT-OFF* */
   clib_bitmap_foreach (i, pg->enabled_streams[worker_index])  {
     pg_stream_t *s = vec_elt_at_index (pg->streams, i);
-    n_packets += pg_input_stream (node, pg, s);
+    if (pg_stream_uses_templates (s))
+      n_packets += pg_input_stream_templates (node, pg, s, worker_index);
+    else
+      n_packets += pg_input_stream (node, pg, s);
   }
   /* *INDENT-ON* */
 
@@ -93,6 +93,24 @@ typedef struct
 
 } pg_buffer_index_t;
 
+/* Packets precomputed by streams using templates, unless specified. */
+#define PG_DEFAULT_N_PACKET_TEMPLATES 1024
+
+/* Per worker state of a stream generated from packet templates. */
+typedef struct
+{
+  /* This worker's share of the stream rate and packet limit. */
+  f64 rate_packets_per_second;
+  u64 n_packets_limit;
+
+  u64 n_packets_generated;
+  f64 time_last_generate;
+  f64 packet_accumulator;
+
+  /* Next template to send. */
+  u32 template_index;
+} pg_stream_worker_t;
+
 typedef struct pg_stream_t
 {
   /* Stream name. */
@@ -103,6 +121,10 @@ typedef struct pg_stream_t
   /* Stream is currently enabled. */
 #define PG_STREAM_FLAGS_IS_ENABLED (1 << 0)
 
+  /* Packets are copied from precomputed templates instead of being
+     edited one by one, see pg_stream_worker_t. */
+#define PG_STREAM_FLAGS_USE_TEMPLATES (1 << 1)
+
   /* Edit groups are created by each protocol level (e.g. ethernet,
      ip4, tcp, ...). */
   pg_edit_group_t *edit_groups;
@@ -151,6 +173,10 @@ typedef struct pg_stream_t
   /* Worker thread index */
   u32 worker_index;
 
+  /* Worker thread indices, streams using templates can run on several
+     workers at once. */
+  uword *workers;
+
   /* Output next index to reach output node from stream input node. */
   u32 next_index;
 
@@ -179,6 +205,16 @@ typedef struct pg_stream_t
   u8 **replay_packet_templates;
   u64 *replay_packet_timestamps;
   u32 current_replay_packet_index;
+
+  /* Number of packets to precompute from edits, and the packets. Streams
+     replaying a pcap use the pcap packets as templates. */
+  u32 n_packet_templates;
+  u8 **packet_templates;
+
+  /* Per worker state, indexed by worker index, and the number of workers
+     still generating. */
+  pg_stream_worker_t *per_worker;
+  u32 n_workers_active;
 } pg_stream_t;
 
 always_inline void
@@ -215,6 +251,11 @@ pg_stream_free (pg_stream_t * s)
     vec_free (s->replay_packet_templates[i]);
   vec_free (s->replay_packet_templates);
   vec_free (s->replay_packet_timestamps);
+  for (i = 0; i < vec_len (s->packet_templates); i++)
+    vec_free (s->packet_templates[i]);
+  vec_free (s->packet_templates);
+  vec_free (s->per_worker);
+  clib_bitmap_free (s->workers);
 
   {
     pg_buffer_index_t *bi;
@@ -229,6 +270,20 @@ pg_stream_is_enabled (pg_stream_t * s)
   return (s->flags & PG_STREAM_FLAGS_IS_ENABLED) != 0;
 }
 
+always_inline int
+pg_stream_uses_templates (pg_stream_t *s)
+{
+  return (s->flags & PG_STREAM_FLAGS_USE_TEMPLATES) != 0;
+}
+
+/* Templates to copy packets from, pcap replays use the pcap packets. */
+always_inline u8 **
+pg_stream_get_templates (pg_stream_t *s)
+{
+  return s->replay_packet_templates ? s->replay_packet_templates :
+				      s->packet_templates;
+}
+
 always_inline pg_edit_group_t *
 pg_stream_get_group (pg_stream_t * s, u32 group_index)
 {
@@ -378,6 +433,12 @@ void pg_stream_change (pg_main_t * pg, pg_stream_t * s);
 void pg_stream_enable_disable (pg_main_t * pg, pg_stream_t * s,
 			       int is_enable);
 
+/* Precompute packet templates from the stream edits. */
+void pg_stream_build_templates (pg_main_t *pg, pg_stream_t *s);
+
+/* A worker reached its share of the stream packet limit. */
+void pg_stream_worker_done (pg_main_t *pg, pg_stream_t *s, u32 worker_index);
+
 /* Enable/disable packet coalesce on given interface */
 void pg_interface_enable_disable_coalesce (pg_interface_t * pi, u8 enable,
 					   u32 tx_node_index);
@@ -44,13 +44,62 @@
 #include <vnet/mpls/mpls.h>
 #include <vnet/devices/devices.h>
 
+static void
+pg_stream_set_worker_enabled (pg_main_t *pg, pg_stream_t *s, u32 worker_index,
+			      int want_enabled)
+{
+  vlib_main_t *vm;
+
+  vec_validate (pg->enabled_streams, worker_index);
+  pg->enabled_streams[worker_index] =
+    clib_bitmap_set (pg->enabled_streams[worker_index], s - pg->streams,
+		     want_enabled);
+
+  if (vlib_num_workers ())
+    vm = vlib_get_worker_vlib_main (worker_index);
+  else
+    vm = vlib_get_main ();
+
+  vlib_node_set_state (vm, pg_input_node.index,
+		       (clib_bitmap_is_zero
+			(pg->enabled_streams[worker_index]) ?
+			VLIB_NODE_STATE_DISABLED : VLIB_NODE_STATE_POLLING));
+}
+
+/* Split rate and packet limit between the workers of a stream using
+   templates, which start at different templates. */
+static void
+pg_stream_init_workers (pg_main_t *pg, pg_stream_t *s)
+{
+  u32 n_workers = clib_bitmap_count_set_bits (s->workers);
+  u32 n_templates = vec_len (pg_stream_get_templates (s));
+  u32 i, k = 0;
+
+  vec_validate (s->per_worker, clib_bitmap_last_set (s->workers));
+
+  clib_bitmap_foreach (i, s->workers)
+    {
+      pg_stream_worker_t *w = vec_elt_at_index (s->per_worker, i);
+
+      clib_memset (w, 0, sizeof (w[0]));
+      w->rate_packets_per_second = s->rate_packets_per_second / n_workers;
+      w->n_packets_limit = s->n_packets_limit / n_workers;
+      if (k < s->n_packets_limit % n_workers)
+	w->n_packets_limit++;
+      w->template_index = (u64) k * n_templates / n_workers;
+      k++;
+    }
+
+  s->n_workers_active = n_workers;
+}
+
 /* Mark stream active or inactive. */
 void
 pg_stream_enable_disable (pg_main_t * pg, pg_stream_t * s, int want_enabled)
 {
-  vlib_main_t *vm;
   vnet_main_t *vnm = vnet_get_main ();
   pg_interface_t *pi = pool_elt_at_index (pg->interfaces, s->pg_if_index);
+  u32 i;
 
   want_enabled = want_enabled != 0;
 
@@ -66,10 +115,12 @@ pg_stream_enable_disable (pg_main_t * pg, pg_stream_t * s, int want_enabled)
 
   ASSERT (!pool_is_free (pg->streams, s));
 
-  vec_validate (pg->enabled_streams, s->worker_index);
-  pg->enabled_streams[s->worker_index] =
-    clib_bitmap_set (pg->enabled_streams[s->worker_index], s - pg->streams,
-		     want_enabled);
+  if (want_enabled && pg_stream_uses_templates (s))
+    {
+      if (pg_stream_get_templates (s) == 0)
+	pg_stream_build_templates (pg, s);
+      pg_stream_init_workers (pg, s);
+    }
 
   if (want_enabled)
     {
@@ -80,20 +131,24 @@ pg_stream_enable_disable (pg_main_t * pg, pg_stream_t * s, int want_enabled)
 				   VNET_SW_INTERFACE_FLAG_ADMIN_UP);
     }
 
-  if (vlib_num_workers ())
-    vm = vlib_get_worker_vlib_main (s->worker_index);
-  else
-    vm = vlib_get_main ();
-
-  vlib_node_set_state (vm, pg_input_node.index,
-		       (clib_bitmap_is_zero
-			(pg->enabled_streams[s->worker_index]) ?
-			VLIB_NODE_STATE_DISABLED : VLIB_NODE_STATE_POLLING));
+  clib_bitmap_foreach (i, s->workers)
+    pg_stream_set_worker_enabled (pg, s, i, want_enabled);
 
   s->packet_accumulator = 0;
   s->time_last_generate = 0;
 }
 
+/* Called on the worker itself, the stream is disabled once the last of
+   its workers is done. */
+void
+pg_stream_worker_done (pg_main_t *pg, pg_stream_t *s, u32 worker_index)
+{
+  pg_stream_set_worker_enabled (pg, s, worker_index, 0);
+
+  if (clib_atomic_sub_fetch (&s->n_workers_active, 1) == 0)
+    clib_atomic_fetch_and (&s->flags, ~PG_STREAM_FLAGS_IS_ENABLED);
+}
+
 static u8 *
 format_pg_output_trace (u8 * s, va_list * va)
 {
@@ -503,6 +558,10 @@ pg_stream_add (pg_main_t * pg, pg_stream_t * s_init)
   pool_get (pg->streams, s);
   s[0] = s_init[0];
 
+  if (clib_bitmap_is_zero (s->workers))
+    s->workers = clib_bitmap_set (s->workers, s->worker_index, 1);
+  s->worker_index = clib_bitmap_first_set (s->workers);
+
   /* Give it a name. */
   if (!s->name)
     s->name = format (0, "stream%d", s - pg->streams);
@@ -609,6 +668,20 @@ pg_stream_change (pg_main_t * pg, pg_stream_t * s)
     }
 
   s->last_increment_packet_size = s->min_packet_bytes;
+
+  /* Templates have the old sizes and workers the old rate and limit, start
+     over. */
+  if (pg_stream_uses_templates (s))
+    {
+      int is_enabled = pg_stream_is_enabled (s);
+      u32 i;
+
+      pg_stream_enable_disable (pg, s, 0);
+      for (i = 0; i < vec_len (s->packet_templates); i++)
+	vec_free (s->packet_templates[i]);
+      vec_free (s->packet_templates);
+      pg_stream_enable_disable (pg, s, is_enabled);
+    }
 }
 
 
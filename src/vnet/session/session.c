@@ -104,12 +104,12 @@ session_send_ctrl_evt_to_thread (session_t * s, session_evt_type_t evt_type)
   return session_send_evt_to_thread (s, 0, s->thread_index, evt_type);
 }
 
-void
+int
 session_send_rpc_evt_to_thread_force (u32 thread_index, void *fp,
 				      void *rpc_args)
 {
-  session_send_evt_to_thread (fp, rpc_args, thread_index,
-			      SESSION_CTRL_EVT_RPC);
+  return session_send_evt_to_thread (fp, rpc_args, thread_index,
+				     SESSION_CTRL_EVT_RPC);
 }
 
 void
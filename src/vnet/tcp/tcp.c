@@ -1536,6 +1536,12 @@ tcp_main_enable (vlib_main_t * vm)
 
   tcp_initialize_iss_seed (tm);
 
+  tm->rtt_histogram.name = "tcp rtt";
+  tm->rtt_histogram.stat_segment_name = "/net/tcp/rtt_us";
+  tm->rtt_histogram.n_buckets = TCP_RTT_HIST_N_BUCKETS;
+  tm->rtt_histogram.log2_sub_buckets = TCP_RTT_HIST_LOG2_SUB_BUCKETS;
+  vlib_validate_histogram (&tm->rtt_histogram, 0);
+
   tm->bytes_per_buffer = vlib_buffer_get_default_data_size (vm);
   tm->cc_last_type = TCP_CC_LAST;
 
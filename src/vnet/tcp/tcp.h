@@ -204,6 +204,10 @@ typedef struct tcp_configuration_
   f64 buffer_fail_fraction;
 } tcp_configuration_t;
 
+/** RTT histogram, 4 buckets per power of two up to TCP_RTT_MAX us */
+#define TCP_RTT_HIST_LOG2_SUB_BUCKETS 2
+#define TCP_RTT_HIST_N_BUCKETS	      96
+
 typedef struct _tcp_main
 {
   /** per-worker context */
@@ -253,6 +257,9 @@ typedef struct _tcp_main
 
   /** message ID base for API */
   u16 msg_id_base;
+
+  /** Valid RTT samples, in us, exported as /net/tcp/rtt_us */
+  vlib_histogram_main_t rtt_histogram;
 } tcp_main_t;
 
 extern tcp_main_t tcp_main;
@@ -860,6 +860,10 @@ show_tcp_stats_fn (vlib_main_t * vm, unformat_input_t * input,
 #undef _
     }
 
+  if (tm->rtt_histogram.counters)
+    vlib_cli_output (vm, "RTT us: %U", format_vlib_histogram,
+		     &tm->rtt_histogram, 0);
+
   return 0;
 }
 
@@ -889,6 +893,7 @@ clear_tcp_stats_fn (vlib_main_t * vm, unformat_input_t * input,
       wrk = tcp_get_worker (thread);
       clib_memset (&wrk->stats, 0, sizeof (wrk->stats));
     }
+  vlib_clear_histograms (&tm->rtt_histogram);
 
   return 0;
 }
@@ -511,6 +511,7 @@ estimate_rtt:
   if (mrtt == 0 || mrtt > TCP_RTT_MAX)
     goto done;
 
+  vlib_histogram_add (&tcp_main.rtt_histogram, tc->c_thread_index, 0, mrtt);
   tcp_estimate_rtt (tc, mrtt);
 
 done:
@@ -66,7 +66,8 @@ typedef struct
   u8 pcap_tx_enable;
   /* Trace drop pkts */
   u8 pcap_drop_enable;
-  u8 pad1;
+  /* Stream to rotating pcapng files instead of pcap_main */
+  u8 pcap_stream_enable;
   u32 max_bytes_per_pkt;
   u32 pcap_sw_if_index;
   pcap_main_t pcap_main;
@@ -74,6 +75,32 @@ typedef struct
   vlib_error_t pcap_error_index;
 } vnet_pcap_t;
 
+/* Latency histograms count nanoseconds in power of two buckets, the
+   last one, from 2^(N_BUCKETS - 2) ns, is open ended */
+#define VNET_LATENCY_N_BUCKETS		28
+#define VNET_LATENCY_LOG2_SUB_BUCKETS	0
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* Received packets to skip before the next one is stamped */
+  u32 countdown;
+  u32 seed;
+} vnet_latency_per_thread_t;
+
+typedef struct
+{
+  /* Stamp one in sample_interval received packets, 0 when off */
+  u32 sample_interval;
+  vnet_latency_per_thread_t *per_thread;
+
+  /* Nanosecond histograms, indexed by rx_sw_if_index */
+  vlib_histogram_main_t rx_tx_hist;
+  vlib_histogram_main_t handoff_hist;
+  u32 n_validated_sw_if_index;
+  f64 ns_per_clock;
+} vnet_latency_t;
+
 typedef struct vnet_main_t
 {
   u32 local_interface_hw_if_index;
@@ -103,6 +130,9 @@ typedef struct vnet_main_t
     /* pcap rx / tx tracing */
     vnet_pcap_t pcap;
 
+    /* sampled rx to tx latency tracking */
+    vnet_latency_t latency;
+
     /*
      * Last "api" error, preserved so we can issue reasonable diagnostics
      * at or near the top of the food chain
@@ -218,6 +218,60 @@ stat_vec_combined_init (vlib_counter_t c)
   return v;
 }
 
+/*
+ * Sum the per-thread histograms, each self-describing, see
+ * vlib_histogram_layout (). If index2 is specified only that one is merged.
+ */
+static stat_histogram_t *
+stat_histogram_merge (stat_client_main_t *sm, counter_t **threads,
+		      u32 index2)
+{
+  stat_histogram_t *res = 0, *h;
+  counter_t *cb, *c;
+  u32 stride, n_buckets, first, last, i, j, b;
+
+  for (i = 0; i < vec_len (threads); i++)
+    {
+      cb = stat_segment_adjust (sm, threads[i]);
+      if (!cb || vec_len (cb) == 0)
+	continue;
+      stride = vlib_histogram_layout_stride (cb[VLIB_HISTOGRAM_LAYOUT]);
+      n_buckets = vlib_histogram_layout_n_buckets (cb[VLIB_HISTOGRAM_LAYOUT]);
+      if (stride < VLIB_HISTOGRAM_BUCKETS + n_buckets)
+	continue;
+
+      first = 0;
+      last = vec_len (cb) / stride;
+      if (index2 != ~0)
+	{
+	  if (index2 >= last)
+	    continue;
+	  first = index2;
+	  last = index2 + 1;
+	}
+      vec_validate (res, last - first - 1);
+
+      for (j = first; j < last; j++)
+	{
+	  c = cb + j * stride;
+	  h = res + j - first;
+	  if (!h->buckets)
+	    {
+	      h->log2_sub_buckets =
+		vlib_histogram_layout_log2_sub_buckets (c[0]);
+	      vec_validate (h->buckets, n_buckets - 1);
+	    }
+	  h->sum += c[VLIB_HISTOGRAM_SUM];
+	  for (b = 0; b < n_buckets && b < vec_len (h->buckets); b++)
+	    {
+	      h->buckets[b] += c[VLIB_HISTOGRAM_BUCKETS + b];
+	      h->count += c[VLIB_HISTOGRAM_BUCKETS + b];
+	    }
+	}
+    }
+  return res;
+}
+
 /*
  * If index2 is specified copy out the column (the indexed value across all
  * threads), otherwise copy out all values.
@@ -244,6 +298,7 @@ copy_data (stat_segment_directory_entry_t *ep, u32 index2, char *name,
       break;
 
     case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
+    case STAT_DIR_TYPE_GAUGE_VECTOR:
       simple_c = stat_segment_adjust (sm, ep->data);
       result.simple_counter_vec = stat_vec_dup (sm, simple_c);
       for (i = 0; i < vec_len (simple_c); i++)
@@ -270,6 +325,11 @@ copy_data (stat_segment_directory_entry_t *ep, u32 index2, char *name,
 	}
       break;
 
+    case STAT_DIR_TYPE_HISTOGRAM_VECTOR:
+      simple_c = stat_segment_adjust (sm, ep->data);
+      result.histogram_vec = stat_histogram_merge (sm, simple_c, index2);
+      break;
+
     case STAT_DIR_TYPE_ERROR_INDEX:
       /* Gather errors from all threads into a vector */
       error_vector =
@@ -320,6 +380,7 @@ stat_segment_data_free (stat_segment_data_t * res)
       switch (res[i].type)
 	{
 	case STAT_DIR_TYPE_COUNTER_VECTOR_SIMPLE:
+	case STAT_DIR_TYPE_GAUGE_VECTOR:
 	  for (j = 0; j < vec_len (res[i].simple_counter_vec); j++)
 	    vec_free (res[i].simple_counter_vec[j]);
 	  vec_free (res[i].simple_counter_vec);
@@ -334,6 +395,11 @@ stat_segment_data_free (stat_segment_data_t * res)
 	    vec_free (res[i].name_vector[j]);
 	  vec_free (res[i].name_vector);
 	  break;
+	case STAT_DIR_TYPE_HISTOGRAM_VECTOR:
+	  for (j = 0; j < vec_len (res[i].histogram_vec); j++)
+	    vec_free (res[i].histogram_vec[j].buckets);
+	  vec_free (res[i].histogram_vec);
+	  break;
 	case STAT_DIR_TYPE_ERROR_INDEX:
 	  vec_free (res[i].error_vector);
 	  break;
@@ -18,7 +18,7 @@
 #define included_stat_client_h
 
 #define STAT_VERSION_MAJOR     1
-#define STAT_VERSION_MINOR     2
+#define STAT_VERSION_MINOR     3
 
 #include <stdint.h>
 #include <unistd.h>
@@ -32,6 +32,15 @@
 #define STAT_SEGMENT_SOCKET_FILE "/run/vpp/stats.sock"
 #define STAT_SEGMENT_SOCKET_FILENAME "stats.sock"
 
+/* A histogram, merged across threads, see vlib_histogram_bucket () */
+typedef struct
+{
+  counter_t count;		/* of values counted */
+  counter_t sum;		/* of values counted */
+  uint32_t log2_sub_buckets;
+  counter_t *buckets;		/* vector */
+} stat_histogram_t;
+
 typedef struct
 {
   char *name;
@@ -43,6 +52,7 @@ typedef struct
     counter_t **simple_counter_vec;
     vlib_counter_t **combined_counter_vec;
     uint8_t **name_vector;
+    stat_histogram_t *histogram_vec;
   };
 } stat_segment_data_t;
 
@@ -392,6 +392,43 @@ class SimpleList(list):
         '''Sum the vector'''
         return sum(self)
 
+class StatsHistogram():
+    '''A log-linear histogram, merged across threads'''
+
+    def __init__(self, log2_sub_buckets, n_buckets):
+        self.log2_sub_buckets = log2_sub_buckets
+        self.buckets = [0] * n_buckets
+        self.sum = 0
+        self.count = 0
+
+    def __repr__(self):
+        return 'count %d sum %d buckets %s' % (self.count, self.sum,
+                                               self.buckets)
+
+    def add(self, value_sum, buckets):
+        '''Add the sum and buckets of another thread'''
+        self.sum += value_sum
+        for i, value in enumerate(buckets[:len(self.buckets)]):
+            self.buckets[i] += value
+            self.count += value
+
+    def bucket_min(self, bucket):
+        '''Smallest value counted in bucket'''
+        octave = bucket >> self.log2_sub_buckets
+        if octave == 0:
+            return bucket
+        sub = bucket & ((1 << self.log2_sub_buckets) - 1)
+        return ((1 << self.log2_sub_buckets) | sub) << (octave - 1)
+
+class StatsHistogramList(list):
+    '''Histograms by index'''
+
+    def __getitem__(self, item):
+        '''Histograms are already merged, [:,1] is the same as [1]'''
+        if isinstance(item, int):
+            return list.__getitem__(self, item)
+        return list.__getitem__(self, item[1])
+
 class StatsEntry():
     '''An individual stats entry'''
     # pylint: disable=unused-argument,no-self-use
@@ -412,6 +449,10 @@ class StatsEntry():
             self.function = self.name
         elif stattype == 7:
             self.function = self.symlink
+        elif stattype == 8:
+            self.function = self.simple
+        elif stattype == 9:
+            self.function = self.histogram
         else:
             self.function = self.illegal
 
@@ -439,6 +480,24 @@ class StatsEntry():
             counter.append(clist)
         return counter
 
+    def histogram(self, stats):
+        '''Histogram counter, see vlib_histogram_layout ()'''
+        counter = StatsHistogramList()
+        for threads in StatsVector(stats, self.value, 'P'):
+            values = [v[0] for v in StatsVector(stats, threads[0], 'Q')]
+            if not values:
+                continue
+            stride = values[0] >> 32
+            n_buckets = (values[0] >> 8) & 0xffffff
+            if stride < 2 + n_buckets:
+                continue
+            for j in range(len(values) // stride):
+                hist = values[j * stride:j * stride + 2 + n_buckets]
+                if j == len(counter):
+                    counter.append(StatsHistogram(hist[0] & 0xff, n_buckets))
+                counter[j].add(hist[1], hist[2:])
+        return counter
+
     def error(self, stats):
         '''Error counter'''
         counter = SimpleList()
@@ -70,6 +70,20 @@ stat_poll_loop (u8 ** patterns)
 			   j, res[i].simple_counter_vec[k][j], res[i].name);
 	      break;
 
+	    case STAT_DIR_TYPE_GAUGE_VECTOR:
+	      for (k = 0; k < vec_len (res[i].simple_counter_vec); k++)
+		for (j = 0; j < vec_len (res[i].simple_counter_vec[k]); j++)
+		  fformat (stdout, "[%d]: %llu %s\n", j,
+			   res[i].simple_counter_vec[k][j], res[i].name);
+	      break;
+
+	    case STAT_DIR_TYPE_HISTOGRAM_VECTOR:
+	      for (j = 0; j < vec_len (res[i].histogram_vec); j++)
+		fformat (stdout, "[%d]: %llu count, %llu sum %s\n", j,
+			 res[i].histogram_vec[j].count,
+			 res[i].histogram_vec[j].sum, res[i].name);
+	      break;
+
 	    case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
 	      for (k = 0; k < vec_len (res[i].simple_counter_vec); k++)
 		for (j = 0; j < vec_len (res[i].combined_counter_vec[k]); j++)
@@ -206,6 +220,31 @@ reconnect:
 			   res[i].name);
 	      break;
 
+	    case STAT_DIR_TYPE_GAUGE_VECTOR:
+	      if (res[i].simple_counter_vec == 0)
+		continue;
+	      for (k = 0; k < vec_len (res[i].simple_counter_vec); k++)
+		for (j = 0; j < vec_len (res[i].simple_counter_vec[k]); j++)
+		  fformat (stdout, "[%d @ %d]: %llu %s\n", j, k,
+			   res[i].simple_counter_vec[k][j], res[i].name);
+	      break;
+
+	    case STAT_DIR_TYPE_HISTOGRAM_VECTOR:
+	      for (j = 0; j < vec_len (res[i].histogram_vec); j++)
+		{
+		  stat_histogram_t *h = res[i].histogram_vec + j;
+		  fformat (stdout, "[%d]: %llu count, %llu sum %s\n", j,
+			   h->count, h->sum, res[i].name);
+		  for (k = 0; k < vec_len (h->buckets); k++)
+		    if (h->buckets[k])
+		      fformat (stdout, "[%d]:   %llu >= %llu %s\n", j,
+			       h->buckets[k],
+			       vlib_histogram_bucket_min (k,
+							  h->log2_sub_buckets),
+			       res[i].name);
+		}
+	      break;
+
 	    case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
 	      if (res[i].combined_counter_vec == 0)
 		continue;
@@ -48,6 +48,27 @@ prom_string (char *s)
   return s;
 }
 
+static void
+dump_histogram (FILE *stream, char *name, int index, stat_histogram_t *h)
+{
+  counter_t seen = 0;
+  int b, last = vec_len (h->buckets) - 1;
+
+  /* The last bucket is open ended, it only shows up as +Inf */
+  for (b = 0; b < last; b++)
+    {
+      seen += h->buckets[b];
+      fformat (stream, "%s_bucket{index=\"%d\",le=\"%lld\"} %lld\n", name,
+	       index,
+	       vlib_histogram_bucket_min (b + 1, h->log2_sub_buckets) - 1,
+	       seen);
+    }
+  fformat (stream, "%s_bucket{index=\"%d\",le=\"+Inf\"} %lld\n", name,
+	   index, h->count);
+  fformat (stream, "%s_sum{index=\"%d\"} %lld\n", name, index, h->sum);
+  fformat (stream, "%s_count{index=\"%d\"} %lld\n", name, index, h->count);
+}
+
 static void
 dump_metrics (FILE * stream, u8 ** patterns)
 {
@@ -78,6 +99,23 @@ retry:
 		       res[i].simple_counter_vec[k][j]);
 	  break;
 
+	case STAT_DIR_TYPE_GAUGE_VECTOR:
+	  fformat (stream, "# TYPE %s gauge\n", prom_string (res[i].name));
+	  for (k = 0; k < vec_len (res[i].simple_counter_vec); k++)
+	    for (j = 0; j < vec_len (res[i].simple_counter_vec[k]); j++)
+	      fformat (stream, "%s{thread=\"%d\",interface=\"%d\"} %lld\n",
+		       prom_string (res[i].name), k, j,
+		       res[i].simple_counter_vec[k][j]);
+	  break;
+
+	case STAT_DIR_TYPE_HISTOGRAM_VECTOR:
+	  fformat (stream, "# TYPE %s histogram\n", prom_string (res[i].name));
+	  for (j = 0; j < vec_len (res[i].histogram_vec); j++)
+	    if (res[i].histogram_vec[j].count)
+	      dump_histogram (stream, res[i].name, j,
+			      res[i].histogram_vec + j);
+	  break;
+
 	case STAT_DIR_TYPE_COUNTER_VECTOR_COMBINED:
 	  fformat (stream, "# TYPE %s_packets counter\n",
 		   prom_string (res[i].name));
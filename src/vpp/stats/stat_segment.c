@@ -481,6 +481,11 @@ vlib_map_stat_segment_init (void)
   sm->directory_vector_by_name = hash_create_string (0, sizeof (uword));
   sm->shared_header = shared_header = memaddr;
 
+  sm->node_profile_hist.name = "node clocks per vector";
+  sm->node_profile_hist.stat_segment_name = "/sys/node/clocks_per_vector_hist";
+  sm->node_profile_hist.n_buckets = VLIB_NODE_PROFILE_N_BUCKETS;
+  sm->node_profile_hist.log2_sub_buckets = VLIB_NODE_PROFILE_LOG2_SUB_BUCKETS;
+
   shared_header->version = STAT_SEGMENT_VERSION;
   shared_header->base = memaddr;
 
@@ -541,6 +546,14 @@ format_stat_dir_entry (u8 * s, va_list * args)
       type_name = "CMainPtr";
       break;
 
+    case STAT_DIR_TYPE_GAUGE_VECTOR:
+      type_name = "GMainPtr";
+      break;
+
+    case STAT_DIR_TYPE_HISTOGRAM_VECTOR:
+      type_name = "HMainPtr";
+      break;
+
     case STAT_DIR_TYPE_ERROR_INDEX:
       type_name = "ErrIndex";
       break;
@@ -644,6 +657,33 @@ VLIB_CLI_COMMAND (show_stat_segment_command, static) =
  * total suspends
  */
 
+/*
+ * Dispatch profiler, see vlib_node_profile_t:
+ * max_clocks [threads][node-index], worst dispatch since last update
+ * clocks_per_vector_hist [threads], a histogram per node-index
+ */
+static void
+update_node_profile (stat_segment_main_t *sm, u32 thread_index,
+		     u32 node_index, vlib_node_profile_t *p)
+{
+  vlib_histogram_main_t *hm = &sm->node_profile_hist;
+  counter_t **counters;
+  counter_t *c;
+  int i;
+
+  counters = sm->directory_vector[STAT_COUNTER_NODE_MAX_CLOCKS].data;
+  counters[thread_index][node_index] =
+    clib_atomic_swap_acq_n (&p->max_clocks, 0);
+
+  /* The owner thread bumps 32-bit buckets without atomics; accumulate
+     their deltas so the exported counters don't wrap. */
+  c = hm->counters[thread_index] + node_index * hm->stride;
+  for (i = 0; i < VLIB_NODE_PROFILE_N_BUCKETS; i++)
+    c[VLIB_HISTOGRAM_BUCKETS + i] +=
+      (u32) (p->clocks_per_vector[i] - (u32) c[VLIB_HISTOGRAM_BUCKETS + i]);
+  c[VLIB_HISTOGRAM_SUM] = p->clocks_per_vector_sum;
+}
+
 static inline void
 update_node_counters (stat_segment_main_t * sm)
 {
@@ -664,6 +704,9 @@ update_node_counters (stat_segment_main_t * sm)
    */
   if (l > no_max_nodes)
     {
+      /* Registers itself, takes the stat segment lock */
+      vlib_validate_histogram (&sm->node_profile_hist, l - 1);
+
       void *oldheap = clib_mem_set_heap (sm->heap);
       vlib_stat_segment_lock ();
 
@@ -675,6 +718,8 @@ update_node_counters (stat_segment_main_t * sm)
 	&sm->directory_vector[STAT_COUNTER_NODE_CALLS], l - 1);
       stat_validate_counter_vector (
 	&sm->directory_vector[STAT_COUNTER_NODE_SUSPENDS], l - 1);
+      stat_validate_counter_vector (
+	&sm->directory_vector[STAT_COUNTER_NODE_MAX_CLOCKS], l - 1);
 
       vec_validate (sm->nodes, l - 1);
       stat_segment_directory_entry_t *ep;
@@ -711,6 +756,7 @@ update_node_counters (stat_segment_main_t * sm)
   for (j = 0; j < vec_len (node_dups); j++)
     {
       vlib_node_t **nodes = node_dups[j];
+      vlib_node_main_t *nm = &stat_vms[j]->node_main;
 
       for (i = 0; i < vec_len (nodes); i++)
 	{
@@ -766,6 +812,11 @@ update_node_counters (stat_segment_main_t * sm)
 	  counters = sm->directory_vector[STAT_COUNTER_NODE_SUSPENDS].data;
 	  c = counters[j];
 	  c[n->index] = n->stats_total.suspends - n->stats_last_clear.suspends;
+
+	  if (n->index < vec_len (nm->node_profiles))
+	    update_node_profile (sm, j, n->index,
+				 vec_elt_at_index (nm->node_profiles,
+						   n->index));
 	}
       vec_free (node_dups[j]);
     }
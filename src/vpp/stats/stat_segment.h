@@ -33,6 +33,7 @@ typedef enum
   STAT_COUNTER_NODE_SUSPENDS,
   STAT_COUNTER_INTERFACE_NAMES,
   STAT_COUNTER_NODE_NAMES,
+  STAT_COUNTER_NODE_MAX_CLOCKS,
   STAT_COUNTERS
 } stat_segment_counter_t;
 
@@ -41,7 +42,8 @@ typedef enum
   _ (NODE_CLOCKS, COUNTER_VECTOR_SIMPLE, clocks, /sys/node)                   \
   _ (NODE_VECTORS, COUNTER_VECTOR_SIMPLE, vectors, /sys/node)                 \
   _ (NODE_CALLS, COUNTER_VECTOR_SIMPLE, calls, /sys/node)                     \
-  _ (NODE_SUSPENDS, COUNTER_VECTOR_SIMPLE, suspends, /sys/node)
+  _ (NODE_SUSPENDS, COUNTER_VECTOR_SIMPLE, suspends, /sys/node)              \
+  _ (NODE_MAX_CLOCKS, GAUGE_VECTOR, max_clocks, /sys/node)
 
 #define foreach_stat_segment_counter_name                                     \
   _ (NUM_WORKER_THREADS, SCALAR_INDEX, num_worker_threads, /sys)              \
@@ -82,6 +84,9 @@ typedef struct
   u8 **interfaces;
   u8 **nodes;
 
+  /* Dispatch profiler histograms, by node index */
+  vlib_histogram_main_t node_profile_hist;
+
   /* Update interval */
   f64 update_interval;
 
@@ -26,6 +26,8 @@ typedef enum
   STAT_DIR_TYPE_NAME_VECTOR,
   STAT_DIR_TYPE_EMPTY,
   STAT_DIR_TYPE_SYMLINK,
+  STAT_DIR_TYPE_GAUGE_VECTOR,
+  STAT_DIR_TYPE_HISTOGRAM_VECTOR,
 } stat_directory_type_t;
 
 typedef struct
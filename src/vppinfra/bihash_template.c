@@ -204,6 +204,7 @@ void BV (clib_bihash_init2) (BVT (clib_bihash_init2_args) * a)
   h->dont_add_to_all_bihash_list = a->dont_add_to_all_bihash_list;
   h->fmt_fn = BV (format_bihash);
   h->kvp_fmt_fn = a->kvp_fmt_fn;
+  h->qsbr = a->qsbr ? a->qsbr : &clib_qsbr_main;
 
   alloc_arena (h) = 0;
 
@@ -276,6 +277,8 @@ void BV (clib_bihash_initiator_init_svm)
   ASSERT (BIHASH_USE_HEAP == 0);
 
   ASSERT (memory_size < (1ULL << 32));
+  /* readers live in other processes, nothing to track */
+  h->qsbr = 0;
   /* Set up for memfd sharing */
   if ((fd = clib_mem_vm_create_fd (CLIB_MEM_PAGE_SZ_DEFAULT, name) == -1)
     {
@@ -346,6 +349,7 @@ void BV (clib_bihash_responder_init_svm)
   BVT (clib_bihash_shared_header) * sh;
 
   ASSERT (BIHASH_USE_HEAP == 0);
+  h->qsbr = 0;
 
   /* Trial mapping, to learn the segment size */
   mmap_addr = mmap (0, 4096, PROT_READ, MAP_SHARED, fd, 0 /* offset */ );
@@ -407,6 +411,17 @@ void BV (clib_bihash_free) (BVT (clib_bihash) * h)
   if (PREDICT_FALSE (h->instantiated == 0))
     goto never_initialized;
 
+  /*
+   * Recycled pages may still be waiting for a grace period. Only the
+   * main thread may wait for one: main could be spinning at the barrier
+   * for a worker waiting here, and never go quiescent.
+   */
+  if (h->qsbr && clib_qsbr_n_pending (h->qsbr))
+    {
+      ASSERT (os_get_thread_index () == 0);
+      clib_qsbr_synchronize (h->qsbr, os_get_thread_index ());
+    }
+
   h->instantiated = 0;
 
   if (BIHASH_USE_HEAP)
@@ -524,6 +539,48 @@ BV (value_free) (BVT (clib_bihash) * h, BVT (clib_bihash_value) * v,
   h->freelists[log2_pages] = (u64) BV (clib_bihash_get_offset) (h, v);
 }
 
+typedef struct
+{
+  BVT (clib_bihash) * h;
+  BVT (clib_bihash_value) * v;
+  u32 log2_pages;
+} BVT (clib_bihash_qsbr_free);
+
+static void
+BV (value_free_qsbr_cb) (void *data)
+{
+  BVT (clib_bihash_qsbr_free) * f = data;
+
+  BV (clib_bihash_alloc_lock) (f->h);
+  BV (value_free) (f->h, f->v, f->log2_pages);
+  BV (clib_bihash_alloc_unlock) (f->h);
+  clib_mem_free (f);
+}
+
+/*
+ * Free pages which lock-free readers may still be walking. Defer
+ * recycling until every reader has gone through a quiescent state,
+ * so a reader never sees the page reused for another bucket.
+ */
+static void
+BV (value_free_qsbr) (BVT (clib_bihash) * h, BVT (clib_bihash_value) * v,
+		      u32 log2_pages)
+{
+  BVT (clib_bihash_qsbr_free) * f;
+
+  if (h->qsbr == 0 || !clib_qsbr_is_enabled (h->qsbr))
+    {
+      BV (value_free) (h, v, log2_pages);
+      return;
+    }
+
+  f = clib_mem_alloc (sizeof (*f));
+  f->h = h;
+  f->v = v;
+  f->log2_pages = log2_pages;
+  clib_qsbr_call_after_grace_period (h->qsbr, BV (value_free_qsbr_cb), f);
+}
+
 static inline void
 BV (make_working_copy) (BVT (clib_bihash) * h, BVT (clib_bihash_bucket) * b)
 {
@@ -872,7 +929,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
 		  BV (clib_bihash_alloc_lock) (h);
 		  /* Note: v currently points into the middle of the bucket */
 		  v = BV (clib_bihash_get_value) (h, tmp_b.offset);
-		  BV (value_free) (h, v, tmp_b.log2_pages);
+		  BV (value_free_qsbr) (h, v, tmp_b.log2_pages);
 		  BV (clib_bihash_alloc_unlock) (h);
 		  BV (clib_bihash_increment_stat) (h, BIHASH_STAT_del_free,
 						   1);
@@ -977,7 +1034,7 @@ expand_ok:
 
       /* free the old bucket, except at the bucket level if so configured */
       v = BV (clib_bihash_get_value) (h, h->saved_bucket.offset);
-      BV (value_free) (h, v, h->saved_bucket.log2_pages);
+      BV (value_free_qsbr) (h, v, h->saved_bucket.log2_pages);
 
 #if BIHASH_KVP_AT_BUCKET_LEVEL
     }
@@ -28,6 +28,7 @@
 #include <vppinfra/pool.h>
 #include <vppinfra/cache.h>
 #include <vppinfra/lock.h>
+#include <vppinfra/qsbr.h>
 
 #ifndef BIHASH_TYPE
 #error BIHASH_TYPE not defined
@@ -169,6 +170,11 @@ BVS (clib_bihash)
 #endif
 
   u64 alloc_arena;		/* Base of the allocation arena */
+
+  /** Readers are tracked here, freed pages are recycled after a
+      grace period. Unused for shared-memory tables. */
+  clib_qsbr_main_t *qsbr;
+
   volatile u8 instantiated;
   u8 dont_add_to_all_bihash_list;
 
@@ -194,6 +200,8 @@ typedef struct
   u32 nbuckets;
   uword memory_size;
   format_function_t *kvp_fmt_fn;
+  /* defaults to clib_qsbr_main */
+  clib_qsbr_main_t *qsbr;
   u8 instantiate_immediately;
   u8 dont_add_to_all_bihash_list;
 } BVT (clib_bihash_init2_args);
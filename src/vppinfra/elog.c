@@ -60,6 +60,19 @@ elog_unlock (elog_main_t * em)
     }
 }
 
+static inline void
+elog_thread_string_lock (elog_thread_t * et)
+{
+  while (clib_atomic_test_and_set (&et->string_table_lock))
+    CLIB_PAUSE ();
+}
+
+static inline void
+elog_thread_string_unlock (elog_thread_t * et)
+{
+  clib_atomic_release (&et->string_table_lock);
+}
+
 /* Non-inline version. */
 __clib_export void *
 elog_event_data (elog_main_t * em,
@@ -484,17 +497,32 @@ elog_nsec_per_clock (elog_main_t * em)
 					    &em->init_time));
 }
 
+static void
+elog_alloc_ring (elog_event_t ** ring, u32 n_events, int free_ring)
+{
+  if (free_ring && ring[0])
+    vec_free (ring[0]);
+
+  vec_validate_aligned (ring[0], n_events, CLIB_CACHE_LINE_BYTES);
+  _vec_len (ring[0]) = n_events;
+}
+
 static void
 elog_alloc_internal (elog_main_t * em, u32 n_events, int free_ring)
 {
-  if (free_ring && em->event_ring)
-    vec_free (em->event_ring);
+  elog_thread_t *et;
 
   /* Ring size must be a power of 2. */
   em->event_ring_size = n_events = max_pow2 (n_events);
 
-  vec_validate_aligned (em->event_ring, n_events, CLIB_CACHE_LINE_BYTES);
-  _vec_len (em->event_ring) = n_events;
+  elog_alloc_ring (&em->event_ring, n_events, free_ring);
+
+  /* Per-thread rings share the ring size; a resized ring starts over. */
+  vec_foreach (et, em->threads)
+  {
+    elog_alloc_ring (&et->event_ring, n_events, free_ring);
+    et->n_total_events = et->n_streamed_events = 0;
+  }
 }
 
 __clib_export void
@@ -509,6 +537,28 @@ elog_resize (elog_main_t * em, u32 n_events)
   elog_alloc_internal (em, n_events, 0 /* do not free ring */ );
 }
 
+/* Give each of n_threads threads its own ring so that recording
+   needs neither the lock nor atomics. */
+__clib_export void
+elog_alloc_threads (elog_main_t * em, u32 n_threads)
+{
+  elog_thread_t *et;
+  uword i, old_len = vec_len (em->threads);
+
+  if (n_threads <= old_len)
+    return;
+
+  vec_validate_aligned (em->threads, n_threads - 1, CLIB_CACHE_LINE_BYTES);
+
+  for (i = old_len; i < n_threads; i++)
+    {
+      et = vec_elt_at_index (em->threads, i);
+      elog_alloc_ring (&et->event_ring, em->event_ring_size, 0);
+      et->n_total_events_disable_limit =
+	em->n_total_events < em->n_total_events_disable_limit ? ~0ULL : 0;
+    }
+}
+
 __clib_export void
 elog_init (elog_main_t * em, u32 n_events)
 {
@@ -553,11 +603,129 @@ elog_event_range (elog_main_t * em, uword * lo)
     }
 }
 
+static int
+elog_cmp (void *a1, void *a2)
+{
+  elog_event_t *e1 = a1;
+  elog_event_t *e2 = a2;
+
+  if (e1->time < e2->time)
+    return -1;
+
+  if (e1->time > e2->time)
+    return 1;
+
+  return 0;
+}
+
+/* Convert absolute time from cycles to seconds from start. */
+static_always_inline void
+elog_event_set_time (elog_main_t * em, elog_event_t * e)
+{
+  e->time =
+    (e->time_cycles - em->init_time.cpu) * em->cpu_timer.seconds_per_clock;
+}
+
+/* Copy a thread-local string into the main string table, returning its
+   offset there. Caller holds the elog lock. */
+static u32
+elog_thread_string_to_main (elog_main_t * em, elog_thread_t * et, u32 o)
+{
+  uword *p;
+  char *s;
+  u8 *key;
+  u32 offset;
+
+  elog_thread_string_lock (et);
+
+  s = o < vec_len (et->string_table) ? et->string_table + o : "?";
+  p = hash_get_mem (em->string_table_hash, s);
+  if (p)
+    offset = p[0];
+  else
+    {
+      key = format (0, "%s%c", s, 0);
+      offset = vec_len (em->string_table);
+      vec_append (em->string_table, key);
+      hash_set_mem (em->string_table_hash, key, offset);
+    }
+
+  elog_thread_string_unlock (et);
+  return offset;
+}
+
+/* Rewrite 'T' arguments of a worker thread event to refer to the main
+   string table. */
+static void
+elog_thread_fix_strings (elog_main_t * em, elog_thread_t * et,
+			 elog_event_t * e)
+{
+  elog_event_type_t *t;
+  u8 *d = e->data;
+  char *a;
+
+  if (e->event_type >= vec_len (em->event_types))
+    return;
+
+  t = vec_elt_at_index (em->event_types, e->event_type);
+
+  for (a = t->format_args; a[0] != 0;)
+    {
+      uword n_bytes = 0, n_digits;
+
+      n_digits = parse_2digit_decimal (a + 1, &n_bytes);
+      if (n_digits == 0 || d + n_bytes > e->data + sizeof (e->data))
+	break;
+
+      if (a[0] == 'T' && n_bytes == 4)
+	clib_mem_unaligned (d, u32) =
+	  elog_thread_string_to_main (em, et, clib_mem_unaligned (d, u32));
+
+      a += 1 + n_digits;
+      d += n_bytes;
+    }
+}
+
+/* Append events [lo, hi) of a thread ring to es. Events the owner
+   thread overwrote while we were copying are discarded and counted in
+   n_dropped. Caller holds the elog lock. */
+static void
+elog_collect_thread (elog_main_t * em, elog_thread_t * et, u64 lo, u64 hi,
+		     elog_event_t ** es, u64 * n_dropped)
+{
+  uword mask = em->event_ring_size - 1;
+  uword first = vec_len (es[0]);
+  elog_event_t *e;
+  u64 i, n;
+
+  for (i = lo; i < hi; i++)
+    {
+      vec_add2 (es[0], e, 1);
+      e[0] = et->event_ring[i & mask];
+    }
+
+  n = clib_atomic_load_acq_n (&et->n_total_events);
+  if (n > em->event_ring_size && n - em->event_ring_size > lo)
+    {
+      u64 n_lost = clib_min (n - em->event_ring_size - lo, hi - lo);
+      vec_delete (es[0], n_lost, first);
+      n_dropped[0] += n_lost;
+    }
+
+  if (et == em->threads)
+    return;
+
+  for (e = es[0] + first; e < vec_end (es[0]); e++)
+    elog_thread_fix_strings (em, et, e);
+}
+
 __clib_export elog_event_t *
 elog_peek_events (elog_main_t * em)
 {
   elog_event_t *e, *f, *es = 0;
+  elog_thread_t *et;
   uword i, j, n;
+  u64 n_dropped = 0;
 
   n = elog_event_range (em, &j);
   for (i = 0; i < n; i++)
@@ -566,17 +734,65 @@ elog_peek_events (elog_main_t * em)
       f = vec_elt_at_index (em->event_ring, j);
       e[0] = f[0];
 
-      /* Convert absolute time from cycles to seconds from start. */
-      e->time =
-	(e->time_cycles -
-	 em->init_time.cpu) * em->cpu_timer.seconds_per_clock;
+      elog_event_set_time (em, e);
 
       j = (j + 1) & (em->event_ring_size - 1);
     }
 
+  if (vec_len (em->threads) == 0)
+    return es;
+
+  /* Merge per-thread rings by time stamp. */
+  elog_lock (em);
+  vec_foreach (et, em->threads)
+  {
+    u64 hi = clib_atomic_load_acq_n (&et->n_total_events);
+    u64 lo = hi > em->event_ring_size ? hi - em->event_ring_size : 0;
+    elog_collect_thread (em, et, lo, hi, &es, &n_dropped);
+  }
+  elog_unlock (em);
+
+  for (e = es + n; e < vec_end (es); e++)
+    elog_event_set_time (em, e);
+
+  vec_sort_with_function (es, elog_cmp);
+
   return es;
 }
 
+static u32
+elog_thread_string (elog_thread_t * et, char *fmt, va_list * va)
+{
+  uword *p, len;
+  u32 offset;
+
+  vec_reset_length (et->string_table_tmp);
+  et->string_table_tmp = va_format (et->string_table_tmp, fmt, va);
+
+  len = vec_len (et->string_table_tmp);
+  ASSERT (len > 0);
+  if (et->string_table_tmp[len - 1] != 0)
+    vec_add1 (et->string_table_tmp, 0);
+
+  if (!et->string_table_hash)
+    et->string_table_hash = hash_create_string (0, sizeof (uword));
+
+  p = hash_get_mem (et->string_table_hash, et->string_table_tmp);
+  if (p)
+    return p[0];
+
+  /* Only the collector reads this table, and only under the lock. */
+  elog_thread_string_lock (et);
+  offset = vec_len (et->string_table);
+  vec_append (et->string_table, et->string_table_tmp);
+  elog_thread_string_unlock (et);
+
+  hash_set_mem (et->string_table_hash, et->string_table_tmp, offset);
+  et->string_table_tmp = 0;
+
+  return offset;
+}
+
 /* Add a formatted string to the string table. */
 __clib_export u32
 elog_string (elog_main_t * em, char *fmt, ...)
@@ -586,6 +802,17 @@ elog_string (elog_main_t * em, char *fmt, ...)
   uword len;
   va_list va;
 
+  elog_thread_t *et = elog_get_thread (em);
+
+  /* Worker threads use their own string table. */
+  if (et && et != em->threads)
+    {
+      va_start (va, fmt);
+      offset = elog_thread_string (et, fmt, &va);
+      va_end (va);
+      return offset;
+    }
+
   elog_lock (em);
   vec_reset_length (em->string_table_tmp);
   va_start (va, fmt);
@@ -677,21 +904,6 @@ maybe_fix_string_table_offset (elog_event_t * e,
     }
 }
 
-static int
-elog_cmp (void *a1, void *a2)
-{
-  elog_event_t *e1 = a1;
-  elog_event_t *e2 = a2;
-
-  if (e1->time < e2->time)
-    return -1;
-
-  if (e1->time > e2->time)
-    return 1;
-
-  return 0;
-}
-
 /*
  * merge two event logs. Complicated and cranky.
  */
@@ -1124,17 +1336,19 @@ serialize_elog_main (serialize_main_t * m, va_list * va)
   serialize (m, serialize_elog_time_stamp, &em->serialize_time);
   serialize (m, serialize_elog_time_stamp, &em->init_time);
 
-  vec_serialize (m, em->event_types, serialize_elog_event_type);
-  vec_serialize (m, em->tracks, serialize_elog_track);
-  vec_serialize (m, em->string_table, serialize_vec_8);
-
-  /* Free old events (cached) in case they have changed. */
+  /* Free old events (cached) in case they have changed. Collecting
+     moves worker thread strings into the main string table, so do it
+     before the table is written. */
   if (flush_ring)
     {
       vec_free (em->events);
       elog_get_events (em);
     }
 
+  vec_serialize (m, em->event_types, serialize_elog_event_type);
+  vec_serialize (m, em->tracks, serialize_elog_track);
+  vec_serialize (m, em->string_table, serialize_vec_8);
+
   serialize_integer (m, vec_len (em->events), sizeof (u32));
 
   /* SMP logs can easily have local time paradoxes... */
@@ -1180,6 +1394,9 @@ unserialize_elog_main (serialize_main_t *m, va_list *va)
 }
 
 #ifdef CLIB_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+
 clib_error_t *
 elog_write_file_not_inline (elog_main_t * em, char *clib_file, int flush_ring)
 {
@@ -1209,6 +1426,142 @@ elog_read_file_not_inline (elog_main_t * em, char *clib_file)
     unserialize_close (&m);
   return error;
 }
+
+/* Streaming: per-thread ring contents are periodically merged and
+   appended to a text file, one event per line, so that logs longer
+   than the rings can be captured. */
+
+__clib_export clib_error_t *
+elog_stream_start (elog_main_t * em, char *file)
+{
+  elog_thread_t *et;
+  u8 *s;
+  int fd;
+
+  if (em->stream_file_name)
+    return clib_error_return (0, "already streaming to %s",
+			      em->stream_file_name);
+
+  if (vec_len (em->threads) == 0)
+    return clib_error_return (0, "per-thread event rings not allocated");
+
+  fd = open (file, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+  if (fd < 0)
+    return clib_error_return_unix (0, "open `%s'", file);
+
+  s = format (0, "# elog stream: %d threads, %wd events per ring, "
+	      "%.3f MHz cpu clock, time in seconds since logger init\n",
+	      vec_len (em->threads), em->event_ring_size,
+	      1e-6 * em->cpu_timer.clocks_per_second);
+  if (write (fd, s, vec_len (s)) != vec_len (s))
+    {
+      vec_free (s);
+      close (fd);
+      return clib_error_return_unix (0, "write `%s'", file);
+    }
+  vec_free (s);
+
+  em->stream_fd = fd;
+  em->stream_file_name = format (0, "%s%c", file, 0);
+  em->n_stream_events = em->n_stream_events_dropped = 0;
+
+  /* Start with whatever the rings currently hold. */
+  vec_foreach (et, em->threads)
+  {
+    u64 n = et->n_total_events;
+    et->n_streamed_events = n > em->event_ring_size ?
+      n - em->event_ring_size : 0;
+  }
+
+  return 0;
+}
+
+static uword
+elog_stream_flush_internal (elog_main_t * em, int flush_all)
+{
+  elog_event_t *es = 0, *e;
+  elog_thread_t *et;
+  u8 *s = 0;
+  uword n_events, n_done = 0;
+
+  if (!em->stream_file_name)
+    return 0;
+
+  elog_lock (em);
+
+  vec_foreach (et, em->threads)
+  {
+    u64 lo = et->n_streamed_events;
+    u64 hi = clib_atomic_load_acq_n (&et->n_total_events);
+
+    /* Buffer was reset. */
+    if (hi < lo)
+      lo = 0;
+
+    /* The owner thread may still be filling in its last event. */
+    if (!flush_all && hi > lo)
+      hi--;
+
+    if (hi - lo > em->event_ring_size)
+      {
+	em->n_stream_events_dropped += hi - lo - em->event_ring_size;
+	lo = hi - em->event_ring_size;
+      }
+
+    elog_collect_thread (em, et, lo, hi, &es, &em->n_stream_events_dropped);
+    et->n_streamed_events = hi;
+  }
+
+  vec_foreach (e, es) elog_event_set_time (em, e);
+  vec_sort_with_function (es, elog_cmp);
+
+  /* Format under the lock: types and strings may be added meanwhile. */
+  vec_foreach (e, es)
+    s = format (s, "%.9f %U: %U\n", e->time, format_elog_track_name, em, e,
+		format_elog_event, em, e);
+
+  elog_unlock (em);
+
+  n_events = vec_len (es);
+  vec_free (es);
+
+  while (n_done < vec_len (s))
+    {
+      word n = write (em->stream_fd, s + n_done, vec_len (s) - n_done);
+      if (n < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  em->n_stream_events_dropped += n_events;
+	  n_events = 0;
+	  break;
+	}
+      n_done += n;
+    }
+  vec_free (s);
+
+  em->n_stream_events += n_events;
+  return n_events;
+}
+
+/* Append new events to the stream file, returns number of events
+   written. Meant to be called periodically from a single thread. */
+__clib_export uword
+elog_stream_flush (elog_main_t * em)
+{
+  return elog_stream_flush_internal (em, 0 /* flush_all */ );
+}
+
+__clib_export void
+elog_stream_stop (elog_main_t * em)
+{
+  if (!em->stream_file_name)
+    return;
+
+  elog_stream_flush_internal (em, 1 /* flush_all */ );
+  close (em->stream_fd);
+  vec_free (em->stream_file_name);
+}
 #endif /* CLIB_UNIX */
 
 
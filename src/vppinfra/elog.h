@@ -55,6 +55,7 @@
 #include <vppinfra/time.h>	/* for clib_cpu_time_now */
 #include <vppinfra/hash.h>
 #include <vppinfra/mhash.h>
+#include <vppinfra/os.h>	/* for os_get_thread_index */
 
 typedef struct
 {
@@ -129,6 +130,36 @@ typedef struct
   u64 os_nsec;
 } elog_time_stamp_t;
 
+/** Per-thread event ring. Each thread records into its own ring
+    without atomics, and strings logged by worker threads go into a
+    thread-local string table. Rings are merged by time stamp when
+    events are collected. */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /** Total number of events logged by this thread. */
+  u64 n_total_events;
+
+  /** Logging is disabled when count reaches limit. */
+  u64 n_total_events_disable_limit;
+
+  /** Events up to this count have been written to the stream file. */
+  u64 n_streamed_events;
+
+  /** Vector of events (circular buffer), event_ring_size elements. */
+  elog_event_t *event_ring;
+
+  /** Thread-local string table; unused for thread 0, which logs
+      into the main string table. */
+  char *string_table;
+  uword *string_table_hash;
+  u8 *string_table_tmp;
+
+  /** Held while the owner thread grows its string table. */
+  u32 string_table_lock;
+} elog_thread_t;
+
 typedef struct
 {
   /** Total number of events in buffer. */
@@ -180,8 +211,33 @@ typedef struct
 
   /** Vector of events converted to generic form after collection. */
   elog_event_t *events;
+
+  /** Per-thread rings indexed by thread index, allocated by
+      elog_alloc_threads (). Threads without a ring (and events logged
+      before the rings were allocated) use event_ring above. */
+  elog_thread_t *threads;
+
+  /** Continuous dump of per-thread rings to a text file. */
+  int stream_fd;
+  u8 *stream_file_name;
+  u64 n_stream_events;
+  u64 n_stream_events_dropped;
 } elog_main_t;
 
+/** @brief Return the calling thread's event ring, if any
+    @param em elog_main_t *
+    @return elog_thread_t * or 0 when the thread logs into the shared ring
+*/
+always_inline elog_thread_t *
+elog_get_thread (elog_main_t * em)
+{
+  uword thread_index = os_get_thread_index ();
+
+  if (PREDICT_TRUE (thread_index < vec_len (em->threads)))
+    return vec_elt_at_index (em->threads, thread_index);
+  return 0;
+}
+
 /** @brief Return number of events in the event-log buffer
     @param em elog_main_t *
     @return number of events in the buffer
@@ -190,7 +246,12 @@ typedef struct
 always_inline uword
 elog_n_events_in_buffer (elog_main_t * em)
 {
-  return clib_min (em->n_total_events, em->event_ring_size);
+  elog_thread_t *et;
+  uword n = clib_min (em->n_total_events, em->event_ring_size);
+
+  vec_foreach (et, em->threads)
+    n += clib_min (et->n_total_events, em->event_ring_size);
+  return n;
 }
 
 /** @brief Return number of events which can fit in the event buffer
@@ -200,7 +261,7 @@ elog_n_events_in_buffer (elog_main_t * em)
 always_inline uword
 elog_buffer_capacity (elog_main_t * em)
 {
-  return em->event_ring_size;
+  return em->event_ring_size * (1 + vec_len (em->threads));
 }
 
 /** @brief Reset the event buffer
@@ -209,8 +270,15 @@ elog_buffer_capacity (elog_main_t * em)
 always_inline void
 elog_reset_buffer (elog_main_t * em)
 {
+  elog_thread_t *et;
+
   em->n_total_events = 0;
   em->n_total_events_disable_limit = ~0;
+  vec_foreach (et, em->threads)
+  {
+    et->n_total_events = et->n_streamed_events = 0;
+    et->n_total_events_disable_limit = ~0ULL;
+  }
 }
 
 /** @brief Enable or disable event logging
@@ -219,8 +287,29 @@ elog_reset_buffer (elog_main_t * em)
 always_inline void
 elog_enable_disable (elog_main_t * em, int is_enabled)
 {
+  elog_thread_t *et;
+
   em->n_total_events = 0;
   em->n_total_events_disable_limit = is_enabled ? ~0 : 0;
+  vec_foreach (et, em->threads)
+  {
+    et->n_total_events = et->n_streamed_events = 0;
+    et->n_total_events_disable_limit = is_enabled ? ~0ULL : 0;
+  }
+}
+
+/** @brief Restart event logging stopped by a trigger, keeping the
+    events already in the buffer
+    @param em elog_main_t *
+*/
+always_inline void
+elog_resume (elog_main_t * em)
+{
+  elog_thread_t *et;
+
+  em->n_total_events_disable_limit = ~0;
+  vec_foreach (et, em->threads)
+    et->n_total_events_disable_limit = ~0ULL;
 }
 
 /** @brief disable logging after specified number of ievents have been logged.
@@ -235,7 +324,11 @@ elog_enable_disable (elog_main_t * em, int is_enabled)
 always_inline void
 elog_disable_after_events (elog_main_t * em, uword n)
 {
+  elog_thread_t *et;
+
   em->n_total_events_disable_limit = em->n_total_events + n;
+  vec_foreach (et, em->threads)
+    et->n_total_events_disable_limit = et->n_total_events + n;
 }
 
 /* @brief mid-buffer logic-analyzer trigger
@@ -247,8 +340,7 @@ elog_disable_after_events (elog_main_t * em, uword n)
 always_inline void
 elog_disable_trigger (elog_main_t * em)
 {
-  em->n_total_events_disable_limit =
-    em->n_total_events + vec_len (em->event_ring) / 2;
+  elog_disable_after_events (em, em->event_ring_size / 2);
 }
 
 /** @brief register an event type
@@ -275,6 +367,10 @@ word elog_track_register (elog_main_t * em, elog_track_t * t);
 always_inline uword
 elog_is_enabled (elog_main_t * em)
 {
+  elog_thread_t *et = elog_get_thread (em);
+
+  if (et)
+    return et->n_total_events < et->n_total_events_disable_limit;
   return em->n_total_events < em->n_total_events_disable_limit;
 }
 
@@ -294,12 +390,20 @@ elog_event_data_inline (elog_main_t * em,
 			elog_event_type_t * type,
 			elog_track_t * track, u64 cpu_time)
 {
+  elog_thread_t *et = elog_get_thread (em);
   elog_event_t *e;
   uword ei;
   word type_index, track_index;
 
   /* Return the user placeholder memory to scribble data into. */
-  if (PREDICT_FALSE (!elog_is_enabled (em)))
+  if (et)
+    {
+      if (PREDICT_FALSE (et->n_total_events >=
+			 et->n_total_events_disable_limit))
+	return em->placeholder_event.data;
+    }
+  else if (PREDICT_FALSE (em->n_total_events >=
+			  em->n_total_events_disable_limit))
     return em->placeholder_event.data;
 
   type_index = (word) type->type_index_plus_one - 1;
@@ -315,6 +419,23 @@ elog_event_data_inline (elog_main_t * em,
   ASSERT (track_index < vec_len (em->tracks));
   ASSERT (is_pow2 (vec_len (em->event_ring)));
 
+  /* Own ring: no other thread writes it, no atomic increment needed. */
+  if (PREDICT_TRUE (et != 0))
+    {
+      u64 n = et->n_total_events;
+
+      e = et->event_ring + (n & (em->event_ring_size - 1));
+      e->time_cycles = cpu_time;
+      e->event_type = type_index;
+      e->track = track_index;
+
+      /* Publish the event to collectors reading the count with acquire.
+         The caller fills in the data after this, so the newest event is
+         only complete once the next one is published. */
+      clib_atomic_store_rel_n (&et->n_total_events, n + 1);
+      return e->data;
+    }
+
   if (em->lock)
     ei = clib_atomic_fetch_add (&em->n_total_events, 1);
   else
@@ -527,6 +648,7 @@ void unserialize_elog_main (serialize_main_t * m, va_list * va);
 void elog_init (elog_main_t * em, u32 n_events);
 void elog_alloc (elog_main_t * em, u32 n_events);
 void elog_resize (elog_main_t * em, u32 n_events);
+void elog_alloc_threads (elog_main_t * em, u32 n_threads);
 
 #ifdef CLIB_UNIX
 always_inline clib_error_t *
@@ -565,6 +687,10 @@ elog_read_file (elog_main_t * em, char *clib_file)
 clib_error_t *elog_read_file_not_inline (elog_main_t * em, char *clib_file);
 char *format_one_elog_event (void *em_arg, void *ep_arg);
 
+clib_error_t *elog_stream_start (elog_main_t * em, char *file);
+uword elog_stream_flush (elog_main_t * em);
+void elog_stream_stop (elog_main_t * em);
+
 #endif /* CLIB_UNIX */
 
 #endif /* included_clib_elog_h */
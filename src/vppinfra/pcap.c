@@ -257,6 +257,125 @@ done:
 
 }
 
+static void
+pcapng_add_option (u8 ** v, u16 code, void *data, u16 len)
+{
+  u8 *p;
+  u16 *o;
+
+  vec_add2 (*v, p, 2 * sizeof (u16) + round_pow2 (len, 4));
+  o = (u16 *) p;
+  o[0] = code;
+  o[1] = len;
+  clib_memcpy_fast (p + 4, data, len);
+  clib_memset (p + 4 + len, 0, round_pow2 (len, 4) - len);
+}
+
+/* Add end-of-options and trailing block length to the block at offset */
+static void
+pcapng_finish_block (u8 ** v, uword offset)
+{
+  pcapng_block_header_t *h;
+  u8 *p;
+  u32 *len;
+
+  vec_add2 (*v, p, 2 * sizeof (u32));
+  len = (u32 *) p;
+  len[0] = PCAPNG_OPT_END;
+  len[1] = vec_len (*v) - offset;
+  h = (pcapng_block_header_t *) (*v + offset);
+  h->block_total_length = len[1];
+}
+
+/**
+ * @brief Append a pcapng section header block
+ *
+ * Every pcapng file starts with one, interface ids used by later blocks
+ * are relative to the section.
+ */
+__clib_export void
+pcapng_add_section_header (u8 ** v, char *user_appl)
+{
+  pcapng_section_header_t *sh;
+  uword offset = vec_len (*v);
+  u8 *p;
+
+  vec_add2 (*v, p, sizeof (*sh));
+  sh = (pcapng_section_header_t *) p;
+  sh->h.block_type = PCAPNG_BLOCK_TYPE_SECTION_HEADER;
+  sh->byte_order_magic = PCAPNG_BYTE_ORDER_MAGIC;
+  sh->major_version = 1;
+  sh->minor_version = 0;
+  sh->section_length = -1;
+  if (user_appl)
+    pcapng_add_option (v, PCAPNG_OPT_SHB_USERAPPL, user_appl,
+		       strlen (user_appl));
+  pcapng_finish_block (v, offset);
+}
+
+/**
+ * @brief Append a pcapng interface description block
+ *
+ * Interfaces are numbered from 0 in the order they are added to the
+ * section. Timestamps of packets on the interface are in nanoseconds.
+ */
+__clib_export void
+pcapng_add_interface (u8 ** v, pcap_packet_type_t packet_type, u32 snap_len,
+		      u8 * name)
+{
+  pcapng_interface_header_t *ih;
+  uword offset = vec_len (*v);
+  u8 tsresol = 9;
+  u8 *p;
+
+  vec_add2 (*v, p, sizeof (*ih));
+  ih = (pcapng_interface_header_t *) p;
+  ih->h.block_type = PCAPNG_BLOCK_TYPE_INTERFACE;
+  ih->link_type = packet_type;
+  ih->reserved = 0;
+  ih->snap_len = snap_len;
+  if (name)
+    pcapng_add_option (v, PCAPNG_OPT_IF_NAME, name, vec_len (name));
+  pcapng_add_option (v, PCAPNG_OPT_IF_TSRESOL, &tsresol, 1);
+  pcapng_finish_block (v, offset);
+}
+
+/**
+ * @brief Append a pcapng enhanced packet block
+ *
+ * @param flags - epb_flags, 0 to omit
+ * @param comment - vector, 0 to omit
+ */
+__clib_export void
+pcapng_add_packet (u8 ** v, u32 interface_id, u64 timestamp_nsec,
+		   void *data, u32 n_bytes_captured, u32 n_bytes_original,
+		   u32 flags, u8 * comment)
+{
+  pcapng_enhanced_packet_header_t *ph;
+  uword offset = vec_len (*v);
+  u32 n_pad = round_pow2 (n_bytes_captured, 4) - n_bytes_captured;
+  u8 *d;
+
+  vec_add2 (*v, d, sizeof (*ph));
+  ph = (pcapng_enhanced_packet_header_t *) d;
+  ph->h.block_type = PCAPNG_BLOCK_TYPE_ENHANCED_PACKET;
+  ph->interface_id = interface_id;
+  ph->timestamp_high = timestamp_nsec >> 32;
+  ph->timestamp_low = timestamp_nsec;
+  ph->n_bytes_captured = n_bytes_captured;
+  ph->n_bytes_original = n_bytes_original;
+
+  vec_add2 (*v, d, n_bytes_captured + n_pad);
+  clib_memcpy_fast (d, data, n_bytes_captured);
+  clib_memset (d + n_bytes_captured, 0, n_pad);
+
+  if (flags)
+    pcapng_add_option (v, PCAPNG_OPT_EPB_FLAGS, &flags, sizeof (flags));
+  if (comment)
+    pcapng_add_option (v, PCAPNG_OPT_COMMENT, comment, vec_len (comment));
+  pcapng_finish_block (v, offset);
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -195,6 +195,66 @@ typedef struct
 
 #define PCAP_DEF_PKT_TO_CAPTURE (100)
 
+/*
+ * pcapng (draft-ietf-opsawg-pcapng). Blocks are written in host byte
+ * order, readers detect it from the section header byte-order magic.
+ */
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1a2b3c4d
+
+typedef enum
+{
+  PCAPNG_BLOCK_TYPE_INTERFACE = 1,
+  PCAPNG_BLOCK_TYPE_ENHANCED_PACKET = 6,
+  PCAPNG_BLOCK_TYPE_SECTION_HEADER = 0x0a0d0d0a,
+} pcapng_block_type_t;
+
+typedef enum
+{
+  PCAPNG_OPT_END = 0,
+  PCAPNG_OPT_COMMENT = 1,
+  PCAPNG_OPT_SHB_USERAPPL = 4,
+  PCAPNG_OPT_IF_NAME = 2,
+  PCAPNG_OPT_IF_TSRESOL = 9,
+  PCAPNG_OPT_EPB_FLAGS = 2,
+} pcapng_option_code_t;
+
+/** epb_flags packet direction */
+#define PCAPNG_EPB_FLAG_INBOUND (1 << 0)
+#define PCAPNG_EPB_FLAG_OUTBOUND (1 << 1)
+
+typedef struct
+{
+  u32 block_type;
+  u32 block_total_length;
+} pcapng_block_header_t;
+
+typedef struct
+{
+  pcapng_block_header_t h;
+  u32 byte_order_magic;
+  u16 major_version;
+  u16 minor_version;
+  i64 section_length;
+} __clib_packed pcapng_section_header_t;
+
+typedef struct
+{
+  pcapng_block_header_t h;
+  u16 link_type;
+  u16 reserved;
+  u32 snap_len;
+} pcapng_interface_header_t;
+
+typedef struct
+{
+  pcapng_block_header_t h;
+  u32 interface_id;
+  u32 timestamp_high;
+  u32 timestamp_low;
+  u32 n_bytes_captured;
+  u32 n_bytes_original;
+} pcapng_enhanced_packet_header_t;
+
 #endif /* included_vppinfra_pcap_h */
 
 /*
@@ -26,6 +26,14 @@ clib_error_t *pcap_read (pcap_main_t * pm);
 /** Close the file created by pcap_write function. */
 clib_error_t *pcap_close (pcap_main_t * pm);
 
+/** Append pcapng blocks to a vector. */
+void pcapng_add_section_header (u8 ** v, char *user_appl);
+void pcapng_add_interface (u8 ** v, pcap_packet_type_t packet_type,
+			   u32 snap_len, u8 * name);
+void pcapng_add_packet (u8 ** v, u32 interface_id, u64 timestamp_nsec,
+			void *data, u32 n_bytes_captured,
+			u32 n_bytes_original, u32 flags, u8 * comment);
+
 /**
  * @brief Add packet
  *
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vppinfra/qsbr.h>
+#include <vppinfra/format.h>
+
+__clib_export clib_qsbr_main_t clib_qsbr_main;
+
+__clib_export void
+clib_qsbr_init (clib_qsbr_main_t *qm, u32 n_threads)
+{
+  ASSERT (n_threads > 0);
+
+  if (qm->threads == 0)
+    {
+      clib_spinlock_init (&qm->lock);
+      /* epoch 0 means offline */
+      qm->epoch = 1;
+    }
+
+  /* all threads start offline and go online when they start reading */
+  vec_validate_aligned (qm->threads, n_threads - 1, CLIB_CACHE_LINE_BYTES);
+}
+
+static void
+clib_qsbr_run (clib_qsbr_pending_t *p)
+{
+  void *oldheap = clib_mem_set_per_cpu_heap (p->heap);
+  p->fn (p->data);
+  clib_mem_set_per_cpu_heap (oldheap);
+}
+
+__clib_export void
+clib_qsbr_free (clib_qsbr_main_t *qm)
+{
+  clib_qsbr_pending_t *p;
+
+  /* caller guarantees there are no readers left */
+  vec_foreach (p, qm->pending)
+    clib_qsbr_run (p);
+
+  vec_free (qm->pending);
+  vec_free (qm->threads);
+  clib_spinlock_free (&qm->lock);
+  clib_memset (qm, 0, sizeof (*qm));
+}
+
+__clib_export void
+clib_qsbr_call_after_grace_period (clib_qsbr_main_t *qm,
+				   clib_qsbr_callback_fn_t *fn, void *data)
+{
+  clib_qsbr_pending_t *p;
+
+  /* no readers to wait for */
+  if (PREDICT_FALSE (!clib_qsbr_is_enabled (qm)))
+    {
+      fn (data);
+      return;
+    }
+
+  clib_spinlock_lock (&qm->lock);
+  vec_add2 (qm->pending, p, 1);
+  p->fn = fn;
+  p->data = data;
+  p->heap = clib_mem_get_per_cpu_heap ();
+  /* seq_cst: unlinking of the object happens before the epoch bump */
+  p->epoch = __atomic_add_fetch (&qm->epoch, 1, __ATOMIC_SEQ_CST);
+  __atomic_store_n (&qm->n_pending, vec_len (qm->pending), __ATOMIC_RELAXED);
+  qm->n_deferred++;
+  clib_spinlock_unlock (&qm->lock);
+}
+
+static void
+clib_qsbr_free_cb (void *data)
+{
+  clib_mem_free (data);
+}
+
+__clib_export void
+clib_qsbr_defer_free (clib_qsbr_main_t *qm, void *p)
+{
+  if (p)
+    clib_qsbr_call_after_grace_period (qm, clib_qsbr_free_cb, p);
+}
+
+/* Oldest epoch which is still observed by an online thread */
+static u64
+clib_qsbr_min_epoch (clib_qsbr_main_t *qm)
+{
+  clib_qsbr_thread_t *t;
+  u64 min = __atomic_load_n (&qm->epoch, __ATOMIC_ACQUIRE);
+
+  vec_foreach (t, qm->threads)
+    {
+      u64 e = __atomic_load_n (&t->epoch, __ATOMIC_ACQUIRE);
+      if (e && e < min)
+	min = e;
+    }
+
+  return min;
+}
+
+/** Run callbacks for all objects whose grace period has expired.
+    Returns number of reclaimed objects. */
+__clib_export uword
+clib_qsbr_poll (clib_qsbr_main_t *qm)
+{
+  clib_qsbr_pending_t *p, *expired = 0;
+  u64 min;
+  uword n;
+
+  if (PREDICT_TRUE (clib_qsbr_n_pending (qm) == 0))
+    return 0;
+
+  min = clib_qsbr_min_epoch (qm);
+
+  clib_spinlock_lock (&qm->lock);
+  for (n = 0; n < vec_len (qm->pending); n++)
+    if (qm->pending[n].epoch > min)
+      break;
+
+  if (n)
+    {
+      vec_add (expired, qm->pending, n);
+      vec_delete (qm->pending, n, 0);
+      __atomic_store_n (&qm->n_pending, vec_len (qm->pending),
+			__ATOMIC_RELAXED);
+      qm->n_reclaimed += n;
+    }
+  clib_spinlock_unlock (&qm->lock);
+
+  /* callbacks may retire more objects, so run them without the lock */
+  vec_foreach (p, expired)
+    clib_qsbr_run (p);
+
+  vec_free (expired);
+  return n;
+}
+
+/** Wait for a full grace period and reclaim everything retired so far.
+    Must not be called by a thread which holds references to shared data,
+    thread_index is the caller's own thread (~0 if not a QSBR reader).
+    With vlib, call it from the main thread only: a worker waiting here
+    deadlocks against main waiting for it at the barrier. */
+__clib_export void
+clib_qsbr_synchronize (clib_qsbr_main_t *qm, u32 thread_index)
+{
+  u64 target;
+
+  if (!clib_qsbr_is_enabled (qm))
+    return;
+
+  target = __atomic_add_fetch (&qm->epoch, 1, __ATOMIC_SEQ_CST);
+  clib_qsbr_quiescent (qm, thread_index);
+
+  while (clib_qsbr_min_epoch (qm) < target)
+    CLIB_PAUSE ();
+
+  while (clib_qsbr_n_pending (qm) && clib_qsbr_poll (qm))
+    ;
+}
+
+/** Same as vec_resize_allocate_memory, except that when the vector has to
+    be moved the old memory is freed after a grace period */
+__clib_export void *
+clib_qsbr_vec_resize_allocate_memory (clib_qsbr_main_t *qm, void *v,
+				      word length_increment, uword data_bytes,
+				      uword header_bytes, uword data_align,
+				      uword numa_id)
+{
+  uword old_alloc_bytes, new_alloc_bytes;
+  void *old, *new, *oldheap = 0;
+
+  if (v == 0)
+    return vec_resize_allocate_memory (v, length_increment, data_bytes,
+				       header_bytes, data_align, numa_id);
+
+  header_bytes = vec_header_bytes (header_bytes);
+  old = v - header_bytes;
+  old_alloc_bytes = clib_mem_size (old);
+
+  /* Fits, resize in place */
+  if (data_bytes + header_bytes <= old_alloc_bytes)
+    {
+      CLIB_MEM_UNPOISON (v, data_bytes);
+      _vec_len (v) += length_increment;
+      return v;
+    }
+
+  new_alloc_bytes = (old_alloc_bytes * 3) / 2;
+  if (new_alloc_bytes < data_bytes + header_bytes)
+    new_alloc_bytes = data_bytes + header_bytes;
+
+  /* as vec_resize_allocate_memory, the old memory is on the same heap */
+  if (PREDICT_FALSE (numa_id != VEC_NUMA_UNSPECIFIED))
+    oldheap =
+      clib_mem_set_per_cpu_heap (clib_mem_get_per_numa_heap (numa_id));
+
+  new = clib_mem_alloc_aligned_at_offset (new_alloc_bytes, data_align,
+					  header_bytes,
+					  1 /* yes, call os_out_of_memory */);
+
+  CLIB_MEM_UNPOISON (old, old_alloc_bytes);
+  clib_memcpy_fast (new, old, old_alloc_bytes);
+
+  new_alloc_bytes = clib_mem_size (new);
+  clib_memset (new + old_alloc_bytes, 0, new_alloc_bytes - old_alloc_bytes);
+  CLIB_MEM_POISON (new + header_bytes + data_bytes,
+		   new_alloc_bytes - header_bytes - data_bytes);
+
+  v = new + header_bytes;
+  _vec_len (v) += length_increment;
+  _vec_numa (v) = numa_id;
+
+  /* readers may still be walking the old copy, it is freed on the heap
+     which is current now */
+  clib_qsbr_defer_free (qm, old);
+
+  if (PREDICT_FALSE (numa_id != VEC_NUMA_UNSPECIFIED))
+    clib_mem_set_per_cpu_heap (oldheap);
+
+  return v;
+}
+
+__clib_export u8 *
+format_clib_qsbr (u8 *s, va_list *args)
+{
+  clib_qsbr_main_t *qm = va_arg (*args, clib_qsbr_main_t *);
+  u32 indent = format_get_indent (s);
+  clib_qsbr_thread_t *t;
+
+  s = format (s, "epoch %llu, pending %wu, deferred %llu, reclaimed %llu",
+	      qm->epoch, clib_qsbr_n_pending (qm), qm->n_deferred,
+	      qm->n_reclaimed);
+
+  vec_foreach (t, qm->threads)
+    {
+      s = format (s, "\n%Uthread %u: ", format_white_space, indent + 2,
+		  t - qm->threads);
+      if (t->epoch)
+	s = format (s, "epoch %llu", t->epoch);
+      else
+	s = format (s, "offline");
+    }
+
+  return s;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
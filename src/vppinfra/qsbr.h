@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * Quiescent-state-based reclamation (QSBR).
+ *
+ * Readers (typically worker threads) access shared data without locks
+ * and periodically announce a quiescent state, i.e. a point where they
+ * hold no references to shared data. Writers unlink an object, then ask
+ * for it to be freed, or for a callback to run, once every online thread
+ * has announced a quiescent state after the unlink. Threads that are
+ * about to block for a while go offline, so they never hold up a grace
+ * period.
+ *
+ * vlib announces a quiescent state for each thread once per main loop
+ * iteration and reclaims expired objects from the main thread, using the
+ * process-wide instance clib_qsbr_main.
+ */
+
+#ifndef included_clib_qsbr_h
+#define included_clib_qsbr_h
+
+#include <vppinfra/clib.h>
+#include <vppinfra/vec.h>
+#include <vppinfra/pool.h>
+#include <vppinfra/lock.h>
+
+typedef void (clib_qsbr_callback_fn_t) (void *data);
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /** last global epoch observed at a quiescent state, 0 if offline */
+  volatile u64 epoch;
+} clib_qsbr_thread_t;
+
+typedef struct
+{
+  clib_qsbr_callback_fn_t *fn;
+  void *data;
+  u64 epoch;
+  /** per-cpu heap at retire time, the callback runs on it */
+  void *heap;
+} clib_qsbr_pending_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /** global epoch, bumped every time an object is retired */
+  volatile u64 epoch;
+
+  /** protects pending */
+  clib_spinlock_t lock;
+
+  /** retired objects, in epoch order */
+  clib_qsbr_pending_t *pending;
+
+  /** vec_len (pending), for lockless peeking by pollers */
+  volatile u32 n_pending;
+
+  /** per-thread state, cache line per thread */
+  clib_qsbr_thread_t *threads;
+
+  /** stats */
+  u64 n_deferred;
+  u64 n_reclaimed;
+} clib_qsbr_main_t;
+
+extern clib_qsbr_main_t clib_qsbr_main;
+
+void clib_qsbr_init (clib_qsbr_main_t *qm, u32 n_threads);
+void clib_qsbr_free (clib_qsbr_main_t *qm);
+void clib_qsbr_call_after_grace_period (clib_qsbr_main_t *qm,
+					clib_qsbr_callback_fn_t *fn,
+					void *data);
+void clib_qsbr_defer_free (clib_qsbr_main_t *qm, void *p);
+uword clib_qsbr_poll (clib_qsbr_main_t *qm);
+void clib_qsbr_synchronize (clib_qsbr_main_t *qm, u32 thread_index);
+void *clib_qsbr_vec_resize_allocate_memory (clib_qsbr_main_t *qm, void *v,
+					    word length_increment,
+					    uword data_bytes,
+					    uword header_bytes,
+					    uword data_align, uword numa_id);
+format_function_t format_clib_qsbr;
+
+static_always_inline int
+clib_qsbr_is_enabled (clib_qsbr_main_t *qm)
+{
+  return qm->threads != 0;
+}
+
+/** Announce that the calling thread holds no references to shared data */
+static_always_inline void
+clib_qsbr_quiescent (clib_qsbr_main_t *qm, u32 thread_index)
+{
+  u64 epoch;
+
+  if (PREDICT_FALSE (thread_index >= vec_len (qm->threads)))
+    return;
+
+  epoch = __atomic_load_n (&qm->epoch, __ATOMIC_ACQUIRE);
+
+  /* release: all prior reads of shared data happen before the store */
+  if (qm->threads[thread_index].epoch != epoch)
+    __atomic_store_n (&qm->threads[thread_index].epoch, epoch,
+		      __ATOMIC_RELEASE);
+}
+
+/** Take the calling thread out of grace period accounting, e.g. before
+ *  blocking in epoll or at the worker barrier */
+static_always_inline void
+clib_qsbr_thread_offline (clib_qsbr_main_t *qm, u32 thread_index)
+{
+  if (PREDICT_FALSE (thread_index >= vec_len (qm->threads)))
+    return;
+
+  __atomic_store_n (&qm->threads[thread_index].epoch, 0, __ATOMIC_RELEASE);
+}
+
+static_always_inline void
+clib_qsbr_thread_online (clib_qsbr_main_t *qm, u32 thread_index)
+{
+  if (PREDICT_FALSE (thread_index >= vec_len (qm->threads)))
+    return;
+
+  __atomic_store_n (&qm->threads[thread_index].epoch,
+		    __atomic_load_n (&qm->epoch, __ATOMIC_ACQUIRE),
+		    __ATOMIC_SEQ_CST);
+  /* no shared data reads before the store is visible to writers */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+}
+
+static_always_inline uword
+clib_qsbr_n_pending (clib_qsbr_main_t *qm)
+{
+  /* pending itself may be moved by a writer holding the lock */
+  return __atomic_load_n (&qm->n_pending, __ATOMIC_RELAXED);
+}
+
+/** Publish a pointer so that readers never see a partially built object */
+#define clib_qsbr_assign_pointer(P, V)                                        \
+  __atomic_store_n (&(P), (V), __ATOMIC_RELEASE)
+
+/** Resize a vector without stopping readers: when a reallocation is
+    needed the old memory is only freed after a grace period. */
+#define _vec_resize_qsbr_numa(Q, V, L, DB, HB, A, N)                          \
+  do                                                                          \
+    {                                                                         \
+      __typeof__ ((V)) _v (qv);                                               \
+      _v (qv) = clib_qsbr_vec_resize_allocate_memory (                        \
+	(Q), (void *) (V), (L), (DB), (HB),                                   \
+	clib_max (sizeof (vec_header_t),                                      \
+		  clib_max (__alignof__((V)[0]), (A))),                       \
+	(N));                                                                 \
+      if (_v (qv) != (V))                                                     \
+	clib_qsbr_assign_pointer ((V), _v (qv));                              \
+    }                                                                         \
+  while (0)
+
+#define _vec_resize_qsbr(Q, V, L, DB, HB, A)                                 \
+  _vec_resize_qsbr_numa (Q, V, L, DB, HB, A, VEC_NUMA_UNSPECIFIED)
+
+/** Reserve room for N more elements without touching the vector length */
+#define _vec_reserve_qsbr(Q, V, N)                                            \
+  _vec_resize_qsbr ((Q), (V), 0, (vec_len (V) + (N)) * sizeof ((V)[0]), 0, 0)
+
+/** Set vector length with release semantics, so readers checking the
+    length never see elements which are not yet initialized */
+#define _vec_set_len_qsbr(V, L)                                               \
+  __atomic_store_n (&_vec_len (V), (L), __ATOMIC_RELEASE)
+
+/** Make sure vector is long enough for given index, QSBR safe. Readers
+    may keep using the old vector until their next quiescent state. */
+#define vec_validate_qsbr(Q, V, I)                                            \
+  do                                                                          \
+    {                                                                         \
+      word _v (vi) = (I);                                                     \
+      word _v (vl) = vec_len (V);                                             \
+      if (_v (vi) >= _v (vl))                                                 \
+	{                                                                     \
+	  uword _v (vb) = (1 + (_v (vi) - _v (vl))) * sizeof ((V)[0]);        \
+	  _vec_reserve_qsbr ((Q), (V), 1 + (_v (vi) - _v (vl)));              \
+	  CLIB_MEM_UNPOISON ((V) + _v (vl), _v (vb));                         \
+	  clib_memset ((V) + _v (vl), 0, _v (vb));                            \
+	  _vec_set_len_qsbr ((V), _v (vi) + 1);                               \
+	}                                                                     \
+    }                                                                         \
+  while (0)
+
+/** Add 1 element to end of vector, QSBR safe */
+#define vec_add1_qsbr(Q, V, E)                                                \
+  do                                                                          \
+    {                                                                         \
+      word _v (vl) = vec_len (V);                                             \
+      _vec_reserve_qsbr ((Q), (V), 1);                                        \
+      CLIB_MEM_UNPOISON ((V) + _v (vl), sizeof ((V)[0]));                     \
+      (V)[_v (vl)] = (E);                                                     \
+      _vec_set_len_qsbr ((V), _v (vl) + 1);                                   \
+    }                                                                         \
+  while (0)
+
+/** Allocate an object E from pool P with alignment A, QSBR safe. If the
+    pool needs to grow, the old pool memory is reclaimed after a grace
+    period so readers holding an element pointer or the old pool base
+    keep working. The free bitmap and free index vectors are writer-only
+    state and are not protected. */
+#define pool_get_aligned_qsbr(Q, P, E, A)                                     \
+  do                                                                          \
+    {                                                                         \
+      uword _pool_var (will_expand) = 0;                                      \
+      if (P)                                                                  \
+	pool_get_aligned_will_expand (P, _pool_var (will_expand), A);         \
+      if (_pool_var (will_expand))                                            \
+	_vec_resize_qsbr ((Q), (P), 0, (vec_len (P) + 1) * sizeof ((P)[0]),   \
+			  pool_aligned_header_bytes, (A));                    \
+      pool_get_aligned (P, E, A);                                             \
+    }                                                                         \
+  while (0)
+
+#define pool_get_qsbr(Q, P, E) pool_get_aligned_qsbr (Q, P, E, 0)
+
+#define pool_get_zero_qsbr(Q, P, E)                                           \
+  do                                                                          \
+    {                                                                         \
+      pool_get_aligned_qsbr (Q, P, E, 0);                                     \
+      clib_memset ((E), 0, sizeof ((E)[0]));                                  \
+    }                                                                         \
+  while (0)
+
+#endif /* included_clib_qsbr_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -96,11 +96,172 @@ g2_test_pattern (elog_main_t * em, int g2_test, char *dump_file)
 }
 
 
+static void
+test_elog_log_events (elog_main_t * em, u32 n_iter, u32 seed)
+{
+  u32 i;
+
+  for (i = 0; i < n_iter; i++)
+    {
+      u32 j, n, sum;
+
+      n = 1 + (random_u32 (&seed) % 128);
+      sum = 0;
+      for (j = 0; j < n; j++)
+	sum += random_u32 (&seed);
+
+      {
+	ELOG_TYPE_XF (e);
+	ELOG (em, e, sum);
+      }
+
+      {
+	ELOG_TYPE_XF (e);
+	ELOG (em, e, sum + 1);
+      }
+
+      {
+	struct
+	{
+	  u32 string_index;
+	  f32 f;
+	} *d;
+	ELOG_TYPE_DECLARE (e) =
+	{
+	  .format = "fumble %s %.9f",.format_args =
+	    "t4f4",.n_enum_strings = 4,.enum_strings =
+	  {
+	"string0", "string1", "string2", "string3",},};
+
+	d = ELOG_DATA (em, e);
+
+	d->string_index = sum & 3;
+	d->f = (sum & 0xff) / 128.;
+      }
+
+      {
+	ELOG_TYPE_DECLARE (e) =
+	{
+	.format = "bar %d.%d.%d.%d",.format_args = "i1i1i1i1",};
+	ELOG_TRACK (my_track);
+	u8 *d = ELOG_TRACK_DATA (em, e, my_track);
+	d[0] = i + 0;
+	d[1] = i + 1;
+	d[2] = i + 2;
+	d[3] = i + 3;
+      }
+
+      {
+	ELOG_TYPE_DECLARE (e) =
+	{
+	.format = "bar `%s'",.format_args = "s20",};
+	struct
+	{
+	  char s[20];
+	} *d;
+	u8 *v;
+
+	d = ELOG_DATA (em, e);
+	v = format (0, "foo %d%c", i, 0);
+	clib_memcpy (d->s, v, clib_min (vec_len (v), sizeof (d->s)));
+      }
+
+      {
+	ELOG_TYPE_DECLARE (e) =
+	{
+	.format = "bar `%s'",.format_args = "T4",};
+	struct
+	{
+	  u32 offset;
+	} *d;
+
+	d = ELOG_DATA (em, e);
+	d->offset = elog_string (em, "string table %d", i);
+      }
+    }
+}
+
+#ifdef CLIB_UNIX
+#include <pthread.h>
+
+typedef struct
+{
+  elog_main_t *em;
+  u32 n_iter;
+  u32 seed;
+} test_elog_thread_args_t;
+
+static void *
+test_elog_thread_fn (void *arg)
+{
+  test_elog_thread_args_t *a = arg;
+
+  /* Gives this thread its own thread index, hence its own elog ring. */
+  clib_mem_set_thread_index ();
+  test_elog_log_events (a->em, a->n_iter, a->seed);
+  return 0;
+}
+
+/* Log from several threads at once, optionally streaming the
+   per-thread rings to a file while they run. */
+static clib_error_t *
+test_elog_threads (elog_main_t * em, u32 n_threads, u32 n_iter, u32 seed,
+		   char *stream_file)
+{
+  test_elog_thread_args_t *args = 0;
+  pthread_t *tids = 0;
+  clib_error_t *error = 0;
+  uword i, n_streamed = 0;
+
+  em->lock = clib_mem_alloc_aligned (CLIB_CACHE_LINE_BYTES,
+				     CLIB_CACHE_LINE_BYTES);
+  em->lock[0] = 0;
+  elog_alloc_threads (em, 1 + n_threads);
+
+  if (stream_file && (error = elog_stream_start (em, stream_file)))
+    return error;
+
+  vec_validate (args, n_threads - 1);
+  vec_validate (tids, n_threads - 1);
+  for (i = 0; i < n_threads; i++)
+    {
+      args[i].em = em;
+      args[i].n_iter = n_iter;
+      args[i].seed = seed + i;
+      if (pthread_create (&tids[i], 0, test_elog_thread_fn, &args[i]))
+	return clib_error_return_unix (0, "pthread_create");
+    }
+
+  /* Main thread logs too. */
+  test_elog_log_events (em, n_iter, seed);
+
+  for (i = 0; i < n_threads; i++)
+    {
+      if (stream_file)
+	n_streamed += elog_stream_flush (em);
+      pthread_join (tids[i], 0);
+    }
+
+  if (stream_file)
+    {
+      elog_stream_stop (em);
+      fformat (stdout, "streamed %wd + %lld events, %lld dropped\n",
+	       n_streamed, em->n_stream_events - n_streamed,
+	       em->n_stream_events_dropped);
+    }
+
+  vec_free (args);
+  vec_free (tids);
+  return 0;
+}
+#endif /* CLIB_UNIX */
+
+
 int
 test_elog_main (unformat_input_t * input)
 {
   clib_error_t *error = 0;
-  u32 i, n_iter, seed, max_events;
+  u32 n_iter, seed, max_events;
   elog_main_t _em, *em = &_em;
   u32 verbose;
   f64 min_sample_time;
@@ -109,6 +270,8 @@ test_elog_main (unformat_input_t * input)
   f64 align_tweak;
   f64 *align_tweaks;
   int g2_test;
+  u32 n_threads = 0;
+  char *stream_file = 0;
 
   n_iter = 100;
   max_events = 100000;
@@ -146,6 +309,10 @@ test_elog_main (unformat_input_t * input)
 	vec_add1 (align_tweaks, align_tweak);
       else if (unformat (input, "g2-test %=", &g2_test, 1))
 	;
+      else if (unformat (input, "threads %d", &n_threads))
+	;
+      else if (unformat (input, "stream %s", &stream_file))
+	;
       else
 	{
 	  error = clib_error_create ("unknown input `%U'\n",
@@ -206,84 +373,17 @@ test_elog_main (unformat_input_t * input)
       elog_enable_disable (em, 1);
       t[0] = unix_time_now ();
 
-      for (i = 0; i < n_iter; i++)
+#ifdef CLIB_UNIX
+      if (n_threads)
 	{
-	  u32 j, n, sum;
-
-	  n = 1 + (random_u32 (&seed) % 128);
-	  sum = 0;
-	  for (j = 0; j < n; j++)
-	    sum += random_u32 (&seed);
-
-	  {
-	    ELOG_TYPE_XF (e);
-	    ELOG (em, e, sum);
-	  }
-
-	  {
-	    ELOG_TYPE_XF (e);
-	    ELOG (em, e, sum + 1);
-	  }
-
-	  {
-	    struct
-	    {
-	      u32 string_index;
-	      f32 f;
-	    } *d;
-	    ELOG_TYPE_DECLARE (e) =
-	    {
-	      .format = "fumble %s %.9f",.format_args =
-		"t4f4",.n_enum_strings = 4,.enum_strings =
-	      {
-	    "string0", "string1", "string2", "string3",},};
-
-	    d = ELOG_DATA (em, e);
-
-	    d->string_index = sum & 3;
-	    d->f = (sum & 0xff) / 128.;
-	  }
-
-	  {
-	    ELOG_TYPE_DECLARE (e) =
-	    {
-	    .format = "bar %d.%d.%d.%d",.format_args = "i1i1i1i1",};
-	    ELOG_TRACK (my_track);
-	    u8 *d = ELOG_TRACK_DATA (em, e, my_track);
-	    d[0] = i + 0;
-	    d[1] = i + 1;
-	    d[2] = i + 2;
-	    d[3] = i + 3;
-	  }
-
-	  {
-	    ELOG_TYPE_DECLARE (e) =
-	    {
-	    .format = "bar `%s'",.format_args = "s20",};
-	    struct
-	    {
-	      char s[20];
-	    } *d;
-	    u8 *v;
-
-	    d = ELOG_DATA (em, e);
-	    v = format (0, "foo %d%c", i, 0);
-	    clib_memcpy (d->s, v, clib_min (vec_len (v), sizeof (d->s)));
-	  }
-
-	  {
-	    ELOG_TYPE_DECLARE (e) =
-	    {
-	    .format = "bar `%s'",.format_args = "T4",};
-	    struct
-	    {
-	      u32 offset;
-	    } *d;
-
-	    d = ELOG_DATA (em, e);
-	    d->offset = elog_string (em, "string table %d", i);
-	  }
+	  error = test_elog_threads (em, n_threads, n_iter, seed,
+				     stream_file);
+	  if (error)
+	    goto done;
 	}
+      else
+#endif
+	test_elog_log_events (em, n_iter, seed);
 
       do
 	{
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vppinfra/qsbr.h>
+#include <vppinfra/format.h>
+#include <vppinfra/error.h>
+#include <vppinfra/time.h>
+#include <vppinfra/random.h>
+#include <pthread.h>
+
+#define QSBR_TEST_MAGIC 0x51534252
+#define QSBR_TEST_DEAD	0xdeaddead
+
+typedef struct
+{
+  u32 magic;
+  u32 seq;
+} qsbr_test_obj_t;
+
+typedef struct
+{
+  /* shared with readers */
+  qsbr_test_obj_t *volatile obj;
+  u32 *volatile vec;
+  qsbr_test_obj_t *volatile pool;
+  volatile u32 pool_len;
+  volatile u32 stop;
+
+  clib_qsbr_main_t qsbr;
+  u32 n_readers;
+  u32 iterations;
+  u32 quiescent_interval;
+  u32 verbose;
+  u32 n_freed;
+  u64 *reader_errors;
+  u64 *reader_loops;
+} qsbr_test_main_t;
+
+static qsbr_test_main_t qsbr_test_main;
+
+typedef struct
+{
+  qsbr_test_main_t *tm;
+  u32 thread_index;
+} qsbr_test_reader_args_t;
+
+static void *
+qsbr_test_reader (void *arg)
+{
+  qsbr_test_reader_args_t *a = arg;
+  qsbr_test_main_t *tm = a->tm;
+  u32 thread_index = a->thread_index;
+  u32 seed = thread_index;
+  u64 errors = 0, loops = 0;
+
+  clib_qsbr_thread_online (&tm->qsbr, thread_index);
+
+  while (!__atomic_load_n (&tm->stop, __ATOMIC_ACQUIRE))
+    {
+      u32 i;
+
+      for (i = 0; i < tm->quiescent_interval; i++)
+	{
+	  qsbr_test_obj_t *o, *p;
+	  u32 *v, len, j;
+
+	  o = __atomic_load_n (&tm->obj, __ATOMIC_ACQUIRE);
+	  if (o && o->magic != QSBR_TEST_MAGIC)
+	    errors++;
+
+	  /* element j of the vector always holds j */
+	  v = __atomic_load_n (&tm->vec, __ATOMIC_ACQUIRE);
+	  len = v ? __atomic_load_n (&_vec_len (v), __ATOMIC_ACQUIRE) : 0;
+	  if (len)
+	    {
+	      j = random_u32 (&seed) % len;
+	      if (v[j] != j)
+		errors++;
+	    }
+
+	  /* length first: a pool loaded afterwards holds at least len elts */
+	  len = __atomic_load_n (&tm->pool_len, __ATOMIC_ACQUIRE);
+	  p = __atomic_load_n (&tm->pool, __ATOMIC_ACQUIRE);
+	  if (p && len)
+	    {
+	      j = random_u32 (&seed) % len;
+	      if (p[j].magic != QSBR_TEST_MAGIC || p[j].seq != j)
+		errors++;
+	    }
+	  loops++;
+	}
+
+      clib_qsbr_quiescent (&tm->qsbr, thread_index);
+    }
+
+  clib_qsbr_thread_offline (&tm->qsbr, thread_index);
+
+  tm->reader_errors[thread_index] = errors;
+  tm->reader_loops[thread_index] = loops;
+  return 0;
+}
+
+static void
+qsbr_test_obj_free (void *data)
+{
+  qsbr_test_obj_t *o = data;
+
+  /* make any late reader fail loudly */
+  o->magic = QSBR_TEST_DEAD;
+  qsbr_test_main.n_freed++;
+  clib_mem_free (o);
+}
+
+static int
+test_qsbr_stress (qsbr_test_main_t *tm)
+{
+  qsbr_test_reader_args_t *args = 0;
+  pthread_t *threads = 0;
+  u64 errors = 0, loops = 0;
+  u32 i, n_threads = tm->n_readers + 1;
+  f64 t0;
+  int rv = 0;
+
+  /* thread 0 is the writer and never reads */
+  clib_qsbr_init (&tm->qsbr, n_threads);
+  vec_validate (tm->reader_errors, n_threads - 1);
+  vec_validate (tm->reader_loops, n_threads - 1);
+  vec_validate (args, n_threads - 1);
+  vec_validate (threads, n_threads - 1);
+
+  for (i = 1; i < n_threads; i++)
+    {
+      args[i].tm = tm;
+      args[i].thread_index = i;
+      if (pthread_create (&threads[i], 0, qsbr_test_reader, &args[i]))
+	{
+	  clib_unix_warning ("pthread_create");
+	  return 1;
+	}
+    }
+
+  t0 = unix_time_now ();
+
+  for (i = 0; i < tm->iterations; i++)
+    {
+      qsbr_test_obj_t *o, *old, *e;
+
+      o = clib_mem_alloc (sizeof (*o));
+      o->magic = QSBR_TEST_MAGIC;
+      o->seq = i;
+      old = tm->obj;
+      clib_qsbr_assign_pointer (tm->obj, o);
+      if (old)
+	clib_qsbr_call_after_grace_period (&tm->qsbr, qsbr_test_obj_free,
+					   old);
+
+      vec_add1_qsbr (&tm->qsbr, tm->vec, i);
+
+      pool_get_qsbr (&tm->qsbr, tm->pool, e);
+      e->magic = QSBR_TEST_MAGIC;
+      e->seq = e - tm->pool;
+      __atomic_store_n (&tm->pool_len, pool_len (tm->pool),
+			__ATOMIC_RELEASE);
+
+      clib_qsbr_poll (&tm->qsbr);
+    }
+
+  __atomic_store_n (&tm->stop, 1, __ATOMIC_RELEASE);
+  for (i = 1; i < n_threads; i++)
+    pthread_join (threads[i], 0);
+
+  clib_qsbr_synchronize (&tm->qsbr, 0);
+
+  for (i = 1; i < n_threads; i++)
+    {
+      errors += tm->reader_errors[i];
+      loops += tm->reader_loops[i];
+    }
+
+  fformat (stdout, "%u iterations, %u readers, %llu reader loops in %.2fs\n",
+	   tm->iterations, tm->n_readers, loops, unix_time_now () - t0);
+  if (tm->verbose)
+    fformat (stdout, "%U\n", format_clib_qsbr, &tm->qsbr);
+
+  if (errors)
+    {
+      fformat (stdout, "FAILED: readers saw %llu freed objects\n", errors);
+      rv = 1;
+    }
+  if (clib_qsbr_n_pending (&tm->qsbr))
+    {
+      fformat (stdout, "FAILED: %u objects not reclaimed\n",
+	       clib_qsbr_n_pending (&tm->qsbr));
+      rv = 1;
+    }
+  if (tm->iterations && tm->n_freed != tm->iterations - 1)
+    {
+      fformat (stdout, "FAILED: freed %u objects, expected %u\n",
+	       tm->n_freed, tm->iterations - 1);
+      rv = 1;
+    }
+
+  clib_mem_free (tm->obj);
+  vec_free (tm->vec);
+  pool_free (tm->pool);
+  clib_qsbr_free (&tm->qsbr);
+  vec_free (tm->reader_errors);
+  vec_free (tm->reader_loops);
+  vec_free (args);
+  vec_free (threads);
+
+  return rv;
+}
+
+static int
+test_qsbr_main (unformat_input_t *input)
+{
+  qsbr_test_main_t *tm = &qsbr_test_main;
+
+  tm->n_readers = 4;
+  tm->iterations = 100000;
+  tm->quiescent_interval = 16;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "readers %u", &tm->n_readers))
+	;
+      else if (unformat (input, "iterations %u", &tm->iterations))
+	;
+      else if (unformat (input, "quiescent-interval %u",
+			 &tm->quiescent_interval))
+	;
+      else if (unformat (input, "verbose"))
+	tm->verbose = 1;
+      else
+	{
+	  clib_warning ("unknown input '%U'", format_unformat_error, input);
+	  return 1;
+	}
+    }
+
+  if (test_qsbr_stress (tm))
+    return 1;
+
+  fformat (stdout, "PASS\n");
+  return 0;
+}
+
+#ifdef CLIB_UNIX
+int
+main (int argc, char *argv[])
+{
+  unformat_input_t i;
+  int ret;
+
+  clib_mem_init (0, 3ULL << 30);
+
+  unformat_init_command_line (&i, argv);
+  ret = test_qsbr_main (&i);
+  unformat_free (&i);
+
+  return ret;
+}
+#endif /* CLIB_UNIX */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
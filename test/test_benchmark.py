@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+
+import json
+import re
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+from vpp_papi_provider import CliFailedCommandError
+
+
+class TestBenchmark(VppTestCase):
+    """ Benchmark Plugin Test Case """
+
+    vpp_worker_count = 2
+    extra_vpp_plugin_config = ["plugin", "benchmark_plugin.so",
+                               "{", "enable", "}"]
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestBenchmark, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestBenchmark, cls).tearDownClass()
+
+    def run_benchmark(self, args):
+        reply = self.vapi.cli("benchmark run %s warmup 0.2 duration 0.5 json"
+                              % args)
+        return json.loads(reply)
+
+    def scenario_setup(self, scenario):
+        """ rx and tx pg interfaces and table of a scenario """
+        reply = self.vapi.cli("show benchmark scenarios")
+        m = re.search(r"^%s .*pg(\d+) -> pg(\d+), table (\d+)" % scenario,
+                      reply, re.M)
+        self.assertIsNotNone(m, reply)
+        return ["pg" + m.group(1), "pg" + m.group(2), int(m.group(3))]
+
+    def verify_result(self, r, scenario, streams):
+        self.assertEqual(r["scenario"], scenario)
+        self.assertEqual(r["packet_size"], 64)
+        self.assertEqual(r["streams"], streams)
+        self.assertGreater(r["duration"], 0)
+        self.assertGreater(r["rx_packets"], 0)
+        self.assertGreater(r["tx_packets"], 0)
+        self.assertGreater(r["rx_mpps"], 0)
+        self.assertGreater(r["clocks_per_packet"], 0)
+
+        # the generator is not part of the cost
+        names = [n["name"] for n in r["nodes"]]
+        self.assertNotIn("pg-input", names)
+        self.assertAlmostEqual(sum(n["clocks"] for n in r["nodes"]) /
+                               r["tx_packets"],
+                               r["clocks_per_packet"], delta=0.01)
+        for n in r["nodes"]:
+            self.assertGreater(n["vectors"], 0)
+            self.assertGreaterEqual(n["vectors"], n["calls"])
+
+    def test_benchmark_l2_xconnect(self):
+        """ l2-xconnect results """
+        out = self.run_benchmark("l2-xconnect")
+        self.assertEqual(out["workers"], 2)
+        self.assertEqual(len(out["results"]), 1)
+        r = out["results"][0]
+        self.verify_result(r, "l2-xconnect", 1)
+        self.assertEqual(r["scale"], 0)
+        names = [n["name"] for n in r["nodes"]]
+        self.assertIn("l2-input", names)
+        self.assertIn("l2-output", names)
+
+        # torn down after the run
+        rx, tx, _ = self.scenario_setup("l2-xconnect")
+        reply = self.vapi.cli("show mode %s %s" % (rx, tx))
+        self.assertIn("l3 %s" % rx, reply)
+        self.assertIn("l3 %s" % tx, reply)
+
+    def test_benchmark_workers(self):
+        """ one stream on each worker """
+        r = self.run_benchmark("l2-xconnect workers 2")["results"][0]
+        self.verify_result(r, "l2-xconnect", 2)
+
+        with self.assertRaises(CliFailedCommandError):
+            self.vapi.cli("benchmark run l2-xconnect workers 3")
+
+    def test_benchmark_rerun(self):
+        """ a second run does not inherit the first one's config """
+        for scale in (10, 20):
+            r = self.run_benchmark("ip4-fib scale %d" % scale)["results"][0]
+            self.verify_result(r, "ip4-fib", 1)
+            self.assertEqual(r["scale"], scale)
+            _, _, table = self.scenario_setup("ip4-fib")
+            self.assertNotIn("ipv4-VRF:%d" % table,
+                             self.vapi.cli("show ip fib summary"))
+        self.assertEqual(self.vapi.cli("show packet-generator").count(
+            "benchmark-"), 0)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
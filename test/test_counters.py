@@ -37,3 +37,11 @@ class TestCounters(VppTestCase):
         if error:
             self.logger.critical(error)
             self.assertNotIn('failed', error)
+
+    def test_counter_histogram_buckets(self):
+        """ Histogram Bucket Bounds """
+        error = self.vapi.cli("test counter histogram buckets")
+
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn('failed', error)
@@ -24,5 +24,37 @@ class TestCrypto(VppTestCase):
             self.logger.critical(error)
         self.assertNotIn("FAIL", error)
 
+    def set_handler(self, algs, engine):
+        reply = self.vapi.cli("set crypto handler %s %s" %
+                              (" ".join(algs), engine))
+        self.assertNotIn("failed", reply)
+
+    def test_crypto_linked(self):
+        """ Crypto HMAC batches and linked cipher + HMAC ops """
+        if "native" not in self.vapi.cli("show crypto engines"):
+            self.skipTest("native crypto engine not available")
+
+        ciphers = ["aes-128-cbc", "aes-192-cbc", "aes-256-cbc"]
+        hmacs = ["hmac-sha-1", "hmac-sha-224", "hmac-sha-256",
+                 "hmac-sha-384", "hmac-sha-512"]
+
+        # the native linked handler, then openssl ciphers with native
+        # HMAC, which run one op type after the other
+        self.set_handler(hmacs, "native")
+        for engine in ("native", "openssl"):
+            self.set_handler(ciphers, engine)
+            reply = self.vapi.cli("test crypto")
+            self.assertNotIn("FAIL", reply)
+            for h in hmacs:
+                self.assertRegex(reply, r"%s batch of \d+ \[native\]\s+OK"
+                                 % h)
+                self.assertRegex(reply, r"%s batch of \d+ chained "
+                                 r"\[native\]\s+OK" % h)
+                for c in ciphers:
+                    self.assertRegex(reply, r"%s \+ %s linked batch of \d+ "
+                                     r"\[%s \+ native\]\s+OK" %
+                                     (c, h, engine))
+        self.set_handler(ciphers, "native")
+
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)
@@ -17,6 +17,7 @@ from framework import VppTestCase, VppTestRunner, running_extended_tests
 from framework import tag_run_solo
 from vpp_object import VppObject
 from vpp_pg_interface import CaptureTimeoutError
+from vpp_papi_provider import CliFailedCommandError
 from util import ppp
 from ipfix import IPFIX, Set, Template, Data, IPFIXDecoder
 from vpp_ip_route import VppIpRoute, VppRoutePath
@@ -1052,6 +1053,147 @@ class ReenableFP(MethodHolder):
         ipfix.remove_vpp_config()
         self.logger.info("FFP_TEST_FINISH_0001")
 
+@tag_fixme_vpp_workers
+class CacheParams(MethodHolder):
+    """flow cache size, eviction and sampling parameters"""
+
+    @classmethod
+    def setUpClass(cls):
+        super(CacheParams, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(CacheParams, cls).tearDownClass()
+
+    def create_flows(self, n_flows, n_pkts=1):
+        """ n_flows UDP flows from pg3 to pg4, distinct source ports """
+        self.pkts = []
+        for sport in range(1024, 1024 + n_flows):
+            for _ in range(n_pkts):
+                self.pkts.append(
+                    Ether(src=self.pg3.remote_mac, dst=self.pg3.local_mac) /
+                    IP(src=self.pg3.remote_ip4, dst=self.pg4.remote_ip4) /
+                    UDP(sport=sport, dport=4321) /
+                    Raw(b'\xa5' * 100))
+
+    def collect_records(self, decoder, set_id, timeout=2):
+        """ decode the data records of every cflow packet until none
+        arrives within timeout """
+        records = []
+        while True:
+            try:
+                p = self.collector.wait_for_packet(timeout=timeout)
+            except CaptureTimeoutError:
+                return records
+            if p[Set].setID == set_id and p.haslayer(Data):
+                records.extend(decoder.decode_data_set(p.getlayer(Set)))
+
+    def test_0001(self):
+        """ cache-size range and eviction """
+        self.logger.info("FFP_TEST_START_0001")
+
+        # fewer than two buckets, more than 2^24 entries, 1 << 32 rounding
+        for size in (8, 15, (1 << 24) + 1, (1 << 31) + 1):
+            with self.assertRaises(CliFailedCommandError):
+                self.vapi.cli("flowprobe params cache-size %d" % size)
+
+        # two 8-way buckets
+        self.vapi.cli("flowprobe params cache-size 16")
+
+        self.pg_enable_capture(self.pg_interfaces)
+        ipfix = VppCFLOW(test=self, intf='pg4', layer='l3 l4',
+                         datapath='ip4', active=10)
+        ipfix.add_vpp_config()
+
+        # the cache is allocated now
+        with self.assertRaises(CliFailedCommandError):
+            self.vapi.cli("flowprobe params cache-size 1024")
+
+        ipfix_decoder = IPFIXDecoder()
+        templates = ipfix.verify_templates(ipfix_decoder, count=1)
+
+        evicted = "/err/flowprobe-ip4/Flow cache evictions"
+        n_evicted = self.statistics.get_err_counter(evicted)
+
+        n_flows = 64
+        self.create_flows(n_flows)
+        self.send_packets(src_if=self.pg3, dst_if=self.pg4)
+
+        # at most 16 flows fit, every other one pushed an older one out
+        n_evicted = self.statistics.get_err_counter(evicted) - n_evicted
+        self.assertGreaterEqual(n_evicted, n_flows - 16)
+        self.assertLess(n_evicted, n_flows)
+
+        # evicted flows are exported right away, each with its one packet
+        self.vapi.ipfix_flush()
+        records = self.collect_records(ipfix_decoder, templates[0])
+        self.assertGreaterEqual(len(records), n_evicted)
+        for record in records:
+            self.assertEqual(int(binascii.hexlify(record[2]), 16), 1)
+
+        ipfix.remove_vpp_config()
+        self.logger.info("FFP_TEST_FINISH_0001")
+
+    def test_0002(self):
+        """ packet sampling scales the exported counts """
+        self.logger.info("FFP_TEST_START_0002")
+        self.pg_enable_capture(self.pg_interfaces)
+
+        self.vapi.cli("flowprobe params sample packets 4")
+        ipfix = VppCFLOW(test=self, intf='pg4', layer='l3 l4',
+                         datapath='ip4')
+        ipfix.add_vpp_config()
+
+        ipfix_decoder = IPFIXDecoder()
+        templates = ipfix.verify_templates(ipfix_decoder, count=1)
+
+        # one flow, no active timer: every sampled packet is a record
+        self.create_flows(1, n_pkts=8)
+        capture = self.send_packets(src_if=self.pg3, dst_if=self.pg4)
+
+        self.vapi.ipfix_flush()
+        records = self.collect_records(ipfix_decoder, templates[0])
+        self.assertEqual(len(records), 2)
+        for record in records:
+            self.assertEqual(int(binascii.hexlify(record[2]), 16), 4)
+            self.assertEqual(int(binascii.hexlify(record[1]), 16),
+                             4 * capture[0][IP].len)
+
+        ipfix.remove_vpp_config()
+        self.vapi.cli("flowprobe params sample packets 1")
+        self.logger.info("FFP_TEST_FINISH_0002")
+
+    def test_0003(self):
+        """ flow sampling accounts all packets of a sampled flow """
+        self.logger.info("FFP_TEST_START_0003")
+        self.pg_enable_capture(self.pg_interfaces)
+
+        self.vapi.cli("flowprobe params sample flows 4")
+        ipfix = VppCFLOW(test=self, intf='pg4', layer='l3 l4',
+                         datapath='ip4')
+        ipfix.add_vpp_config()
+
+        ipfix_decoder = IPFIXDecoder()
+        templates = ipfix.verify_templates(ipfix_decoder, count=1)
+
+        n_flows = 64
+        self.create_flows(n_flows, n_pkts=2)
+        self.send_packets(src_if=self.pg3, dst_if=self.pg4)
+
+        self.vapi.ipfix_flush()
+        records = self.collect_records(ipfix_decoder, templates[0])
+
+        # roughly a quarter of the flows, each with both of its packets
+        sports = [int(binascii.hexlify(r[7]), 16) for r in records]
+        self.assertGreater(len(set(sports)), 0)
+        self.assertLess(len(set(sports)), n_flows)
+        for sport in set(sports):
+            self.assertEqual(sports.count(sport), 2)
+
+        ipfix.remove_vpp_config()
+        self.vapi.cli("flowprobe params sample flows 1")
+        self.logger.info("FFP_TEST_FINISH_0003")
+
 
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)
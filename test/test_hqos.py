@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+
+import re
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+from vpp_papi_provider import CliFailedCommandError
+
+from scapy.layers.inet import IP, UDP
+from scapy.layers.l2 import Ether
+from scapy.packet import Raw
+
+# default DSCP map: EF (46) is traffic class 0, 0 is best-effort queue 0
+DSCP_EF = 46
+DSCP_BE = 0
+QUEUE_TC0 = 0
+QUEUE_BE0 = 3
+
+
+class TestHQoS(VppTestCase):
+    """ Hierarchical QoS Test Case """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestHQoS, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestHQoS, cls).tearDownClass()
+
+    def setUp(self):
+        super(TestHQoS, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        # two subscribers behind pg1
+        self.pg1.generate_remote_hosts(2)
+        self.pg1.configure_ipv4_neighbors()
+
+    def tearDown(self):
+        if "pg1" in self.vapi.cli("show hqos"):
+            self.vapi.cli("hqos port pg1 disable")
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestHQoS, self).tearDown()
+
+    def create_stream(self, host, dscp, n_pkts, size=100):
+        return [(Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac) /
+                 IP(src=self.pg0.remote_ip4, dst=host.ip4, tos=dscp << 2) /
+                 UDP(sport=1234, dport=1234) /
+                 Raw(b'\xa5' * size)) for i in range(n_pkts)]
+
+    def pipe_queues(self, pipe):
+        """ per queue (enq, deq, drop) counters of subport 0 pipe <pipe> """
+        reply = self.vapi.cli("show hqos pg1 subport 0 pipe %d" % pipe)
+        queues = {}
+        for m in re.finditer(r"queue (\d+) tc \d+: depth \d+ enq (\d+) "
+                             r"deq (\d+) deq-bytes \d+ drop (\d+)", reply):
+            queues[int(m.group(1))] = (int(m.group(2)), int(m.group(3)),
+                                       int(m.group(4)))
+        self.assertEqual(len(queues), 7, reply)
+        return queues
+
+    def test_hqos_port_limits(self):
+        """ HQoS port size limits """
+        for args in ("subports 0", "pipes 0", "pipes 65537",
+                     "subports 4097", "subports 4096 pipes 65536",
+                     "subports 32 pipes 65536"):
+            with self.assertRaises(CliFailedCommandError):
+                self.vapi.cli("hqos port pg1 %s" % args)
+        self.vapi.cli("hqos port pg1 subports 4 pipes 1024")
+
+    def test_hqos_classify(self):
+        """ HQoS pipe and traffic class classification """
+        enqueued = "/err/hqos-enqueue/packets enqueued"
+        n_enqueued = self.statistics.get_err_counter(enqueued)
+
+        self.vapi.cli("hqos port pg1 subports 1 pipes 4")
+        self.vapi.cli("hqos classify pg1 ip4 %s pipe 1" %
+                      self.pg1.remote_hosts[1].ip4)
+
+        # host 0 takes the default pipe 0, host 1 pipe 1
+        pkts = (self.create_stream(self.pg1.remote_hosts[0], DSCP_BE, 10) +
+                self.create_stream(self.pg1.remote_hosts[1], DSCP_EF, 20) +
+                self.create_stream(self.pg1.remote_hosts[1], DSCP_BE, 30))
+        self.send_and_expect(self.pg0, pkts, self.pg1)
+
+        q = self.pipe_queues(0)
+        self.assertEqual(q[QUEUE_BE0], (10, 10, 0))
+        self.assertEqual(q[QUEUE_TC0], (0, 0, 0))
+        q = self.pipe_queues(1)
+        self.assertEqual(q[QUEUE_TC0], (20, 20, 0))
+        self.assertEqual(q[QUEUE_BE0], (30, 30, 0))
+
+        # remap EF to best-effort queue 2
+        self.vapi.cli("hqos dscp pg1 dscp %d tc 3 queue 2" % DSCP_EF)
+        pkts = self.create_stream(self.pg1.remote_hosts[1], DSCP_EF, 5)
+        self.send_and_expect(self.pg0, pkts, self.pg1)
+        q = self.pipe_queues(1)
+        self.assertEqual(q[QUEUE_TC0], (20, 20, 0))
+        self.assertEqual(q[QUEUE_BE0 + 2], (5, 5, 0))
+
+        self.assertEqual(self.statistics.get_err_counter(enqueued) -
+                         n_enqueued, 65)
+
+    def test_hqos_tc_shaping(self):
+        """ HQoS per traffic class shaping """
+        full = "/err/hqos-enqueue/packets dropped, queue full"
+        n_full = self.statistics.get_err_counter(full)
+
+        self.vapi.cli("hqos port pg1 subports 1 pipes 4")
+
+        # pipe 1: TC0 shaped to 10 kB/s with the default 36 kB bucket
+        self.vapi.cli("hqos pipe-profile pg1 profile 1 tc 0 rate 80k")
+        self.vapi.cli("hqos pipe pg1 subport 0 pipe 1 profile 1")
+        self.vapi.cli("hqos classify pg1 ip4 %s pipe 1" %
+                      self.pg1.remote_hosts[1].ip4)
+
+        # ~50 kB in one burst: the bucket passes ~34 packets, the rest
+        # waits in the queue and leaves at ~1 packet per 100ms.
+        # Best-effort on the same pipe and the unshaped pipe 0 are not
+        # held back.
+        n_tc0 = 50
+        pkts = (self.create_stream(self.pg1.remote_hosts[1], DSCP_EF, n_tc0,
+                                   size=1000) +
+                self.create_stream(self.pg1.remote_hosts[1], DSCP_BE, 10) +
+                self.create_stream(self.pg1.remote_hosts[0], DSCP_EF, 10))
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg0.add_stream(pkts)
+        self.pg_start()
+
+        q = self.pipe_queues(1)
+        enq, deq, drop = q[QUEUE_TC0]
+        self.assertEqual((enq, drop), (n_tc0, 0))
+        self.assertGreater(deq, 0)
+        self.assertLess(deq, n_tc0)
+        self.assertEqual(q[QUEUE_BE0], (10, 10, 0))
+        self.assertEqual(self.pipe_queues(0)[QUEUE_TC0], (10, 10, 0))
+
+        # the backlog drains at the shaped rate
+        self.sleep(3)
+        self.assertEqual(self.pipe_queues(1)[QUEUE_TC0], (n_tc0, n_tc0, 0))
+        self.pg1.get_capture(n_tc0 + 20)
+        self.assertEqual(self.statistics.get_err_counter(full), n_full)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+
+import os
+import re
+import unittest
+
+from framework import tag_fixme_vpp_workers
+from framework import VppTestCase, VppTestRunner
+from vpp_ip_route import VppIpTable, VppIpRoute, VppRoutePath
+
+# three of these fit in the smallest static server cache, four do not
+FILE_SIZE = 48 << 10
+
+
+class HttpTestCase(VppTestCase):
+    """ Client in app namespace 1 reaches servers in namespace 0 """
+
+    def setUp(self):
+        super(HttpTestCase, self).setUp()
+
+        self.vapi.session_enable_disable(is_enable=1)
+        self.create_loopback_interfaces(2)
+
+        for table_id, i in enumerate(self.lo_interfaces):
+            i.admin_up()
+            if table_id:
+                VppIpTable(self, table_id).add_vpp_config()
+            i.set_table_ip4(table_id)
+            i.config_ip4()
+
+        self.vapi.app_namespace_add_del(namespace_id="0",
+                                        sw_if_index=self.loop0.sw_if_index)
+        self.vapi.app_namespace_add_del(namespace_id="1",
+                                        sw_if_index=self.loop1.sw_if_index)
+
+        self.routes = [
+            VppIpRoute(self, self.loop0.local_ip4, 32,
+                       [VppRoutePath("0.0.0.0", 0xffffffff, nh_table_id=0)],
+                       table_id=1),
+            VppIpRoute(self, self.loop1.local_ip4, 32,
+                       [VppRoutePath("0.0.0.0", 0xffffffff, nh_table_id=1)])]
+        for r in self.routes:
+            r.add_vpp_config()
+
+    def tearDown(self):
+        for r in self.routes:
+            r.remove_vpp_config()
+        for i in self.lo_interfaces:
+            i.unconfig_ip4()
+            i.set_table_ip4(0)
+            i.admin_down()
+
+        super(HttpTestCase, self).tearDown()
+
+    def www_root(self):
+        www_root = os.path.join(self.tempdir, "www")
+        os.mkdir(www_root)
+        return www_root
+
+
+@tag_fixme_vpp_workers
+class TestHttp(HttpTestCase):
+    """ HTTP Test Case """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestHttp, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestHttp, cls).tearDownClass()
+
+    def test_http_parser(self):
+        """ Vector and scalar header scanning agree """
+        reply = self.vapi.cli("test http parser iterations 200")
+        self.assertIn("parser tests passed", reply)
+
+    def test_http_pipeline(self):
+        """ Pipelined requests all get a reply """
+        www_root = self.www_root()
+        with open(os.path.join(www_root, "index.html"), "w") as f:
+            f.write("<html>" + "x" * 1300 + "</html>\n")
+
+        uri = "tcp://%s/80" % self.loop0.local_ip4
+        self.vapi.cli("http static server www-root %s uri %s" %
+                      (www_root, uri))
+
+        for pipeline in (1, 8, 32):
+            reply = self.vapi.cli("test http clients appns 1 uri %s "
+                                  "path index.html sessions 4 requests 100 "
+                                  "pipeline %d" % (uri, pipeline))
+            m = re.search(r"pipeline (\d+): (\d+) replies .* (\d+) errors",
+                          reply)
+            self.assertIsNotNone(m, reply)
+            self.assertEqual(int(m.group(1)), pipeline)
+            self.assertEqual(int(m.group(2)), 400)
+            self.assertEqual(int(m.group(3)), 0)
+
+
+@tag_fixme_vpp_workers
+class TestHttpStaticCache(HttpTestCase):
+    """ HTTP Static Server Cache Test Case """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestHttpStaticCache, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestHttpStaticCache, cls).tearDownClass()
+
+    def write_file(self, name, size):
+        with open(os.path.join(self.www, name), "w") as f:
+            f.write("x" * size)
+
+    def fetch(self, name, requests=1):
+        reply = self.vapi.cli("test http clients appns 1 uri %s path %s "
+                              "sessions 1 requests %d" %
+                              (self.uri, name, requests))
+        m = re.search(r"(\d+) replies .* (\d+) errors", reply)
+        self.assertIsNotNone(m, reply)
+        self.assertEqual(int(m.group(1)), requests)
+        self.assertEqual(int(m.group(2)), 0)
+
+        # the entry stays attached until the server session is cleaned up
+        for i in range(20):
+            if not self.vapi.cli("show http static server sessions").strip():
+                return
+            self.sleep(0.05)
+        self.fail("server session not cleaned up")
+
+    def cache_stats(self):
+        reply = self.vapi.cli("show http static server cache")
+        m = re.search(r"cache size (\d+) bytes, limit \d+ bytes, "
+                      r"loads (\d+), evictions (\d+)", reply)
+        self.assertIsNotNone(m, reply)
+        return [int(g) for g in m.groups()]
+
+    def cached_files(self):
+        """ file name to size, most recently added first """
+        reply = self.vapi.cli("show http static server cache verbose")
+        files = {}
+        for m in re.finditer(r"%s/(\S+)\s+(\d+)" % re.escape(self.www),
+                             reply):
+            files[m.group(1)] = int(m.group(2))
+        return files
+
+    def test_http_static_cache(self):
+        """ Cache hits, LRU eviction and clearing """
+        self.www = self.www_root()
+        for name in ("a.html", "b.html", "c.html", "d.html"):
+            self.write_file(name, FILE_SIZE)
+
+        # three files fit in the smallest cache, the fourth evicts one
+        self.uri = "tcp://%s/80" % self.loop0.local_ip4
+        self.vapi.cli("http static server www-root %s uri %s cache-size 128k"
+                      % (self.www, self.uri))
+
+        # one load, every later request on the session is a hit
+        self.fetch("a.html", requests=4)
+        self.assertEqual(self.cache_stats(), [FILE_SIZE, 1, 0])
+
+        self.fetch("b.html")
+        self.fetch("c.html")
+        self.assertEqual(self.cache_stats(), [3 * FILE_SIZE, 3, 0])
+
+        # a, the oldest, was used again and gets another round: b goes
+        self.fetch("a.html")
+        self.fetch("d.html")
+        self.assertEqual(self.cache_stats(), [3 * FILE_SIZE, 4, 1])
+        self.assertEqual(sorted(self.cached_files()),
+                         ["a.html", "c.html", "d.html"])
+
+        # changes on disk are not seen until the cache is cleared
+        self.write_file("c.html", 1000)
+        self.fetch("c.html")
+        self.assertEqual(self.cache_stats()[1], 4)
+        self.assertEqual(self.cached_files()["c.html"], FILE_SIZE)
+
+        self.assertIn("Cache cleared",
+                      self.vapi.cli("clear http static cache"))
+        self.assertEqual(self.cache_stats(), [0, 4, 4])
+        self.assertEqual(self.cached_files(), {})
+
+        self.fetch("c.html")
+        self.assertEqual(self.cache_stats(), [1000, 5, 4])
+        self.assertEqual(self.cached_files(), {"c.html": 1000})
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
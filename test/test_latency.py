@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+
+from scapy.layers.inet import IP, UDP
+from scapy.layers.l2 import Ether
+from scapy.packet import Raw
+
+
+class TestLatencyTracking(VppTestCase):
+    """ Latency Tracking Test Case """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestLatencyTracking, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestLatencyTracking, cls).tearDownClass()
+
+    def setUp(self):
+        super(TestLatencyTracking, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    def tearDown(self):
+        self.vapi.cli("set latency-tracking disable")
+        self.vapi.cli("clear latency-tracking")
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestLatencyTracking, self).tearDown()
+
+    def create_stream(self, n_pkts):
+        return [(Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac) /
+                 IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+                 UDP(sport=1234, dport=1234) /
+                 Raw(b'\xa5' * 100)) for i in range(n_pkts)]
+
+    def latency(self, name, intf):
+        return self.statistics.get_counter(
+            "/if/latency/%s" % name)[intf.sw_if_index]
+
+    def test_latency_sample_all(self):
+        """ Every packet sampled """
+        self.vapi.cli("set latency-tracking sample 1")
+
+        self.send_and_expect(self.pg0, self.create_stream(65), self.pg1)
+
+        h = self.latency("rx-tx", self.pg0)
+        self.assertEqual(h.count, 65)
+        self.assertEqual(sum(h.buckets), 65)
+        self.assertGreater(h.sum, 0)
+
+        # counted against the receiving interface, nothing was handed off
+        self.assertEqual(self.latency("rx-tx", self.pg1).count, 0)
+        self.assertEqual(self.latency("handoff", self.pg0).count, 0)
+
+        self.assertRegex(self.vapi.cli("show latency-tracking"),
+                         r"rx-tx\s+65\s")
+
+        # not counted once disabled
+        self.vapi.cli("set latency-tracking disable")
+        self.send_and_expect(self.pg0, self.create_stream(10), self.pg1)
+        self.assertEqual(self.latency("rx-tx", self.pg0).count, 65)
+
+        self.vapi.cli("clear latency-tracking")
+        self.assertEqual(self.latency("rx-tx", self.pg0).count, 0)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -1,5 +1,9 @@
 #!/usr/bin/env python3
 
+import os
+import re
+import socket
+import struct
 import unittest
 
 from scapy.layers.inet import IP, UDP
@@ -290,6 +294,130 @@ class TestLinuxCP(VppTestCase):
         tun6.unconfig_ip6()
 
 
+# netlink route message constants, linux/rtnetlink.h
+RTM_NEWROUTE = 24
+RTM_DELROUTE = 25
+RTA_DST = 1
+RTA_OIF = 4
+RTA_GATEWAY = 5
+RT_TABLE_MAIN = 254
+RTPROT_STATIC = 4
+RTN_UNICAST = 1
+
+
+def nl_route_msg(msg_type, prefix, dst_len, gw, oif):
+    """ a raw RTM_NEWROUTE/RTM_DELROUTE message as the kernel sends it """
+    def attr(rta_type, payload):
+        rta = struct.pack("=HH", 4 + len(payload), rta_type) + payload
+        return rta + b"\x00" * (-len(rta) % 4)
+
+    rtm = struct.pack("=BBBBBBBBI", socket.AF_INET, dst_len, 0, 0,
+                      RT_TABLE_MAIN, RTPROT_STATIC, 0, RTN_UNICAST, 0)
+    attrs = (attr(RTA_DST, socket.inet_aton(prefix)) +
+             attr(RTA_OIF, struct.pack("=I", oif)) +
+             attr(RTA_GATEWAY, socket.inet_aton(gw)))
+    body = rtm + attrs
+    return struct.pack("=IHHII", 16 + len(body), msg_type, 0, 0, 0) + body
+
+
+class TestLinuxCPNetlink(VppTestCase):
+    """ Linux Control Plane netlink route batching """
+
+    extra_vpp_plugin_config = ["plugin",
+                               "linux_cp_plugin.so",
+                               "{", "enable", "}",
+                               "plugin",
+                               "linux_nl_plugin.so",
+                               "{", "enable", "}",
+                               "plugin",
+                               "linux_cp_unittest_plugin.so",
+                               "{", "enable", "}"]
+    extra_vpp_punt_config = ["linux-nl", "{", "nl-batch-size", "4", "}"]
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestLinuxCPNetlink, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestLinuxCPNetlink, cls).tearDownClass()
+
+    def setUp(self):
+        super(TestLinuxCPNetlink, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+        self.pg0.config_ip4()
+
+    def tearDown(self):
+        self.pg0.unconfig_ip4()
+        for i in self.pg_interfaces:
+            i.admin_down()
+        super(TestLinuxCPNetlink, self).tearDown()
+
+    def route_nhs(self, prefix):
+        """ next-hops of prefix in table 0, None if there is no route """
+        for e in self.vapi.ip_route_dump(0, False):
+            if str(e.route.prefix) == prefix:
+                return [str(p.nh.address.ip4) for p in e.route.paths]
+        return None
+
+    def test_linux_cp_nl_coalesce(self):
+        """ Linux CP netlink route coalescing """
+
+        # the first pair gets kernel ifindex 1
+        pair = VppLcpPair(self, self.pg0, self.pg1).add_vpp_config()
+        oif = 1
+        gw = ["10.10.10.%d" % i for i in range(1, 4)]
+
+        def new(p, g):
+            return nl_route_msg(RTM_NEWROUTE, p, 24, g, oif)
+
+        def delete(p, g):
+            return nl_route_msg(RTM_DELROUTE, p, 24, g, oif)
+
+        A, B, C, D, E, F = ["10.0.%d.0" % i for i in range(1, 7)]
+        msgs = [
+            # batch 1: the first add of A is redundant, B is deleted again
+            new(A, gw[0]), new(A, gw[1]), new(B, gw[0]), delete(B, gw[0]),
+            # batch 2: deletes are kept, and stop an add before them being
+            # dropped
+            delete(C, gw[0]), new(C, gw[0]), new(D, gw[0]), delete(D, gw[0]),
+            # batch 3: the first add of E is redundant
+            new(D, gw[0]), new(E, gw[0]), new(E, gw[1]), new(F, gw[0]),
+            # batch 4: nothing is coalesced with the previous batch
+            new(F, gw[1]), new(E, gw[2]),
+        ]
+        path = os.path.join(self.tempdir, "routes.nl")
+        with open(path, "wb") as f:
+            f.write(b"".join(msgs))
+
+        reply = self.vapi.cli("lcp nl replay %s" % path)
+        self.logger.info(reply)
+        self.assertIn("%d messages in" % len(msgs), reply)
+        n = int(re.search(r"(\d+) messages coalesced", reply).group(1))
+        self.assertEqual(n, 2)
+
+        self.assertEqual(self.route_nhs(A + "/24"), [gw[1]])
+        self.assertIsNone(self.route_nhs(B + "/24"))
+        self.assertEqual(self.route_nhs(C + "/24"), [gw[0]])
+        self.assertEqual(self.route_nhs(D + "/24"), [gw[0]])
+        self.assertEqual(self.route_nhs(E + "/24"), [gw[2]])
+        self.assertEqual(self.route_nhs(F + "/24"), [gw[1]])
+
+        # remove the routes again
+        with open(path, "wb") as f:
+            f.write(b"".join([delete(A, gw[1]), delete(C, gw[0]),
+                              delete(D, gw[0]), delete(E, gw[2]),
+                              delete(F, gw[1])]))
+        self.vapi.cli("lcp nl replay %s" % path)
+        for p in (A, C, D, E, F):
+            self.assertIsNone(self.route_nhs(p + "/24"))
+
+        pair.remove_vpp_config()
+
+
 class TestLinuxCPIpsec(TemplateIpsec,
                        TemplateIpsecItf4,
                        IpsecTun4):
@@ -1,9 +1,11 @@
 #!/usr/bin/env python3
 
+import glob
 import os
 import unittest
 
 from framework import VppTestCase, VppTestRunner, running_gcov_tests
+from vpp_papi_provider import CliFailedCommandError
 from vpp_ip_route import VppIpTable, VppIpRoute, VppRoutePath
 
 
@@ -86,5 +88,77 @@ class TestPcap(VppTestCase):
         os.remove('/tmp/filt.pcap')
 
 
+class TestPcapStream(VppTestCase):
+    """ Pcap Streaming Capture Test Cases """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestPcapStream, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestPcapStream, cls).tearDownClass()
+
+    def test_pcap_stream(self):
+        """ PCAP streaming capture with rotation """
+        cmds = ["loop create",
+                "set int ip address loop0 11.22.33.1/24",
+                "set int state loop0 up",
+                "loop create",
+                "set int ip address loop1 11.22.34.1/24",
+                "set int state loop1 up",
+                "set ip neighbor loop1 11.22.34.44 03:00:11:22:34:44",
+                "packet-generator new {\n"
+                "  name s0\n"
+                "  limit 50\n"
+                "  rate 100\n"
+                "  size 128-128\n"
+                "  interface loop0\n"
+                "  tx-interface loop1\n"
+                "  node loop1-output\n"
+                "  data {\n"
+                "    IP4: 1.2.3 -> dead.0000.0001\n"
+                "    UDP: 11.22.33.44 -> 11.22.34.44\n"
+                "    UDP: 1234 -> 2345\n"
+                "    incrementing 100\n"
+                "  }\n"
+                "}"]
+        for cmd in cmds:
+            self.vapi.cli(cmd)
+
+        for f in glob.glob('/tmp/stream.pcapng.*'):
+            os.remove(f)
+
+        with self.assertRaises(CliFailedCommandError):
+            self.vapi.cli("pcap trace tx intfc any file stream.pcapng "
+                          "stream ring-size 1000000")
+
+        # a ~200 byte record per packet, a new file every few packets
+        self.vapi.cli("pcap trace tx intfc any file stream.pcapng stream "
+                      "ring-size 64 rotate-size 1k rotate-files 3")
+        self.vapi.cli("packet-generator enable-stream s0")
+        self.sleep(1, "wait for the stream to finish")
+        status = self.vapi.cli("pcap trace status")
+        self.assertIn("rotate at", status)
+        self.vapi.cli("pcap trace tx off")
+
+        # only the last three files are kept, each a pcapng section
+        files = sorted(glob.glob('/tmp/stream.pcapng.*'),
+                       key=lambda f: int(f.rsplit('.', 1)[1]))
+        self.assertEqual(len(files), 3, files)
+        self.assertGreater(int(files[0].rsplit('.', 1)[1]), 0)
+        for f in files:
+            with open(f, 'rb') as fd:
+                self.assertEqual(fd.read(4), b'\x0a\x0d\x0d\x0a')
+            os.remove(f)
+
+        # the file name was released with the stream, start a plain capture
+        self.vapi.cli("pcap trace status")
+        self.vapi.cli("pcap trace tx max 10 intfc any file after.pcap")
+        self.vapi.cli_return_response("pcap trace tx off")
+        if os.path.exists('/tmp/after.pcap'):
+            os.remove('/tmp/after.pcap')
+
+
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)
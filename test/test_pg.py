@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 
 import unittest
+from collections import Counter
 
 import scapy.compat
 from scapy.packet import Raw
@@ -9,6 +10,7 @@ from scapy.layers.inet import IP, UDP
 from scapy.layers.inet6 import IPv6
 
 from framework import VppTestCase, VppTestRunner
+from vpp_papi_provider import CliFailedCommandError
 
 
 class TestPgTun(VppTestCase):
@@ -94,5 +96,83 @@ class TestPgTun(VppTestCase):
             self.assertEqual(rx[IPv6].dst, self.pg2.remote_ip6)
 
 
+class TestPgTemplates(VppTestCase):
+    """ PG Templates Test Case """
+
+    def setUp(self):
+        super(TestPgTemplates, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+        self.vapi.cli("set interface l2 xconnect pg0 pg1")
+
+    def tearDown(self):
+        self.vapi.cli("set interface l3 pg0")
+        for i in self.pg_interfaces:
+            i.admin_down()
+        super(TestPgTemplates, self).tearDown()
+
+    def new_stream(self, n_pkts, params):
+        """ a stream to 4 destinations over pg0 """
+        self.vapi.cli("packet-generator new {\n"
+                      "  name templates\n"
+                      "  limit %d\n"
+                      "  size 100-100\n"
+                      "  interface pg0\n"
+                      "  node ethernet-input\n"
+                      "  %s\n"
+                      "  data {\n"
+                      "    IP4: 00:01:02:03:04:05 -> 00:02:03:04:05:06\n"
+                      "    UDP: 10.0.0.1 -> 10.0.1.1 - 10.0.1.4\n"
+                      "    UDP: 1234 -> 4321\n"
+                      "    incrementing 58\n"
+                      "  }\n"
+                      "}" % (n_pkts, params))
+
+    def send_templates(self, n_pkts, n_templates, params=""):
+        """ run the stream, return the destinations captured on pg1 """
+        self.new_stream(n_pkts, "templates %d %s" % (n_templates, params))
+
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        reply = self.vapi.cli("show packet-generator verbose")
+        self.assertIn("templates %d," % n_templates, reply)
+        self.assertIn(" %d " % n_pkts, reply)
+        self.vapi.cli("packet-generator delete templates")
+
+        rxs = self.pg1.get_capture(n_pkts)
+        for rx in rxs:
+            self.assertEqual(len(rx), 100)
+            self.assertEqual(rx[UDP].dport, 4321)
+        return [rx[IP].dst for rx in rxs]
+
+    def test_pg_templates(self):
+        """ Packets rotate through the templates """
+        dsts = self.send_templates(10, 4)
+        self.assertEqual(dsts, ["10.0.1.%d" % (i % 4 + 1) for i in range(10)])
+
+        # fewer templates than the edits would make, the rest never shows
+        dsts = self.send_templates(5, 2)
+        self.assertEqual(dsts, ["10.0.1.%d" % (i % 2 + 1) for i in range(5)])
+
+
+class TestPgTemplatesMW(TestPgTemplates):
+    """ PG Templates Multi-worker Test Case """
+
+    vpp_worker_count = 2
+
+    def test_pg_workers_limit(self):
+        """ Limit split between workers """
+        # 6 packets from worker 0 starting at template 0, 5 from worker 1
+        # starting at template 2
+        dsts = self.send_templates(11, 4, "workers 0-1")
+        self.assertEqual(Counter(dsts), {"10.0.1.1": 3, "10.0.1.2": 3,
+                                         "10.0.1.3": 3, "10.0.1.4": 2})
+
+        with self.assertRaises(CliFailedCommandError):
+            self.new_stream(1, "workers 0-2")
+
+
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)
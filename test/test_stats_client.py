@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
 
+import re
 import unittest
 import psutil
 from vpp_papi.vpp_stats import VPPStats
@@ -8,6 +9,7 @@ from framework import tag_fixme_vpp_workers
 from framework import VppTestCase, VppTestRunner
 from scapy.layers.l2 import Ether
 from scapy.layers.inet import IP
+from vpp_ip_route import VppIpTable, VppIpRoute, VppRoutePath
 
 
 @tag_fixme_vpp_workers
@@ -26,6 +28,10 @@ class StatsClientTestCase(VppTestCase):
     def setUpConstants(cls):
         cls.extra_vpp_statseg_config = "per-node-counters on"
         cls.extra_vpp_statseg_config += "update-interval 0.05"
+        # profile every dispatch, so the histograms count exactly
+        cls.extra_vpp_punt_config = ["vlib", "{",
+                                     "node-profile-sample-interval", "1",
+                                     "}"]
         super(StatsClientTestCase, cls).setUpConstants()
 
     def test_set_errors(self):
@@ -139,6 +145,121 @@ class StatsClientTestCase(VppTestCase):
         for i in self.lo_interfaces:
             i.remove_vpp_config()
 
+    def test_histogram_merge(self):
+        """Test histograms merged across threads"""
+        values = [0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 100, 1000, 447, 448,
+                  1 << 20, 1 << 40]
+        self.vapi.cli("test counter histogram add " +
+                      " ".join(str(v) for v in values))
+        n_threads = int(
+            self.statistics.get_counter('/sys/num_worker_threads')) + 1
+
+        h = self.statistics.get_counter('/vlib/test-histogram')[0]
+        self.assertEqual(h.count, n_threads * len(values))
+        self.assertEqual(h.sum, n_threads * sum(values))
+
+        # vpp counted with vlib_histogram_bucket (), which has to agree
+        # with the bucket bounds the client reports
+        last = len(h.buckets) - 1
+        expected = [0] * len(h.buckets)
+        for v in values:
+            b = 0
+            while b < last and h.bucket_min(b + 1) <= v:
+                b += 1
+            self.assertLessEqual(h.bucket_min(b), v)
+            expected[b] += n_threads
+        self.assertEqual(h.buckets, expected)
+
+    def test_node_profile(self):
+        """Test node profiler entries"""
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        names = self.statistics.get_counter('/sys/node/names')
+        node = names.index('ip4-lookup')
+        max_clocks = self.statistics.get_counter('/sys/node/max_clocks')
+        self.assertEqual(len(max_clocks[0]), len(names))
+        # a gauge, reset on every update, so only its shape is stable
+        self.assertEqual(len(self.statistics.get_counter(
+            '/nodes/ip4-lookup/max_clocks')), 1)
+
+        hist = '/sys/node/clocks_per_vector_hist'
+        h = self.statistics.get_counter(hist)[node]
+        n_calls = self.statistics.get_counter('/sys/node/calls')[0][node]
+        self.assertEqual(len(h.buckets), 19)
+
+        # one ip4-lookup dispatch per burst
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4))
+        for i in range(3):
+            self.send_and_expect(self.pg0, p * 10, self.pg1)
+        self.sleep(0.2)
+
+        calls = self.statistics.get_counter('/sys/node/calls')[0][node]
+        self.assertEqual(calls - n_calls, 3)
+        after = self.statistics.get_counter(hist)[node]
+        self.assertEqual(after.count - h.count, calls - n_calls)
+        self.assertEqual(after.count, sum(after.buckets))
+        self.assertGreater(after.sum, h.sum)
+
+        for i in self.pg_interfaces:
+            i.unconfig()
+            i.admin_down()
+
+    def test_tcp_rtt_histogram(self):
+        """Test /net/tcp/rtt_us against show tcp stats"""
+        self.vapi.session_enable_disable(is_enable=1)
+        self.create_loopback_interfaces(2)
+        for table_id, i in enumerate(self.lo_interfaces):
+            i.admin_up()
+            if table_id:
+                VppIpTable(self, table_id).add_vpp_config()
+            i.set_table_ip4(table_id)
+            i.config_ip4()
+        self.vapi.app_namespace_add_del(namespace_id="0",
+                                        sw_if_index=self.loop0.sw_if_index)
+        self.vapi.app_namespace_add_del(namespace_id="1",
+                                        sw_if_index=self.loop1.sw_if_index)
+        routes = [VppIpRoute(self, self.loop1.local_ip4, 32,
+                             [VppRoutePath("0.0.0.0", 0xffffffff,
+                                           nh_table_id=1)]),
+                  VppIpRoute(self, self.loop0.local_ip4, 32,
+                             [VppRoutePath("0.0.0.0", 0xffffffff,
+                                           nh_table_id=0)], table_id=1)]
+        for r in routes:
+            r.add_vpp_config()
+
+        self.vapi.cli("clear tcp stats")
+        uri = "tcp://" + self.loop0.local_ip4 + "/1234"
+        error = self.vapi.cli("test echo server appns 0 fifo-size 4 uri " +
+                              uri)
+        self.assertNotIn("failed", error)
+        error = self.vapi.cli("test echo client mbytes 10 appns 1 "
+                              "fifo-size 4 no-output test-bytes "
+                              "syn-timeout 2 uri " + uri)
+        self.assertNotIn("failed", error)
+
+        h = self.statistics.get_counter('/net/tcp/rtt_us')[0]
+        m = re.search(r"RTT us: count (\d+)(?: mean ([\d.]+))?",
+                      self.vapi.cli("show tcp stats"))
+        self.assertIsNotNone(m)
+        self.assertEqual(h.count, int(m.group(1)))
+        self.assertEqual(h.count, sum(h.buckets))
+        if h.count:
+            self.assertAlmostEqual(h.sum / h.count, float(m.group(2)),
+                                   delta=0.05)
+
+        for r in routes:
+            r.remove_vpp_config()
+        for i in self.lo_interfaces:
+            i.unconfig_ip4()
+            i.set_table_ip4(0)
+            i.admin_down()
+        self.vapi.session_enable_disable(is_enable=0)
+
     @unittest.skip("Manual only")
     def test_mem_leak(self):
         def loop():
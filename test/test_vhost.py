@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
 
+import re
 import unittest
 
 from framework import VppTestCase, VppTestRunner
@@ -26,17 +27,18 @@ class TesVhostInterface(VppTestCase):
             for ifc in if_dump:
                 self.vapi.delete_vhost_user_if(ifc.sw_if_index)
 
-    def test_vhost(self):
-        """ Vhost User add/delete interface test """
+    def vhost_add_delete(self, enable_packed_ring=0):
         self.logger.info("Vhost User add interfaces")
 
         # create interface 1 (VirtualEthernet0/0/0)
-        vhost_if1 = VppVhostInterface(self, sock_filename='/tmp/sock1')
+        vhost_if1 = VppVhostInterface(self, sock_filename='/tmp/sock1',
+                                      enable_packed_ring=enable_packed_ring)
         vhost_if1.add_vpp_config()
         vhost_if1.admin_up()
 
         # create interface 2 (VirtualEthernet0/0/1)
-        vhost_if2 = VppVhostInterface(self, sock_filename='/tmp/sock2')
+        vhost_if2 = VppVhostInterface(self, sock_filename='/tmp/sock2',
+                                      enable_packed_ring=enable_packed_ring)
         vhost_if2.add_vpp_config()
         vhost_if2.admin_up()
 
@@ -44,6 +46,8 @@ class TesVhostInterface(VppTestCase):
         ifs = self.vapi.cli("show interface")
         self.assertIn('VirtualEthernet0/0/0', ifs)
         self.assertIn('VirtualEthernet0/0/1', ifs)
+        self.assertEqual(self.vapi.cli("show vhost-user").count(
+            "Packed ring enable"), 2 if enable_packed_ring else 0)
 
         # verify they are in the dump also
         if_dump = self.vapi.sw_interface_vhost_user_dump()
@@ -84,16 +88,35 @@ class TesVhostInterface(VppTestCase):
         if_dump = self.vapi.sw_interface_vhost_user_dump()
         self.assertFalse(vhost_if1.is_interface_config_in_dump(if_dump))
 
-    def test_vhost_interface_state(self):
-        """ Vhost User interface states and events test """
-
+    def test_vhost(self):
+        """ Vhost User add/delete interface test """
+        self.vhost_add_delete()
+
+    def test_vhost_packed(self):
+        """ Vhost User add/delete packed ring interface test """
+        self.vhost_add_delete(enable_packed_ring=1)
+
+    def test_vhost_packed_batch(self):
+        """ Vhost User packed ring descriptor batches """
+        for seed in (1, 2, 3):
+            reply = self.vapi.cli("test vhost-user packed batch seed %d "
+                                  "iterations 20000" % seed)
+            m = re.search(r"tests passed, (\d+) of 20000 batches taken",
+                          reply)
+            self.assertIsNotNone(m, reply)
+            # both outcomes were exercised
+            self.assertGreater(int(m.group(1)), 0)
+            self.assertLess(int(m.group(1)), 20000)
+
+    def vhost_interface_state(self, enable_packed_ring=0):
         self.vapi.want_interface_events()
 
         # clear outstanding events
         # (like delete interface events from other tests)
         self.vapi.collect_events()
 
-        vhost_if = VppVhostInterface(self, sock_filename='/tmp/sock1')
+        vhost_if = VppVhostInterface(self, sock_filename='/tmp/sock1',
+                                     enable_packed_ring=enable_packed_ring)
 
         # create vhost interface
         vhost_if.add_vpp_config()
@@ -119,5 +142,13 @@ class TesVhostInterface(VppTestCase):
         events = self.vapi.collect_events()
         self.assert_equal(len(events), 0, "number of events")
 
+    def test_vhost_interface_state(self):
+        """ Vhost User interface states and events test """
+        self.vhost_interface_state()
+
+    def test_vhost_interface_state_packed(self):
+        """ Vhost User packed ring interface states and events test """
+        self.vhost_interface_state(enable_packed_ring=1)
+
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)
@@ -2,8 +2,10 @@
 """ Wg tests """
 
 import datetime
+import time
 import base64
 import os
+import re
 
 from hashlib import blake2s
 from scapy.packet import Packet
@@ -473,6 +475,17 @@ class TestWg(VppTestCase):
 
         self.assertEqual(tgt, act)
 
+    def test_wg_handshake_perf(self):
+        """ Handshake crypto benchmark """
+        reply = self.vapi.cli("test wireguard handshake iterations 100")
+        self.logger.info(reply)
+        self.assertIn("handshakes:", reply)
+
+    def test_wg_x25519(self):
+        """ X25519 known answers """
+        reply = self.vapi.cli("test wireguard x25519")
+        self.assertIn("x25519 known answer tests passed", reply)
+
     def test_wg_peer_resp(self):
         """ Send handshake response """
         port = 12323
@@ -1309,6 +1322,10 @@ class WireguardHandoffTests(TestWg):
     """ Wireguard Tests in multi worker setup """
     vpp_worker_count = 2
 
+    # peers and packets per peer and direction of the multi-peer tests
+    NUM_PEERS = 8
+    N_PKTS = 64
+
     def test_wg_peer_init(self):
         """ Handoff """
 
@@ -1394,6 +1411,119 @@ class WireguardHandoffTests(TestWg):
         peer_1.remove_vpp_config()
         wg0.remove_vpp_config()
 
+    def _wg_output_handoffs(self):
+        """ packets handed off to the peers' output threads """
+        reply = self.vapi.cli("show runtime wg4-output-tun-handoff")
+        return sum(int(m.group(1)) for m in re.finditer(
+            r"wg4-output-tun-handoff\D+\d+\s+(\d+)", reply))
+
+    def _wg_multi_peer_traffic(self, port, is_async):
+        """ bring up peers and pass traffic on both workers, return the
+            time spent in the data path, the number of output handoffs and
+            the number of packets decrypted for each peer """
+
+        self.vapi.wg_set_async_mode(async_enable=is_async)
+        self.vapi.cli("clear runtime")
+
+        wg0 = VppWgInterface(self,
+                             self.pg1.local_ip4,
+                             port).add_vpp_config()
+        wg0.admin_up()
+        wg0.config_ip4()
+
+        self.pg1.generate_remote_hosts(self.NUM_PEERS)
+        self.pg1.configure_ipv4_neighbors()
+
+        peers = []
+        routes = []
+        for i in range(self.NUM_PEERS):
+            peers.append(VppWgPeer(self,
+                                   wg0,
+                                   self.pg1.remote_hosts[i].ip4,
+                                   port+1+i,
+                                   ["10.12.%d.0/24" % i]).add_vpp_config())
+            routes.append(VppIpRoute(self, "10.12.%d.0" % i, 24,
+                                     [VppRoutePath("10.12.%d.1" % i,
+                                                   wg0.sw_if_index)]
+                                     ).add_vpp_config())
+
+        elapsed = 0
+        decrypted = [0] * self.NUM_PEERS
+        for i, peer in enumerate(peers):
+            # complete the handshake
+            p = peer.mk_handshake(self.pg1)
+            rx = self.send_and_expect(self.pg1, [p], self.pg1)
+            peer.consume_response(rx[0])
+
+            # traffic from the peer, i.e. decrypt, pins its input thread
+            p = [(peer.mk_tunnel_header(self.pg1) /
+                  Wireguard(message_type=4, reserved_zero=0) /
+                  WireguardTransport(
+                      receiver_index=peer.sender,
+                      counter=ii,
+                      encrypted_encapsulated_packet=peer.encrypt_transport(
+                          (IP(src="10.12.%d.1" % i,
+                              dst=self.pg0.remote_ip4, ttl=20) /
+                           UDP(sport=222, dport=223) /
+                           Raw(b'\x00' * 80)))))
+                 for ii in range(self.N_PKTS)]
+            start = time.time()
+            rxs = self.send_and_expect(self.pg1, p, self.pg0,
+                                       worker=i % 2)
+            elapsed += time.time() - start
+            for rx in rxs:
+                self.assertEqual(rx[IP].dst, self.pg0.remote_ip4)
+                self.assertEqual(rx[IP].ttl, 19)
+                if rx[IP].src == "10.12.%d.1" % i:
+                    decrypted[i] += 1
+
+            # traffic into the tunnel from both workers, i.e. encrypt
+            pe = (Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac) /
+                  IP(src=self.pg0.remote_ip4, dst="10.12.%d.2" % i) /
+                  UDP(sport=555, dport=556) /
+                  Raw(b'\x00' * 80))
+            for worker in (0, 1):
+                start = time.time()
+                rxs = self.send_and_expect(self.pg0, pe * self.N_PKTS,
+                                           self.pg1, worker=worker)
+                elapsed += time.time() - start
+                peer.validate_encapped(rxs, pe)
+
+        n_handoffs = self._wg_output_handoffs()
+
+        for r in routes:
+            r.remove_vpp_config()
+        for p in peers:
+            p.remove_vpp_config()
+        wg0.remove_vpp_config()
+        self.vapi.wg_set_async_mode(async_enable=False)
+
+        return elapsed, n_handoffs, decrypted
+
+    def test_wg_multi_peer_async(self):
+        """ Multi-peer sync vs async crypto """
+        decrypt_errors = self.statistics.get_err_counter(
+            self.wg4_input_node_name + "Failed during decryption")
+
+        sync_time, sync_handoffs, decrypted = \
+            self._wg_multi_peer_traffic(12393, False)
+        # each peer's output is owned by one worker, the other hands off
+        self.assertGreaterEqual(sync_handoffs, self.NUM_PEERS * self.N_PKTS)
+        self.assertEqual(decrypted, [self.N_PKTS] * self.NUM_PEERS)
+
+        async_time, async_handoffs, decrypted = \
+            self._wg_multi_peer_traffic(12413, True)
+        # every worker encrypts what it received
+        self.assertEqual(async_handoffs, 0)
+        self.assertEqual(decrypted, [self.N_PKTS] * self.NUM_PEERS)
+
+        self.assertEqual(self.statistics.get_err_counter(
+            self.wg4_input_node_name + "Failed during decryption"),
+            decrypt_errors)
+
+        self.logger.info("wireguard %d peers: sync %.3fs async %.3fs" %
+                         (self.NUM_PEERS, sync_time, async_time))
+
     @unittest.skip("test disabled")
     def test_wg_multi_interface(self):
         """ Multi-tunnel on the same port """